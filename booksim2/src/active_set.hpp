@@ -0,0 +1,116 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*active_set.hpp
+ *
+ *Bit set of the timed modules that have work in the current cycle. Modules
+ *are woken up through Insert(), which only marks them as pending so that a
+ *module retired during a phase is not lost; pending modules are merged into
+ *the active set at the beginning of every phase. Modules are retired once
+ *they report that they are quiescent after WriteOutputs.
+ *
+ *Insertions can come from several worker threads of the parallel engine,
+ *so the words are updated atomically.
+ */
+
+#ifndef _ACTIVE_SET_HPP_
+#define _ACTIVE_SET_HPP_
+
+#include <vector>
+#include <atomic>
+#include <cassert>
+#include <algorithm>
+
+class ActiveSet {
+
+  typedef unsigned long long word_t;
+  static const int WORD_BITS = 64;
+
+  int _size;
+  std::vector<std::atomic<word_t> > _active;
+  std::vector<std::atomic<word_t> > _pending;
+
+public:
+  ActiveSet( ) : _size( 0 ) {}
+
+  // all modules start out active
+  void Resize( int size ) {
+    _size = size;
+    int const words = ( size + WORD_BITS - 1 ) / WORD_BITS;
+    std::vector<std::atomic<word_t> > active( words ), pending( words );
+    _active.swap( active );
+    _pending.swap( pending );
+    for ( int w = 0; w < words; ++w ) {
+      int const bits = std::min( WORD_BITS, size - w * WORD_BITS );
+      word_t const mask = ( bits == WORD_BITS ) ? ~0ULL : ( ( 1ULL << bits ) - 1 );
+      _active[w].store( mask, std::memory_order_relaxed );
+      _pending[w].store( 0, std::memory_order_relaxed );
+    }
+  }
+
+  int Size( ) const { return _size; }
+
+  inline void Insert( int id ) {
+    assert( ( id >= 0 ) && ( id < _size ) );
+    _pending[id / WORD_BITS].fetch_or( 1ULL << ( id % WORD_BITS ),
+                                       std::memory_order_relaxed );
+  }
+
+  inline void Remove( int id ) {
+    assert( ( id >= 0 ) && ( id < _size ) );
+    _active[id / WORD_BITS].fetch_and( ~( 1ULL << ( id % WORD_BITS ) ),
+                                       std::memory_order_relaxed );
+  }
+
+  // fold the pending modules into the active set
+  void Merge( ) {
+    for ( size_t w = 0; w < _pending.size( ); ++w ) {
+      word_t const p = _pending[w].load( std::memory_order_relaxed );
+      if ( p ) {
+        _pending[w].store( 0, std::memory_order_relaxed );
+        _active[w].fetch_or( p, std::memory_order_relaxed );
+      }
+    }
+  }
+
+  // first active module in [id, end), or end if there is none
+  inline int Next( int id, int end ) const {
+    while ( id < end ) {
+      int const w = id / WORD_BITS;
+      word_t const bits = _active[w].load( std::memory_order_relaxed ) >>
+        ( id % WORD_BITS );
+      if ( bits ) {
+        id += __builtin_ctzll( bits );
+        return ( id < end ) ? id : end;
+      }
+      id = ( w + 1 ) * WORD_BITS;
+    }
+    return end;
+  }
+};
+
+#endif
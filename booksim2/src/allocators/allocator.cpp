@@ -41,6 +41,8 @@
 #include "selalloc.hpp"
 #include "separable_input_first.hpp"
 #include "separable_output_first.hpp"
+#include "separable_input_first_bits.hpp"
+#include "wavefront_bits.hpp"
 //
 /////////////////////////////////////////////////////////////////////////
 
@@ -419,6 +421,184 @@ void SparseAllocator::PrintRequests( ostream * os ) const
   *os << "]." << endl;
 }
 
+//==================================================
+// BitmaskAllocator
+//==================================================
+
+BitmaskAllocator::BitmaskAllocator( Module *parent, const string& name,
+				    int inputs, int outputs ) :
+  Allocator( parent, name, inputs, outputs ), _mixed_pri( false )
+{
+  _request.resize(_inputs*_outputs);
+  _in_occ.resize(_inputs);
+  _out_occ.resize(_outputs);
+  _in_req.resize(_inputs, BitMask(_outputs));
+  _out_req.resize(_outputs, BitMask(_inputs));
+}
+
+void BitmaskAllocator::Clear( )
+{
+  for ( int i = _in_occ.next(0); i < _inputs; i = _in_occ.next(i+1) ) {
+    _in_req[i].clear( );
+  }
+  for ( int j = _out_occ.next(0); j < _outputs; j = _out_occ.next(j+1) ) {
+    _out_req[j].clear( );
+  }
+
+  _in_occ.clear( );
+  _out_occ.clear( );
+  _mixed_pri = false;
+
+  Allocator::Clear();
+}
+
+int BitmaskAllocator::ReadRequest( int in, int out ) const
+{
+  sRequest r;
+
+  if ( ! ReadRequest( r, in, out ) ) {
+    r.label = -1;
+  } 
+
+  return r.label;
+}
+
+bool BitmaskAllocator::ReadRequest( sRequest &req, int in, int out ) const
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+
+  if ( !_in_req[in].count(out) ) {
+    return false;
+  }
+  req = _Request(in, out);
+  return true;
+}
+
+void BitmaskAllocator::AddRequest( int in, int out, int label, 
+				   int in_pri, int out_pri )
+{
+  Allocator::AddRequest(in, out, label, in_pri, out_pri);
+  assert( !_in_req[in].count(out) );
+  assert( !_out_req[out].count(in) );
+
+  // compare against any request that is already present
+  if ( !_mixed_pri && !_in_occ.empty( ) ) {
+    const int first = _in_occ.next(0);
+    const sRequest & r = _Request(first, _in_req[first].next(0));
+    _mixed_pri = ( r.in_pri != in_pri ) || ( r.out_pri != out_pri );
+  }
+
+  _in_occ.insert(in);
+  _out_occ.insert(out);
+  _in_req[in].insert(out);
+  _out_req[out].insert(in);
+
+  sRequest & req = _Request(in, out);
+  req.port    = out;
+  req.label   = label;
+  req.in_pri  = in_pri;
+  req.out_pri = out_pri;
+}
+
+void BitmaskAllocator::RemoveRequest( int in, int out, int label )
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) ); 
+  
+  assert( _in_req[in].count( out ) > 0 );
+  assert( _Request(in, out).label == label );
+
+  _in_req[in].erase( out );
+  if ( _in_req[in].empty( ) ) {
+    _in_occ.erase(in);
+  }
+  _out_req[out].erase( in );
+  if ( _out_req[out].empty( ) ) {
+    _out_occ.erase(out);
+  }
+}
+
+bool BitmaskAllocator::InputHasRequests( int in ) const
+{
+  return _in_occ.count(in) > 0;
+}
+
+bool BitmaskAllocator::OutputHasRequests( int out ) const
+{
+  return _out_occ.count(out) > 0;
+}
+
+int BitmaskAllocator::NumInputRequests( int in ) const
+{
+  return _in_req[in].size();
+}
+
+int BitmaskAllocator::NumOutputRequests( int out ) const
+{
+  return _out_req[out].size();
+}
+
+int BitmaskAllocator::_RoundRobin( const BitMask &reqs, int offset, 
+				   int base, int stride, 
+				   int sRequest::* pri ) const
+{
+  if ( !_mixed_pri ) {
+    return reqs.next_cyclic(offset);
+  }
+
+  // visit the requests in round-robin order; only a strictly higher
+  // priority supersedes an earlier request
+  const int size = reqs.capacity();
+  int best = -1;
+  int best_pri = 0;
+  for ( int i = reqs.next(offset); i < size; i = reqs.next(i+1) ) {
+    const int p = _request[base+i*stride].*pri;
+    if ( ( best < 0 ) || ( p > best_pri ) ) {
+      best = i;
+      best_pri = p;
+    }
+  }
+  for ( int i = reqs.next(0); i < offset; i = reqs.next(i+1) ) {
+    const int p = _request[base+i*stride].*pri;
+    if ( ( best < 0 ) || ( p > best_pri ) ) {
+      best = i;
+      best_pri = p;
+    }
+  }
+  return best;
+}
+
+void BitmaskAllocator::PrintRequests( ostream * os ) const
+{
+  if(!os) os = &cout;
+  
+  *os << "Input requests = [ ";
+  for ( int input = 0; input < _inputs; ++input ) {
+    if(!_in_req[input].empty()) {
+      *os << input << " -> [ ";
+      for ( int output = _in_req[input].next(0); output < _outputs;
+	    output = _in_req[input].next(output+1) ) {
+	*os << output << "@" << _Request(input, output).in_pri << " ";
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "], output requests = [ ";
+  for ( int output = 0; output < _outputs; ++output ) {
+    if(!_out_req[output].empty()) {
+      *os << output << " -> ";
+      *os << "[ ";
+      for ( int input = _out_req[output].next(0); input < _inputs;
+	    input = _out_req[output].next(input+1) ) {
+	*os << input << "@" << _Request(input, output).out_pri << " ";
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "]." << endl;
+}
+
 //==================================================
 // Global allocator allocation function
 //==================================================
@@ -458,6 +638,10 @@ Allocator *Allocator::NewAllocator( Module *parent, const string& name,
     a = new Wavefront( parent, name, inputs, outputs );
   } else if ( alloc_name == "rr_wavefront" ) {
     a = new Wavefront( parent, name, inputs, outputs, true );
+  } else if ( alloc_name == "wavefront_bits" ) {
+    a = new WavefrontBits( parent, name, inputs, outputs );
+  } else if ( alloc_name == "rr_wavefront_bits" ) {
+    a = new WavefrontBits( parent, name, inputs, outputs, true );
   } else if ( alloc_name == "select" ) {
     int iters = param_str.empty() ? (config ? config->GetInt("alloc_iters") : 1) : atoi(param_str.c_str());
     a = new SelAlloc( parent, name, inputs, outputs, iters );
@@ -469,6 +653,12 @@ Allocator *Allocator::NewAllocator( Module *parent, const string& name,
     string arb_type = param_str.empty() ? (config ? config->GetStr("arb_type") : "round_robin") : param_str;
     a = new SeparableOutputFirstAllocator( parent, name, inputs, outputs,
 					   arb_type );
+  } else if (alloc_name == "separable_input_first_bits") {
+    // the bitmask version implements round-robin arbiters only
+    string arb_type = param_str.empty() ? (config ? config->GetStr("arb_type") : "round_robin") : param_str;
+    if((arb_type == "round_robin") || (arb_type == "round_robin_bits")) {
+      a = new SeparableInputFirstBitsAllocator( parent, name, inputs, outputs );
+    }
   }
 
 //==================================================
@@ -35,6 +35,9 @@
 
 #include "module.hpp"
 #include "config_utils.hpp"
+#include "bitmask.hpp"
+
+class Checkpoint;
 
 class Allocator : public Module {
 protected:
@@ -81,6 +84,9 @@ public:
   virtual void PrintRequests( ostream * os = NULL ) const = 0;
   void PrintGrants( ostream * os = NULL ) const;
 
+  // save or restore the state that carries over between allocations
+  virtual void Serialize( Checkpoint & cp ) {}
+
   static Allocator *NewAllocator( Module *parent, const string& name,
 				  const string &alloc_type, 
 				  int inputs, int outputs, 
@@ -155,4 +161,59 @@ public:
 
 };
 
+//==================================================
+// A bitmask allocator keeps the requests of each
+// input and output as bitmasks, plus a flat array
+// with the request labels and priorities.
+//==================================================
+
+class BitmaskAllocator : public Allocator {
+protected:
+  vector<sRequest> _request;
+
+  BitMask _in_occ;
+  BitMask _out_occ;
+
+  vector<BitMask> _in_req;
+  vector<BitMask> _out_req;
+
+  // set once requests with different priorities were added
+  bool _mixed_pri;
+
+  inline sRequest & _Request( int in, int out ) {
+    return _request[in*_outputs+out];
+  }
+  inline const sRequest & _Request( int in, int out ) const {
+    return _request[in*_outputs+out];
+  }
+
+  // winner among the requests in reqs of a round-robin arbiter pointing at
+  // offset, taking into account the given priority field of the requests
+  // at _request[base+i*stride]
+  int _RoundRobin( const BitMask &reqs, int offset, int base, int stride,
+		   int sRequest::* pri ) const;
+
+public:
+  BitmaskAllocator( Module *parent, const string& name,
+		    int inputs, int outputs );
+
+  void Clear( );
+  
+  int  ReadRequest( int in, int out ) const;
+  bool ReadRequest( sRequest &req, int in, int out ) const;
+
+  void AddRequest( int in, int out, int label = 1, 
+		   int in_pri = 0, int out_pri = 0 );
+  void RemoveRequest( int in, int out, int label = 1 );
+  
+  bool OutputHasRequests( int out ) const;
+  bool InputHasRequests( int in ) const;
+
+  int NumOutputRequests( int out ) const;
+  int NumInputRequests( int in ) const;
+
+  void PrintRequests( ostream * os = NULL ) const;
+
+};
+
 #endif
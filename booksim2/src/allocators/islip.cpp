@@ -30,6 +30,7 @@
 
 #include "islip.hpp"
 #include "random_utils.hpp"
+#include "checkpoint.hpp"
 
 //#define DEBUG_ISLIP
 
@@ -181,3 +182,9 @@ void iSLIP_Sparse::Allocate( )
   cout << endl;
 #endif
 }
+
+void iSLIP_Sparse::Serialize( Checkpoint & cp )
+{
+  cp.Sync( _gptrs );
+  cp.Sync( _aptrs );
+}
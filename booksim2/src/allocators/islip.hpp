@@ -43,6 +43,7 @@ public:
 		int inputs, int outputs, int iters );
 
   void Allocate( );
+  virtual void Serialize( Checkpoint & cp );
 };
 
 #endif 
@@ -30,6 +30,7 @@
 
 #include "loa.hpp"
 #include "random_utils.hpp"
+#include "checkpoint.hpp"
 
 LOA::LOA( Module *parent, const string& name,
 	  int inputs, int outputs ) :
@@ -109,4 +110,8 @@ void LOA::Allocate( )
 
 }
 
-
+void LOA::Serialize( Checkpoint & cp )
+{
+  cp.Sync( _rptr );
+  cp.Sync( _gptr );
+}
@@ -44,6 +44,7 @@ public:
        int inputs, int outputs );
 
   void Allocate( );
+  virtual void Serialize( Checkpoint & cp );
 };
 
 #endif
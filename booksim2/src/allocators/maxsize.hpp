@@ -46,6 +46,7 @@ public:
   ~MaxSizeMatch( );
   
   void Allocate( );
+  virtual void Serialize( Checkpoint & cp );
 };
 
 #endif 
@@ -30,6 +30,7 @@
 
 #include "selalloc.hpp"
 #include "random_utils.hpp"
+#include "checkpoint.hpp"
 
 //#define DEBUG_SELALLOC
 
@@ -252,3 +253,9 @@ void SelAlloc::PrintRequests( ostream * os ) const
   *os << "]." << endl;
 }
 
+void SelAlloc::Serialize( Checkpoint & cp )
+{
+  cp.Sync( _aptrs );
+  cp.Sync( _gptrs );
+  cp.Sync( _outmask );
+}
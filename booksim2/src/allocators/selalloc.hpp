@@ -45,6 +45,7 @@ public:
 	    int inputs, int outputs, int iters );
 
   void Allocate( );
+  virtual void Serialize( Checkpoint & cp );
 
   void MaskOutput( int out, int mask = 1 );
 
@@ -36,6 +36,7 @@
 #include <sstream>
 
 #include "arbiter.hpp"
+#include "checkpoint.hpp"
 
 SeparableAllocator::SeparableAllocator( Module* parent, const string& name,
 					int inputs, int outputs,
@@ -84,3 +85,12 @@ void SeparableAllocator::Clear() {
   }
   SparseAllocator::Clear();
 }
+
+void SeparableAllocator::Serialize( Checkpoint & cp ) {
+  for ( int i = 0 ; i < _inputs ; i++ ) {
+    _input_arb[i]->Serialize( cp ) ;
+  }
+  for ( int o = 0; o < _outputs; o++ ) {
+    _output_arb[o]->Serialize( cp ) ;
+  }
+}
@@ -0,0 +1,91 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  SeparableInputFirstBitsAllocator: Separable Input-First Allocator
+//  with round-robin arbiters operating on request bitmasks
+//
+//  Produces the same grants as SeparableInputFirstAllocator with
+//  round_robin arbiters.
+//
+// ----------------------------------------------------------------------
+
+#include "separable_input_first_bits.hpp"
+
+#include "booksim.hpp"
+#include "checkpoint.hpp"
+
+SeparableInputFirstBitsAllocator::
+SeparableInputFirstBitsAllocator( Module* parent, const string& name,
+				  int inputs, int outputs )
+  : BitmaskAllocator( parent, name, inputs, outputs ),
+    _in_pointer( inputs, 0 ), _out_pointer( outputs, 0 ),
+    _out_cand( outputs, BitMask( inputs ) ), _cand_occ( outputs )
+{}
+
+void SeparableInputFirstBitsAllocator::Allocate() {
+  
+  // Execute the input arbiters and propagate the grants to the output
+  // arbiters.
+
+  for(int input = _in_occ.next(0); input < _inputs;
+      input = _in_occ.next(input + 1)) {
+
+    const int output = _RoundRobin(_in_req[input], _in_pointer[input],
+				   input * _outputs, 1, &sRequest::in_pri);
+    assert(output > -1);
+
+    _out_cand[output].insert(input);
+    _cand_occ.insert(output);
+  }
+
+  // Execute the output arbiters.
+
+  for(int output = _cand_occ.next(0); output < _outputs;
+      output = _cand_occ.next(output + 1)) {
+
+    const int input = _RoundRobin(_out_cand[output], _out_pointer[output],
+				  output, _outputs, &sRequest::out_pri);
+    assert(input > -1);
+    assert((_inmatch[input] == -1) && (_outmatch[output] == -1));
+
+    _inmatch[input] = output;
+    _outmatch[output] = input;
+    _in_pointer[input] = (output + 1) % _outputs;
+    _out_pointer[output] = (input + 1) % _inputs;
+
+    _out_cand[output].clear();
+  }
+  _cand_occ.clear();
+}
+
+void SeparableInputFirstBitsAllocator::Serialize( Checkpoint & cp )
+{
+  cp.Sync( _in_pointer );
+  cp.Sync( _out_pointer );
+}
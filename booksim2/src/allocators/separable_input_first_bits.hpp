@@ -0,0 +1,62 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  SeparableInputFirstBitsAllocator: Separable Input-First Allocator
+//  with round-robin arbiters operating on request bitmasks
+//
+// ----------------------------------------------------------------------
+
+#ifndef _SEPARABLE_INPUT_FIRST_BITS_HPP_
+#define _SEPARABLE_INPUT_FIRST_BITS_HPP_
+
+#include <vector>
+
+#include "allocator.hpp"
+
+class SeparableInputFirstBitsAllocator : public BitmaskAllocator {
+
+  // round-robin pointers of the input and output arbiters
+  vector<int> _in_pointer ;
+  vector<int> _out_pointer ;
+
+  // inputs that forwarded a request to each output
+  vector<BitMask> _out_cand ;
+  BitMask _cand_occ ;
+
+public:
+  
+  SeparableInputFirstBitsAllocator( Module* parent, const string& name,
+				    int inputs, int outputs ) ;
+
+  virtual void Allocate() ;
+  virtual void Serialize( Checkpoint & cp ) ;
+
+} ;
+
+#endif
@@ -52,6 +52,7 @@ public:
   virtual void AddRequest( int in, int out, int label = 1, 
 			   int in_pri = 0, int out_pri = 0 );
   virtual void Allocate( );
+  virtual void Serialize( Checkpoint & cp );
 };
 
 #endif
@@ -0,0 +1,169 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*wavefront_bits.cpp
+ *
+ *The wave front allocator over request bitmasks
+ *
+ *The requests are also kept per diagonal of the (square) request matrix,
+ *as a mask over the outputs, so the requests on a diagonal that hit free
+ *outputs are found a word at a time. As all cells of a diagonal belong to
+ *different inputs and outputs, they can be granted in any order. Produces
+ *the same grants as Wavefront.
+ *
+ */
+#include "booksim.hpp"
+
+#include <algorithm>
+
+#include "wavefront_bits.hpp"
+#include "checkpoint.hpp"
+
+WavefrontBits::WavefrontBits( Module *parent, const string& name,
+			      int inputs, int outputs, bool skip_diags ) :
+  BitmaskAllocator( parent, name, inputs, outputs ),
+  _skip_diags(skip_diags), _square(max(inputs, outputs)), _pri(0)
+{
+  _diag.resize(_square, BitMask(_outputs));
+  _diag_occ.resize(_square);
+  _out_busy.resize(_outputs);
+}
+
+void WavefrontBits::Clear( )
+{
+  for ( int d = _diag_occ.next(0); d < _square; d = _diag_occ.next(d+1) ) {
+    _diag[d].clear();
+  }
+  _diag_occ.clear();
+  BitmaskAllocator::Clear();
+}
+
+void WavefrontBits::AddRequest( int in, int out, int label, 
+				int in_pri, int out_pri )
+{
+  BitmaskAllocator::AddRequest(in, out, label, in_pri, out_pri);
+  const int d = ( in + out ) % _square;
+  _diag[d].insert(out);
+  _diag_occ.insert(d);
+}
+
+void WavefrontBits::RemoveRequest( int in, int out, int label )
+{
+  BitmaskAllocator::RemoveRequest(in, out, label);
+  const int d = ( in + out ) % _square;
+  _diag[d].erase(out);
+  if ( _diag[d].empty() ) {
+    _diag_occ.erase(d);
+  }
+}
+
+void WavefrontBits::_Sweep( int &first_diag, const pair<int, int> * pri )
+{
+  // visit the occupied diagonals in order, starting at the priority diagonal
+  for ( int pass = 0; pass < 2; ++pass ) {
+    const int begin = pass ? 0 : _pri;
+    const int end = pass ? _pri : _square;
+    for ( int d = _diag_occ.next(begin); d < end; d = _diag_occ.next(d+1) ) {
+      const BitMask & diag = _diag[d];
+      for ( int w = 0; w < diag.words(); ++w ) {
+	BitMask::word_t cand = diag.word(w) & ~_out_busy.word(w);
+	while ( cand ) {
+	  const int output = w * BitMask::WORD_BITS + __builtin_ctzll(cand);
+	  cand &= cand - 1;
+	  const int input = ( d + _square - output ) % _square;
+	  if ( _inmatch[input] != -1 ) {
+	    continue;
+	  }
+	  if ( pri ) {
+	    const sRequest & req = _Request(input, output);
+	    if ( ( req.out_pri != pri->first ) || ( req.in_pri != pri->second ) ) {
+	      continue;
+	    }
+	  }
+	  // Grant!
+	  _inmatch[input] = output;
+	  _outmatch[output] = input;
+	  _out_busy.insert(output);
+	  if(first_diag < 0) {
+	    first_diag = d;
+	  }
+	}
+      }
+    }
+  }
+}
+
+void WavefrontBits::Allocate( )
+{
+  if(_in_occ.empty())
+
+    // bypass allocator completely if there were no requests
+    return;
+
+  int first_diag = -1;
+
+  if(!_mixed_pri) {
+
+    _Sweep(first_diag);
+
+  } else {
+
+    // sweep the diagonals once per distinct priority pair, starting with
+    // the highest output priority, then the highest input priority
+
+    vector<pair<int, int> > priorities;
+    for ( int input = _in_occ.next(0); input < _inputs; 
+	  input = _in_occ.next(input+1) ) {
+      for ( int output = _in_req[input].next(0); output < _outputs;
+	    output = _in_req[input].next(output+1) ) {
+	const sRequest & req = _Request(input, output);
+	priorities.push_back(make_pair(req.out_pri, req.in_pri));
+      }
+    }
+    sort(priorities.begin(), priorities.end());
+    priorities.erase(unique(priorities.begin(), priorities.end()),
+		     priorities.end());
+
+    for(vector<pair<int, int> >::const_reverse_iterator iter = 
+	  priorities.rbegin();
+	iter != priorities.rend(); ++iter) {
+      _Sweep(first_diag, &(*iter));
+    }
+  }
+
+  _out_busy.clear();
+  
+  assert(first_diag >= 0);
+
+  // Round-robin the priority diagonal
+  _pri = ( ( _skip_diags ? first_diag : _pri ) + 1 ) % _square;
+}
+
+void WavefrontBits::Serialize( Checkpoint & cp )
+{
+  cp.Sync( _pri );
+}
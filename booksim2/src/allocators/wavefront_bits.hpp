@@ -0,0 +1,67 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _WAVEFRONT_BITS_HPP_
+#define _WAVEFRONT_BITS_HPP_
+
+#include <vector>
+
+#include "allocator.hpp"
+
+class WavefrontBits : public BitmaskAllocator {
+
+private:
+  bool _skip_diags;
+
+  // requests on each diagonal, indexed by output
+  vector<BitMask> _diag;
+  BitMask _diag_occ;
+  BitMask _out_busy;
+
+  // grant the free requests on the diagonals, starting with the priority
+  // diagonal; if pri is given, only requests with these priorities
+  void _Sweep( int &first_diag, const pair<int, int> * pri = NULL );
+
+protected:
+  int _square;
+  int _pri;
+
+public:
+  WavefrontBits( Module *parent, const string& name,
+		 int inputs, int outputs, bool skip_diags = false );
+  
+  virtual void Clear( );
+
+  virtual void AddRequest( int in, int out, int label = 1, 
+			   int in_pri = 0, int out_pri = 0 );
+  virtual void RemoveRequest( int in, int out, int label = 1 );
+
+  virtual void Allocate( );
+  virtual void Serialize( Checkpoint & cp );
+};
+
+#endif
@@ -35,6 +35,8 @@
 #include "roundrobin_arb.hpp"
 #include "matrix_arb.hpp"
 #include "tree_arb.hpp"
+#include "roundrobin_bits_arb.hpp"
+#include "matrix_bits_arb.hpp"
 
 #include <limits>
 #include <cassert>
@@ -96,6 +98,10 @@ Arbiter *Arbiter::NewArbiter( Module *parent, const string& name,
     a = new RoundRobinArbiter( parent, name, size );
   } else if(arb_type == "matrix") {
     a = new MatrixArbiter( parent, name, size );
+  } else if(arb_type == "round_robin_bits") {
+    a = new RoundRobinBitsArbiter( parent, name, size );
+  } else if(arb_type == "matrix_bits") {
+    a = new MatrixBitsArbiter( parent, name, size );
   } else if(arb_type.substr(0, 5) == "tree(") {
     size_t left = 4;
     size_t middle = arb_type.find_first_of(',');
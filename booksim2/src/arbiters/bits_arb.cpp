@@ -0,0 +1,73 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// ----------------------------------------------------------------------
+//
+//  BitsArbiter: Base class for arbiters that keep their requests as
+//  bitmasks, with a separate bucket for the highest priority
+//
+// ----------------------------------------------------------------------
+
+#include "bits_arb.hpp"
+
+#include <cassert>
+
+using namespace std ;
+
+BitsArbiter::BitsArbiter( Module *parent, const string &name, int size )
+  : Arbiter( parent, name, size ), _valid( size ), _top( size )
+{
+}
+
+void BitsArbiter::AddRequest( int input, int id, int pri )
+{
+  assert( 0 <= input && input < _size ) ;
+  assert( !_valid.count( input ) );
+
+  if ( ( _num_reqs == 0 ) || ( pri > _highest_pri ) ) {
+    _top.clear();
+    _highest_pri = pri;
+  }
+  if ( pri == _highest_pri ) {
+    _top.insert( input );
+  }
+
+  // the valid flags of the entries are not used
+  _num_reqs++ ;
+  _valid.insert( input );
+  _request[input].id = id ;
+  _request[input].pri = pri ;
+}
+
+void BitsArbiter::Clear()
+{
+  if(_num_reqs > 0) {
+    _valid.clear() ;
+    _top.clear() ;
+    _num_reqs = 0 ;
+    _selected = -1;
+  }
+}
@@ -0,0 +1,67 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// ----------------------------------------------------------------------
+//
+//  BitsArbiter: Base class for arbiters that keep their requests as
+//  bitmasks, with a separate bucket for the highest priority
+//
+// ----------------------------------------------------------------------
+
+#ifndef _BITS_ARB_HPP_
+#define _BITS_ARB_HPP_
+
+#include "arbiter.hpp"
+#include "bitmask.hpp"
+
+class BitsArbiter : public Arbiter {
+
+protected:
+
+  // all requests, and the ones with the highest priority; the requests
+  // with a lower priority can never win, so they need no bucket of their
+  // own
+  BitMask _valid ;
+  BitMask _top ;
+
+  // requests that can win the arbitration
+  inline const BitMask & _Candidates() const {
+    return _top ;
+  }
+
+public:
+
+  // Constructors
+  BitsArbiter( Module *parent, const string &name, int size ) ;
+
+  // Register request with arbiter
+  virtual void AddRequest( int input, int id, int pri ) ;
+
+  virtual void Clear();
+
+} ;
+
+#endif
@@ -0,0 +1,133 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// ----------------------------------------------------------------------
+//
+//  MatrixBits: Matrix Arbiter over request bitmasks
+//
+//  Grants the same requests as MatrixArbiter: among the requests of the
+//  highest priority, the one that no other request takes precedence over.
+//
+// ----------------------------------------------------------------------
+
+#include "matrix_bits_arb.hpp"
+#include "checkpoint.hpp"
+#include <iostream>
+using namespace std ;
+
+MatrixBitsArbiter::MatrixBitsArbiter( Module *parent, const string &name,
+				      int size )
+  : BitsArbiter( parent, name, size ), _last_req(-1) {
+  _words = ( size + BitMask::WORD_BITS - 1 ) / BitMask::WORD_BITS;
+  _matrix.resize(size * _words, 0);
+  for ( int i = 0 ; i < size ; i++ ) {
+    for ( int j = 0; j < i; j++ ) {
+      _matrix[j * _words + i / BitMask::WORD_BITS] |= 
+	1ULL << ( i % BitMask::WORD_BITS );
+    }
+  }
+}
+
+void MatrixBitsArbiter::PrintState() const  {
+  cout << "Priority Matrix: " << endl ;
+  for ( int r = 0; r < _size ; r++ ) {
+    for ( int c = 0 ; c < _size ; c++ ) {
+      cout << ( ( _matrix[c * _words + r / BitMask::WORD_BITS] >> 
+		  ( r % BitMask::WORD_BITS ) ) & 1 ) << " " ;
+    }
+    cout << endl ;
+  }
+  cout << endl ;
+}
+
+void MatrixBitsArbiter::UpdateState() {
+  // update priority matrix using last grant
+  if ( _selected > -1 ) {
+    const int w = _selected / BitMask::WORD_BITS;
+    const BitMask::word_t bit = 1ULL << ( _selected % BitMask::WORD_BITS );
+    for ( int i = 0; i < _size ; i++ ) {
+      _matrix[i * _words + w] &= ~bit;
+    }
+    // all other inputs now take precedence over the selected one
+    BitMask::word_t * const col = &_matrix[_selected * _words];
+    for ( int v = 0; v < _words - 1; v++ ) {
+      col[v] = ~0ULL;
+    }
+    col[_words - 1] = ( _size % BitMask::WORD_BITS ) ? 
+      ( ( 1ULL << ( _size % BitMask::WORD_BITS ) ) - 1 ) : ~0ULL;
+    col[w] &= ~bit;
+  }
+}
+
+void MatrixBitsArbiter::AddRequest( int input, int id, int pri )
+{
+  _last_req = input;
+  BitsArbiter::AddRequest(input, id, pri);
+}
+
+int MatrixBitsArbiter::Arbitrate( int* id, int* pri ) {
+  
+  // avoid running arbiter if it has not recevied at least two requests
+  // (in this case, requests and grants are identical)
+  if ( _num_reqs < 2 ) {
+    
+    _selected = _last_req ;
+    
+  } else {
+
+    _selected = -1 ;
+
+    // grant the candidate whose column has no other candidate in it
+    const BitMask & cand = _Candidates();
+    for ( int input = cand.next(0); input < _size; input = cand.next(input+1) ) {
+      const BitMask::word_t * const col = &_matrix[input * _words];
+      bool grant = true;
+      for ( int v = 0; v < _words; v++ ) {
+	if ( col[v] & cand.word(v) ) {
+	  grant = false;
+	  break;
+	}
+      }
+      if ( grant ) {
+	_selected = input ;
+	break ; 
+      }
+    }
+  }
+    
+  return Arbiter::Arbitrate(id, pri);
+}
+
+void MatrixBitsArbiter::Clear()
+{
+  _last_req = -1;
+  BitsArbiter::Clear();
+}
+
+void MatrixBitsArbiter::Serialize( Checkpoint & cp )
+{
+  cp.Sync( _matrix );
+}
@@ -59,6 +59,7 @@ public:
   virtual void AddRequest( int input, int id, int pri ) ;
 
   virtual void Clear();
+  virtual void Serialize( Checkpoint & cp );
 
   static inline bool Supersedes(int input1, int pri1, int input2, int pri2, int offset, int size)
   {
@@ -117,3 +117,11 @@ void TreeArbiter::Clear()
   _global_arbiter->Clear();
   Arbiter::Clear();
 }
+
+void TreeArbiter::Serialize( Checkpoint & cp )
+{
+  for ( size_t i = 0; i < _group_arbiters.size( ); ++i ) {
+    _group_arbiters[i]->Serialize( cp );
+  }
+  _global_arbiter->Serialize( cp );
+}
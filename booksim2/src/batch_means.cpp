@@ -0,0 +1,178 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*batch_means.cpp
+ *
+ *batch means confidence intervals and MSER-5 warmup detection
+ */
+
+#include <cassert>
+#include <cmath>
+
+#include "batch_means.hpp"
+
+// inverse of the standard normal distribution (Acklam's rational
+// approximation, relative error below 1.2e-9)
+static double NormalQuantile( double p )
+{
+  static double const a[] = { -3.969683028665376e+01, 2.209460984245205e+02,
+                              -2.759285104469687e+02, 1.383577518672690e+02,
+                              -3.066479806614716e+01, 2.506628277459239e+00 };
+  static double const b[] = { -5.447609879822406e+01, 1.615858368580409e+02,
+                              -1.556989798598866e+02, 6.680131188771972e+01,
+                              -1.328068155288572e+01 };
+  static double const c[] = { -7.784894002430293e-03, -3.223964580411365e-01,
+                              -2.400758277161838e+00, -2.549732539343734e+00,
+                              4.374664141464968e+00, 2.938163982698783e+00 };
+  static double const d[] = { 7.784695709041462e-03, 3.224671290700398e-01,
+                              2.445134137142996e+00, 3.754408661907416e+00 };
+
+  assert( ( p > 0.0 ) && ( p < 1.0 ) );
+  double const p_low = 0.02425;
+  if ( p < p_low ) {
+    double const q = sqrt( -2.0 * log( p ) );
+    return ( ( ( ( ( c[0] * q + c[1] ) * q + c[2] ) * q + c[3] ) * q + c[4] ) * q + c[5] ) /
+      ( ( ( ( d[0] * q + d[1] ) * q + d[2] ) * q + d[3] ) * q + 1.0 );
+  } else if ( p > 1.0 - p_low ) {
+    return -NormalQuantile( 1.0 - p );
+  }
+  double const q = p - 0.5;
+  double const r = q * q;
+  return ( ( ( ( ( a[0] * r + a[1] ) * r + a[2] ) * r + a[3] ) * r + a[4] ) * r + a[5] ) * q /
+    ( ( ( ( ( b[0] * r + b[1] ) * r + b[2] ) * r + b[3] ) * r + b[4] ) * r + 1.0 );
+}
+
+// quantile of Student's t distribution with df degrees of freedom
+// (Cornish-Fisher expansion around the normal quantile)
+static double StudentQuantile( double p, int df )
+{
+  double const z = NormalQuantile( p );
+  double const z2 = z * z;
+  double const v = (double)df;
+  return z + z * ( z2 + 1.0 ) / ( 4.0 * v ) +
+    z * ( ( 5.0 * z2 + 16.0 ) * z2 + 3.0 ) / ( 96.0 * v * v ) +
+    z * ( ( ( 3.0 * z2 + 19.0 ) * z2 + 17.0 ) * z2 - 15.0 ) / ( 384.0 * v * v * v );
+}
+
+BatchMeans::BatchMeans( int min_batches ) : _min_batches( min_batches )
+{
+  assert( _min_batches >= 2 );
+}
+
+void BatchMeans::Clear( )
+{
+  _obs.clear();
+}
+
+void BatchMeans::AddObservation( double x )
+{
+  _obs.push_back( x );
+}
+
+bool BatchMeans::Interval( double confidence, double * mean,
+                           double * half_width, int * batches ) const
+{
+  assert( ( confidence > 0.0 ) && ( confidence < 1.0 ) );
+  int const n = _obs.size();
+  double const z = NormalQuantile( 0.5 * ( 1.0 + confidence ) );
+
+  for ( int size = 1; n / size >= _min_batches; size *= 2 ) {
+    int const k = n / size;
+    int const first = n - k * size;
+
+    vector<double> means( k, 0.0 );
+    double sum = 0.0;
+    for ( int i = 0; i < k; ++i ) {
+      for ( int j = 0; j < size; ++j ) {
+        means[i] += _obs[first + i * size + j];
+      }
+      means[i] /= (double)size;
+      sum += means[i];
+    }
+    double const avg = sum / (double)k;
+
+    double var = 0.0;
+    double cov = 0.0;
+    for ( int i = 0; i < k; ++i ) {
+      var += ( means[i] - avg ) * ( means[i] - avg );
+      if ( i > 0 ) {
+        cov += ( means[i] - avg ) * ( means[i - 1] - avg );
+      }
+    }
+
+    // the batch means of a constant series are trivially independent
+    double const lag1 = ( var > 0.0 ) ? ( cov / var ) : 0.0;
+    if ( lag1 > z / sqrt( (double)k ) ) {
+      continue;
+    }
+
+    *mean = avg;
+    *half_width = StudentQuantile( 0.5 * ( 1.0 + confidence ), k - 1 ) *
+      sqrt( var / (double)( k - 1 ) / (double)k );
+    *batches = k;
+    return true;
+  }
+  return false;
+}
+
+int BatchMeans::MSER5( vector<double> const & x )
+{
+  int const k = x.size() / 5;
+  // too few batches to tell the transient from the steady state
+  if ( k < 4 ) {
+    return -1;
+  }
+
+  vector<double> batch( k, 0.0 );
+  for ( int i = 0; i < k; ++i ) {
+    for ( int j = 0; j < 5; ++j ) {
+      batch[i] += x[5 * i + j];
+    }
+    batch[i] /= 5.0;
+  }
+
+  // suffix sums give the statistic of every truncation point in O(k)
+  vector<double> sum( k + 1, 0.0 );
+  vector<double> squared_sum( k + 1, 0.0 );
+  for ( int i = k - 1; i >= 0; --i ) {
+    sum[i] = sum[i + 1] + batch[i];
+    squared_sum[i] = squared_sum[i + 1] + batch[i] * batch[i];
+  }
+
+  int best = 0;
+  double best_mser = 0.0;
+  for ( int d = 0; d < k - 1; ++d ) {
+    double const m = (double)( k - d );
+    double const mser = ( squared_sum[d] - sum[d] * sum[d] / m ) / ( m * m );
+    if ( ( d == 0 ) || ( mser < best_mser ) ) {
+      best = d;
+      best_mser = mser;
+    }
+  }
+
+  return ( 2 * best < k ) ? ( 5 * best ) : -1;
+}
@@ -0,0 +1,62 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _BATCH_MEANS_HPP_
+#define _BATCH_MEANS_HPP_
+
+#include <vector>
+
+using namespace std;
+
+// Confidence interval for the steady-state mean of a series of
+// observations, e.g. one per sample period, using non-overlapping batch
+// means. The batch size is doubled until the lag-1 autocorrelation of the
+// batch means is no longer significant, as long as at least min_batches
+// batches remain; the oldest observations are dropped if the series does
+// not divide evenly.
+class BatchMeans {
+  int _min_batches;
+  vector<double> _obs;
+
+public:
+  BatchMeans( int min_batches = 10 );
+
+  void Clear( );
+  void AddObservation( double x );
+  inline int NumObservations( ) const { return _obs.size(); }
+
+  // returns false if there are not enough uncorrelated batches yet
+  bool Interval( double confidence, double * mean, double * half_width,
+                 int * batches ) const;
+
+  // MSER-5 truncation point of a series: the number of leading
+  // observations to discard, or -1 if the optimal truncation is not within
+  // the first half of the series (i.e. warmup has not ended yet)
+  static int MSER5( vector<double> const & x );
+};
+
+#endif
@@ -45,6 +45,14 @@ BatchTrafficManager::BatchTrafficManager( const Configuration &config,
   _batch_size = config.GetInt( "batch_size" );
   _batch_count = config.GetInt( "batch_count" );
 
+  // batch runs always end after batch_count batches
+  _confidence_stopping = false;
+
+  // batch limits are enforced by _IssuePacket, which requires sampling
+  // every cycle
+  _event_injection.assign(_classes, false);
+  _legacy_injection = true;
+
   _batch_time = new Stats( this, "batch_time", 1.0, 1000 );
   _stats["batch_time"] = _batch_time;
   
@@ -0,0 +1,158 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*arbiter_bench.cpp
+ *
+ *Microbenchmark for the arbiters: runs the same random request patterns
+ *through each arbiter type (Clear, AddRequest, Arbitrate, UpdateState) and
+ *reports arbitrations per second. Arbiters that are supposed to grant the
+ *same requests are checked against each other.
+ *
+ *usage: arbiter_bench [iterations]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+#include "arbiter.hpp"
+
+using namespace std;
+
+// the arbiters only need the simulation time for error messages
+int GetSimTime() { return 0; }
+
+struct sPattern {
+  vector<int> inputs;
+  vector<int> pris;
+};
+
+static vector<sPattern> MakePatterns( int size, double load, int levels,
+				      int count, mt19937 & gen )
+{
+  uniform_real_distribution<double> coin(0.0, 1.0);
+  uniform_int_distribution<int> level(0, levels - 1);
+  vector<sPattern> patterns(count);
+  for ( int p = 0; p < count; ++p ) {
+    for ( int i = 0; i < size; ++i ) {
+      if ( coin(gen) < load ) {
+	patterns[p].inputs.push_back(i);
+	patterns[p].pris.push_back(level(gen));
+      }
+    }
+  }
+  return patterns;
+}
+
+// returns the arbitrations per second and a checksum of the winners
+static double Run( const string & arb_type, int size,
+		   const vector<sPattern> & patterns, int iterations,
+		   unsigned long & checksum )
+{
+  Arbiter * arb = Arbiter::NewArbiter( NULL, "arb", arb_type, size );
+  checksum = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for ( int it = 0; it < iterations; ++it ) {
+    const sPattern & p = patterns[it % patterns.size()];
+    arb->Clear();
+    for ( size_t r = 0; r < p.inputs.size(); ++r ) {
+      arb->AddRequest(p.inputs[r], p.inputs[r], p.pris[r]);
+    }
+    const int winner = arb->Arbitrate(NULL, NULL);
+    arb->UpdateState();
+    checksum = checksum * 31 + (winner + 1);
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  delete arb;
+  return iterations / elapsed.count();
+}
+
+int main( int argc, char ** argv )
+{
+  const int iterations = ( argc > 1 ) ? atoi( argv[1] ) : 2000000;
+
+  const int sizes[] = { 5, 16, 64, 128 };
+  const double loads[] = { 0.25, 1.0 };
+  const int levels[] = { 1, 4 };
+
+  // pairs of arbiters that must grant the same requests
+  const char * const types[][2] = {
+    { "round_robin", "round_robin_bits" },
+    { "matrix", "matrix_bits" },
+    { "tree(4,round_robin)", "tree(4,round_robin_bits)" },
+  };
+
+  bool ok = true;
+
+  cout << setw(26) << left << "arbiter" << right
+       << setw(6) << "size" << setw(6) << "load" << setw(6) << "pris"
+       << setw(14) << "Marb/s" << setw(14) << "bits Marb/s"
+       << setw(10) << "speedup" << endl;
+
+  for ( size_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t ) {
+    for ( size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s ) {
+      const int size = sizes[s];
+      if ( ( string(types[t][0]).substr(0, 5) == "tree(" ) && ( size % 4 ) ) {
+	continue;
+      }
+      for ( size_t l = 0; l < sizeof(loads) / sizeof(loads[0]); ++l ) {
+	for ( size_t v = 0; v < sizeof(levels) / sizeof(levels[0]); ++v ) {
+	  mt19937 gen( size * 1000 + l * 10 + v );
+	  const vector<sPattern> patterns =
+	    MakePatterns( size, loads[l], levels[v], 1024, gen );
+	  // best of a few alternating runs, to filter out noise
+	  unsigned long ref_sum, bits_sum;
+	  double ref = 0.0, bits = 0.0;
+	  for ( int r = 0; r < 3; ++r ) {
+	    ref = max( ref, Run( types[t][0], size, patterns, iterations, ref_sum ) );
+	    bits = max( bits, Run( types[t][1], size, patterns, iterations, bits_sum ) );
+	  }
+	  cout << setw(26) << left << types[t][0] << right
+	       << setw(6) << size << setw(6) << loads[l] << setw(6) << levels[v]
+	       << fixed << setprecision(2)
+	       << setw(14) << ref / 1e6 << setw(14) << bits / 1e6
+	       << setw(9) << bits / ref << "x"
+	       << ( ( ref_sum != bits_sum ) ? "  MISMATCH" : "" ) << endl;
+	  cout.unsetf(ios::fixed);
+	  ok = ok && ( ref_sum == bits_sum );
+	}
+      }
+    }
+  }
+
+  if ( !ok ) {
+    cerr << "Error: bitmask arbiters granted different requests." << endl;
+    return 1;
+  }
+  return 0;
+}
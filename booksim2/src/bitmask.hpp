@@ -0,0 +1,155 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*bitmask.hpp
+ *
+ *Dynamically sized bit set for the bitmask allocators and arbiters. Bits
+ *are kept in 64-bit words, so set operations and searches for the next
+ *set bit (optionally wrapping around a round-robin pointer) work on a
+ *whole word at a time using count-trailing-zeros.
+ */
+
+#ifndef _BITMASK_HPP_
+#define _BITMASK_HPP_
+
+#include <vector>
+#include <cassert>
+
+class BitMask {
+
+public:
+
+  typedef unsigned long long word_t;
+  static const int WORD_BITS = 64;
+
+private:
+
+  std::vector<word_t> _bits;
+  int _size;
+
+public:
+
+  BitMask( int size = 0 ) : _size( 0 ) { resize( size ); }
+
+  inline void resize( int size ) {
+    assert( size >= 0 );
+    _size = size;
+    _bits.assign( ( size + WORD_BITS - 1 ) / WORD_BITS, 0 );
+  }
+  // number of bits the mask can hold
+  inline int capacity( ) const { return _size; }
+  inline int words( ) const { return _bits.size( ); }
+  inline word_t word( int w ) const { return _bits[w]; }
+
+  inline void clear( ) {
+    // most masks fit in a single word, which is cheaper to clear directly
+    // than through the memset the loop turns into
+    if ( _bits.size( ) == 1 ) {
+      _bits[0] = 0;
+    } else {
+      for ( size_t w = 0; w < _bits.size( ); ++w ) {
+        _bits[w] = 0;
+      }
+    }
+  }
+  inline void fill( ) {
+    for ( size_t w = 0; w < _bits.size( ); ++w ) {
+      _bits[w] = ~0ULL;
+    }
+    if ( _size % WORD_BITS ) {
+      _bits.back( ) &= ( 1ULL << ( _size % WORD_BITS ) ) - 1;
+    }
+  }
+  inline void insert( int i ) {
+    assert( ( i >= 0 ) && ( i < _size ) );
+    _bits[i / WORD_BITS] |= 1ULL << ( i % WORD_BITS );
+  }
+  inline void erase( int i ) {
+    assert( ( i >= 0 ) && ( i < _size ) );
+    _bits[i / WORD_BITS] &= ~( 1ULL << ( i % WORD_BITS ) );
+  }
+  inline int count( int i ) const {
+    assert( ( i >= 0 ) && ( i < _size ) );
+    return ( _bits[i / WORD_BITS] >> ( i % WORD_BITS ) ) & 1;
+  }
+  inline bool empty( ) const {
+    for ( size_t w = 0; w < _bits.size( ); ++w ) {
+      if ( _bits[w] ) {
+        return false;
+      }
+    }
+    return true;
+  }
+  inline bool intersects( BitMask const & m ) const {
+    assert( m._size == _size );
+    for ( size_t w = 0; w < _bits.size( ); ++w ) {
+      if ( _bits[w] & m._bits[w] ) {
+        return true;
+      }
+    }
+    return false;
+  }
+  inline int size( ) const {
+    int n = 0;
+    for ( size_t w = 0; w < _bits.size( ); ++w ) {
+      n += __builtin_popcountll( _bits[w] );
+    }
+    return n;
+  }
+  // first set bit at or after i, or capacity() if there is none
+  inline int next( int i ) const {
+    while ( i < _size ) {
+      int const w = i / WORD_BITS;
+      word_t const bits = _bits[w] >> ( i % WORD_BITS );
+      if ( bits ) {
+        return i + __builtin_ctzll( bits );
+      }
+      i = ( w + 1 ) * WORD_BITS;
+    }
+    return _size;
+  }
+  // first set bit at or after offset, wrapping around to the lowest set
+  // bit; this is the winner of a round-robin arbiter pointing at offset
+  inline int next_cyclic( int offset ) const {
+    assert( ( offset >= 0 ) && ( offset < _size ) );
+    if ( _size <= WORD_BITS ) {
+      word_t const bits = _bits[0];
+      if ( !bits ) {
+        return -1;
+      }
+      word_t const upper = bits >> offset;
+      return upper ? ( offset + __builtin_ctzll( upper ) ) : __builtin_ctzll( bits );
+    }
+    int i = next( offset );
+    if ( i >= _size ) {
+      i = next( 0 );
+    }
+    return ( i < _size ) ? i : -1;
+  }
+};
+
+#endif
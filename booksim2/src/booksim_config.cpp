@@ -51,6 +51,8 @@ BookSimConfig::BookSimConfig() {
   _int_map["n"] = 2;  // network dimension
   _int_map["c"] = 1;  // concentration
   AddStrField("routing_function", "none");
+  _int_map["routing_cache"] = 0;  // memoize routes of deterministic routing functions
+  _int_map["routing_cache_size"] = 4096;  // max. number of cached routes per router
 
   // simulator tries to correclty adjust latency for node/router placement
   _int_map["use_noc_latency"] = 1;
@@ -185,6 +187,8 @@ BookSimConfig::BookSimConfig() {
               "");  // workaraound to allow for vector specification
 
   AddStrField("injection_process", "bernoulli");
+  // legacy: sample every source every cycle, event: draw inter-arrival times
+  AddStrField("injection_sampling", "legacy");
 
   _float_map["burst_alpha"] = 0.5;  // burst interval
   _float_map["burst_beta"] = 0.5;   // burst length
@@ -238,6 +242,8 @@ BookSimConfig::BookSimConfig() {
   // types:
   //   latency    - average + latency distribution for a particular injection
   //   rate throughput - sustained throughput for a particular injection rate
+  //   saturation - zero-load latency, saturation throughput and the
+  //   latency-load curve, found by a series of latency simulations
 
   AddStrField("sim_type", "latency");
 
@@ -249,18 +255,59 @@ BookSimConfig::BookSimConfig() {
       10;  // maximum number of sample periods in a simulation
   _int_map["converged_threshold"] = 3; // no. of phases to be considred as converged, -1 means run to max_smaples
 
+  // stopping rule: "convergence" compares consecutive sample periods,
+  // "confidence" runs until the batch means confidence intervals of the
+  // latency and accepted rate of every measured class are within a
+  // relative half-width of ci_half_width (the end of warmup is detected
+  // with MSER-5 instead of warmup_periods)
+  AddStrField("stopping_mode", "convergence");
+  _float_map["ci_half_width"] = 0.05;
+  _float_map["ci_confidence"] = 0.95;
+  _int_map["ci_min_batches"] = 10;
+
+  // the state of the first simulation is saved to checkpoint_out once it is
+  // warmed up; a simulation with checkpoint_in resumes from such a state
+  // instead of warming up, e.g., to run several measurements from one warmup
+  AddStrField("checkpoint_out", "");
+  AddStrField("checkpoint_in", "");
+  // warm up again after resuming from checkpoint_in, e.g., when the
+  // checkpoint was saved at a lower load
+  _int_map["checkpoint_warmup"] = 0;
+
   // whether or not to measure statistics for a given traffic class
   _int_map["measure_stats"] = 1;
   AddStrField("measure_stats",
               "");  // workaround to allow for vector specification
   // whether to enable per pair statistics, caution N^2 memory usage
   _int_map["pair_stats"] = 0;
+  // precision of the per pair latency quantile sketches, allocated for
+  // the pairs exchanging traffic (0 disables them)
+  _int_map["pair_quantile_bits"] = 0;
+  // binary dump of the per pair statistics after each simulation
+  AddStrField("pair_stats_out", "");
+
+  // latency quantiles to report in addition to min/avg/max, e.g.
+  // {0.5,0.95,0.99,0.999}; estimated from log-linear histograms
+  AddStrField("latency_quantiles", "");
 
   // if avg. latency exceeds the threshold, assume unstable
   _float_map["latency_thres"] = 500.0;
   AddStrField("latency_thres",
               "");  // workaround to allow for vector specification
 
+  // if the avg. latency of the packets arriving in a sample period (or in a
+  // 1000-cycle interval while draining) grew by more than
+  // latency_trend_growth in this many successive periods, assume unstable
+  // (0 disables the check)
+  _int_map["latency_trend_periods"] = 0;
+  _float_map["latency_trend_growth"] = 0.05;
+  _int_map["latency_trend_min_samples"] = 100;  // periods with fewer packets are ignored
+
+  // 1: measure the latency as with sim_type = latency, i.e., apply the
+  // latency thresholds and drain the measured packets, with the traffic
+  // manager of another sim_type, e.g., flov
+  _int_map["measure_latency"] = 0;
+
   // consider warmed up once relative change in latency / throughput between
   // successive iterations is smaller than this
   _float_map["warmup_thres"] = 0.05;
@@ -283,6 +330,27 @@ BookSimConfig::BookSimConfig() {
 
   _int_map["include_queuing"] = 1;  // non-zero includes source queuing latency
 
+  _int_map["sim_threads"] = 1;  // worker threads evaluating the network
+  _int_map["active_set_scheduling"] = 1;  // skip idle routers and channels
+  _int_map["fast_forward"] = 1;  // skip cycles in which the network is idle
+
+  AddStrField("sweep_params", "");  // --sweep: parameters to sweep over, e.g. {injection_rate}
+  AddStrField("sweep_values", "");  // --sweep: their values, e.g. {{0.01,0.02,...,0.3}}
+  _int_map["sweep_jobs"] = 0;  // --sweep: points simulated at a time, 0 for one per core
+  AddStrField("sweep_log", "");  // --sweep: prefix of the per-point output files, discarded if empty
+
+  // 1: search with probes of the configured sim_type, e.g. flov, so that the
+  // power-gating traffic managers keep running (sim_type = saturation
+  // searches with latency probes)
+  _int_map["saturation_search"] = 0;
+  // saturation search: the traffic patterns to search, e.g.
+  // {uniform,transpose}, the configured traffic if empty
+  AddStrField("saturation_traffic", "");
+  _float_map["saturation_zero_load_rate"] = 0.0025;  // injection rate of the zero-load probe
+  _float_map["saturation_step"] = 0.05;  // initial injection rate step
+  _float_map["saturation_min_step"] = 0.001;  // search resolution
+  _int_map["saturation_trend_periods"] = 3;  // latency_trend_periods of the probes
+
   //  _int_map["reorder"]         = 0;  // know what you're doing
 
   //_int_map["flit_timing"]     = 0;  // know what you're doing
@@ -368,6 +436,10 @@ BookSimConfig::BookSimConfig() {
 
   /* ==== Power Gate - Begin ==== */
   _int_map["fabric_manager"] = -1;  // Router Parking: fabric manager
+  _int_map["route_table_threads"] = 0;  // Router Parking: threads building the routing tables, 0 for one per core
+  AddStrField("reconfig_times", "");  // Router Parking: cycles of the runtime reconfigurations
+  AddStrField("reconfig_cores", "");  // Router Parking: cores turned off or on at these cycles
+  _int_map["reconfig_latency"] = 0; // Router Parking: cycles to distribute the new routing tables
   AddStrField("off_cores", "");
   AddStrField("off_routers", "");
   _int_map["powergate_auto_config"] = 0;  // config power-gate map automatically
@@ -387,6 +459,9 @@ BookSimConfig::BookSimConfig() {
   _float_map["low_watermark"] = 1.2;
   _float_map["high_watermark"] = 1.5;
   _int_map["flov_monitor_epoch"] = 1000;
+  _int_map["flov_vote_tile_size"] = 0; // 0: vote per row and column
+  _int_map["flov_vote_propagation"] = 0; // 1: relay votes over the handshake channels
+  _float_map["flov_vote_quantile"] = 0.0; // 0: vote on average latency
   _int_map["routing_deadlock_timeout_threshold"] = 512;
   /* ==== Power Gate - End ==== */
 
@@ -25,30 +25,63 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <limits>
 #include <sstream>
 
 #include "globals.hpp"
 #include "booksim.hpp"
 #include "buffer.hpp"
+#include "checkpoint.hpp"
 
 Buffer::Buffer( const Configuration& config, int outputs, 
 		Module *parent, const string& name ) :
 Module( parent, name ), _occupancy(0)
 {
-  int num_vcs = config.GetInt( "num_vcs" );
+  _vcs = config.GetInt( "num_vcs" );
 
+  int const vc_buf_size = config.GetInt( "vc_buf_size" );
   _size = config.GetInt("buf_size");
   if(_size < 0) {
-    _size = num_vcs * config.GetInt( "vc_buf_size" );
+    _size = _vcs * vc_buf_size;
   };
 
-  _vc.resize(num_vcs);
+  // shared buffer policies can let a VC grow beyond vc_buf_size, in which
+  // case the partitions are enlarged on demand
+  _vc_size = (vc_buf_size > 0) ? vc_buf_size : (_size + _vcs - 1) / _vcs;
+  _vc_size = max(1, min(_vc_size, _size));
+  _flits.resize(_vcs * _vc_size, NULL);
+  _head.resize(_vcs, 0);
+  _count.resize(_vcs, 0);
 
-  for(int i = 0; i < num_vcs; ++i) {
-    ostringstream vc_name;
-    vc_name << "vc_" << i;
-    _vc[i] = new VC(config, outputs, this, vc_name.str( ) );
+  _state.resize(_vcs, VC::idle);
+  _lookahead_routing = !config.GetInt("routing_delay");
+  _route_set.resize(_vcs, NULL);
+  if(!_lookahead_routing) {
+    _route_sets.resize(_vcs);
+    for(int i = 0; i < _vcs; ++i) {
+      _route_set[i] = &_route_sets[i];
+    }
   }
+  _out_port.resize(_vcs, -1);
+  _out_vc.resize(_vcs, -1);
+  _pri.resize(_vcs, 0);
+  _expected_pid.resize(_vcs, -1);
+  _watched.resize(_vcs, false);
+
+  string priority = config.GetStr( "priority" );
+  if ( priority == "local_age" ) {
+    _pri_type = local_age_based;
+  } else if ( priority == "queue_length" ) {
+    _pri_type = queue_length_based;
+  } else if ( priority == "hop_count" ) {
+    _pri_type = hop_count_based;
+  } else if ( priority == "none" ) {
+    _pri_type = none;
+  } else {
+    _pri_type = other;
+  }
+
+  _priority_donation = config.GetInt("vc_priority_donation");
 
 #ifdef TRACK_BUFFERS
   int classes = config.GetInt("classes");
@@ -56,28 +89,208 @@ Module( parent, name ), _occupancy(0)
 #endif
 }
 
-Buffer::~Buffer()
+string Buffer::_VCName( int vc ) const
 {
-  for(vector<VC*>::iterator i = _vc.begin(); i != _vc.end(); ++i) {
-    delete *i;
+  ostringstream vc_name;
+  vc_name << FullName() << "/vc_" << vc;
+  return vc_name.str();
+}
+
+// double the size of all VC partitions, keeping the flits in order
+void Buffer::_Grow( )
+{
+  int const vc_size = min(2 * _vc_size, _size);
+  assert(vc_size > _vc_size);
+  vector<Flit *> flits(_vcs * vc_size, NULL);
+  for(int vc = 0; vc < _vcs; ++vc) {
+    for(int i = 0; i < _count[vc]; ++i) {
+      flits[vc * vc_size + i] = _Slot(vc, i);
+    }
+    _head[vc] = 0;
   }
+  _flits.swap(flits);
+  _vc_size = vc_size;
 }
 
 void Buffer::AddFlit( int vc, Flit *f )
 {
+  assert(f);
+
   if(_occupancy >= _size) {
     Error("Flit buffer overflow.");
   }
+
+  if(_expected_pid[vc] >= 0) {
+    if(f->pid != _expected_pid[vc]) {
+      ostringstream err;
+      err << "Received flit " << f->id << " with unexpected packet ID: " << f->pid
+        << " (expected: " << _expected_pid[vc] << ") at VC " << vc;
+      Error(err.str());
+    } else if(f->tail) {
+      _expected_pid[vc] = -1;
+    }
+  } else if(!f->tail) {
+    _expected_pid[vc] = f->pid;
+  }
+
+  // update flit priority before adding to VC buffer
+  if(_pri_type == local_age_based) {
+    f->pri = numeric_limits<int>::max() - GetSimTime();
+    assert(f->pri >= 0);
+  } else if(_pri_type == hop_count_based) {
+    f->pri = f->hops;
+    assert(f->pri >= 0);
+  }
+
   ++_occupancy;
-  _vc[vc]->AddFlit(f);
+  if(_count[vc] == _vc_size) {
+    _Grow();
+  }
+  _Slot(vc, _count[vc]) = f;
+  ++_count[vc];
 #ifdef TRACK_BUFFERS
   ++_class_occupancy[f->cl];
 #endif
+  _UpdatePriority(vc);
+}
+
+Flit *Buffer::RemoveFlit( int vc )
+{
+  if(_count[vc] == 0) {
+    Error("Trying to remove flit from empty buffer.");
+  }
+  --_occupancy;
+  Flit * const f = FrontFlit(vc);
+#ifdef TRACK_BUFFERS
+  int cl = f->cl;
+  assert(_class_occupancy[cl] > 0);
+  --_class_occupancy[cl];
+#endif
+  if(++_head[vc] == _vc_size) {
+    _head[vc] = 0;
+  }
+  --_count[vc];
+  _UpdatePriority(vc);
+  return f;
+}
+
+void Buffer::SetState( int vc, VC::eVCState s )
+{
+  Flit * f = FrontFlit(vc);
+
+  if(f && f->watch)
+    *gWatchOut << GetSimTime() << " | " << _VCName(vc) << " | "
+      << "Changing state from " << VC::VCSTATE[_state[vc]]
+      << " to " << VC::VCSTATE[s] << "." << endl;
+
+  _state[vc] = s;
+}
+
+void Buffer::_UpdatePriority( int vc )
+{
+  if(_count[vc] == 0) return;
+  if(_pri_type == queue_length_based) {
+    _pri[vc] = _count[vc];
+  } else if(_pri_type != none) {
+    Flit * f = FrontFlit(vc);
+    if((_pri_type != local_age_based) && _priority_donation) {
+      Flit * df = f;
+      for(int i = 1; i < _count[vc]; ++i) {
+        Flit * bf = _Slot(vc, i);
+        if(bf->pri > df->pri) df = bf;
+      }
+      if((df != f) && (df->watch || f->watch)) {
+        *gWatchOut << GetSimTime() << " | " << _VCName(vc) << " | "
+          << "Flit " << df->id
+          << " donates priority to flit " << f->id
+          << "." << endl;
+      }
+      f = df;
+    }
+    if(f->watch)
+      *gWatchOut << GetSimTime() << " | " << _VCName(vc) << " | "
+        << "Flit " << f->id
+        << " sets priority to " << f->pri
+        << "." << endl;
+    _pri[vc] = f->pri;
+  }
+}
+
+// the flits of each VC are restored to the front of its partition; with
+// lookahead routing, the route set is that of the head flit at the front
+void Buffer::Serialize( Checkpoint & cp )
+{
+  cp.Check( _vcs, FullName( ) + " VCs" );
+  cp.Check( _size, FullName( ) + " size" );
+  cp.Sync( _occupancy );
+  int vc_size = _vc_size;
+  cp.Sync( vc_size );
+  if ( cp.Loading( ) && ( vc_size != _vc_size ) ) {
+    _vc_size = vc_size;
+    _flits.assign( _vcs * _vc_size, NULL );
+  }
+  for ( int vc = 0; vc < _vcs; ++vc ) {
+    int count = _count[vc];
+    cp.Sync( count );
+    for ( int i = 0; i < count; ++i ) {
+      Flit * f = cp.Loading( ) ? NULL : _Slot( vc, i );
+      cp.Sync( f );
+      if ( cp.Loading( ) ) {
+        _flits[vc * _vc_size + i] = f;
+      }
+    }
+    if ( cp.Loading( ) ) {
+      _head[vc] = 0;
+      _count[vc] = count;
+    }
+
+    if ( _lookahead_routing ) {
+      Flit * const front = FrontFlit( vc );
+      bool front_route = front && ( _route_set[vc] == &front->la_route_set );
+      cp.Sync( front_route );
+      _route_set[vc] = front_route ? &front->la_route_set : NULL;
+    } else {
+      cp.Sync( _route_sets[vc] );
+    }
+  }
+  cp.Sync( _state );
+  cp.Sync( _out_port );
+  cp.Sync( _out_vc );
+  cp.Sync( _pri );
+  cp.Sync( _expected_pid );
+  cp.Sync( _watched );
 }
 
 void Buffer::Display( ostream & os ) const
 {
-  for(vector<VC*>::const_iterator i = _vc.begin(); i != _vc.end(); ++i) {
-    (*i)->Display(os);
+  for(int vc = 0; vc < _vcs; ++vc) {
+    if ( _state[vc] == VC::idle ) {
+      continue;
+    }
+    os << _VCName(vc) << ": "
+       << " state: " << VC::VCSTATE[_state[vc]];
+    if(_state[vc] == VC::active) {
+      os << " out_port: " << _out_port[vc]
+        << " out_vc: " << _out_vc[vc];
+    }
+    os << " fill: " << _count[vc];
+    os << " expected_pid: " << _expected_pid[vc];
+    if(_count[vc]) {
+      Flit const * const f = FrontFlit(vc);
+      os << " front: " << f->id;
+      os << " (pid " << f->pid;
+      if (f->head)
+        os << " head)";
+      else if (f->tail)
+        os << " tail)";
+      else
+        os << " body)";
+      /* ==== Power Gate - Begin ==== */
+      os << " src: " << f->src;
+      os << " dest: " << f->dest;
+      /* ==== Power Gate - End ==== */
+    }
+    os << " pri: " << _pri[vc];
+    os << endl;
   }
 }
@@ -29,6 +29,7 @@
 #define _BUFFER_HPP_
 
 #include <vector>
+#include <string>
 
 #include "vc.hpp"
 #include "flit.hpp"
@@ -36,44 +37,83 @@
 #include "routefunc.hpp"
 #include "config_utils.hpp"
 
+class Checkpoint;
+
 class Buffer : public Module {
   
   int _occupancy;
   int _size;
 
-  vector<VC*> _vc;
+  int _vcs;
+
+  // one contiguous array of flit pointers, partitioned into a ring of
+  // _vc_size entries per VC
+  int _vc_size;
+  vector<Flit *> _flits;
+  vector<int> _head;
+  vector<int> _count;
+
+  // per-VC state
+  vector<VC::eVCState> _state;
+  vector<OutputSet *> _route_set;
+  vector<OutputSet> _route_sets;
+  vector<int> _out_port;
+  vector<int> _out_vc;
+  vector<int> _pri;
+  vector<int> _expected_pid;
+  vector<bool> _watched;
+
+  enum ePrioType { local_age_based, queue_length_based, hop_count_based, none, other };
+
+  ePrioType _pri_type;
+
+  int _priority_donation;
+
+  bool _lookahead_routing;
 
 #ifdef TRACK_BUFFERS
   vector<int> _class_occupancy;
 #endif
 
+  inline Flit * & _Slot( int vc, int i )
+  {
+    int pos = _head[vc] + i;
+    if(pos >= _vc_size) {
+      pos -= _vc_size;
+    }
+    return _flits[vc * _vc_size + pos];
+  }
+
+  inline Flit * _Slot( int vc, int i ) const
+  {
+    int pos = _head[vc] + i;
+    if(pos >= _vc_size) {
+      pos -= _vc_size;
+    }
+    return _flits[vc * _vc_size + pos];
+  }
+
+  void _Grow( );
+  void _UpdatePriority( int vc );
+  string _VCName( int vc ) const;
+
 public:
   
   Buffer( const Configuration& config, int outputs,
 	  Module *parent, const string& name );
-  ~Buffer();
 
   void AddFlit( int vc, Flit *f );
 
-  inline Flit *RemoveFlit( int vc )
-  {
-    --_occupancy;
-#ifdef TRACK_BUFFERS
-    int cl = _vc[vc]->FrontFlit()->cl;
-    assert(_class_occupancy[cl] > 0);
-    --_class_occupancy[cl];
-#endif
-    return _vc[vc]->RemoveFlit( );
-  }
+  Flit *RemoveFlit( int vc );
   
   inline Flit *FrontFlit( int vc ) const
   {
-    return _vc[vc]->FrontFlit( );
+    return _count[vc] ? _flits[vc * _vc_size + _head[vc]] : NULL;
   }
   
   inline bool Empty( int vc ) const
   {
-    return _vc[vc]->Empty( );
+    return _count[vc] == 0;
   }
 
   inline bool Full( ) const
@@ -83,59 +123,61 @@ public:
 
   inline VC::eVCState GetState( int vc ) const
   {
-    return _vc[vc]->GetState( );
+    return _state[vc];
   }
 
-  inline void SetState( int vc, VC::eVCState s )
-  {
-    _vc[vc]->SetState(s);
-  }
+  void SetState( int vc, VC::eVCState s );
 
   inline const OutputSet *GetRouteSet( int vc ) const
   {
-    return _vc[vc]->GetRouteSet( );
+    return _route_set[vc];
   }
 
   inline void SetRouteSet( int vc, OutputSet * output_set )
   {
-    _vc[vc]->SetRouteSet(output_set);
+    _route_set[vc] = output_set;
+    _out_port[vc] = -1;
+    _out_vc[vc] = -1;
   }
 
   inline void SetOutput( int vc, int out_port, int out_vc )
   {
-    _vc[vc]->SetOutput(out_port, out_vc);
+    _out_port[vc] = out_port;
+    _out_vc[vc] = out_vc;
   }
 
   inline int GetOutputPort( int vc ) const
   {
-    return _vc[vc]->GetOutputPort( );
+    return _out_port[vc];
   }
 
   inline int GetOutputVC( int vc ) const
   {
-    return _vc[vc]->GetOutputVC( );
+    return _out_vc[vc];
   }
 
   inline int GetPriority( int vc ) const
   {
-    return _vc[vc]->GetPriority( );
+    return _pri[vc];
   }
 
   inline void Route( int vc, tRoutingFunction rf, const Router* router, const Flit* f, int in_channel )
   {
-    _vc[vc]->Route(rf, router, f, in_channel);
+    rf( router, f, in_channel, _route_set[vc], false );
+    _out_port[vc] = -1;
+    _out_vc[vc] = -1;
   }
 
   // ==== Debug functions ====
 
   inline void SetWatch( int vc, bool watch = true )
   {
-    _vc[vc]->SetWatch(watch);
+    _watched[vc] = watch;
   }
 
   inline bool IsWatched( int vc ) const
   {
-    return _vc[vc]->IsWatched( );
+    return _watched[vc];
   }
 
   inline int GetOccupancy( ) const
@@ -145,7 +187,7 @@ public:
 
   inline int GetOccupancy( int vc ) const
   {
-    return _vc[vc]->GetOccupancy( );
+    return _count[vc];
   }
 
 #ifdef TRACK_BUFFERS
@@ -155,12 +197,14 @@ public:
   }
 #endif
 
+  void Serialize( Checkpoint & cp );
+
   void Display( ostream & os = cout ) const;
 
   /* ==== Power Gate - Begin ==== */
   inline void ClearRouteSet( int vc )
   {
-    _vc[vc]->ClearRouteSet();
+    _route_set[vc]->Clear();
   }
   /* ==== Power Gate - End ==== */
 };
@@ -41,6 +41,7 @@
 #include "buffer_state.hpp"
 #include "random_utils.hpp"
 #include "globals.hpp"
+#include "checkpoint.hpp"
 
 //#define DEBUG_FEEDBACK
 //#define DEBUG_SIMPLEFEEDBACK
@@ -134,6 +135,11 @@ int BufferState::PrivateBufferPolicy::LimitFor(int vc) const
   return _vc_buf_size;
 }
 
+void BufferState::PrivateBufferPolicy::Serialize(Checkpoint & cp)
+{
+  cp.Sync(_vc_buf_size);
+}
+
 /* ==== Power Gate - Begin ==== */
 void BufferState::PrivateBufferPolicy::SetVCBufferSize(int vc_buf_size)
 {
@@ -264,6 +270,13 @@ void BufferState::SharedBufferPolicy::FreeSlotFor(int vc)
   }
 }
 
+void BufferState::SharedBufferPolicy::Serialize(Checkpoint & cp)
+{
+  cp.Sync(_private_buf_occupancy);
+  cp.Sync(_shared_buf_occupancy);
+  cp.Sync(_reserved_slots);
+}
+
 bool BufferState::SharedBufferPolicy::IsFullFor(int vc) const
 {
   int i = _private_buf_vc_map[vc];
@@ -315,6 +328,13 @@ void BufferState::LimitedSharedBufferPolicy::SendingFlit(Flit const * const f)
   }
 }
 
+void BufferState::LimitedSharedBufferPolicy::Serialize(Checkpoint & cp)
+{
+  SharedBufferPolicy::Serialize(cp);
+  cp.Sync(_active_vcs);
+  cp.Sync(_max_held_slots);
+}
+
 bool BufferState::LimitedSharedBufferPolicy::IsFullFor(int vc) const
 {
   return (SharedBufferPolicy::IsFullFor(vc) ||
@@ -532,6 +552,16 @@ void BufferState::FeedbackSharedBufferPolicy::FreeSlotFor(int vc)
 #endif
 }
 
+void BufferState::FeedbackSharedBufferPolicy::Serialize(Checkpoint & cp)
+{
+  SharedBufferPolicy::Serialize(cp);
+  cp.Sync(_occupancy_limit);
+  cp.Sync(_round_trip_time);
+  cp.Sync(_flit_sent_time);
+  cp.Sync(_min_latency);
+  cp.Sync(_total_mapped_size);
+}
+
 bool BufferState::FeedbackSharedBufferPolicy::IsFullFor(int vc) const
 {
   if(SharedBufferPolicy::IsFullFor(vc)) {
@@ -598,10 +628,22 @@ void BufferState::SimpleFeedbackSharedBufferPolicy::FreeSlotFor(int vc)
   SharedBufferPolicy::FreeSlotFor(vc);
 }
 
+void BufferState::SimpleFeedbackSharedBufferPolicy::Serialize(Checkpoint & cp)
+{
+  FeedbackSharedBufferPolicy::Serialize(cp);
+  cp.Sync(_pending_credits);
+}
+
 BufferState::BufferState( const Configuration& config, Module *parent, const string& name ) :
   Module( parent, name ), _occupancy(0)
 {
   _vcs = config.GetInt( "num_vcs" );
+  if(_vcs > VCMask::MAX_VCS) {
+    ostringstream err;
+    err << "Credits support at most " << VCMask::MAX_VCS << " VCs, "
+        << "rebuild with -DCREDIT_MAX_VCS=" << _vcs;
+    Error( err.str() );
+  }
   _size = config.GetInt("buf_size");
   /* ==== Power Gate - Begin ==== */
   _full_vc_buf_size = config.GetInt("vc_buf_size");
@@ -638,7 +680,7 @@ void BufferState::ProcessCredit( Credit const * const c )
 {
   assert( c );
 
-  set<int>::iterator iter = c->vc.begin();
+  VCMask::const_iterator iter = c->vc.begin();
   while(iter != c->vc.end()) {
 
     int const vc = *iter;
@@ -789,6 +831,19 @@ void BufferState::SetVCBufferSize(int vc_buf_size)
 }
 /* ==== Power Gate - End ==== */
 
+void BufferState::Serialize( Checkpoint & cp )
+{
+  cp.Check( _vcs, FullName( ) + " VCs" );
+  cp.Sync( _size );
+  cp.Sync( _occupancy );
+  cp.Sync( _vc_occupancy );
+  cp.Sync( _in_use_by );
+  cp.Sync( _tail_sent );
+  cp.Sync( _last_id );
+  cp.Sync( _last_pid );
+  _buffer_policy->Serialize( cp );
+}
+
 void BufferState::Display( ostream & os ) const
 {
   if (_occupancy) {
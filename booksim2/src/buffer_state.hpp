@@ -36,6 +36,8 @@
 #include "credit.hpp"
 #include "config_utils.hpp"
 
+class Checkpoint;
+
 class BufferState : public Module {
 
   class BufferPolicy : public Module {
@@ -55,6 +57,8 @@ class BufferState : public Module {
     static BufferPolicy * New(Configuration const & config,
         BufferState * parent, const string & name);
 
+    virtual void Serialize(Checkpoint & cp) {}
+
     /* ==== Power Gate - Begin ==== */
     virtual void ReturnBuffer(int vc = 0);  // for push back SA to RC
     virtual void SetVCBufferSize(int vc_buf_size);
@@ -75,6 +79,7 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const;
     virtual int AvailableFor(int vc = 0) const;
     virtual int LimitFor(int vc = 0) const;
+    virtual void Serialize(Checkpoint & cp);
     /* ==== Power Gate - Begin ==== */
     virtual void ResetVCBufferSize();
     virtual void SetVCBufferSize(int vc_buf_size);
@@ -99,6 +104,7 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const;
     virtual int AvailableFor(int vc = 0) const;
     virtual int LimitFor(int vc = 0) const;
+    virtual void Serialize(Checkpoint & cp);
   };
 
   class LimitedSharedBufferPolicy : public SharedBufferPolicy {
@@ -115,6 +121,7 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const;
     virtual int AvailableFor(int vc = 0) const;
     virtual int LimitFor(int vc = 0) const;
+    virtual void Serialize(Checkpoint & cp);
     /* ==== Power Gate - Begin ==== */
     virtual void ReturnBuffer(int vc = 0);
     /* ==== Power Gate - End ==== */
@@ -166,6 +173,7 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const;
     virtual int AvailableFor(int vc = 0) const;
     virtual int LimitFor(int vc = 0) const;
+    virtual void Serialize(Checkpoint & cp);
   };
 
   class SimpleFeedbackSharedBufferPolicy : public FeedbackSharedBufferPolicy {
@@ -176,6 +184,7 @@ class BufferState : public Module {
         BufferState * parent, const string & name);
     virtual void SendingFlit(Flit const * const f);
     virtual void FreeSlotFor(int vc = 0);
+    virtual void Serialize(Checkpoint & cp);
   };
 
   bool _wait_for_tail_credit;
@@ -273,6 +282,8 @@ public:
   }
 #endif
 
+  void Serialize( Checkpoint & cp );
+
   void Display( ostream & os = cout ) const;
 };
 
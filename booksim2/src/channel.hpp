@@ -37,46 +37,85 @@
 #ifndef _CHANNEL_HPP
 #define _CHANNEL_HPP
 
-#include <queue>
+#include <vector>
 #include <cassert>
 
 #include "globals.hpp"
 #include "module.hpp"
 #include "timed_module.hpp"
+#include "channel_wheel.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
+// type-independent part of a channel, as seen by the timing wheel
+class ChannelBase : public Module {
+public:
+  ChannelBase(Module * parent, string const & name)
+    : Module(parent, name), _delay(1), _wheel(0), _wheel_id(-1),
+      _sink_module(0) {}
+  virtual ~ChannelBase() {}
+
+  int GetLatency() const { return _delay ; }
+
+  void SetWheel(ChannelWheel * wheel, int id) {
+    _wheel = wheel;
+    _wheel_id = id;
+  }
+
+  // module that reads the channel, woken up when data is delivered
+  void SetSinkModule(TimedModule * sink) { _sink_module = sink; }
+  TimedModule * GetSinkModule() const { return _sink_module; }
+
+  // true if data is delivered in the given cycle
+  virtual bool Deliver(int time) = 0;
+  // true if data is in flight to be delivered in the given cycle
+  virtual bool HasData(int time) const = 0;
+  // report the traversal of watched data sent in the previous cycle
+  virtual void WatchDeparture() {}
+
+protected:
+  int _delay;
+  ChannelWheel * _wheel;
+  int _wheel_id;
+  TimedModule * _sink_module;
+};
+
 template<typename T>
-class Channel : public TimedModule {
+class Channel : public ChannelBase {
 public:
   Channel(Module * parent, string const & name);
   virtual ~Channel() {}
 
   // Physical Parameters
   void SetLatency(int cycles);
-  int GetLatency() const { return _delay ; }
   
   // Send data 
   virtual void Send(T * data);
   
   // Receive data
   virtual T * Receive(); 
-  
-  virtual void ReadInputs();
-  virtual void Evaluate() {}
-  virtual void WriteOutputs();
+
+  virtual bool Deliver(int time);
+  virtual bool HasData(int time) const;
+
+  // data delivered after the given cycle, or in it and not yet received
+  void Serialize(Checkpoint & cp, int time);
 
 protected:
-  int _delay;
-  T * _input;
-  T * _output;
-  queue<pair<int, T *> > _wait_queue;
+  // data in flight, indexed by delivery cycle; the ring holds one entry
+  // more than the delay so that the data delivered in the last cycle can
+  // still be received while new data is sent
+  vector<pair<int, T *> > _ring;
 
+  inline pair<int, T *> & _Slot(int time) {
+    return _ring[time % _ring.size()];
+  }
 };
 
 template<typename T>
 Channel<T>::Channel(Module * parent, string const & name)
-  : TimedModule(parent, name), _delay(1), _input(0), _output(0) {
+  : ChannelBase(parent, name), _ring(_delay + 2, make_pair(-1, (T *)0)) {
 }
 
 template<typename T>
@@ -84,42 +123,62 @@ void Channel<T>::SetLatency(int cycles) {
   if(cycles <= 0) {
     Error("Channel must have positive delay.");
   }
+  if(_wheel && _wheel->Started()) {
+    Error("Channel delay cannot change after the simulation has started.");
+  }
   _delay = cycles ;
+  _ring.assign(_delay + 2, make_pair(-1, (T *)0));
 }
 
+// the last data sent in a cycle wins, sending NULL cancels it
 template<typename T>
 void Channel<T>::Send(T * data) {
-  _input = data;
+  assert(_wheel);
+  int const time = GetSimTime() + _delay;
+  _Slot(time) = make_pair(time, data);
+  if(data) {
+    _wheel->Schedule(_wheel_id, time);
+  }
 }
 
 template<typename T>
 T * Channel<T>::Receive() {
-  return _output;
+  int const time = _wheel ? _wheel->Time() : -1;
+  if(time < 0) {
+    return 0;
+  }
+  pair<int, T *> const & item = _Slot(time);
+  return (item.first == time) ? item.second : 0;
 }
 
 template<typename T>
-void Channel<T>::ReadInputs() {
-  if(_input) {
-    _wait_queue.push(make_pair(GetSimTime() + _delay - 1, _input));
-    _input = 0;
-  }
+bool Channel<T>::Deliver(int time) {
+  pair<int, T *> const & item = _Slot(time);
+  return (item.first == time) && item.second;
 }
 
 template<typename T>
-void Channel<T>::WriteOutputs() {
-  _output = 0;
-  if(_wait_queue.empty()) {
-    return;
-  }
-  pair<int, T *> const & item = _wait_queue.front();
-  int const & time = item.first;
-  if(GetSimTime() < time) {
-    return;
+bool Channel<T>::HasData(int time) const {
+  pair<int, T *> const & item = _ring[time % _ring.size()];
+  return (item.first == time) && item.second;
+}
+
+// slots that were delivered before may still point at data that has been
+// freed since, they are stored as empty
+template<typename T>
+void Channel<T>::Serialize(Checkpoint & cp, int time) {
+  cp.Check(_delay, FullName() + " latency");
+  for(size_t i = 0; i < _ring.size(); ++i) {
+    int t = _ring[i].first;
+    T * data = _ring[i].second;
+    if(!cp.Loading() && (t < time)) {
+      t = -1;
+      data = 0;
+    }
+    cp.Sync(t);
+    cp.Sync(data);
+    _ring[i] = make_pair(t, data);
   }
-  assert(GetSimTime() == time);
-  _output = item.second;
-  assert(_output);
-  _wait_queue.pop();
 }
 
 #endif
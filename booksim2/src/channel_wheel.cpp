@@ -0,0 +1,159 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include "channel_wheel.hpp"
+#include "channel.hpp"
+
+void ChannelWheel::Attach( ChannelBase * channel )
+{
+  if ( _slots ) {
+    channel->Error( "Channels cannot be added after the simulation has started." );
+  }
+  channel->SetWheel( this, _channels.size( ) );
+  _channels.push_back( channel );
+}
+
+// the wheel is sized once all channel latencies are known
+void ChannelWheel::_Start( )
+{
+  assert( !_slots );
+  int max_delay = 1;
+  for ( size_t c = 0; c < _channels.size( ); ++c ) {
+    max_delay = max( max_delay, _channels[c]->GetLatency( ) );
+  }
+  _slots = max_delay + 2;
+  _words = ( _channels.size( ) + WORD_BITS - 1 ) / WORD_BITS;
+  vector<atomic<word_t> > wheel( _slots * _words ), departures( _words );
+  _wheel.swap( wheel );
+  _departures.swap( departures );
+  for ( size_t w = 0; w < _wheel.size( ); ++w ) {
+    _wheel[w].store( 0, memory_order_relaxed );
+  }
+  for ( int w = 0; w < _words; ++w ) {
+    _departures[w].store( 0, memory_order_relaxed );
+  }
+}
+
+void ChannelWheel::PrintDepartures( )
+{
+  for ( int w = 0; w < _words; ++w ) {
+    word_t bits = _departures[w].load( memory_order_relaxed );
+    if ( !bits ) {
+      continue;
+    }
+    _departures[w].store( 0, memory_order_relaxed );
+    for ( ; bits; bits &= bits - 1 ) {
+      _channels[w * WORD_BITS + __builtin_ctzll( bits )]->WatchDeparture( );
+    }
+  }
+}
+
+void ChannelWheel::Deliver( int time )
+{
+  _time = time;
+  _delivered.clear( );
+  if ( !_slots ) {
+    return;
+  }
+  atomic<word_t> * const slot = &_wheel[( time % _slots ) * _words];
+  for ( int w = 0; w < _words; ++w ) {
+    word_t bits = slot[w].load( memory_order_relaxed );
+    if ( !bits ) {
+      continue;
+    }
+    slot[w].store( 0, memory_order_relaxed );
+    for ( ; bits; bits &= bits - 1 ) {
+      int const id = w * WORD_BITS + __builtin_ctzll( bits );
+      if ( _channels[id]->Deliver( time ) ) {
+        _delivered.push_back( id );
+      }
+    }
+  }
+}
+
+void ChannelWheel::Restore( int time )
+{
+  if ( !_slots ) {
+    _Start( );
+  }
+  for ( size_t w = 0; w < _wheel.size( ); ++w ) {
+    _wheel[w].store( 0, memory_order_relaxed );
+  }
+  for ( int w = 0; w < _words; ++w ) {
+    _departures[w].store( 0, memory_order_relaxed );
+  }
+  _time = time;
+  _delivered.clear( );
+  for ( size_t id = 0; id < _channels.size( ); ++id ) {
+    ChannelBase const * const channel = _channels[id];
+    if ( channel->HasData( time ) ) {
+      _delivered.push_back( id );
+    }
+    for ( int d = 1; d <= channel->GetLatency( ); ++d ) {
+      if ( channel->HasData( time + d ) ) {
+        Schedule( id, time + d );
+      }
+    }
+  }
+}
+
+// sinks are woken up after the routers have written their outputs, like
+// they were when the channels were evaluated as modules
+void ChannelWheel::ActivateSinks( )
+{
+  for ( size_t i = 0; i < _delivered.size( ); ++i ) {
+    TimedModule * const sink = _channels[_delivered[i]]->GetSinkModule( );
+    if ( sink ) {
+      sink->Activate( );
+    }
+  }
+}
+
+int ChannelWheel::IdleCycles( int now, int limit ) const
+{
+  if ( !_delivered.empty( ) && ( _time == now - 1 ) ) {
+    return 0;
+  }
+  for ( int w = 0; w < _words; ++w ) {
+    if ( _departures[w].load( memory_order_relaxed ) ) {
+      return 0;
+    }
+  }
+  int const horizon = min( limit, _slots );
+  for ( int d = 0; d < horizon; ++d ) {
+    atomic<word_t> const * const slot = &_wheel[( ( now + d ) % _slots ) * _words];
+    for ( int w = 0; w < _words; ++w ) {
+      if ( slot[w].load( memory_order_relaxed ) ) {
+        return d;
+      }
+    }
+  }
+  return limit;
+}
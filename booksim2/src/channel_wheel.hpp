@@ -0,0 +1,106 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*channel_wheel.hpp
+ *
+ *Timing wheel that delivers the data in flight on all channels of a
+ *network. A channel keeps the items it carries in a small ring indexed by
+ *delivery cycle and marks itself in the wheel slot of that cycle when it
+ *sends; the network then only visits the channels that deliver something in
+ *the current cycle, instead of evaluating every channel every cycle.
+ *
+ *The wheel has one slot more than the longest channel delay, so the slot of
+ *the cycle being delivered is never reused by a send in the same cycle.
+ *Sends can come from several worker threads of the parallel engine, so the
+ *slot words are updated atomically.
+ */
+
+#ifndef _CHANNEL_WHEEL_HPP_
+#define _CHANNEL_WHEEL_HPP_
+
+#include <vector>
+#include <atomic>
+#include <cassert>
+
+class ChannelBase;
+
+class ChannelWheel {
+
+  typedef unsigned long long word_t;
+  static const int WORD_BITS = 64;
+
+  std::vector<ChannelBase *> _channels;
+  int _words;
+  int _slots;
+  std::vector<std::atomic<word_t> > _wheel;
+  // channels that sent a watched flit in the previous cycle
+  std::vector<std::atomic<word_t> > _departures;
+  // channels that delivered data in the last call to Deliver
+  std::vector<int> _delivered;
+  int _time;
+
+  void _Start( );
+
+public:
+  ChannelWheel( ) : _words( 0 ), _slots( 0 ), _time( -1 ) {}
+
+  void Attach( ChannelBase * channel );
+  bool Started( ) const { return _slots > 0; }
+  // the wheel starts on the first send, or here before any parallel phase
+  // can send concurrently
+  inline void Start( ) { if ( !_slots ) _Start( ); }
+
+  // cycle of the last delivery, the data delivered then can be received
+  // until the next one
+  inline int Time( ) const { return _time; }
+
+  inline void Schedule( int id, int time ) {
+    Start( );
+    assert( ( id >= 0 ) && ( id < (int)_channels.size( ) ) );
+    assert( time > _time );
+    _wheel[( time % _slots ) * _words + id / WORD_BITS].fetch_or(
+      1ULL << ( id % WORD_BITS ), std::memory_order_relaxed );
+  }
+
+  inline void WatchDeparture( int id ) {
+    _departures[id / WORD_BITS].fetch_or( 1ULL << ( id % WORD_BITS ),
+                                          std::memory_order_relaxed );
+  }
+
+  void PrintDepartures( );
+  void Deliver( int time );
+  // rebuild the wheel from the data in flight on the channels, after they
+  // were restored from a checkpoint taken after the delivery in the given
+  // cycle
+  void Restore( int time );
+  void ActivateSinks( );
+
+  // number of cycles, starting with now, without any channel activity
+  int IdleCycles( int now, int limit ) const;
+};
+
+#endif
@@ -0,0 +1,268 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*checkpoint.cpp
+ *
+ *binary checkpoints of the simulation state
+ */
+
+#include <fstream>
+#include <sstream>
+#include <cerrno>
+#include <cassert>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "checkpoint.hpp"
+#include "flit.hpp"
+#include "credit.hpp"
+#include "outputset.hpp"
+#include "packet_reply_info.hpp"
+#include "handshake.hpp"
+
+const char Checkpoint::MAGIC[8] = { 'B', 'S', 'I', 'M', 'C', 'K', 'P', 'T' };
+const int Checkpoint::VERSION = 2;
+
+Checkpoint::Checkpoint( string const & filename, bool load )
+  : Module( 0, "checkpoint" ), _loading( load ), _filename( filename ),
+    _map( 0 ), _map_size( 0 ), _pos( 0 )
+{
+  if ( !_loading ) {
+    _Write( MAGIC, sizeof( MAGIC ) );
+    _Write( &VERSION, sizeof( VERSION ) );
+    return;
+  }
+
+  int const fd = open( _filename.c_str( ), O_RDONLY );
+  if ( fd < 0 ) {
+    Error( "Unable to open checkpoint " + _filename + ": " + strerror( errno ) );
+  }
+  struct stat st;
+  if ( fstat( fd, &st ) < 0 ) {
+    Error( "Unable to stat checkpoint " + _filename + ": " + strerror( errno ) );
+  }
+  _map_size = st.st_size;
+  if ( _map_size < sizeof( MAGIC ) + sizeof( VERSION ) ) {
+    Error( "Truncated checkpoint " + _filename );
+  }
+  void * const map = mmap( 0, _map_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+  close( fd );
+  if ( map == MAP_FAILED ) {
+    Error( "Unable to map checkpoint " + _filename + ": " + strerror( errno ) );
+  }
+  _map = (char const *)map;
+
+  char magic[sizeof( MAGIC )];
+  _Read( magic, sizeof( magic ) );
+  int version;
+  _Read( &version, sizeof( version ) );
+  if ( memcmp( magic, MAGIC, sizeof( MAGIC ) ) || ( version != VERSION ) ) {
+    Error( _filename + " is not a checkpoint of this simulator version" );
+  }
+}
+
+Checkpoint::~Checkpoint( )
+{
+  if ( _map ) {
+    munmap( (void *)_map, _map_size );
+  }
+}
+
+void Checkpoint::Save( )
+{
+  assert( !_loading );
+  ofstream out( _filename.c_str( ), ios::out | ios::binary );
+  out.write( &_data[0], _data.size( ) );
+  if ( !out ) {
+    Error( "Unable to write checkpoint " + _filename );
+  }
+}
+
+void Checkpoint::Check( int value, string const & what )
+{
+  int saved = value;
+  Sync( saved );
+  if ( saved != value ) {
+    ostringstream err;
+    err << "Checkpoint " << _filename << " does not match the configuration: "
+        << what << " is " << value << ", but was " << saved << ".";
+    Error( err.str( ) );
+  }
+}
+
+// a flit that was not visited yet is stored with the next free index
+void Checkpoint::Sync( Flit * & f )
+{
+  int index = -1;
+  if ( !_loading ) {
+    if ( f ) {
+      map<Flit const *, int>::const_iterator const iter = _flit_index.find( f );
+      if ( iter != _flit_index.end( ) ) {
+        index = iter->second;
+        Sync( index );
+        return;
+      }
+      index = _flit_index.size( );
+      _flit_index.insert( make_pair( f, index ) );
+    }
+    Sync( index );
+    if ( !f ) {
+      return;
+    }
+    if ( f->data ) {
+      Error( "Flits with attached data cannot be checkpointed." );
+    }
+  } else {
+    Sync( index );
+    if ( index < 0 ) {
+      f = 0;
+      return;
+    }
+    if ( index < (int)_flits.size( ) ) {
+      f = _flits[index];
+      return;
+    }
+    if ( index != (int)_flits.size( ) ) {
+      Error( "Corrupt checkpoint " + _filename );
+    }
+    f = Flit::New( );
+    _flits.push_back( f );
+  }
+
+  Sync( f->type );
+  Sync( f->vc );
+  Sync( f->cl );
+  Sync( f->head );
+  Sync( f->tail );
+  Sync( f->ctime );
+  Sync( f->itime );
+  Sync( f->atime );
+  Sync( f->rtime );
+  Sync( f->bypass_vc );
+  Sync( f->id );
+  Sync( f->pid );
+  Sync( f->record );
+  Sync( f->src );
+  Sync( f->dest );
+  Sync( f->pri );
+  Sync( f->flov_hops );
+  Sync( f->misroute_hops );
+  Sync( f->ring_dest );
+  Sync( f->hops );
+  Sync( f->watch );
+  Sync( f->subnetwork );
+  Sync( f->intm );
+  Sync( f->ph );
+  Sync( f->la_route_set );
+}
+
+// credits and replies are only held in one place at a time
+void Checkpoint::Sync( Credit * & c )
+{
+  bool valid = ( c != 0 );
+  Sync( valid );
+  if ( !valid ) {
+    c = 0;
+    return;
+  }
+  if ( _loading ) {
+    c = Credit::New( );
+  }
+  vector<int> vcs;
+  for ( VCMask::const_iterator iter = c->vc.begin( ); iter != c->vc.end( ); ++iter ) {
+    vcs.push_back( *iter );
+  }
+  Sync( vcs );
+  c->vc.clear( );
+  for ( size_t i = 0; i < vcs.size( ); ++i ) {
+    c->vc.insert( vcs[i] );
+  }
+  Sync( c->head );
+  Sync( c->tail );
+  Sync( c->id );
+}
+
+void Checkpoint::Sync( PacketReplyInfo * & p )
+{
+  bool valid = ( p != 0 );
+  Sync( valid );
+  if ( !valid ) {
+    p = 0;
+    return;
+  }
+  if ( _loading ) {
+    p = PacketReplyInfo::New( );
+  }
+  Sync( p->source );
+  Sync( p->time );
+  Sync( p->record );
+  Sync( p->type );
+}
+
+void Checkpoint::Sync( Handshake * & h )
+{
+  bool valid = ( h != 0 );
+  Sync( valid );
+  if ( !valid ) {
+    h = 0;
+    return;
+  }
+  if ( _loading ) {
+    h = Handshake::New( );
+  }
+  Sync( h->new_state );
+  Sync( h->src_state );
+  Sync( h->drain_done );
+  Sync( h->wakeup );
+  Sync( h->id );
+  Sync( h->hid );
+  Sync( h->logical_neighbor );
+  Sync( h->vote );
+}
+
+void Checkpoint::Sync( OutputSet & s )
+{
+  OutputSet::ElementSet const & elements = s.GetSet( );
+  vector<OutputSet::sSetElement> v( elements.begin( ), elements.end( ) );
+  int const size = SyncSize( v.size( ) );
+  v.resize( size );
+  for ( int i = 0; i < size; ++i ) {
+    Sync( v[i].vc_start );
+    Sync( v[i].vc_end );
+    Sync( v[i].pri );
+    Sync( v[i].output_port );
+  }
+  if ( _loading ) {
+    s.Clear( );
+    for ( int i = 0; i < size; ++i ) {
+      s.AddRange( v[i].output_port, v[i].vc_start, v[i].vc_end, v[i].pri );
+    }
+  }
+}
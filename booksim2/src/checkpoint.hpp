@@ -0,0 +1,209 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*checkpoint.hpp
+ *
+ *Binary snapshot of the simulation state, e.g., of a warmed-up network, so
+ *that several measurement runs can start from the same state. The state of
+ *an object is saved and restored by the same Serialize() method, the
+ *direction is given by the checkpoint. A flit is stored when it is first
+ *visited and referenced by its index afterwards, so flits that are held by
+ *both the traffic manager and the network are restored as one. Checkpoints
+ *are read through mmap.
+ */
+
+#ifndef _CHECKPOINT_HPP_
+#define _CHECKPOINT_HPP_
+
+#include <vector>
+#include <deque>
+#include <queue>
+#include <list>
+#include <map>
+#include <string>
+#include <cstring>
+#include <type_traits>
+
+#include "module.hpp"
+
+class Flit;
+class Credit;
+class OutputSet;
+class PacketReplyInfo;
+class Handshake;
+
+class Checkpoint : public Module {
+
+  bool _loading;
+  string _filename;
+
+  // contents of a checkpoint being saved
+  vector<char> _data;
+  map<Flit const *, int> _flit_index;
+
+  // mapped file of a checkpoint being restored
+  char const * _map;
+  size_t _map_size;
+  size_t _pos;
+  vector<Flit *> _flits;
+
+  static const char MAGIC[8];
+  static const int VERSION;
+
+  inline void _Write( void const * p, size_t size ) {
+    char const * const c = (char const *)p;
+    _data.insert( _data.end( ), c, c + size );
+  }
+  inline void _Read( void * p, size_t size ) {
+    if ( _pos + size > _map_size ) {
+      Error( "Truncated checkpoint " + _filename );
+    }
+    memcpy( p, _map + _pos, size );
+    _pos += size;
+  }
+
+public:
+
+  // an empty checkpoint to save to filename, or the checkpoint in filename
+  // to restore from
+  Checkpoint( string const & filename, bool load );
+  ~Checkpoint( );
+
+  inline bool Loading( ) const { return _loading; }
+
+  // write the saved state to the file
+  void Save( );
+
+  template<class T>
+  void Sync( T & x ) {
+    static_assert( std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                   "only plain values are stored directly" );
+    if ( _loading ) {
+      _Read( &x, sizeof( T ) );
+    } else {
+      _Write( &x, sizeof( T ) );
+    }
+  }
+
+  // the size of a container is stored, and the container is resized to it
+  // when it is restored
+  inline int SyncSize( int size ) {
+    Sync( size );
+    if ( size < 0 ) {
+      Error( "Corrupt checkpoint " + _filename );
+    }
+    return size;
+  }
+
+  template<class T>
+  void Sync( vector<T> & v ) {
+    v.resize( SyncSize( v.size( ) ) );
+    for ( size_t i = 0; i < v.size( ); ++i ) {
+      Sync( v[i] );
+    }
+  }
+  void Sync( vector<bool> & v ) {
+    v.resize( SyncSize( v.size( ) ) );
+    for ( size_t i = 0; i < v.size( ); ++i ) {
+      bool b = v[i];
+      Sync( b );
+      v[i] = b;
+    }
+  }
+  template<class T>
+  void Sync( deque<T> & d ) {
+    d.resize( SyncSize( d.size( ) ) );
+    for ( size_t i = 0; i < d.size( ); ++i ) {
+      Sync( d[i] );
+    }
+  }
+  template<class T>
+  void Sync( list<T> & l ) {
+    int const size = SyncSize( l.size( ) );
+    if ( _loading ) {
+      l.clear( );
+      for ( int i = 0; i < size; ++i ) {
+        T x = T( );
+        Sync( x );
+        l.push_back( x );
+      }
+    } else {
+      for ( typename list<T>::iterator iter = l.begin( ); iter != l.end( ); ++iter ) {
+        Sync( *iter );
+      }
+    }
+  }
+  template<class T>
+  void Sync( queue<T> & q ) {
+    int const size = SyncSize( q.size( ) );
+    if ( _loading ) {
+      q = queue<T>( );
+    }
+    for ( int i = 0; i < size; ++i ) {
+      // rotate the queue, so it is in its original order afterwards
+      T x = T( );
+      if ( !_loading ) {
+        x = q.front( );
+        q.pop( );
+      }
+      Sync( x );
+      q.push( x );
+    }
+  }
+  template<class K, class V>
+  void Sync( map<K, V> & m ) {
+    int const size = SyncSize( m.size( ) );
+    if ( _loading ) {
+      m.clear( );
+      for ( int i = 0; i < size; ++i ) {
+        K k = K( );
+        V v = V( );
+        Sync( k );
+        Sync( v );
+        m.insert( make_pair( k, v ) );
+      }
+    } else {
+      for ( typename map<K, V>::iterator iter = m.begin( ); iter != m.end( ); ++iter ) {
+        K k = iter->first;
+        Sync( k );
+        Sync( iter->second );
+      }
+    }
+  }
+
+  void Sync( Flit * & f );
+  void Sync( Credit * & c );
+  void Sync( PacketReplyInfo * & p );
+  void Sync( Handshake * & h );
+  void Sync( OutputSet & s );
+
+  // a value that is given by the configuration; restoring fails if it
+  // differs from the one of the saved simulation
+  void Check( int value, string const & what );
+};
+
+#endif
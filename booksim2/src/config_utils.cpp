@@ -36,14 +36,17 @@
 #include <sstream>
 #include <fstream>
 #include <cstdlib>
+#include <mutex>
 
 #include "config_utils.hpp"
 
 Configuration *Configuration::theConfig = 0;
 
+// held while theConfig is being parsed
+static std::mutex _parse_mutex;
+
 Configuration::Configuration()
 {
-  theConfig = this;
   _config_file = 0;
 }
 
@@ -152,7 +155,12 @@ void Configuration::ParseFile(string const & filename)
     exit(-1);
   }
 
-  yyparse();
+  {
+    std::lock_guard<std::mutex> lock(_parse_mutex);
+    theConfig = this;
+    yyparse();
+    theConfig = 0;
+  }
 
   fclose(_config_file);
   _config_file = 0;
@@ -161,7 +169,12 @@ void Configuration::ParseFile(string const & filename)
 void Configuration::ParseString(string const & str)
 {
   _config_string = str + ';';
-  yyparse();
+  {
+    std::lock_guard<std::mutex> lock(_parse_mutex);
+    theConfig = this;
+    yyparse();
+    theConfig = 0;
+  }
   _config_string = "";
 }
 
@@ -38,6 +38,8 @@
 extern "C" int yyparse();
 
 class Configuration {
+  // the configuration being parsed; the parser is not reentrant, so the
+  // configurations of concurrent simulations are parsed one at a time
   static Configuration * theConfig;
   FILE * _config_file;
   string _config_string;
@@ -33,8 +33,7 @@
 #include "booksim.hpp"
 #include "credit.hpp"
 
-stack<Credit *> Credit::_all;
-stack<Credit *> Credit::_free;
+thread_local ObjectPool<Credit> * Credit::_pool = 0;
 
 Credit::Credit()
 {
@@ -50,30 +49,19 @@ void Credit::Reset()
 }
 
 Credit * Credit::New() {
-  Credit * c;
-  if(_free.empty()) {
-    c = new Credit();
-    _all.push(c);
-  } else {
-    c = _free.top();
-    c->Reset();
-    _free.pop();
-  }
+  Credit * c = _pool->New();
+  c->Reset();
   return c;
 }
 
 void Credit::Free() {
-  _free.push(this);
+  _pool->Free(this);
 }
 
 void Credit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
-  }
+  _pool->FreeAll();
 }
 
-
 int Credit::OutStanding(){
-  return _all.size()-_free.size();
+  return _pool->OutStanding();
 }
@@ -28,14 +28,98 @@
 #ifndef _CREDIT_HPP_
 #define _CREDIT_HPP_
 
-#include <set>
-#include <stack>
+#include <cassert>
+
+#include "object_pool.hpp"
+
+// largest number of VCs a credit can carry; override with -DCREDIT_MAX_VCS
+#ifndef CREDIT_MAX_VCS
+#define CREDIT_MAX_VCS 64
+#endif
+
+// Set of VCs stored as an inline bitmask. Iteration visits the VCs in
+// ascending order, like the std::set<int> it replaces.
+class VCMask {
+
+  typedef unsigned long long word_t;
+  static const int WORD_BITS = 64;
+  static const int WORDS = ( CREDIT_MAX_VCS + WORD_BITS - 1 ) / WORD_BITS;
+
+  word_t _bits[WORDS];
+
+public:
+
+  static const int MAX_VCS = WORDS * WORD_BITS;
+
+  class const_iterator {
+    VCMask const * _mask;
+    int _vc;
+  public:
+    const_iterator( VCMask const * mask, int vc ) : _mask( mask ), _vc( vc ) {}
+    inline int operator*( ) const { return _vc; }
+    inline const_iterator & operator++( ) {
+      _vc = _mask->next( _vc + 1 );
+      return *this;
+    }
+    inline bool operator==( const_iterator const & i ) const { return _vc == i._vc; }
+    inline bool operator!=( const_iterator const & i ) const { return _vc != i._vc; }
+  };
+
+  VCMask( ) { clear( ); }
+
+  inline void clear( ) {
+    for ( int w = 0; w < WORDS; ++w ) {
+      _bits[w] = 0;
+    }
+  }
+  inline void insert( int vc ) {
+    assert( ( vc >= 0 ) && ( vc < MAX_VCS ) );
+    _bits[vc / WORD_BITS] |= 1ULL << ( vc % WORD_BITS );
+  }
+  inline void erase( int vc ) {
+    assert( ( vc >= 0 ) && ( vc < MAX_VCS ) );
+    _bits[vc / WORD_BITS] &= ~( 1ULL << ( vc % WORD_BITS ) );
+  }
+  inline int count( int vc ) const {
+    assert( ( vc >= 0 ) && ( vc < MAX_VCS ) );
+    return ( _bits[vc / WORD_BITS] >> ( vc % WORD_BITS ) ) & 1;
+  }
+  inline bool empty( ) const {
+    for ( int w = 0; w < WORDS; ++w ) {
+      if ( _bits[w] ) {
+        return false;
+      }
+    }
+    return true;
+  }
+  inline int size( ) const {
+    int n = 0;
+    for ( int w = 0; w < WORDS; ++w ) {
+      n += __builtin_popcountll( _bits[w] );
+    }
+    return n;
+  }
+  // first VC at or after vc, or MAX_VCS if there is none
+  inline int next( int vc ) const {
+    while ( vc < MAX_VCS ) {
+      int const w = vc / WORD_BITS;
+      word_t const bits = _bits[w] >> ( vc % WORD_BITS );
+      if ( bits ) {
+        return vc + __builtin_ctzll( bits );
+      }
+      vc = ( w + 1 ) * WORD_BITS;
+    }
+    return MAX_VCS;
+  }
+  inline const_iterator begin( ) const { return const_iterator( this, next( 0 ) ); }
+  inline const_iterator end( ) const { return const_iterator( this, MAX_VCS ); }
+};
 
 class Credit {
 
 public:
 
-  set<int> vc;
+  VCMask vc;
 
   // these are only used by the event router
   bool head, tail;
@@ -49,12 +133,14 @@ public:
   static int OutStanding();
 private:
 
-  static stack<Credit *> _all;
-  static stack<Credit *> _free;
-
   Credit();
   ~Credit() {}
 
+  friend class ObjectPool<Credit>;
+  // the pool of the simulation of the calling thread, see SimContext
+  friend class SimContext;
+  static thread_local ObjectPool<Credit> * _pool;
+
 };
 
 #endif
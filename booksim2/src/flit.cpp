@@ -37,8 +37,7 @@
 #include "booksim.hpp"
 #include "flit.hpp"
 
-stack<Flit *> Flit::_all;
-stack<Flit *> Flit::_free;
+thread_local ObjectPool<Flit> * Flit::_pool = 0;
 
 ostream& operator<<( ostream& os, const Flit& f )
 {
@@ -90,26 +89,18 @@ void Flit::Reset()
 }
 
 Flit * Flit::New() {
-  Flit * f;
-  if(_free.empty()) {
-    f = new Flit;
-    _all.push(f);
-  } else {
-    f = _free.top();
-    f->Reset();
-    _free.pop();
-  }
-  return f;
+  return _pool->New();
 }
 
 void Flit::Free() {
   Reset();
-  _free.push(this);
+  _pool->Free(this);
 }
 
 void Flit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
-  }
+  _pool->FreeAll();
+}
+
+int Flit::OutStanding() {
+  return _pool->OutStanding();
 }
@@ -29,10 +29,10 @@
 #define _FLIT_HPP_
 
 #include <iostream>
-#include <stack>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
+#include "object_pool.hpp"
 
 class Flit {
 
@@ -99,14 +99,17 @@ public:
   static Flit * New();
   void Free();
   static void FreeAll();
+  static int OutStanding();
 
 private:
 
   Flit();
   ~Flit() {}
 
-  static stack<Flit *> _all;
-  static stack<Flit *> _free;
+  friend class ObjectPool<Flit>;
+  // the pool of the simulation of the calling thread, see SimContext
+  friend class SimContext;
+  static thread_local ObjectPool<Flit> * _pool;
 
 };
 
@@ -70,25 +70,38 @@ void FlitChannel::Send(Flit * f) {
     ++_idle;
   }
   Channel<Flit>::Send(f);
+  if(f && f->watch) {
+    _wheel->WatchDeparture(_wheel_id);
+  }
 }
 
-void FlitChannel::ReadInputs() {
-  Flit const * const & f = _input;
-  if(f && f->watch) {
+void FlitChannel::WatchDeparture() {
+  int const time = GetSimTime() - 1 + _delay;
+  pair<int, Flit *> const & item = _Slot(time);
+  Flit const * const f = item.second;
+  if((item.first == time) && f && f->watch) {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 	       << "Beginning channel traversal for flit " << f->id
 	       << " with delay " << _delay
 	       << "." << endl;
   }
-
-  Channel<Flit>::ReadInputs();
 }
 
-void FlitChannel::WriteOutputs() {
-  Channel<Flit>::WriteOutputs();
-  if(_output && _output->watch) {
+bool FlitChannel::Deliver(int time) {
+  if(!Channel<Flit>::Deliver(time)) {
+    return false;
+  }
+  Flit const * const f = _Slot(time).second;
+  if(f->watch) {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-	       << "Completed channel traversal for flit " << _output->id
+	       << "Completed channel traversal for flit " << f->id
 	       << "." << endl;
   }
+  return true;
+}
+
+void FlitChannel::Serialize(Checkpoint & cp, int time) {
+  Channel<Flit>::Serialize(cp, time);
+  cp.Sync(_active);
+  cp.Sync(_idle);
 }
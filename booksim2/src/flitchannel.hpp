@@ -79,8 +79,10 @@ public:
   // Send flit
   virtual void Send(Flit * flit);
 
-  virtual void ReadInputs();
-  virtual void WriteOutputs();
+  virtual bool Deliver(int time);
+  virtual void WatchDeparture();
+
+  void Serialize(Checkpoint & cp, int time);
 
 private:
 
@@ -0,0 +1,61 @@
+/*
+ * flov_voter.cpp
+ * - latency votes for adaptive FlyOver power-gating
+ *
+ * Author: Jiayi Huang
+ */
+
+#include <cassert>
+
+#include "flov_voter.hpp"
+
+FLOVVoter::FLOVVoter(int width, int height, int tile_size)
+  : _width(width), _height(height), _tile_size(tile_size), _tiles_per_row(0)
+{
+  assert(_width > 0 && _height > 0 && _tile_size >= 0);
+  _votes.resize(_width * _height, 0);
+  if (_tile_size == 0) {
+    _row_votes.resize(_height, 0);
+    _col_votes.resize(_width, 0);
+  } else {
+    _tiles_per_row = (_width + _tile_size - 1) / _tile_size;
+    int tiles_per_col = (_height + _tile_size - 1) / _tile_size;
+    _tile_votes.resize(_tiles_per_row * tiles_per_col, 0);
+  }
+}
+
+void FLOVVoter::Clear()
+{
+  _votes.assign(_votes.size(), 0);
+  _row_votes.assign(_row_votes.size(), 0);
+  _col_votes.assign(_col_votes.size(), 0);
+  _tile_votes.assign(_tile_votes.size(), 0);
+}
+
+void FLOVVoter::Vote(int node, int vote)
+{
+  assert(node >= 0 && node < (int)_votes.size());
+  _votes[node] += vote;
+  if (_tile_size == 0) {
+    int const row = node / _width;
+    int const col = node % _width;
+    if (row <= col)
+      _row_votes[row] += vote;
+    if (col <= row)
+      _col_votes[col] += vote;
+  } else {
+    _tile_votes[_Tile(node)] += vote;
+  }
+}
+
+int FLOVVoter::Tally(int node) const
+{
+  assert(node >= 0 && node < (int)_votes.size());
+  if (_tile_size == 0) {
+    int const row = node / _width;
+    int const col = node % _width;
+    // a node on the diagonal has its vote in both its row and its column
+    return _row_votes[row] + _col_votes[col] - ((row == col) ? _votes[node] : 0);
+  }
+  return _tile_votes[_Tile(node)];
+}
@@ -0,0 +1,54 @@
+/*
+ * flov_voter.hpp
+ * - latency votes for adaptive FlyOver power-gating
+ *
+ * Author: Jiayi Huang
+ */
+
+#ifndef _FLOV_VOTER_HPP_
+#define _FLOV_VOTER_HPP_
+
+#include <vector>
+
+#include "booksim.hpp"
+
+// Collects the votes of the nodes of a width x height mesh (row-major) for
+// one monitor epoch and aggregates them per region. A positive vote asks
+// for a more aggressive power-gating policy, a negative one for a less
+// aggressive policy. Without a tile size, the node at (row, col) votes into
+// its row if row <= col and into its column if col <= row (both for nodes
+// on the diagonal, counted once), and a node tallies the votes of its row
+// and its column; otherwise the region of a node is the tile_size x
+// tile_size tile holding it (tiles at the east and south edges may be
+// smaller). Voting and tallying are O(1) per node.
+class FLOVVoter {
+
+private:
+
+  int _width;
+  int _height;
+  int _tile_size;
+  int _tiles_per_row;
+
+  vector<int> _votes;
+  // partial sums per row and column, or per tile
+  vector<int> _row_votes;
+  vector<int> _col_votes;
+  vector<int> _tile_votes;
+
+  inline int _Tile(int node) const {
+    return (node / _width / _tile_size) * _tiles_per_row +
+      (node % _width) / _tile_size;
+  }
+
+public:
+
+  FLOVVoter(int width, int height, int tile_size = 0);
+
+  void Clear();
+  void Vote(int node, int vote);
+  int Tally(int node) const;
+
+};
+
+#endif
@@ -18,6 +18,7 @@
 #include "random_utils.hpp"
 #include "vc.hpp"
 #include "packet_reply_info.hpp"
+#include "checkpoint.hpp"
 
 FLOVTrafficManager::FLOVTrafficManager( const Configuration &config,
                                         const vector<Network *> & net )
@@ -89,13 +90,18 @@ FLOVTrafficManager::FLOVTrafficManager( const Configuration &config,
         tmp_name.str("");
     }
 
-    _router_idle_periods.resize(_nodes, 0);
     _idle_cycles.resize(_nodes);
     _overall_idle_cycles.resize(_nodes);
     for (int n = 0; n < _nodes; ++n) {
       _idle_cycles[n].resize(320000, 0);
       _overall_idle_cycles[n].resize(32000, 0);
     }
+    _injection_backlog.resize(_nodes, 0);
+    _last_ejection.resize(_nodes, -1);
+    _node_idle.resize(_nodes, false);
+    _period_start.resize(_nodes, -1);
+    _busy_nodes = _nodes;
+    _idle_clock = 0;
     _wakeup_handshake_latency.resize(_nodes, false);
 
     _monitor_counter = 0;
@@ -107,13 +113,47 @@ FLOVTrafficManager::FLOVTrafficManager( const Configuration &config,
     _plat_low_watermark = zeroload_latency * low_watermark;
 
     _powergate_type = config.GetStr("powergate_type");
-    _power_state_votes.resize(_nodes, 0);
+    // FlyOver meshes are laid out row-major with gK nodes per row
+    _mesh_width = gK;
+    if (_nodes % _mesh_width != 0) {
+      ostringstream err;
+      err << "FLOV voting requires a mesh with " << _mesh_width
+          << " nodes per row, got " << _nodes << " nodes";
+      Error(err.str());
+    }
+    int const tile_size = config.GetInt("flov_vote_tile_size");
+    if (tile_size < 0) {
+      ostringstream err;
+      err << "flov_vote_tile_size " << tile_size << " is negative";
+      Error(err.str());
+    }
+    _flov_voter = new FLOVVoter(_mesh_width, _nodes / _mesh_width, tile_size);
+    // with propagation, the routers tally the votes relayed over the
+    // handshake channels, which cross any region within this many cycles
+    _vote_propagation = (config.GetInt("flov_vote_propagation") > 0);
+    _vote_settle = 2 * (_mesh_width + _nodes / _mesh_width);
+    _votes_cast = false;
+    if (_vote_propagation && _monitor_epoch <= _vote_settle) {
+      ostringstream err;
+      err << "flov_monitor_epoch must exceed the " << _vote_settle
+          << " cycles votes take to propagate";
+      Error(err.str());
+    }
+    // latency quantile compared against the watermarks, 0 for the average
+    _vote_quantile = config.GetFloat("flov_vote_quantile");
+    if (_vote_quantile < 0.0 || _vote_quantile > 1.0) {
+      ostringstream err;
+      err << "flov_vote_quantile " << _vote_quantile << " not in [0, 1]";
+      Error(err.str());
+    }
     _per_node_plat.resize(_nodes);
     for (int n = 0; n < _nodes; ++n) {
       ostringstream tmp_name;
 
       tmp_name << "per_node_plat_stat_" << n;
       _per_node_plat[n] = new Stats(this, tmp_name.str(), 1.0, 1000);
+      if (!_latency_quantiles.empty() || _vote_quantile > 0.0)
+        _per_node_plat[n]->EnableQuantiles();
       tmp_name.str("");
     }
     /* ==== Power Gate - End ==== */
@@ -126,6 +166,27 @@ FLOVTrafficManager::~FLOVTrafficManager( )
     for ( int c = 0; c < _classes; ++c ) {
         delete _flov_hop_stats[c];
     }
+    delete _flov_voter;
+    /* ==== Power Gate - End ==== */
+}
+
+// the votes are cast and tallied within a cycle, and the idle cycles per
+// node are not reported
+void FLOVTrafficManager::_Serialize( Checkpoint & cp )
+{
+    /* ==== Power Gate - Begin ==== */
+    cp.Sync( _monitor_counter );
+    cp.Sync( _votes_cast );
+    for ( int n = 0; n < _nodes; ++n ) {
+        _per_node_plat[n]->Serialize( cp );
+    }
+    cp.Sync( _injection_backlog );
+    cp.Sync( _last_ejection );
+    cp.Sync( _node_idle );
+    cp.Sync( _period_start );
+    cp.Sync( _busy_nodes );
+    cp.Sync( _idle_clock );
+    cp.Sync( _wakeup_handshake_latency );
     /* ==== Power Gate - End ==== */
 }
 
@@ -167,7 +228,7 @@ void FLOVTrafficManager::_RetireFlit( Flit *f, int dest )
         _slowest_flit[f->cl] = f->id;
     _flat_stats[f->cl]->AddSample( f->atime - f->itime);
     if(_pair_stats){
-        _pair_flat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - f->itime );
+        _pair_flat[f->cl]->AddSample( f->src, dest, f->atime - f->itime );
     }
 
     if ( f->tail ) {
@@ -229,8 +290,8 @@ void FLOVTrafficManager::_RetireFlit( Flit *f, int dest )
             _frag_stats[f->cl]->AddSample( (f->atime - head->atime) - (f->id - head->id) );
 
             if(_pair_stats){
-                _pair_plat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - head->ctime );
-                _pair_nlat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - head->itime );
+                _pair_plat[f->cl]->AddSample( f->src, dest, f->atime - head->ctime );
+                _pair_nlat[f->cl]->AddSample( f->src, dest, f->atime - head->itime );
             }
         }
 
@@ -398,50 +459,41 @@ void FLOVTrafficManager::_GeneratePacket( int source, int stype,
 
         _partial_packets[source][cl].push_back( f );
     }
+    /* ==== Power Gate - Begin ==== */
+    _injection_backlog[source] += size;
+    /* ==== Power Gate - End ==== */
 }
 
-void FLOVTrafficManager::_Inject()
+void FLOVTrafficManager::_Step( )
 {
     /* ==== Power Gate - Begin ==== */
-    vector<bool> & core_states = _net[0]->GetCoreStates();
-    /* ==== Power Gate - End ==== */
-
-    for ( int input = 0; input < _nodes; ++input ) {
-        /* ==== Power Gate - Begin ==== */
-        if (core_states[input] == false)
-            continue;
-        /* ==== Power Gate - End ==== */
-        for ( int c = 0; c < _classes; ++c ) {
-            // Potentially generate packets for any (input,class)
-            // that is currently empty
-            if ( _partial_packets[input][c].empty() ) {
-                bool generated = false;
-                while( !generated && ( _qtime[input][c] <= _time ) ) {
-                    int stype = _IssuePacket( input, c );
-
-                    if ( stype != 0 ) { //generate a packet
-                        _GeneratePacket( input, stype, c,
-                                         _include_queuing==1 ?
-                                         _qtime[input][c] : _time );
-                        generated = true;
-                    }
-                    // only advance time if this is not a reply packet
-                    if(!_use_read_write[c] || (stype >= 0)){
-                        ++_qtime[input][c];
-                    }
-                }
-
-                if ( ( _sim_state == draining ) &&
-                     ( _qtime[input][c] > _drain_time ) ) {
-                    _qdrained[input][c] = true;
-                }
+    // cycles can only be skipped once every node is idle, and not past the
+    // next vote or tally; skipped cycles count towards the monitor epoch
+    bool injected = false;
+    if ( _fast_forward && ( _busy_nodes == 0 ) ) {
+        int const step_limit = _step_limit;
+        if ( _powergate_type == "flov" ) {
+            int const end = _votes_cast ? _vote_settle : _monitor_epoch;
+            int const next = _time + max( 0, end - _monitor_counter );
+            if ( next < _step_limit ) {
+                _step_limit = next;
             }
         }
+        int const start = _time;
+        int const pid = _cur_pid;
+        bool const idle = !_SkipIdleCycles( true );
+        _step_limit = step_limit;
+        _monitor_counter += _time - start;
+        _idle_clock += _time - start;
+        if ( idle && ( _time >= _step_limit ) ) {
+            return;
+        }
+        // with legacy injection sampling, the packets of this cycle may
+        // already have been generated; the source queues were empty before
+        injected = ( _cur_pid != pid );
     }
-}
+    /* ==== Power Gate - End ==== */
 
-void FLOVTrafficManager::_Step( )
-{
     bool flits_in_flight = false;
     for(int c = 0; c < _classes; ++c) {
         flits_in_flight |= !_total_in_flight_flits[c].empty();
@@ -465,118 +517,61 @@ void FLOVTrafficManager::_Step( )
     }
 
     /* ==== Power Gate - Begin ==== */
-    // adaptive power-gating
-    if (_powergate_type == "flov" && _monitor_counter / _monitor_epoch > 0) {
-      int turn = _monitor_counter % _monitor_epoch;
-      for (int row = 0; row < gK; ++row) {
-        for (int col = 0; col < gK; ++col) {
-          if (row == turn || col == turn) {
-            int n = row * gK + col;
-            if (_per_node_plat[n]->NumSamples() == 0)
-              continue;
-
-            int vote = 0;
-            double avg_plat = _per_node_plat[n]->Average();
-            if (avg_plat < _plat_low_watermark) {
-              vote = 1;
-            } else if (avg_plat > _plat_high_watermark) {
-              vote = -1;
-            }
-
-            if (row == turn) {
-              for (int c = 0; c < gK; ++c) {
-                if (c == col)
-                  continue;
-
-                int node = row * gK + c;
-                _power_state_votes[node] += vote;
-              }
-            }
-            if (col == turn) {
-              for (int r = 0; r < gK; ++r) {
-                if (r == row)
-                  continue;
-
-                int node = r * gK + col;
-                _power_state_votes[node] += vote;
-              }
-            }
-            _power_state_votes[n] += vote;
-
-            _per_node_plat[n]->Clear();
-          }
-        }
-      }
-
-      if (turn == gK) {
-        vector<Router *> routers = _net[0]->GetRouters();
+    // adaptive power-gating: at the end of each monitor epoch, every node
+    // that received packets votes based on their average latency, and each
+    // router changes its FLOV policy according to the votes of its region;
+    // propagated votes are tallied once they have crossed their region
+    if (_powergate_type == "flov") {
+      const vector<Router *> & routers = _net[0]->GetRouters();
+      bool tally = false;
+      if (_monitor_counter >= _monitor_epoch) {
+        _flov_voter->Clear();
         for (int n = 0; n < _nodes; ++n) {
-          if (n >= _nodes - gK) {
-            _power_state_votes[n] = 0;
+          if (_per_node_plat[n]->NumSamples() == 0)
             continue;
-          }
 
-          if (_power_state_votes[n] > 0) {
-            routers[n]->AggressPowerGatingPolicy();
-            //cout << GetSimTime() << " | node " << n
-            //  << " | (vote " << _power_state_votes[n]
-            //  << ") can switch off to save more power" << endl;
-          } else if (_power_state_votes[n] < 0) {
-            routers[n]->RegressPowerGatingPolicy();
-            //cout << GetSimTime() << " | node " << n
-            //  << " | (vote " << _power_state_votes[n]
-            //  << ") should switch on for performance" << endl;
+          int vote = 0;
+          double plat = (_vote_quantile > 0.0) ?
+            _per_node_plat[n]->Quantile(_vote_quantile) :
+            _per_node_plat[n]->Average();
+          if (plat < _plat_low_watermark) {
+            vote = 1;
+          } else if (plat > _plat_high_watermark) {
+            vote = -1;
           }
-          _power_state_votes[n] = 0;
+          if (_vote_propagation)
+            routers[n]->CastPowerGatingVote(vote);
+          else
+            _flov_voter->Vote(n, vote);
+
+          _per_node_plat[n]->Clear();
         }
         _monitor_counter = 0;
+        _votes_cast = _vote_propagation;
+        tally = !_vote_propagation;
+      } else if (_votes_cast && _monitor_counter >= _vote_settle) {
+        _votes_cast = false;
+        tally = true;
       }
-    }
 
-    for (int n = 0; n < _nodes; ++n) {
-        bool is_idle = true;
-        bool is_inj_busy = false;
-        for (int c = 0; c < _classes; ++c) { // injection
-            list<Flit *> const & flist = _partial_packets[n][c];
-            if (!flist.empty()) {
-                is_inj_busy = true;
-                break;
-            }
-        }
-        for (int subnet = 0; subnet < _subnets; ++subnet) {
-            Flit * const f = _net[subnet]->ReadFlit(n); // ejection
-            if (is_inj_busy || f) {
-                is_idle = false;
-                break;
-            }
-        }
-        if (is_idle == true) {  // found an idle cycle
-            for (int subnet = 0; subnet < _subnets; ++subnet) {
-                vector<Router *> routers = _net[subnet]->GetRouters();
-                routers[n]->IdleDetected();
-            }
-            ++_router_idle_periods[n];
-        } else {    // busy for any subnetwork with the node
-            int cur_idle_cycles = _router_idle_periods[n];
-            if (cur_idle_cycles >= _overall_idle_cycles[n].size()) {
-                for (int i = 0; i < _nodes; ++i) {
-                    _idle_cycles[i].resize(cur_idle_cycles + 10, 0);
-                    _overall_idle_cycles[i].resize(cur_idle_cycles + 10, 0);
-                }
-            }
-            if (cur_idle_cycles != 0) { // for the busy cycle
-                ++_idle_cycles[n][0];
-                ++_overall_idle_cycles[n][0];
-            }
-            ++_idle_cycles[n][cur_idle_cycles];
-            ++_overall_idle_cycles[n][cur_idle_cycles];
-            _router_idle_periods[n] = 0;
-            // Power on Router
-            for (int subnet = 0; subnet < _subnets; ++subnet) {
-                vector<Router *> routers = _net[subnet]->GetRouters();
-                routers[n]->WakeUp();
-            }
+      for (int n = 0; tally && (n < _nodes); ++n) {
+        int const votes = _vote_propagation ?
+          routers[n]->TallyPowerGatingVotes() : _flov_voter->Tally(n);
+        // bottom row routers are always on
+        if (n >= _nodes - _mesh_width)
+          continue;
+        if (votes > 0) {
+          routers[n]->AggressPowerGatingPolicy();
+          //cout << GetSimTime() << " | node " << n
+          //  << " | (vote " << votes
+          //  << ") can switch off to save more power" << endl;
+        } else if (votes < 0) {
+          routers[n]->RegressPowerGatingPolicy();
+          //cout << GetSimTime() << " | node " << n
+          //  << " | (vote " << votes
+          //  << ") should switch on for performance" << endl;
         }
+      }
     }
     /* ==== Power Gate - End ==== */
 
@@ -595,6 +590,9 @@ void FLOVTrafficManager::_Step( )
                                << "." << endl;
                 }
                 flits[subnet].insert(make_pair(n, f));
+                /* ==== Power Gate - Begin ==== */
+                _last_ejection[n] = _idle_clock;
+                /* ==== Power Gate - End ==== */
                 if((_sim_state == warming_up) || (_sim_state == running)) {
                     ++_accepted_flits[f->cl][n];
                     if(f->tail) {
@@ -606,7 +604,7 @@ void FLOVTrafficManager::_Step( )
             Credit * const c = _net[subnet]->ReadCredit( n );
             if ( c ) {
 #ifdef TRACK_FLOWS
-                for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+                for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
                     int const vc = *iter;
                     assert(!_outstanding_classes[n][subnet][vc].empty());
                     int cl = _outstanding_classes[n][subnet][vc].front();
@@ -619,6 +617,49 @@ void FLOVTrafficManager::_Step( )
                 c->Free();
             }
         }
+    }
+
+    /* ==== Power Gate - Begin ==== */
+    // a node is idle in a cycle if it has no flits waiting for injection
+    // and ejects none; its routers are only notified when this changes
+    for (int n = 0; n < _nodes; ++n) {
+        bool const is_idle = (injected || (_injection_backlog[n] == 0)) &&
+                             (_last_ejection[n] != _idle_clock);
+        if (is_idle == _node_idle[n] && _period_start[n] >= 0)
+            continue;
+        if (is_idle != _node_idle[n])
+            _busy_nodes += is_idle ? -1 : 1;
+        if (is_idle) {  // start of an idle period
+            if (_period_start[n] >= 0) {  // for the busy cycles
+                _idle_cycles[n][0] += _idle_clock - _period_start[n];
+                _overall_idle_cycles[n][0] += _idle_clock - _period_start[n];
+            }
+            for (int subnet = 0; subnet < _subnets; ++subnet) {
+                _net[subnet]->GetRouters()[n]->IdleDetected();
+            }
+        } else {  // busy for any subnetwork with the node
+            if (_period_start[n] >= 0) {
+                int cur_idle_cycles = _idle_clock - _period_start[n];
+                if (cur_idle_cycles >= _overall_idle_cycles[n].size()) {
+                    for (int i = 0; i < _nodes; ++i) {
+                        _idle_cycles[i].resize(cur_idle_cycles + 10, 0);
+                        _overall_idle_cycles[i].resize(cur_idle_cycles + 10, 0);
+                    }
+                }
+                ++_idle_cycles[n][cur_idle_cycles];
+                ++_overall_idle_cycles[n][cur_idle_cycles];
+            }
+            // Power on Router
+            for (int subnet = 0; subnet < _subnets; ++subnet) {
+                _net[subnet]->GetRouters()[n]->BusyDetected();
+            }
+        }
+        _node_idle[n] = is_idle;
+        _period_start[n] = _idle_clock;
+    }
+    /* ==== Power Gate - End ==== */
+
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
         _net[subnet]->ReadInputs( );
     }
 
@@ -700,7 +741,7 @@ void FLOVTrafficManager::_Step( )
 
                     OutputSet route_set;
                     _rf(NULL, cf, -1, &route_set, true);
-                    set<OutputSet::sSetElement> const & os = route_set.GetSet();
+                    OutputSet::ElementSet const & os = route_set.GetSet();
                     assert(os.size() == 1);
                     OutputSet::sSetElement const & se = *os.begin();
                     assert(se.output_port == -1);
@@ -727,7 +768,7 @@ void FLOVTrafficManager::_Step( )
                                        << "Generating lookahead routing info for flit " << cf->id
                                        << " (NOQ)." << endl;
                         }
-                        set<OutputSet::sSetElement> const sl = cf->la_route_set.GetSet();
+                        OutputSet::ElementSet const sl = cf->la_route_set.GetSet();
                         assert(sl.size() == 1);
                         int next_output = sl.begin()->output_port;
                         vc_count /= router->NumOutputs();
@@ -853,6 +894,9 @@ void FLOVTrafficManager::_Step( )
                 _last_class[n][subnet] = c;
 
                 _partial_packets[n][c].pop_front();
+                /* ==== Power Gate - Begin ==== */
+                --_injection_backlog[n];
+                /* ==== Power Gate - End ==== */
 
 #ifdef TRACK_FLOWS
                 ++_outstanding_credits[c][subnet][n];
@@ -934,6 +978,7 @@ void FLOVTrafficManager::_Step( )
     }
 
     ++_monitor_counter;
+    ++_idle_clock;
     ++_time;
     assert(_time);
     if(gTrace){
@@ -968,13 +1013,9 @@ void FLOVTrafficManager::_ClearStats( )
         _crossbar_conflict_stalls[c].assign(_subnets*_routers, 0);
 #endif
         if(_pair_stats){
-            for ( int i = 0; i < _nodes; ++i ) {
-                for ( int j = 0; j < _nodes; ++j ) {
-                    _pair_plat[c][i*_nodes+j]->Clear( );
-                    _pair_nlat[c][i*_nodes+j]->Clear( );
-                    _pair_flat[c][i*_nodes+j]->Clear( );
-                }
-            }
+            _pair_plat[c]->Clear( );
+            _pair_nlat[c]->Clear( );
+            _pair_flat[c]->Clear( );
         }
         _hop_stats[c]->Clear();
         /* ==== Power Gate - Begin ==== */
@@ -1024,34 +1065,9 @@ void FLOVTrafficManager::WriteStats(ostream & os) const {
            /* ==== Power Gate - Begin ==== */
            << "flov hops(" << c+1 << ",:)" << *_flov_hop_stats[c] << ";" << endl;
            /* ==== Power Gate - End ==== */
+        _WriteLatencyQuantiles(os, c);
         if(_pair_stats){
-            os<< "pair_sent(" << c+1 << ",:) = [ ";
-            for(int i = 0; i < _nodes; ++i) {
-                for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_plat[c][i*_nodes+j]->NumSamples() << " ";
-                }
-            }
-            os << "];" << endl
-               << "pair_plat(" << c+1 << ",:) = [ ";
-            for(int i = 0; i < _nodes; ++i) {
-                for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_plat[c][i*_nodes+j]->Average( ) << " ";
-                }
-            }
-            os << "];" << endl
-               << "pair_nlat(" << c+1 << ",:) = [ ";
-            for(int i = 0; i < _nodes; ++i) {
-                for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_nlat[c][i*_nodes+j]->Average( ) << " ";
-                }
-            }
-            os << "];" << endl
-               << "pair_flat(" << c+1 << ",:) = [ ";
-            for(int i = 0; i < _nodes; ++i) {
-                for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_flat[c][i*_nodes+j]->Average( ) << " ";
-                }
-            }
+            _WritePairStats(os, c);
         }
 
         double time_delta = (double)(_drain_time - _reset_time);
@@ -1115,6 +1131,18 @@ void FLOVTrafficManager::WriteStats(ostream & os) const {
         os << "];" << endl;
 #endif
     }
+
+    /* ==== Power Gate - Begin ==== */
+    // latency quantiles of each destination node within the current
+    // monitor epoch
+    for (size_t i = 0; i < _latency_quantiles.size(); ++i) {
+        os << "per_node_plat_quantiles(" << i+1 << ",:) = [ ";
+        for (int n = 0; n < _nodes; ++n) {
+            os << _per_node_plat[n]->Quantile(_latency_quantiles[i]) << " ";
+        }
+        os << "];" << endl;
+    }
+    /* ==== Power Gate - End ==== */
 }
 
 void FLOVTrafficManager::DisplayOverallStats( ostream & os ) const {
@@ -1134,6 +1162,7 @@ void FLOVTrafficManager::DisplayOverallStats( ostream & os ) const {
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_plat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        _DisplayOverallLatencyQuantiles(os, _overall_plat_quantiles[c]);
 
         os << "Network latency average = " << _overall_avg_nlat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
@@ -1141,6 +1170,7 @@ void FLOVTrafficManager::DisplayOverallStats( ostream & os ) const {
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_nlat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        _DisplayOverallLatencyQuantiles(os, _overall_nlat_quantiles[c]);
 
         os << "Flit latency average = " << _overall_avg_flat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
@@ -1196,6 +1226,8 @@ void FLOVTrafficManager::DisplayOverallStats( ostream & os ) const {
         os << "FLOV hops average = " << _overall_flov_hop_stats[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
 
+        _DisplayOverallConfidence(os, c);
+
 #ifdef TRACK_STALLS
         os << "Buffer busy stall rate = " << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl
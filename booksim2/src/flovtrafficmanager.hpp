@@ -11,6 +11,7 @@
 #include <iostream>
 
 #include "config_utils.hpp"
+#include "flov_voter.hpp"
 #include "stats.hpp"
 #include "trafficmanager.hpp"
 
@@ -32,14 +33,31 @@ private:
   int _monitor_counter;
   int _monitor_epoch;
   vector<Stats *> _per_node_plat;
-  vector<int> _power_state_votes;
+  FLOVVoter * _flov_voter;
+  double _vote_quantile;
+  // votes propagated over the handshake channels are tallied by the
+  // routers _vote_settle cycles after they were cast
+  bool _vote_propagation;
+  int _vote_settle;
+  bool _votes_cast;
+  int _mesh_width;
   string _powergate_type;
   /* ==== Power Gate - End ==== */
 
   /* ==== Power Gate - Begin ==== */
   vector<vector<int> > _idle_cycles;
-  vector<int> _router_idle_periods;
   vector<vector<int> > _overall_idle_cycles;
+  // idle tracking: flits waiting at the source queues of each node, the
+  // last cycle a flit was ejected at each node, whether the node is idle
+  // and the cycle its current idle or busy period started (-1 before the
+  // first cycle), and the number of nodes that are not idle; cycles are
+  // counted across simulations
+  vector<int> _injection_backlog;
+  vector<int> _last_ejection;
+  vector<bool> _node_idle;
+  vector<int> _period_start;
+  int _busy_nodes;
+  int _idle_clock;
   vector<bool> _wakeup_handshake_latency;
   /* ==== Power Gate - End ==== */
   // ============ Internal methods ============
@@ -47,7 +65,6 @@ protected:
 
   virtual void _RetireFlit( Flit *f, int dest );
 
-  virtual void _Inject();
   virtual void _Step( );
 
   virtual void _GeneratePacket( int source, int size, int cl, int time );
@@ -56,6 +73,8 @@ protected:
 
   virtual void _UpdateOverallStats();
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
 
   FLOVTrafficManager( const Configuration &config, const vector<Network *> & net );
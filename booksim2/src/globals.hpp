@@ -33,21 +33,32 @@
 
 /*all declared in main.cpp*/
 
+/* the state of a simulation is thread local, so that simulations in
+ * different threads are independent, see sim_context.hpp
+ */
+
 int GetSimTime();
 
+class BookSimConfig;
+struct SimSummary;
+// prints to out instead of cout if given, see SimContext::SeparateOutput()
+bool Simulate( BookSimConfig const & config, std::ostream * results = 0,
+               SimSummary * summary = 0, std::ostream * out = 0 );
+
 class Stats;
 Stats * GetStats(const std::string & name);
 
-extern bool gPrintActivity;
+extern thread_local bool gPrintActivity;
 
-extern int gK;
-extern int gN;
-extern int gC;
+extern thread_local int gK;
+extern thread_local int gN;
+extern thread_local int gC;
 
-extern int gNodes;
+extern thread_local int gNodes;
 
-extern bool gTrace;
+extern thread_local bool gTrace;
 
-extern std::ostream * gWatchOut;
+// thread local so that parallel workers can buffer their watch output
+extern thread_local std::ostream * gWatchOut;
 
 #endif
@@ -9,8 +9,7 @@
 #include "handshake.hpp"
 #include "routers/router.hpp"
 
-stack<Handshake *> Handshake::_all;
-stack<Handshake *> Handshake::_free;
+thread_local ObjectPool<Handshake> * Handshake::_pool = 0;
 
 ostream& operator<<(ostream& os, const Handshake& h)
 {
@@ -22,6 +21,8 @@ ostream& operator<<(ostream& os, const Handshake& h)
   os << ", drain done signal: " << (h.drain_done ? "True" : "False");
   if (h.logical_neighbor != -1)
     os << ", logical neighbor router: " << h.logical_neighbor;
+  if (h.vote != 0)
+    os << ", votes: " << h.vote;
   os << endl;
   return os;
 }
@@ -40,33 +41,23 @@ void Handshake::Reset()
   id = -1;
   hid = -1;
   logical_neighbor = -1;
+  vote = 0;
 }
 
 Handshake * Handshake::New() {
-  Handshake * hs;
-  if(_free.empty()) {
-    hs = new Handshake();
-    _all.push(hs);
-  } else {
-    hs = _free.top();
-    hs->Reset();
-    _free.pop();
-  }
+  Handshake * hs = _pool->New();
+  hs->Reset();
   return hs;
 }
 
 void Handshake::Free() {
-  _free.push(this);
+  _pool->Free(this);
 }
 
 void Handshake::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
-  }
+  _pool->FreeAll();
 }
 
-
 int Handshake::OutStanding(){
-  return _all.size()-_free.size();
+  return _pool->OutStanding();
 }
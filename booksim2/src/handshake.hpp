@@ -10,7 +10,8 @@
 
 #include <iostream>
 #include <set>
-#include <stack>
+
+#include "object_pool.hpp"
 
 class Handshake {
 
@@ -23,6 +24,8 @@ public:
   int id;
   int hid;
   int logical_neighbor;
+  // sum of the latency votes relayed with this handshake, see FLOVRouter
+  int vote;
 
   void Reset();
 
@@ -32,12 +35,14 @@ public:
   static int OutStanding();
 private:
 
-  static stack<Handshake *> _all;
-  static stack<Handshake *> _free;
-
   Handshake();
   ~Handshake() {}
 
+  friend class ObjectPool<Handshake>;
+  // the pool of the simulation of the calling thread, see SimContext
+  friend class SimContext;
+  static thread_local ObjectPool<Handshake> * _pool;
+
 };
 
 ostream& operator<<(ostream& os, const Handshake& h);
@@ -29,8 +29,11 @@
 #include <vector>
 #include <cassert>
 #include <limits>
+#include <cmath>
 #include "random_utils.hpp"
 #include "injection.hpp"
+#include "module.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
@@ -39,12 +42,12 @@ InjectionProcess::InjectionProcess(int nodes, double rate)
 {
   if(nodes <= 0) {
     cout << "Error: Number of nodes must be greater than zero." << endl;
-    exit(-1);
+    throw SimError("Invalid injection process");
   }
   if((rate < 0.0) || (rate > 1.0)) {
     cout << "Error: Injection process must have load between 0.0 and 1.0."
 	 << endl;
-    exit(-1);
+    throw SimError("Invalid injection process");
   }
 }
 
@@ -53,6 +56,36 @@ void InjectionProcess::reset()
 
 }
 
+// number of failed trials before the first success, capped at max()
+static int geometric(double p)
+{
+  if(p <= 0.0) {
+    return numeric_limits<int>::max();
+  }
+  if(p >= 1.0) {
+    return 0;
+  }
+  double const k = floor(log(1.0 - RandomFloat()) / log1p(-p));
+  return (k < numeric_limits<int>::max()) ? (int)k : numeric_limits<int>::max();
+}
+
+static int advance(int time, int cycles)
+{
+  return (cycles < numeric_limits<int>::max() - time) ? 
+    (time + cycles) : numeric_limits<int>::max();
+}
+
+int InjectionProcess::next(int source, int time)
+{
+  if(_rate <= 0.0) {
+    return numeric_limits<int>::max();
+  }
+  while(!test(source)) {
+    ++time;
+  }
+  return time;
+}
+
 InjectionProcess * InjectionProcess::New(string const & inject, int nodes, 
 					 double load, 
 					 Configuration const * const config)
@@ -106,14 +139,14 @@ InjectionProcess * InjectionProcess::New(string const & inject, int nodes,
     }
     if(missing_params) {
       cout << "Missing parameters for injection process: " << inject << endl;
-      exit(-1);
+      throw SimError("Invalid injection process");
     }
     if((alpha < 0.0 && beta < 0.0) || 
        (alpha < 0.0 && r1 < 0.0) || 
        (beta < 0.0 && r1 < 0.0) || 
        (alpha >= 0.0 && beta >= 0.0 && r1 >= 0.0)) {
       cout << "Invalid parameters for injection process: " << inject << endl;
-      exit(-1);
+      throw SimError("Invalid injection process");
     }
     vector<int> initial(nodes);
     if(params.size() > 3) {
@@ -127,7 +160,7 @@ InjectionProcess * InjectionProcess::New(string const & inject, int nodes,
     result = new OnOffInjectionProcess(nodes, load, alpha, beta, r1, initial);
   } else {
     cout << "Invalid injection process: " << inject << endl;
-    exit(-1);
+    throw SimError("Invalid injection process");
   }
   return result;
 }
@@ -146,6 +179,12 @@ bool BernoulliInjectionProcess::test(int source)
   return (RandomFloat() < _rate);
 }
 
+int BernoulliInjectionProcess::next(int source, int time)
+{
+  assert((source >= 0) && (source < _nodes));
+  return advance(time, geometric(_rate));
+}
+
 //=============================================================
 
 OnOffInjectionProcess::OnOffInjectionProcess(int nodes, double rate, 
@@ -188,3 +227,39 @@ bool OnOffInjectionProcess::test(int source)
   // generate packet
   return _state[source] && (RandomFloat() < _r1);
 }
+
+// Draws the sojourn times of the on and off periods instead of advancing the
+// state once per cycle. _state holds the state of the cycle before time.
+int OnOffInjectionProcess::next(int source, int time)
+{
+  assert((source >= 0) && (source < _nodes));
+
+  bool on = _state[source];
+  while(time < numeric_limits<int>::max()) {
+    int on_cycles;
+    if(on) {
+      on_cycles = geometric(_beta);
+    } else {
+      time = advance(time, geometric(_alpha));
+      if(time == numeric_limits<int>::max()) {
+	break;
+      }
+      on_cycles = advance(1, geometric(_beta));
+    }
+    int const wait = geometric(_r1);
+    if(wait < on_cycles) {
+      _state[source] = 1;
+      return advance(time, wait);
+    }
+    // the source turns off in cycle time + on_cycles
+    time = advance(advance(time, on_cycles), 1);
+    on = false;
+  }
+  _state[source] = 0;
+  return numeric_limits<int>::max();
+}
+
+void OnOffInjectionProcess::Serialize(Checkpoint & cp)
+{
+  cp.Sync(_state);
+}
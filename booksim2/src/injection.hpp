@@ -32,6 +32,8 @@
 
 using namespace std;
 
+class Checkpoint;
+
 class InjectionProcess {
 protected:
   int _nodes;
@@ -40,7 +42,12 @@ protected:
 public:
   virtual ~InjectionProcess() {}
   virtual bool test(int source) = 0;
+  // first cycle at or after time in which source injects, given that the
+  // previous cycles have been sampled; numeric_limits<int>::max() if never
+  virtual int next(int source, int time);
   virtual void reset();
+  // save or restore the state of the sources
+  virtual void Serialize(Checkpoint & cp) {}
   static InjectionProcess * New(string const & inject, int nodes, double load, 
 				Configuration const * const config = NULL);
 };
@@ -49,6 +56,7 @@ class BernoulliInjectionProcess : public InjectionProcess {
 public:
   BernoulliInjectionProcess(int nodes, double rate);
   virtual bool test(int source);
+  virtual int next(int source, int time);
 };
 
 class OnOffInjectionProcess : public InjectionProcess {
@@ -63,6 +71,8 @@ public:
 			double r1, vector<int> initial);
   virtual void reset();
   virtual bool test(int source);
+  virtual int next(int source, int time);
+  virtual void Serialize(Checkpoint & cp);
 };
 
 #endif 
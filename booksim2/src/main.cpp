@@ -52,6 +52,9 @@
 #include "random_utils.hpp"
 #include "network.hpp"
 #include "injection.hpp"
+#include "sweep.hpp"
+#include "saturation.hpp"
+#include "sim_context.hpp"
 #include "power_module.hpp"
 #include "dsent_power_module.hpp"
 
@@ -62,9 +65,13 @@
 //////////////////////
 
  /* the current traffic manager instance */
-TrafficManager * trafficManager = NULL;
+thread_local TrafficManager * trafficManager = NULL;
 
 int GetSimTime() {
+  // errors may be reported while the traffic manager is being constructed
+  if(!trafficManager) {
+    return 0;
+  }
   return trafficManager->getTime();
 }
 
@@ -78,25 +85,28 @@ Stats * GetStats(const std::string & name) {
 }
 
 /* printing activity factor*/
-bool gPrintActivity;
+thread_local bool gPrintActivity;
 
-int gK;//radix
-int gN;//dimension
-int gC;//concentration
+thread_local int gK;//radix
+thread_local int gN;//dimension
+thread_local int gC;//concentration
 
-int gNodes;
+thread_local int gNodes;
 
 //generate nocviewer trace
-bool gTrace;
+thread_local bool gTrace;
 
-ostream * gWatchOut;
+thread_local ostream * gWatchOut;
 
 
 
 /////////////////////////////////////////////////////////////////////////////
 
-bool Simulate( BookSimConfig const & config )
+bool Simulate( BookSimConfig const & config, ostream * results,
+               SimSummary * summary, ostream * out )
 {
+  SimContext context( config, out );
+
   vector<Network *> net;
 
   int subnets = config.GetInt("subnets");
@@ -134,6 +144,13 @@ bool Simulate( BookSimConfig const & config )
 
   cout<<"Total run time "<<total_time<<endl;
 
+  if(result && results) {
+    trafficManager->DisplayOverallStatsCSV(*results);
+  }
+  if(result && summary) {
+    trafficManager->Summarize(summary);
+  }
+
   for (int i=0; i<subnets; ++i) {
 
     ///Power analysis
@@ -153,7 +170,6 @@ bool Simulate( BookSimConfig const & config )
   }
 
   delete trafficManager;
-  trafficManager = NULL;
 
   return result;
 }
@@ -166,30 +182,39 @@ int main( int argc, char **argv )
 
 
   if ( !ParseArgs( &config, argc, argv ) ) {
-    cerr << "Usage: " << argv[0] << " configfile... [param=value...]" << endl;
+    cerr << "Usage: " << argv[0] << " [--sweep] configfile... [param=value...]" << endl;
     return 0;
  }
 
-
-  /*initialize routing, traffic, injection functions
-   */
-  InitializeRoutingMap( config );
-
-  gPrintActivity = (config.GetInt("print_activity") > 0);
-  gTrace = (config.GetInt("viewer_trace") > 0);
-
-  string watch_out_file = config.GetStr( "watch_out" );
-  if(watch_out_file == "") {
-    gWatchOut = NULL;
-  } else if(watch_out_file == "-") {
-    gWatchOut = &cout;
-  } else {
-    gWatchOut = new ofstream(watch_out_file.c_str());
+  bool sweep = false;
+  for ( int i = 1; i < argc; ++i ) {
+    if ( string( argv[i] ) == "--sweep" ) {
+      sweep = true;
+    }
+  }
+  if ( !sweep && !config.GetStr( "sweep_params" ).empty() ) {
+    config.ParseError( "sweep_params requires --sweep" );
+  }
+  bool const saturation = ( config.GetStr( "sim_type" ) == "saturation" ) ||
+                          ( config.GetInt( "saturation_search" ) > 0 );
+  if ( sweep && saturation ) {
+    config.ParseError( "A saturation search cannot be swept" );
   }
 
 
   /*configure and run the simulator
    */
-  bool result = Simulate( config );
-  return result ? -1 : 0;
+  // the error has been printed by Module::Error()
+  try {
+    if ( sweep ) {
+      return RunSweep( config ) ? 0 : -1;
+    }
+    if ( saturation ) {
+      return RunSaturation( config ) ? 0 : -1;
+    }
+    bool result = Simulate( config );
+    return result ? -1 : 0;
+  } catch ( SimError const & ) {
+    return -1;
+  }
 }
@@ -75,7 +75,7 @@ void Module::DisplayHierarchy( int level, ostream & os ) const
 void Module::Error( const string& msg ) const
 {
   cout << GetSimTime() << " | Error in " << _fullname << " : " << msg << endl;
-  exit( -1 );
+  throw SimError( _fullname + " : " + msg );
 }
 
 void Module::Debug( const string& msg ) const
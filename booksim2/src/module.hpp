@@ -33,6 +33,14 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <stdexcept>
+
+// ends the simulation that raised it, but not the other simulations of the
+// process; the message has already been printed
+class SimError : public runtime_error {
+public:
+  explicit SimError( const string& msg ) : runtime_error( msg ) { }
+};
 
 class Module {
 private:
@@ -53,6 +61,7 @@ public:
 
   void DisplayHierarchy( int level = 0, ostream & os = cout ) const;
 
+  // prints msg and throws a SimError
   void Error( const string& msg ) const;
   void Debug( const string& msg ) const;
 
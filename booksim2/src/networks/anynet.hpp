@@ -35,6 +35,9 @@
 #include <map>
 #include <list>
 
+// used by the routing functions
+extern thread_local map<int, int>* global_routing_table;
+
 class AnyNet : public Network {
 
   string file_name;
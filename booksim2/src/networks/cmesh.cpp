@@ -47,11 +47,11 @@
 #include "misc_utils.hpp"
 #include "cmesh.hpp"
 
-int CMesh::_cX = 0 ;
-int CMesh::_cY = 0 ;
-int CMesh::_memo_NodeShiftX = 0 ;
-int CMesh::_memo_NodeShiftY = 0 ;
-int CMesh::_memo_PortShiftY = 0 ;
+thread_local int CMesh::_cX = 0 ;
+thread_local int CMesh::_cY = 0 ;
+thread_local int CMesh::_memo_NodeShiftX = 0 ;
+thread_local int CMesh::_memo_NodeShiftY = 0 ;
+thread_local int CMesh::_memo_PortShiftY = 0 ;
 
 CMesh::CMesh( const Configuration& config, const string & name ) 
   : Network(config, name) 
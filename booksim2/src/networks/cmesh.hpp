@@ -57,12 +57,15 @@ public:
 
 private:
 
-  static int _cX ;
-  static int _cY ;
+  // copied to the worker threads of the parallel engine by SimContext
+  friend class SimContext;
 
-  static int _memo_NodeShiftX ;
-  static int _memo_NodeShiftY ;
-  static int _memo_PortShiftY ;
+  static thread_local int _cX ;
+  static thread_local int _cY ;
+
+  static thread_local int _memo_NodeShiftX ;
+  static thread_local int _memo_NodeShiftY ;
+  static thread_local int _memo_PortShiftY ;
 
   void _ComputeSize( const Configuration &config );
   void _BuildNet( const Configuration& config );
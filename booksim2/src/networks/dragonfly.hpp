@@ -31,6 +31,9 @@
 #include "network.hpp"
 #include "routefunc.hpp"
 
+// used by the routing functions
+extern thread_local int gP, gA, gG;
+
 class DragonFlyNew : public Network {
 
   int _m;
@@ -33,6 +33,11 @@
 #include "routefunc.hpp"
 #include <cassert>
 
+// used by the routing functions
+extern thread_local int _xcount;
+extern thread_local int _ycount;
+extern thread_local int _xrouter;
+extern thread_local int _yrouter;
 
 class FlatFlyOnChip : public Network {
 
@@ -87,6 +87,15 @@ void KNCube::_BuildNet( const Configuration &config )
   bool use_noc_latency;
   use_noc_latency = (config.GetInt("use_noc_latency")==1);
 
+  /* ==== Power Gate - Begin ==== */
+  // routing tables of all routers for Router Parking, kept for the
+  // reconfigurations at runtime
+  if (config.GetStr("router") == "rp") {
+    _route_tbl = new RouteTbl(_size, _router_states, _fabric_manager,
+        config.GetInt("route_table_threads"));
+  }
+  /* ==== Power Gate - End ==== */
+
   for ( int node = 0; node < _size; ++node ) {
 
     router_name << "router" << node;
@@ -107,15 +116,12 @@ void KNCube::_BuildNet( const Configuration &config )
     bool is_nord = (type == "nord");
     if (_router_states[node] == false) {
       _routers[node]->SetRouterState(false);
-      if (is_rp) { // TODO: make all dynamic
+      if (is_rp) {
         _routers[node]->SetPowerState(Router::power_off);
       }
     } else if (is_rp) {
-      RouteTbl rt = RouteTbl(node, _size, _router_states);
-      rt.BuildRoute();
-      rt.BuildEscRoute(_fabric_manager);
-      _routers[node]->SetRouteTable(rt.GetRouteTbl());
-      _routers[node]->SetEscRouteTable(rt.GetEscRouteTbl());
+      _routers[node]->SetRouteTable(_route_tbl->GetRouteTbl(node));
+      _routers[node]->SetEscRouteTable(_route_tbl->GetEscRouteTbl(node));
     }
     /* ==== Power Gate - End ==== */
 
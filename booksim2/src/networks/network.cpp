@@ -35,10 +35,14 @@
 #include <cassert>
 #include <sstream>
 #include <algorithm>
+#include <set>
 
 #include "booksim.hpp"
 #include "network.hpp"
 #include "random_utils.hpp"
+#include "routefunc.hpp"
+#include "routetbl.hpp"
+#include "sim_context.hpp"
 
 #include "kncube.hpp"
 #include "fly.hpp"
@@ -146,11 +150,44 @@ Network::Network( const Configuration &config, const string & name ) :
   _off_routers = config.GetIntArray("off_routers");
   _powergate_seed = config.GetInt("powergate_seed");
   _powergate_percentile = config.GetInt("powergate_percentile");
+  _route_tbl = NULL;
   /* ==== Power Gate - End ==== */
+  _active_set_scheduling = (config.GetInt("active_set_scheduling") > 0);
+  _threads = config.GetInt("sim_threads");
+  if ( _threads < 1 ) {
+    _threads = 1;
+  }
+  if ( _threads > 1 ) {
+    // random draws of the routers would be made in the nondeterministic
+    // order of the worker threads
+    string const rf = config.GetStr("routing_function") + "_" +
+      config.GetStr("topology");
+    ostringstream err;
+    if ( RandomizedRoutingFunction( rf ) ) {
+      err << "Routing function " << rf << " draws random numbers";
+    } else if ( config.GetStr("router") == "chaos" ) {
+      err << "Chaos routers draw random numbers";
+    } else if ( ( config.GetStr("vc_allocator") == "pim" ) ||
+		( config.GetStr("sw_allocator") == "pim" ) ) {
+      err << "The pim allocator draws random numbers";
+    }
+    if ( !err.str( ).empty( ) ) {
+      err << ", sim_threads must be 1";
+      Error( err.str( ) );
+    }
+  }
+  _pool = NULL;
+  _phase = NULL;
+  _phase_watch = false;
+  _phase_context = NULL;
 }
 
 Network::~Network( )
 {
+  if ( _pool ) delete _pool;
+  for ( size_t t = 0; t < _watch_bufs.size( ); ++t ) {
+    delete _watch_bufs[t];
+  }
   for ( int r = 0; r < _size; ++r ) {
     if ( _routers[r] ) delete _routers[r];
   }
@@ -169,6 +206,9 @@ Network::~Network( )
     if ( _chan_handshake[c] ) delete _chan_handshake[c];
     /* ==== Power Gate - End ==== */
   }
+  /* ==== Power Gate - Begin ==== */
+  if ( _route_tbl ) delete _route_tbl;
+  /* ==== Power Gate - End ==== */
 }
 
 Network * Network::New(const Configuration & config, const string & name)
@@ -228,7 +268,8 @@ void Network::_Alloc( )
   gNodes = _nodes;
 
   /* ==== Power Gate - Begin ==== */
-  _core_states.resize(_size, true);
+  // indexed by node, and by router for the meshes
+  _core_states.resize(max(_size, _nodes), true);
   _router_states.resize(_size, true);
   if (_powergate_auto_config) {
     _off_cores.clear();
@@ -511,11 +552,11 @@ void Network::_Alloc( )
     name << Name() << "_fchan_ingress" << s;
     _inject[s] = new FlitChannel(this, name.str(), _classes);
     _inject[s]->SetSource(NULL, s);
-    _timed_modules.push_back(_inject[s]);
+    _wheel.Attach(_inject[s]);
     name.str("");
     name << Name() << "_cchan_ingress" << s;
     _inject_cred[s] = new CreditChannel(this, name.str());
-    _timed_modules.push_back(_inject_cred[s]);
+    _wheel.Attach(_inject_cred[s]);
   }
   _eject.resize(_nodes);
   _eject_cred.resize(_nodes);
@@ -524,11 +565,11 @@ void Network::_Alloc( )
     name << Name() << "_fchan_egress" << d;
     _eject[d] = new FlitChannel(this, name.str(), _classes);
     _eject[d]->SetSink(NULL, d);
-    _timed_modules.push_back(_eject[d]);
+    _wheel.Attach(_eject[d]);
     name.str("");
     name << Name() << "_cchan_egress" << d;
     _eject_cred[d] = new CreditChannel(this, name.str());
-    _timed_modules.push_back(_eject_cred[d]);
+    _wheel.Attach(_eject_cred[d]);
   }
   _chan.resize(_channels);
   _chan_cred.resize(_channels);
@@ -539,58 +580,422 @@ void Network::_Alloc( )
     ostringstream name;
     name << Name() << "_fchan_" << c;
     _chan[c] = new FlitChannel(this, name.str(), _classes);
-    _timed_modules.push_back(_chan[c]);
+    _wheel.Attach(_chan[c]);
     name.str("");
     name << Name() << "_cchan_" << c;
     _chan_cred[c] = new CreditChannel(this, name.str());
-    _timed_modules.push_back(_chan_cred[c]);
+    _wheel.Attach(_chan_cred[c]);
     /* ==== Power Gate - Begin ==== */
     name.str("");
     name << Name() << "_hchan_" << c;
     _chan_handshake[c] = new HandshakeChannel(this, name.str());
-    _timed_modules.push_back(_chan_handshake[c]);
+    _wheel.Attach(_chan_handshake[c]);
     /* ==== Power Gate - End ==== */
   }
 }
 
 void Network::ReadInputs( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->ReadInputs( );
+  _wheel.PrintDepartures( );
+  /* ==== Power Gate - Begin ==== */
+  if ( GetSimTime( ) < _power_timers.Time( ) ) {
+    // the clock restarted with a new simulation
+    for ( size_t m = 0; m < _modules.size( ); ++m ) {
+      _modules[m]->RestartPowerState( GetSimTime( ) - 1 );
+    }
   }
+  _power_timers.Advance( GetSimTime( ), _active_modules );
+  /* ==== Power Gate - End ==== */
+  _RunPhase( &TimedModule::ReadInputs );
 }
 
 /* ==== Power Gate - Begin ==== */
 void Network::PowerStateEvaluate( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->PowerStateEvaluate( );
-  }
+  _RunPhase( &TimedModule::EvaluatePowerState );
 }
 /* ==== Power Gate - End ==== */
 
 void Network::Evaluate( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->Evaluate( );
-  }
+  _RunPhase( &TimedModule::Evaluate );
 }
 
 void Network::WriteOutputs( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->WriteOutputs( );
+  _wheel.Deliver( GetSimTime( ) );
+  _RunPhase( &TimedModule::WriteOutputs );
+  _wheel.ActivateSinks( );
+}
+
+/* Modules are only visited while they are in the active set. Routers are
+ * woken up by the channels that deliver data to them and by power-state
+ * changes. A module is retired after WriteOutputs once it reports that it
+ * is quiescent, i.e., that all of its phases are no-ops until it is woken
+ * up again, so skipping it does not change the simulation. The power-state
+ * timers that keep running meanwhile are caught up with lazily, and the
+ * module is woken up by the timer wheel when its next power-state event is
+ * due.
+ */
+void Network::_InitSchedule( )
+{
+  _modules.assign(_timed_modules.begin(), _timed_modules.end());
+  _active_modules.Resize(_modules.size( ));
+  _power_timers.Resize(_modules.size( ));
+  for ( size_t m = 0; m < _modules.size( ); ++m ) {
+    _modules[m]->SetActiveSet(&_active_modules, m);
+  }
+  _wheel.Start( );
+  if ( _threads > 1 ) {
+    _InitParallel( );
   }
 }
 
+/* Within a phase, routers only modify their own state and the channels
+ * they send on (neighbor power states are written in ReadInputs and
+ * PowerStateEvaluate, and only read in Evaluate), so evaluating contiguous
+ * partitions of the routers reproduces the serial engine exactly. Watch
+ * output of the worker threads is buffered and appended in partition order
+ * after each phase.
+ */
+void Network::_InitParallel( )
+{
+  if ( gTrace ) {
+    cout << "WARNING: viewer_trace requires the serial engine, "
+	 << "ignoring sim_threads." << endl;
+    _threads = 1;
+    return;
+  }
+
+  _threads = min(_threads, (int)_modules.size( ));
+  if ( _threads <= 1 ) {
+    _threads = 1;
+    return;
+  }
+  _watch_bufs.resize(_threads);
+  for ( int t = 0; t < _threads; ++t ) {
+    _watch_bufs[t] = new ostringstream;
+  }
+  _pool = new WorkerPool(_threads);
+}
+
+void Network::_RunPhase( void (TimedModule::*phase)( ) )
+{
+  if ( _modules.empty( ) ) {
+    _InitSchedule( );
+  }
+  _active_modules.Merge( );
+  _phase = phase;
+
+  if ( !_pool ) {
+    _EvaluateModules( phase, 0, _modules.size( ) );
+    return;
+  }
+
+  _phase_watch = ( gWatchOut != NULL );
+  _phase_context = SimContext::Current( );
+  _phase_context->Capture( );
+  gParallelPhase = true;
+  _pool->Run( &Network::_PhaseTask, this );
+  gParallelPhase = false;
+
+  if ( _phase_watch ) {
+    for ( int t = 1; t < _threads; ++t ) {
+      *gWatchOut << _watch_bufs[t]->str( );
+      _watch_bufs[t]->str( "" );
+    }
+  }
+
+  // the draws of this phase have already been made out of order
+  if ( _phase_context->ParallelRandomDraws( ) > 0 ) {
+    ostringstream err;
+    err << "Random numbers were drawn while evaluating " << Name()
+	<< " in parallel, sim_threads must be 1";
+    Error( err.str( ) );
+  }
+}
+
+void Network::_EvaluateModules( void (TimedModule::*phase)( ), int begin, int end )
+{
+  bool const retire = _active_set_scheduling &&
+    ( phase == &TimedModule::WriteOutputs );
+  /* ==== Power Gate - Begin ==== */
+  // modules catch up with the skipped cycles before their inputs can
+  // change the power-state timers
+  bool const synchronize = ( phase == &TimedModule::ReadInputs );
+  int const time = GetSimTime( );
+  /* ==== Power Gate - End ==== */
+  for ( int m = _active_modules.Next(begin, end); m < end;
+	m = _active_modules.Next(m + 1, end) ) {
+    TimedModule * const module = _modules[m];
+    /* ==== Power Gate - Begin ==== */
+    if ( synchronize ) {
+      module->SynchronizePowerState( time - 1 );
+    }
+    /* ==== Power Gate - End ==== */
+    (module->*phase)( );
+    if ( retire && module->Quiescent( ) ) {
+      _active_modules.Remove(m);
+      /* ==== Power Gate - Begin ==== */
+      int const next = module->NextPowerEventCycle( );
+      if ( next < numeric_limits<int>::max( ) - time - 1 ) {
+        _power_timers.Schedule( m, time + 1 + next );
+      }
+      /* ==== Power Gate - End ==== */
+    }
+  }
+}
+
+void Network::_PhaseTask( void * arg, int thread )
+{
+  Network * net = (Network *)arg;
+  int const size = net->_modules.size( );
+  int const begin = (size * thread) / net->_threads;
+  int const end = (size * (thread + 1)) / net->_threads;
+
+  if ( thread > 0 ) {
+    net->_phase_context->Install( );
+    gWatchOut = net->_phase_watch ? net->_watch_bufs[thread] : NULL;
+  }
+  net->_EvaluateModules( net->_phase, begin, end );
+}
+
+/* Number of cycles, starting with the current one, in which none of the
+ * channels delivers data and none of the modules has any work, capped at
+ * limit. Modules outside of the active set are quiescent and need not be
+ * checked. With power_events, the cycles in which PowerStateEvaluate
+ * changes a power state count as work as well.
+ */
+int Network::IdleCycles( int limit, bool power_events )
+{
+  if ( _modules.empty( ) ) {
+    _InitSchedule( );
+  }
+  _active_modules.Merge( );
+
+  int idle = _wheel.IdleCycles( GetSimTime( ), limit );
+  /* ==== Power Gate - Begin ==== */
+  if ( power_events && ( _power_timers.NextEvent( ) < numeric_limits<int>::max( ) ) ) {
+    idle = min(idle, max(0, _power_timers.NextEvent( ) - GetSimTime( )));
+  }
+  /* ==== Power Gate - End ==== */
+  int const end = _modules.size( );
+  for ( int m = _active_modules.Next(0, end); ( m < end ) && ( idle > 0 );
+	m = _active_modules.Next(m + 1, end) ) {
+    idle = min(idle, _modules[m]->IdleCycles( ));
+    if ( power_events ) {
+      idle = min(idle, _modules[m]->NextPowerEventCycle( ));
+    }
+  }
+  return idle;
+}
+
+/* ==== Power Gate - Begin ==== */
+// brings the lazily accounted power states of all modules up to the last
+// simulated cycle, e.g., before their power-off cycles are read
+void Network::SynchronizePowerStates( )
+{
+  for ( size_t m = 0; m < _modules.size( ); ++m ) {
+    _modules[m]->SynchronizePowerState( GetSimTime( ) - 1 );
+  }
+}
+
+/* The power states are accounted for up to the last cycle before they are
+ * saved. After restoring, all modules are in the active set, which does not
+ * change the simulation, and they retire again once they are quiescent.
+ * The routing tables of the fabric manager follow the restored router states.
+ */
+void Network::Serialize( Checkpoint & cp )
+{
+  int const time = GetSimTime( ) - 1;
+
+  cp.Check( _size, "number of routers" );
+  cp.Check( _nodes, "number of nodes" );
+  cp.Check( _channels, "number of channels" );
+
+  if ( !cp.Loading( ) ) {
+    SynchronizePowerStates( );
+  }
+
+  cp.Sync( _core_states );
+  cp.Sync( _router_states );
+
+  for ( int r = 0; r < _size; ++r ) {
+    _routers[r]->Serialize( cp );
+  }
+  for ( int n = 0; n < _nodes; ++n ) {
+    _inject[n]->Serialize( cp, time );
+    _inject_cred[n]->Serialize( cp, time );
+    _eject[n]->Serialize( cp, time );
+    _eject_cred[n]->Serialize( cp, time );
+  }
+  for ( int c = 0; c < _channels; ++c ) {
+    _chan[c]->Serialize( cp, time );
+    _chan_cred[c]->Serialize( cp, time );
+  }
+  cp.Check( (int)_chan_handshake.size( ), "number of handshake channels" );
+  for ( size_t c = 0; c < _chan_handshake.size( ); ++c ) {
+    _chan_handshake[c]->Serialize( cp, time );
+  }
+
+  if ( cp.Loading( ) ) {
+    if ( _route_tbl ) {
+      for ( int r = 0; r < _size; ++r ) {
+        if ( _route_tbl->GetRouterState( r ) != _router_states[r] ) {
+          _route_tbl->SetRouterState( r, _router_states[r] );
+        }
+      }
+    }
+    _wheel.Restore( time );
+    if ( _modules.empty( ) ) {
+      _InitSchedule( );
+    }
+    for ( size_t m = 0; m < _modules.size( ); ++m ) {
+      _modules[m]->RestartPowerState( time );
+      _modules[m]->Activate( );
+    }
+  }
+}
+
+// Router Parking at runtime: the routers of the power-on cores are unparked,
+// the routers of the power-off cores are parked as far as the power-gating
+// type allows, and the power-on routers are kept connected to the fabric
+// manager. Unlike the initial configuration, no random numbers are drawn, so
+// the traffic is not perturbed. Returns the routers that changed their state.
+vector<int> Network::ReconfigureRouters( )
+{
+  assert(_fabric_manager >= 0 && _fabric_manager < _size);
+  vector<bool> const old_states = _router_states;
+
+  for (int r = 0; r < _size; ++r) {
+    if (_core_states[r] == true) _router_states[r] = true;
+  }
+
+  if (_powergate_type == "rpa" || _powergate_type == "rpc") {
+    for (int r = 0; r < _size; ++r) {
+      if (_core_states[r] == true || _router_states[r] == false ||
+          r == _fabric_manager)
+        continue;
+      _router_states[r] = false;
+      if (_powergate_type == "rpa") {
+        // aggressive RP: park as long as the network stays connected
+        if (!_RoutersConnected()) _router_states[r] = true;
+      } else {
+        // conservative RP: park if no direct or diagonal neighbor is parked
+        int rx = r % gK;
+        int ry = r / gK;
+        for (int dy = -1; dy <= 1; ++dy) {
+          for (int dx = -1; dx <= 1; ++dx) {
+            if (rx + dx < 0 || rx + dx >= gK || ry + dy < 0 || ry + dy >= gK ||
+                (dx == 0 && dy == 0))
+              continue;
+            if (_router_states[r + dy * gK + dx] == false)
+              _router_states[r] = true;
+          }
+        }
+      }
+    }
+  }
+  _ConnectRouters();
+
+  vector<int> changed;
+  for (int r = 0; r < _size; ++r) {
+    if (_router_states[r] != old_states[r]) changed.push_back(r);
+  }
+  return changed;
+}
+
+void Network::_MeshNeighbors( int r, vector<int> & neighbors ) const
+{
+  neighbors.clear();
+  if (r / gK > 0) neighbors.push_back(r - gK);
+  if (r % gK > 0) neighbors.push_back(r - 1);
+  if (r % gK < gK - 1) neighbors.push_back(r + 1);
+  if (r / gK < gK - 1) neighbors.push_back(r + gK);
+}
+
+// whether all power-on routers are reachable from the fabric manager
+bool Network::_RoutersConnected( ) const
+{
+  vector<bool> visited(_size, false);
+  vector<int> neighbors;
+  deque<int> bfs_q;
+  bfs_q.push_back(_fabric_manager);
+  visited[_fabric_manager] = true;
+  int reached = 0;
+  while (!bfs_q.empty()) {
+    int n = bfs_q.front();
+    bfs_q.pop_front();
+    ++reached;
+    _MeshNeighbors(n, neighbors);
+    for (size_t i = 0; i < neighbors.size(); ++i) {
+      int nid = neighbors[i];
+      if (_router_states[nid] == true && visited[nid] == false) {
+        visited[nid] = true;
+        bfs_q.push_back(nid);
+      }
+    }
+  }
+  return reached == count(_router_states.begin(), _router_states.end(), true);
+}
+
+// unparks the routers on the shortest paths from the partitions that got
+// disconnected to the partition of the fabric manager
+void Network::_ConnectRouters( )
+{
+  vector<int> neighbors;
+  while (true) {
+    vector<bool> connected(_size, false);
+    deque<int> bfs_q;
+    bfs_q.push_back(_fabric_manager);
+    connected[_fabric_manager] = true;
+    while (!bfs_q.empty()) {
+      int n = bfs_q.front();
+      bfs_q.pop_front();
+      _MeshNeighbors(n, neighbors);
+      for (size_t i = 0; i < neighbors.size(); ++i) {
+        int nid = neighbors[i];
+        if (_router_states[nid] == true && connected[nid] == false) {
+          connected[nid] = true;
+          bfs_q.push_back(nid);
+        }
+      }
+    }
+
+    int start = -1;
+    for (int r = 0; r < _size && start < 0; ++r) {
+      if (_router_states[r] == true && connected[r] == false) start = r;
+    }
+    if (start < 0) break;
+
+    // search through the parked routers as well
+    vector<int> pred(_size, -1);
+    pred[start] = start;
+    bfs_q.push_back(start);
+    int r = -1;
+    while (!bfs_q.empty() && r < 0) {
+      int n = bfs_q.front();
+      bfs_q.pop_front();
+      _MeshNeighbors(n, neighbors);
+      for (size_t i = 0; i < neighbors.size(); ++i) {
+        int nid = neighbors[i];
+        if (pred[nid] >= 0) continue;
+        pred[nid] = n;
+        if (connected[nid] == true) {
+          r = nid;
+          break;
+        }
+        bfs_q.push_back(nid);
+      }
+    }
+    assert(r >= 0);
+    for (r = pred[r]; r != start; r = pred[r]) {
+      _router_states[r] = true;
+    }
+  }
+}
+/* ==== Power Gate - End ==== */
+
 void Network::WriteFlit( Flit *f, int source )
 {
   assert( ( source >= 0 ) && ( source < _nodes ) );
@@ -30,6 +30,7 @@
 
 #include <vector>
 #include <deque>
+#include <sstream>
 
 #include "module.hpp"
 #include "flit.hpp"
@@ -42,8 +43,17 @@
 #include "timed_module.hpp"
 #include "flitchannel.hpp"
 #include "channel.hpp"
+#include "channel_wheel.hpp"
+#include "timer_wheel.hpp"
 #include "config_utils.hpp"
 #include "globals.hpp"
+#include "parallel_utils.hpp"
+
+class SimContext;
+
+/* ==== Power Gate - Begin ==== */
+class RouteTbl;
+/* ==== Power Gate - End ==== */
 
 /* ==== DSENT power model - Begin ==== */
 class netEnergyStats {
@@ -127,15 +137,49 @@ protected:
   vector<int> _off_cores;
   vector<int> _off_routers;
   vector<HandshakeChannel *> _chan_handshake;
+  RouteTbl * _route_tbl;  // RP: routing tables of all routers
   /* ==== Power Gate - End ==== */
 
   deque<TimedModule *> _timed_modules;
 
+  // delivers the data in flight on all channels
+  ChannelWheel _wheel;
+
+  // modules in evaluation order, only those in the active set are visited
+  vector<TimedModule *> _modules;
+  ActiveSet _active_modules;
+  bool _active_set_scheduling;
+  /* ==== Power Gate - Begin ==== */
+  // wakes up retired modules when their next power-state event is due
+  TimerWheel _power_timers;
+  /* ==== Power Gate - End ==== */
+
+  // parallel cycle engine: the routers are split into contiguous
+  // per-thread partitions
+  int _threads;
+  WorkerPool * _pool;
+  vector<ostringstream *> _watch_bufs;
+  void (TimedModule::*_phase)( );
+  bool _phase_watch;
+  SimContext * _phase_context;
+
   virtual void _ComputeSize( const Configuration &config ) = 0;
   virtual void _BuildNet( const Configuration &config ) = 0;
 
   void _Alloc( );
 
+  /* ==== Power Gate - Begin ==== */
+  void _MeshNeighbors( int r, vector<int> & neighbors ) const;
+  bool _RoutersConnected( ) const;
+  void _ConnectRouters( );
+  /* ==== Power Gate - End ==== */
+
+  void _InitSchedule( );
+  void _InitParallel( );
+  void _RunPhase( void (TimedModule::*phase)( ) );
+  void _EvaluateModules( void (TimedModule::*phase)( ), int begin, int end );
+  static void _PhaseTask( void * arg, int thread );
+
 public:
   Network( const Configuration &config, const string & name );
   virtual ~Network( );
@@ -162,6 +206,15 @@ public:
   virtual void Evaluate( );
   virtual void WriteOutputs( );
 
+  int IdleCycles( int limit, bool power_events = false );
+  /* ==== Power Gate - Begin ==== */
+  void SynchronizePowerStates( );
+  /* ==== Power Gate - End ==== */
+
+  // save or restore the state of the routers and of the data in flight
+  // between two cycles
+  void Serialize( Checkpoint & cp );
+
   void Display( ostream & os = cout ) const;
   void DumpChannelMap( ostream & os = cout, string const & prefix = "" ) const;
   void DumpNodeMap( ostream & os = cout, string const & prefix = "" ) const;
@@ -189,6 +242,8 @@ public:
   /* ==== Power Gate - Begin ==== */
   vector<bool> & GetCoreStates(){return _core_states;}
   vector<bool> & GetRouterStates(){return _router_states;}
+  RouteTbl * GetRouteTbl(){return _route_tbl;}
+  vector<int> ReconfigureRouters( );
   /* ==== Power Gate - End ==== */
 };
 
@@ -18,6 +18,7 @@
 #include "random_utils.hpp"
 #include "vc.hpp"
 #include "packet_reply_info.hpp"
+#include "checkpoint.hpp"
 
 
 NoRDTrafficManager::NoRDTrafficManager( const Configuration &config,
@@ -115,6 +116,8 @@ NoRDTrafficManager::NoRDTrafficManager( const Configuration &config,
       }
     }
 
+    _bypass_flits = 0;
+
     _during_bypassing.resize(_nodes);
     for (int s = 0; s < _nodes; ++s) {
       _during_bypassing[s].resize(_classes, false);
@@ -148,6 +151,20 @@ NoRDTrafficManager::~NoRDTrafficManager( )
 
 }
 
+void NoRDTrafficManager::_Serialize( Checkpoint & cp )
+{
+    /* ==== Power Gate - Begin ==== */
+    for ( int n = 0; n < _nodes; ++n ) {
+        for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+            _buffers[n][subnet]->Serialize( cp );
+        }
+    }
+    cp.Sync( _bypass_flits );
+    cp.Sync( _during_bypassing );
+    cp.Sync( _wakeup_monitor_vc_requests );
+    /* ==== Power Gate - End ==== */
+}
+
 
 
 void NoRDTrafficManager::_GeneratePacket( int source, int stype,
@@ -304,48 +321,15 @@ void NoRDTrafficManager::_GeneratePacket( int source, int stype,
     }
 }
 
-void NoRDTrafficManager::_Inject()
-{
-    /* ==== Power Gate - Begin ==== */
-    vector<bool> & core_states = _net[0]->GetCoreStates();
-    /* ==== Power Gate - End ==== */
-
-    for ( int input = 0; input < _nodes; ++input ) {
-        /* ==== Power Gate - Begin ==== */
-        if (core_states[input] == false)
-            continue;
-        /* ==== Power Gate - End ==== */
-        for ( int c = 0; c < _classes; ++c ) {
-            // Potentially generate packets for any (input,class)
-            // that is currently empty
-            if ( _partial_packets[input][c].empty() ) {
-                bool generated = false;
-                while( !generated && ( _qtime[input][c] <= _time ) ) {
-                    int stype = _IssuePacket( input, c );
-
-                    if ( stype != 0 ) { //generate a packet
-                        _GeneratePacket( input, stype, c,
-                                         _include_queuing==1 ?
-                                         _qtime[input][c] : _time );
-                        generated = true;
-                    }
-                    // only advance time if this is not a reply packet
-                    if(!_use_read_write[c] || (stype >= 0)){
-                        ++_qtime[input][c];
-                    }
-                }
-
-                if ( ( _sim_state == draining ) &&
-                     ( _qtime[input][c] > _drain_time ) ) {
-                    _qdrained[input][c] = true;
-                }
-            }
-        }
-    }
-}
-
 void NoRDTrafficManager::_Step( )
 {
+  /* ==== Power Gate - Begin ==== */
+  // bypassed flits are forwarded by the traffic manager
+  if ( _fast_forward && ( _bypass_flits == 0 ) && !_SkipIdleCycles( true ) ) {
+    return;
+  }
+  /* ==== Power Gate - End ==== */
+
   bool flits_in_flight = false;
   for(int c = 0; c < _classes; ++c) {
     flits_in_flight |= !_total_in_flight_flits[c].empty();
@@ -427,7 +411,7 @@ void NoRDTrafficManager::_Step( )
       Credit * const c = _net[subnet]->ReadCredit( n );
       if ( c ) {
 #ifdef TRACK_FLOWS
-        for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+        for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
           int const vc = *iter;
           assert(!_outstanding_classes[n][subnet][vc].empty());
           int cl = _outstanding_classes[n][subnet][vc].front();
@@ -439,7 +423,7 @@ void NoRDTrafficManager::_Step( )
         if (_routers_to_watch_power_gating.count(n) > 0) {
           *gWatchOut << GetSimTime() << " | node " << n << " | "
             << "receives credit for bypass VCs";
-          for (set<int>::iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+          for (VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
             *gWatchOut << " " << *iter;
           }
           *gWatchOut << endl;
@@ -513,7 +497,7 @@ void NoRDTrafficManager::_Step( )
 
             OutputSet route_set;
             _rf(nullptr, cf, -1, &route_set, true);
-            set<OutputSet::sSetElement> const & os = route_set.GetSet();
+            OutputSet::ElementSet const & os = route_set.GetSet();
             assert(os.size() == 1);
             OutputSet::sSetElement const & se = *os.begin();
             assert(se.output_port == -1);
@@ -645,8 +629,8 @@ void NoRDTrafficManager::_Step( )
 
             OutputSet route_set;
             _rf(routers[n], cf, -1, &route_set, true);
-            set<OutputSet::sSetElement> const & os = route_set.GetSet();
-            for (set<OutputSet::sSetElement>::const_iterator iset = os.begin();
+            OutputSet::ElementSet const & os = route_set.GetSet();
+            for (OutputSet::ElementSet::const_iterator iset = os.begin();
                 iset != os.end(); ++iset)
             {
               OutputSet::sSetElement const & se = *(iset);
@@ -775,6 +759,7 @@ void NoRDTrafficManager::_Step( )
           assert(_partial_packets[n][c].empty() ||
               _partial_packets[n][c].front()->head);
           _buffers[n][subnet]->RemoveFlit(bypass_vc);
+          --_bypass_flits;
         } else {
           pp.pop_front();
         }
@@ -925,6 +910,7 @@ void NoRDTrafficManager::_Step( )
           f->vc = -1;
           assert(_buffers[n][subnet]->Empty(vc));
           _buffers[n][subnet]->AddFlit(vc, f);
+          ++_bypass_flits;
           if (f->head) {
             // XXX: a packet can be reroute back to this node
             assert(_buffers[n][subnet]->GetState(vc) == VC::idle);
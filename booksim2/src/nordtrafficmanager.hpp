@@ -23,6 +23,8 @@ private:
   vector<int> _packet_size_max_val;
 
   vector<vector<bool> > _during_bypassing;
+  // flits in the bypass buffers of all nodes
+  int _bypass_flits;
 
   int _routing_deadlock_timeout_threshold;
   int _performance_centric_wakeup_threshold;
@@ -36,11 +38,12 @@ protected:
 
   vector<vector<Buffer *> > _buffers;
 
-  virtual void _Inject();
   virtual void _Step( );
 
   virtual void _GeneratePacket( int source, int size, int cl, int time );
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
 
   NoRDTrafficManager( const Configuration &config, const vector<Network *> & net );
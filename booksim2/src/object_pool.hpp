@@ -0,0 +1,222 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*object_pool.hpp
+ *
+ *Slab allocator for the flits, credits and handshakes. Objects are
+ *constructed in contiguous slabs and recycled through an intrusive free
+ *list, so they are never returned to the heap until FreeAll(). Every
+ *simulation has its own pools, see SimContext.
+ *
+ *Every thread keeps a small magazine of free objects, so the worker
+ *threads of the parallel engine only touch the shared free list (under
+ *the pool lock) to refill or flush half a magazine at a time. The number
+ *of outstanding objects is computed from the slab, free list and magazine
+ *counts; it is only exact while no other thread is allocating, which is the
+ *case between simulation phases.
+ */
+
+#ifndef _OBJECT_POOL_HPP_
+#define _OBJECT_POOL_HPP_
+
+#include <vector>
+#include <mutex>
+#include <new>
+#include <algorithm>
+#include <cassert>
+
+#include "parallel_utils.hpp"
+
+template<class T, int SLAB_SIZE = 256>
+class ObjectPool {
+
+  struct Slot {
+    T obj;
+    Slot * next;
+  };
+
+  struct Magazine {
+    ObjectPool * pool;
+    Slot * head;
+    int count;
+    unsigned generation;
+    Magazine( ) : pool( 0 ), head( 0 ), count( 0 ), generation( 0 ) {}
+    ~Magazine( ) {
+      if ( pool ) pool->_Detach( this );
+    }
+  };
+
+  static const int MAGAZINE_SIZE = 64;
+  static thread_local Magazine _magazine;
+
+  std::mutex _mutex;
+  std::vector<Slot *> _slabs;
+  Slot * _free;
+  int _free_count;
+  unsigned _generation;
+  std::vector<Magazine *> _magazines;
+
+  // magazines filled before the last FreeAll() are stale and dropped
+  void _Attach( Magazine & m ) {
+    ParallelLock lock( _mutex );
+    assert( !m.pool || ( m.pool == this ) );
+    if ( !m.pool ) {
+      m.pool = this;
+      _magazines.push_back( &m );
+    }
+    m.head = 0;
+    m.count = 0;
+    m.generation = _generation;
+  }
+
+  void _Detach( Magazine * m ) {
+    std::lock_guard<std::mutex> lock( _mutex );
+    if ( m->generation == _generation ) {
+      _Flush( *m, m->count );
+    }
+    _magazines.erase( std::find( _magazines.begin( ), _magazines.end( ), m ) );
+    m->pool = 0;
+  }
+
+  void _NewSlab( ) {
+    Slot * slab = static_cast<Slot *>( ::operator new( SLAB_SIZE * sizeof( Slot ) ) );
+    for ( int i = SLAB_SIZE - 1; i >= 0; --i ) {
+      new ( &slab[i].obj ) T( );
+      slab[i].next = _free;
+      _free = &slab[i];
+    }
+    _free_count += SLAB_SIZE;
+    _slabs.push_back( slab );
+  }
+
+  void _Refill( Magazine & m ) {
+    ParallelLock lock( _mutex );
+    if ( !_free ) {
+      _NewSlab( );
+    }
+    while ( _free && ( m.count < MAGAZINE_SIZE / 2 ) ) {
+      Slot * s = _free;
+      _free = s->next;
+      --_free_count;
+      s->next = m.head;
+      m.head = s;
+      ++m.count;
+    }
+  }
+
+  // caller holds the lock if needed
+  void _Flush( Magazine & m, int n ) {
+    for ( ; n > 0; --n ) {
+      Slot * s = m.head;
+      m.head = s->next;
+      --m.count;
+      s->next = _free;
+      _free = s;
+      ++_free_count;
+    }
+  }
+
+public:
+
+  ObjectPool( ) : _free( 0 ), _free_count( 0 ), _generation( 1 ) {}
+  ~ObjectPool( ) {
+    FreeAll( );
+    // the threads may go on to use the pool of another simulation
+    for ( size_t i = 0; i < _magazines.size( ); ++i ) {
+      _magazines[i]->pool = 0;
+      _magazines[i]->head = 0;
+      _magazines[i]->count = 0;
+      _magazines[i]->generation = 0;
+    }
+  }
+
+  inline T * New( ) {
+    Magazine & m = _magazine;
+    if ( m.generation != _generation ) {
+      _Attach( m );
+    }
+    if ( !m.head ) {
+      _Refill( m );
+    }
+    Slot * s = m.head;
+    m.head = s->next;
+    --m.count;
+    return &s->obj;
+  }
+
+  inline void Free( T * obj ) {
+    Slot * s = reinterpret_cast<Slot *>( obj );
+    Magazine & m = _magazine;
+    if ( m.generation != _generation ) {
+      _Attach( m );
+    }
+    s->next = m.head;
+    m.head = s;
+    ++m.count;
+    if ( m.count > MAGAZINE_SIZE ) {
+      ParallelLock lock( _mutex );
+      _Flush( m, MAGAZINE_SIZE / 2 );
+    }
+  }
+
+  // number of objects constructed so far
+  int Allocated( ) const {
+    return _slabs.size( ) * SLAB_SIZE;
+  }
+
+  // number of objects handed out and not freed yet
+  int OutStanding( ) {
+    ParallelLock lock( _mutex );
+    int available = _free_count;
+    for ( size_t i = 0; i < _magazines.size( ); ++i ) {
+      if ( _magazines[i]->generation == _generation ) {
+        available += _magazines[i]->count;
+      }
+    }
+    return Allocated( ) - available;
+  }
+
+  // destroy all objects, including the ones still handed out
+  void FreeAll( ) {
+    std::lock_guard<std::mutex> lock( _mutex );
+    for ( size_t i = 0; i < _slabs.size( ); ++i ) {
+      for ( int j = 0; j < SLAB_SIZE; ++j ) {
+        _slabs[i][j].obj.~T( );
+      }
+      ::operator delete( _slabs[i] );
+    }
+    _slabs.clear( );
+    _free = 0;
+    _free_count = 0;
+    ++_generation;
+  }
+};
+
+template<class T, int SLAB_SIZE>
+thread_local typename ObjectPool<T, SLAB_SIZE>::Magazine ObjectPool<T, SLAB_SIZE>::_magazine;
+
+#endif
@@ -38,6 +38,58 @@
 #include "booksim.hpp"
 #include "outputset.hpp"
 
+void OutputSet::ElementSet::clear( )
+{
+  _size = 0;
+  _overflow.clear( );
+}
+
+void OutputSet::ElementSet::insert( sSetElement const & s )
+{
+  sSetElement * data = _Data( );
+  int pos = 0;
+  while ( ( pos < _size ) && ( data[pos] < s ) ) {
+    ++pos;
+  }
+  if ( ( pos < _size ) && !( s < data[pos] ) ) {
+    return; // an element with the same priority is already in the set
+  }
+
+  if ( _size == INLINE_SIZE ) {
+    _overflow.assign( _inline, _inline + INLINE_SIZE );
+  }
+  ++_size;
+  if ( _size > INLINE_SIZE ) {
+    _overflow.insert( _overflow.begin( ) + pos, s );
+  } else {
+    for ( int i = _size - 1; i > pos; --i ) {
+      _inline[i] = _inline[i - 1];
+    }
+    _inline[pos] = s;
+  }
+}
+
+OutputSet::ElementSet::const_iterator OutputSet::ElementSet::erase( const_iterator i )
+{
+  int const pos = i - _Data( );
+  assert( ( pos >= 0 ) && ( pos < _size ) );
+  if ( _size > INLINE_SIZE ) {
+    _overflow.erase( _overflow.begin( ) + pos );
+    if ( _size - 1 == INLINE_SIZE ) {
+      for ( int j = 0; j < INLINE_SIZE; ++j ) {
+        _inline[j] = _overflow[j];
+      }
+      _overflow.clear( );
+    }
+  } else {
+    for ( int j = pos; j < _size - 1; ++j ) {
+      _inline[j] = _inline[j + 1];
+    }
+  }
+  --_size;
+  return _Data( ) + pos;
+}
+
 void OutputSet::Clear( )
 {
   _outputs.clear( );
@@ -64,7 +116,7 @@ void OutputSet::AddRange( int output_port, int vc_start, int vc_end, int pri )
 int OutputSet::NumVCs( int output_port ) const
 {
   int total = 0;
-  set<sSetElement>::const_iterator i = _outputs.begin( );
+  ElementSet::const_iterator i = _outputs.begin( );
   while(i!=_outputs.end( )){
     if(i->output_port == output_port){
       total += (i->vc_end - i->vc_start + 1);
@@ -76,7 +128,7 @@ int OutputSet::NumVCs( int output_port ) const
 
 bool OutputSet::OutputEmpty( int output_port ) const
 {
-  set<sSetElement>::const_iterator i = _outputs.begin( );
+  ElementSet::const_iterator i = _outputs.begin( );
   while(i!=_outputs.end( )){
     if(i->output_port == output_port){
       return false;
@@ -87,7 +139,7 @@ bool OutputSet::OutputEmpty( int output_port ) const
 }
 
 
-const set<OutputSet::sSetElement> & OutputSet::GetSet() const{
+const OutputSet::ElementSet & OutputSet::GetSet() const{
   return _outputs;
 }
 
@@ -101,7 +153,7 @@ int OutputSet::GetVC( int output_port, int vc_index, int *pri ) const
   
   if ( pri ) { *pri = -1; }
 
-  set<sSetElement>::const_iterator i = _outputs.begin( );
+  ElementSet::const_iterator i = _outputs.begin( );
   while(i!=_outputs.end( )){
     if(i->output_port == output_port){
       range = i->vc_end - i->vc_start + 1;
@@ -128,7 +180,7 @@ bool OutputSet::GetPortVC( int *out_port, int *out_vc ) const
   bool single_output = false;
   int  used_outputs  = 0;
 
-  set<sSetElement>::const_iterator i = _outputs.begin( );
+  ElementSet::const_iterator i = _outputs.begin( );
   if(i!=_outputs.end( )){
     used_outputs = i->output_port;
   }
@@ -28,7 +28,7 @@
 #ifndef _OUTPUTSET_HPP_
 #define _OUTPUTSET_HPP_
 
-#include <set>
+#include <vector>
 
 class OutputSet {
 
@@ -41,6 +41,40 @@ public:
     int output_port;
   };
 
+  // Elements ordered by decreasing priority, with at most one element per
+  // priority (like the std::set it replaces). Up to INLINE_SIZE elements are
+  // stored inline, larger sets spill over into a vector.
+  class ElementSet {
+  public:
+    static const int INLINE_SIZE = 5;
+
+    typedef sSetElement const * const_iterator;
+    typedef const_iterator iterator;
+
+    ElementSet( ) : _size( 0 ) {}
+
+    inline const_iterator begin( ) const { return _Data( ); }
+    inline const_iterator end( ) const { return _Data( ) + _size; }
+    inline int size( ) const { return _size; }
+    inline bool empty( ) const { return _size == 0; }
+
+    void clear( );
+    void insert( sSetElement const & s );
+    const_iterator erase( const_iterator i );
+
+  private:
+    int _size;
+    sSetElement _inline[INLINE_SIZE];
+    vector<sSetElement> _overflow;
+
+    inline sSetElement * _Data( ) {
+      return ( _size <= INLINE_SIZE ) ? _inline : &_overflow[0];
+    }
+    inline sSetElement const * _Data( ) const {
+      return ( _size <= INLINE_SIZE ) ? _inline : &_overflow[0];
+    }
+  };
+
   void Clear( );
   void Add( int output_port, int vc, int pri = 0 );
   void AddRange( int output_port, int vc_start, int vc_end, int pri = 0 );
@@ -48,12 +82,12 @@ public:
   bool OutputEmpty( int output_port ) const;
   int NumVCs( int output_port ) const;
   
-  const set<sSetElement> & GetSet() const;
+  const ElementSet & GetSet() const;
 
   int  GetVC( int output_port,  int vc_index, int *pri = 0 ) const;
   bool GetPortVC( int *out_port, int *out_vc ) const;
 private:
-  set<sSetElement> _outputs;
+  ElementSet _outputs;
 };
 
 inline bool operator<(const OutputSet::sSetElement & se1, 
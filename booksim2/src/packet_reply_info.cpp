@@ -27,8 +27,8 @@
 
 #include "packet_reply_info.hpp"
 
-stack<PacketReplyInfo*> PacketReplyInfo::_all;
-stack<PacketReplyInfo*> PacketReplyInfo::_free;
+thread_local stack<PacketReplyInfo*> PacketReplyInfo::_all;
+thread_local stack<PacketReplyInfo*> PacketReplyInfo::_free;
 
 PacketReplyInfo * PacketReplyInfo::New()
 {
@@ -54,4 +54,5 @@ void PacketReplyInfo::FreeAll()
     delete _all.top();
     _all.pop();
   }
+  _free = stack<PacketReplyInfo*>();
 }
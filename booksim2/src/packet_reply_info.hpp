@@ -47,8 +47,10 @@ public:
 
 private:
 
-  static stack<PacketReplyInfo*> _all;
-  static stack<PacketReplyInfo*> _free;
+  // only used by the traffic manager, i.e., by the thread running the
+  // simulation
+  static thread_local stack<PacketReplyInfo*> _all;
+  static thread_local stack<PacketReplyInfo*> _free;
 
   PacketReplyInfo() {}
   ~PacketReplyInfo() {}
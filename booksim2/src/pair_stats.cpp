@@ -0,0 +1,154 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*pair_stats.cpp
+ *
+ *compact per source/destination pair statistics
+ */
+
+#include "booksim.hpp"
+#include <iostream>
+#include <sstream>
+#include <limits>
+#include <cassert>
+#include <stdint.h>
+
+#include "pair_stats.hpp"
+
+PairStats::PairStats( Module *parent, const string &name, int nodes,
+		      int quantile_bits ) :
+  Module( parent, name ), _nodes( nodes ), _quantile_bits( quantile_bits )
+{
+  int const pairs = _nodes * _nodes;
+  _num_samples.resize( pairs );
+  _sample_sum.resize( pairs );
+  _sample_squared_sum.resize( pairs );
+  _min.resize( pairs );
+  _max.resize( pairs );
+  Clear();
+}
+
+PairStats::~PairStats( )
+{
+  for ( map<int, Stats *>::iterator iter = _sketches.begin();
+	iter != _sketches.end(); ++iter ) {
+    delete iter->second;
+  }
+}
+
+void PairStats::Clear( )
+{
+  _num_samples.assign( _num_samples.size(), 0 );
+  _sample_sum.assign( _sample_sum.size(), 0.0 );
+  _sample_squared_sum.assign( _sample_squared_sum.size(), 0.0 );
+  _min.assign( _min.size(), numeric_limits<double>::quiet_NaN() );
+  _max.assign( _max.size(), -numeric_limits<double>::quiet_NaN() );
+  for ( map<int, Stats *>::iterator iter = _sketches.begin();
+	iter != _sketches.end(); ++iter ) {
+    iter->second->Clear();
+  }
+}
+
+void PairStats::AddSample( int src, int dest, double val )
+{
+  assert( ( src >= 0 ) && ( src < _nodes ) );
+  assert( ( dest >= 0 ) && ( dest < _nodes ) );
+  int const p = src * _nodes + dest;
+
+  ++_num_samples[p];
+  _sample_sum[p] += val;
+  _sample_squared_sum[p] += val * val;
+
+  // NOTE: the negation ensures that NaN values are handled correctly!
+  _max[p] = !(val <= _max[p]) ? val : _max[p];
+  _min[p] = !(val >= _min[p]) ? val : _min[p];
+
+  if ( _quantile_bits > 0 ) {
+    map<int, Stats *>::iterator iter = _sketches.find( p );
+    if ( iter == _sketches.end() ) {
+      ostringstream name;
+      name << Name() << "_" << src << "_" << dest;
+      Stats * const s = new Stats( this, name.str(), 1.0, 1 );
+      s->EnableQuantiles( _quantile_bits );
+      iter = _sketches.insert( make_pair( p, s ) ).first;
+    }
+    iter->second->AddSample( val );
+  }
+}
+
+int PairStats::NumSamples( int src, int dest ) const
+{
+  return _num_samples[src * _nodes + dest];
+}
+
+double PairStats::Average( int src, int dest ) const
+{
+  int const p = src * _nodes + dest;
+  return _sample_sum[p] / (double)_num_samples[p];
+}
+
+double PairStats::Variance( int src, int dest ) const
+{
+  int const p = src * _nodes + dest;
+  double const n = (double)_num_samples[p];
+  return (_sample_squared_sum[p] * n - _sample_sum[p] * _sample_sum[p]) / (n * n);
+}
+
+double PairStats::Min( int src, int dest ) const
+{
+  return _min[src * _nodes + dest];
+}
+
+double PairStats::Max( int src, int dest ) const
+{
+  return _max[src * _nodes + dest];
+}
+
+double PairStats::Quantile( int src, int dest, double q ) const
+{
+  assert( HasQuantiles() );
+  map<int, Stats *>::const_iterator iter = _sketches.find( src * _nodes + dest );
+  if ( iter == _sketches.end() ) {
+    return numeric_limits<double>::quiet_NaN();
+  }
+  return iter->second->Quantile( q );
+}
+
+void PairStats::WriteBinary( ostream & os ) const
+{
+  int32_t const nodes = _nodes;
+  os.write( (char const *)&nodes, sizeof( nodes ) );
+  for ( size_t p = 0; p < _num_samples.size(); ++p ) {
+    int32_t const count = _num_samples[p];
+    os.write( (char const *)&count, sizeof( count ) );
+  }
+  size_t const bytes = _sample_sum.size() * sizeof( double );
+  os.write( (char const *)&_sample_sum[0], bytes );
+  os.write( (char const *)&_sample_squared_sum[0], bytes );
+  os.write( (char const *)&_min[0], bytes );
+  os.write( (char const *)&_max[0], bytes );
+}
@@ -0,0 +1,79 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _PAIR_STATS_HPP_
+#define _PAIR_STATS_HPP_
+
+#include <map>
+
+#include "module.hpp"
+#include "stats.hpp"
+
+// Latency statistics of all source/destination pairs of a network, kept
+// in flat arrays indexed by source * nodes + destination instead of one
+// Stats object per pair. If quantile_bits is non-zero, a log-linear
+// quantile sketch is allocated for each pair on its first sample; sketches
+// are kept across Clear() since the same pairs tend to exchange traffic
+// again.
+class PairStats : public Module {
+  int _nodes;
+  int _quantile_bits;
+
+  vector<int>    _num_samples;
+  vector<double> _sample_sum;
+  vector<double> _sample_squared_sum;
+  vector<double> _min;
+  vector<double> _max;
+
+  map<int, Stats *> _sketches;
+
+public:
+  PairStats( Module *parent, const string &name, int nodes,
+	     int quantile_bits = 0 );
+  ~PairStats( );
+
+  void Clear( );
+
+  void AddSample( int src, int dest, double val );
+
+  int    NumSamples( int src, int dest ) const;
+  double Average( int src, int dest ) const;
+  double Variance( int src, int dest ) const;
+  double Min( int src, int dest ) const;
+  double Max( int src, int dest ) const;
+  double Quantile( int src, int dest, double q ) const;
+
+  inline bool HasQuantiles( ) const { return _quantile_bits > 0; }
+  inline int NumActivePairs( ) const { return _sketches.size(); }
+
+  // raw dump for offline processing: the number of nodes (int32) followed
+  // by the sample counts (int32) and the sums, squared sums, minima and
+  // maxima (double) of all pairs, each in source-major order
+  void WriteBinary( ostream & os ) const;
+};
+
+#endif
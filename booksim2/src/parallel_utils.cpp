@@ -0,0 +1,127 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*parallel_utils.cpp
+ *
+ *Worker pool for the parallel cycle engine
+ */
+
+#include <cassert>
+
+#include "parallel_utils.hpp"
+
+thread_local bool gParallelPhase = false;
+
+// number of polls before an idle worker blocks on the condition variable
+static const int WORKER_SPIN_COUNT = 4096;
+
+WorkerPool::WorkerPool( int threads ) :
+  _threads( threads ), _task( 0 ), _arg( 0 ), _generation( 0 ),
+  _pending( 0 ), _shutdown( false )
+{
+  assert( _threads > 0 );
+  for ( int t = 1; t < _threads; ++t ) {
+    _workers.push_back( std::thread( &WorkerPool::_WorkerLoop, this, t ) );
+  }
+}
+
+WorkerPool::~WorkerPool( )
+{
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _shutdown = true;
+    _generation.fetch_add( 1, std::memory_order_release );
+  }
+  _cond.notify_all( );
+  for ( size_t t = 0; t < _workers.size( ); ++t ) {
+    _workers[t].join( );
+  }
+}
+
+void WorkerPool::Run( Task task, void * arg )
+{
+  _task = task;
+  _arg = arg;
+  _pending.store( _threads - 1, std::memory_order_relaxed );
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _generation.fetch_add( 1, std::memory_order_release );
+  }
+  _cond.notify_all( );
+
+  _RunTask( 0 );
+
+  while ( _pending.load( std::memory_order_acquire ) > 0 ) {
+    std::this_thread::yield( );
+  }
+
+  if ( _error ) {
+    std::exception_ptr error = _error;
+    _error = std::exception_ptr( );
+    std::rethrow_exception( error );
+  }
+}
+
+// the workers must not unwind past the pool, the first error is kept
+void WorkerPool::_RunTask( int thread )
+{
+  try {
+    _task( _arg, thread );
+  } catch ( ... ) {
+    std::lock_guard<std::mutex> lock( _mutex );
+    if ( !_error ) {
+      _error = std::current_exception( );
+    }
+  }
+}
+
+void WorkerPool::_WorkerLoop( int thread )
+{
+  // workers only run during parallel phases
+  gParallelPhase = true;
+  unsigned seen = 0;
+  while ( true ) {
+    int spin = 0;
+    while ( _generation.load( std::memory_order_acquire ) == seen &&
+            spin < WORKER_SPIN_COUNT ) {
+      ++spin;
+      std::this_thread::yield( );
+    }
+    if ( _generation.load( std::memory_order_acquire ) == seen ) {
+      std::unique_lock<std::mutex> lock( _mutex );
+      while ( _generation.load( std::memory_order_acquire ) == seen ) {
+        _cond.wait( lock );
+      }
+    }
+    seen = _generation.load( std::memory_order_acquire );
+    if ( _shutdown ) {
+      return;
+    }
+    _RunTask( thread );
+    _pending.fetch_sub( 1, std::memory_order_release );
+  }
+}
@@ -0,0 +1,94 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*parallel_utils.hpp
+ *
+ *Worker pool used by the network to evaluate the modules of one simulation
+ *phase in parallel. The caller takes part in every round as thread 0 and
+ *Run() only returns once all workers have finished, i.e., each round ends
+ *with a barrier.
+ */
+
+#ifndef _PARALLEL_UTILS_HPP_
+#define _PARALLEL_UTILS_HPP_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+
+// set while worker threads are evaluating a network phase; set for good in
+// the worker threads themselves
+extern thread_local bool gParallelPhase;
+
+// Scoped lock that only engages during a parallel phase, so that the serial
+// engine does not pay for synchronizing the shared pools.
+class ParallelLock {
+  std::mutex * _m;
+public:
+  explicit ParallelLock( std::mutex & m ) : _m( gParallelPhase ? &m : 0 ) {
+    if ( _m ) _m->lock( );
+  }
+  ~ParallelLock( ) {
+    if ( _m ) _m->unlock( );
+  }
+};
+
+class WorkerPool {
+public:
+  typedef void (*Task)( void * arg, int thread );
+
+  WorkerPool( int threads );
+  ~WorkerPool( );
+
+  int NumThreads( ) const { return _threads; }
+
+  // run task(arg, t) for t in [0, NumThreads()) and wait for all of them;
+  // an exception thrown by any of the tasks is rethrown once all are done
+  void Run( Task task, void * arg );
+
+private:
+  int _threads;
+  std::vector<std::thread> _workers;
+
+  Task _task;
+  void * _arg;
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+  std::atomic<unsigned> _generation;
+  std::atomic<int> _pending;
+  bool _shutdown;
+  std::exception_ptr _error;
+
+  void _WorkerLoop( int thread );
+  void _RunTask( int thread );
+};
+
+#endif
@@ -34,6 +34,7 @@
 using namespace std;
 
 class Flit;
+class Checkpoint;
 
 class BufferMonitor {
   int  _cycles ;
@@ -47,6 +48,7 @@ public:
   void cycle() ;
   void write( int input, Flit const * f ) ;
   void read( int input, Flit const * f ) ;
+  void Serialize( Checkpoint & cp ) ;
   inline const vector<int> & GetReads() const {
     return _reads;
   }
@@ -108,6 +108,8 @@ void DSENT_Power_Module::run() {
   }
 
   // router power
+  // retired routers account for their power-off cycles lazily
+  net->SynchronizePowerStates();
   vector<Router *> routers = net->GetRouters();
   for (size_t r = 0; r < routers.size(); ++r) {
     IQRouter *temp = dynamic_cast<IQRouter *>(routers[r]);
@@ -28,6 +28,7 @@
 #include "switch_monitor.hpp"
 
 #include "flit.hpp"
+#include "checkpoint.hpp"
 
 SwitchMonitor::SwitchMonitor( int inputs, int outputs, int classes )
 : _cycles(0), _inputs(inputs), _outputs(outputs), _classes(classes) {
@@ -49,6 +50,11 @@ void SwitchMonitor::traversal( int input, int output, Flit const * f ) {
   _event[ index( input, output, f->cl) ]++ ;
 }
 
+void SwitchMonitor::Serialize( Checkpoint & cp ) {
+  cp.Sync( _cycles ) ;
+  cp.Sync( _event ) ;
+}
+
 void SwitchMonitor::display(ostream & os) const {
   for ( int i = 0 ; i < _inputs ; i++ ) {
     for ( int o = 0 ; o < _outputs ; o++) {
@@ -29,8 +29,8 @@
 #include <algorithm>
 #include <cassert>
 
-extern long ran_x[];
-extern double ran_u[];
+extern thread_local long ran_x[];
+extern thread_local double ran_u[];
 #define KK 100
 
 void SaveRandomState( std::vector<long> & save_x, std::vector<double> & save_u ) {
@@ -35,6 +35,10 @@ void   ran_start(long seed);
 long   ran_next( );
 void   ranf_start(long seed);
 double ranf_next( );
+void   ran_get_state( std::vector<long> & state );
+void   ran_set_state( std::vector<long> const & state );
+void   ranf_get_state( std::vector<double> & state );
+void   ranf_set_state( std::vector<double> const & state );
 
 inline void RandomSeed( long seed ) {
   ran_start( seed );
@@ -66,4 +70,17 @@ void SaveRandomState( std::vector<long> & save_x, std::vector<double> & save_u )
 // Restores the generator state from previously saved values
 void RestoreRandomState( std::vector<long> const & save_x, std::vector<double> const & save_u );
 
+// Saves the complete generator state, including the numbers that were
+// generated in advance but not used yet, so that a restored generator
+// continues the exact same sequence
+inline void SaveRandomGenerator( std::vector<long> & state_x, std::vector<double> & state_u ) {
+  ran_get_state( state_x );
+  ranf_get_state( state_u );
+}
+
+inline void RestoreRandomGenerator( std::vector<long> const & state_x, std::vector<double> const & state_u ) {
+  ran_set_state( state_x );
+  ranf_set_state( state_u );
+}
+
 #endif
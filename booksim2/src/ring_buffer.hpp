@@ -0,0 +1,197 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*ring_buffer.hpp
+ *
+ *Containers for the router pipelines. RingBuffer is a FIFO in a single
+ *power-of-two sized array, with the subset of the deque interface used by
+ *the routers (including random access and erase, which preserve the order
+ *of the remaining entries). It doubles its capacity when it is full, so the
+ *capacity given at construction only needs to cover the common case.
+ *
+ *PortArray holds at most one item per router port in a dense array, e.g.,
+ *the flits received in the current cycle, and is visited in port order.
+ */
+
+#ifndef _RING_BUFFER_HPP_
+#define _RING_BUFFER_HPP_
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+template<class T>
+class RingBuffer {
+
+  std::vector<T> _data;
+  int _mask;
+  int _head;
+  int _size;
+
+  void _Grow( ) {
+    std::vector<T> data( 2 * _data.size( ) );
+    for ( int i = 0; i < _size; ++i ) {
+      data[i] = ( *this )[i];
+    }
+    _data.swap( data );
+    _mask = _data.size( ) - 1;
+    _head = 0;
+  }
+
+public:
+
+  template<class R, class V>
+  class iterator_base {
+    friend class RingBuffer;
+    R * _ring;
+    int _index;
+  public:
+    iterator_base( ) : _ring( 0 ), _index( 0 ) {}
+    iterator_base( R * ring, int index ) : _ring( ring ), _index( index ) {}
+    template<class R2, class V2>
+    iterator_base( iterator_base<R2, V2> const & iter )
+      : _ring( iter._Ring( ) ), _index( iter._Index( ) ) {}
+    R * _Ring( ) const { return _ring; }
+    int _Index( ) const { return _index; }
+    V & operator*( ) const { return ( *_ring )[_index]; }
+    V * operator->( ) const { return &( *_ring )[_index]; }
+    iterator_base & operator++( ) { ++_index; return *this; }
+    iterator_base operator+( int n ) const {
+      return iterator_base( _ring, _index + n );
+    }
+    bool operator==( iterator_base const & iter ) const {
+      return _index == iter._index;
+    }
+    bool operator!=( iterator_base const & iter ) const {
+      return _index != iter._index;
+    }
+  };
+
+  typedef iterator_base<RingBuffer, T> iterator;
+  typedef iterator_base<RingBuffer const, T const> const_iterator;
+
+  explicit RingBuffer( int capacity = 16 ) : _head( 0 ), _size( 0 ) {
+    int size = 1;
+    while ( size < capacity ) {
+      size *= 2;
+    }
+    _data.resize( size );
+    _mask = size - 1;
+  }
+
+  inline bool empty( ) const { return _size == 0; }
+  inline size_t size( ) const { return _size; }
+
+  inline T & operator[]( int i ) {
+    assert( ( i >= 0 ) && ( i < _size ) );
+    return _data[( _head + i ) & _mask];
+  }
+  inline T const & operator[]( int i ) const {
+    assert( ( i >= 0 ) && ( i < _size ) );
+    return _data[( _head + i ) & _mask];
+  }
+
+  inline T & front( ) { return ( *this )[0]; }
+  inline T const & front( ) const { return ( *this )[0]; }
+  inline T & back( ) { return ( *this )[_size - 1]; }
+  inline T const & back( ) const { return ( *this )[_size - 1]; }
+
+  inline void push_back( T const & item ) {
+    if ( _size == (int)_data.size( ) ) {
+      _Grow( );
+    }
+    _data[( _head + _size ) & _mask] = item;
+    ++_size;
+  }
+
+  inline void pop_front( ) {
+    assert( _size > 0 );
+    _head = ( _head + 1 ) & _mask;
+    --_size;
+  }
+
+  void clear( ) {
+    _head = 0;
+    _size = 0;
+  }
+
+  iterator begin( ) { return iterator( this, 0 ); }
+  iterator end( ) { return iterator( this, _size ); }
+  const_iterator begin( ) const { return const_iterator( this, 0 ); }
+  const_iterator end( ) const { return const_iterator( this, _size ); }
+
+  // remove an entry, the following ones move up by one
+  iterator erase( iterator iter ) {
+    int const index = iter._index;
+    assert( ( index >= 0 ) && ( index < _size ) );
+    for ( int i = index; i < _size - 1; ++i ) {
+      ( *this )[i] = ( *this )[i + 1];
+    }
+    --_size;
+    return iterator( this, index );
+  }
+};
+
+template<class T>
+class PortArray {
+
+  std::vector<T *> _items;
+  int _count;
+
+public:
+  PortArray( ) : _count( 0 ) {}
+
+  void resize( int ports ) {
+    _items.assign( ports, 0 );
+    _count = 0;
+  }
+
+  inline bool empty( ) const { return _count == 0; }
+  inline size_t size( ) const { return _items.size( ); }
+
+  // item at the given port, NULL if there is none
+  inline T * operator[]( int port ) const {
+    assert( ( port >= 0 ) && ( port < (int)_items.size( ) ) );
+    return _items[port];
+  }
+
+  inline void insert( int port, T * item ) {
+    assert( ( port >= 0 ) && ( port < (int)_items.size( ) ) );
+    assert( !_items[port] && item );
+    _items[port] = item;
+    ++_count;
+  }
+
+  void clear( ) {
+    if ( _count ) {
+      std::fill( _items.begin( ), _items.end( ), (T *)0 );
+      _count = 0;
+    }
+  }
+};
+
+#endif
@@ -27,8 +27,46 @@
 
 #define main rng_double_main
 #include "rng-double.c"
+#undef main
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+#include "parallel_utils.hpp"
+#include "sim_context.hpp"
 
 double ranf_next( )
 {
+  if ( gParallelPhase ) {
+    // a worker thread draws from its own generator, so the numbers depend
+    // on the partitioning; count the draw so the network can report it
+    SimContext::Current( )->CountParallelRandomDraw( );
+  }
   return ranf_arr_next( );
 }
+
+// complete generator state, see ran_get_state
+void ranf_get_state( std::vector<double> & state )
+{
+  state.assign( ran_u, ran_u + KK );
+  state.insert( state.end( ), ranf_arr_buf, ranf_arr_buf + QUALITY );
+  if ( ranf_arr_ptr == &ranf_arr_dummy ) {
+    state.push_back( -2.0 );
+  } else if ( ranf_arr_ptr == &ranf_arr_started ) {
+    state.push_back( -1.0 );
+  } else {
+    state.push_back( double( ranf_arr_ptr - ranf_arr_buf ) );
+  }
+}
+
+void ranf_set_state( std::vector<double> const & state )
+{
+  assert( state.size( ) == KK + QUALITY + 1 );
+  std::copy( state.begin( ), state.begin( ) + KK, ran_u );
+  std::copy( state.begin( ) + KK, state.begin( ) + KK + QUALITY, ranf_arr_buf );
+  int const pos = int( state.back( ) );
+  assert( ( pos >= -2 ) && ( pos < QUALITY ) );
+  ranf_arr_ptr = ( pos == -2 ) ? &ranf_arr_dummy :
+    ( pos == -1 ) ? &ranf_arr_started : ( ranf_arr_buf + pos );
+}
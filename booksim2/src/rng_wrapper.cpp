@@ -27,8 +27,48 @@
 
 #define main rng_main
 #include "rng.c"
+#undef main
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+#include "parallel_utils.hpp"
+#include "sim_context.hpp"
 
 long ran_next( )
 {
+  if ( gParallelPhase ) {
+    // a worker thread draws from its own generator, so the numbers depend
+    // on the partitioning; count the draw so the network can report it
+    SimContext::Current( )->CountParallelRandomDraw( );
+  }
   return ran_arr_next( );
 }
+
+// complete generator state: the lagged values, the buffered numbers that
+// were generated but not yet handed out, and the position of the next one
+// (-2 before ran_start, -1 right after it)
+void ran_get_state( std::vector<long> & state )
+{
+  state.assign( ran_x, ran_x + KK );
+  state.insert( state.end( ), ran_arr_buf, ran_arr_buf + QUALITY );
+  if ( ran_arr_ptr == &ran_arr_dummy ) {
+    state.push_back( -2 );
+  } else if ( ran_arr_ptr == &ran_arr_started ) {
+    state.push_back( -1 );
+  } else {
+    state.push_back( ran_arr_ptr - ran_arr_buf );
+  }
+}
+
+void ran_set_state( std::vector<long> const & state )
+{
+  assert( state.size( ) == KK + QUALITY + 1 );
+  std::copy( state.begin( ), state.begin( ) + KK, ran_x );
+  std::copy( state.begin( ) + KK, state.begin( ) + KK + QUALITY, ran_arr_buf );
+  long const pos = state.back( );
+  assert( ( pos >= -2 ) && ( pos < QUALITY ) );
+  ran_arr_ptr = ( pos == -2 ) ? &ran_arr_dummy :
+    ( pos == -1 ) ? &ran_arr_started : ( ran_arr_buf + pos );
+}
@@ -0,0 +1,167 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <sstream>
+#include <algorithm>
+#include <cassert>
+
+#include "booksim.hpp"
+#include "routecache.hpp"
+#include "router.hpp"
+#include "globals.hpp"
+#include "parallel_utils.hpp"
+
+thread_local map<string, RouteCache::sSpec> gRouteCacheMap;
+
+RouteCache::RouteCache( const Router * router, tRoutingFunction rf,
+                        sSpec const & spec, int inputs, int size )
+  : _router( router ), _rf( rf ), _spec( spec ), _inputs( inputs )
+{
+  assert( _spec.keys > 0 );
+
+  int keys = _spec.keys * Flit::NUM_FLIT_TYPES * gNodes;
+  if ( _spec.in_channel ) {
+    keys *= _inputs;
+  }
+
+  // the smallest power of two holding every key, unless that is too large
+  int entries = 1;
+  while ( ( entries < keys ) && ( entries < size ) ) {
+    entries <<= 1;
+  }
+  _entries.resize( entries );
+  _mask = entries - 1;
+  _changed.resize( 32 );
+  Clear( );
+}
+
+RouteCache * RouteCache::New( const Configuration & config, const Router * router,
+                              tRoutingFunction rf, int inputs )
+{
+  if ( !config.GetInt( "routing_cache" ) ) {
+    return NULL;
+  }
+
+  string const name = config.GetStr( "routing_function" ) + "_" + config.GetStr( "topology" );
+  map<string, sSpec>::const_iterator spec_iter = gRouteCacheMap.find( name );
+  if ( spec_iter == gRouteCacheMap.end( ) ) {
+    if ( router->GetID( ) == 0 ) {
+      cout << "WARNING: Routing function " << name
+           << " does not support the routing cache." << endl;
+    }
+    return NULL;
+  }
+
+  int const size = config.GetInt( "routing_cache_size" );
+  if ( size <= 0 ) {
+    ostringstream err;
+    err << "Invalid routing cache size: " << size;
+    router->Error( err.str( ) );
+  }
+
+  return new RouteCache( router, rf, spec_iter->second, inputs, size );
+}
+
+void RouteCache::Route( const Router * r, const Flit * f, int in_channel,
+                        OutputSet * outputs, bool inject )
+{
+  RouteCache * cache = r->GetRouteCache( );
+  assert( cache );
+
+  // watched flits print the routing decision, so they are always routed
+  if ( inject || f->watch ) {
+    cache->_rf( r, f, in_channel, outputs, inject );
+  } else {
+    cache->_Route( f, in_channel, outputs );
+  }
+}
+
+void RouteCache::_Route( const Flit * f, int in_channel, OutputSet * outputs )
+{
+  int key = _spec.key ? _spec.key( _router, f, in_channel ) : 0;
+  assert( ( key >= 0 ) && ( key < _spec.keys ) );
+  key = key * Flit::NUM_FLIT_TYPES + f->type;
+  if ( _spec.in_channel ) {
+    assert( ( in_channel >= 0 ) && ( in_channel < _inputs ) );
+    key = key * _inputs + in_channel;
+  }
+  key = key * gNodes + f->dest;
+
+  // lookahead routing fills the cache of the downstream router
+  ParallelLock lock( _mutex );
+
+  sEntry & e = _entries[key & _mask];
+  if ( ( e.tag == key + 1 ) && _Valid( e ) ) {
+    outputs->Clear( );
+    outputs->AddRange( e.route.output_port, e.route.vc_start,
+                       e.route.vc_end, e.route.pri );
+    return;
+  }
+
+  unsigned deps = 0;
+  Router::_route_deps = &deps;
+  _rf( _router, f, in_channel, outputs, false );
+  Router::_route_deps = 0;
+
+  OutputSet::ElementSet const & routes = outputs->GetSet( );
+  if ( routes.size( ) == 1 ) {
+    e.tag = key + 1;
+    e.deps = deps;
+    e.filled = _stamp;
+    e.route = *routes.begin( );
+  }
+}
+
+// an entry is stale if one of the ports it depends on changed after it was filled
+bool RouteCache::_Valid( sEntry const & e ) const
+{
+  for ( unsigned deps = e.deps; deps; deps &= deps - 1 ) {
+    if ( _changed[__builtin_ctz( deps )] > e.filled ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RouteCache::Invalidate( int port )
+{
+  assert( ( port >= 0 ) && ( port < 32 ) );
+
+  ParallelLock lock( _mutex );
+  _changed[port] = ++_stamp;
+}
+
+void RouteCache::Clear( )
+{
+  ParallelLock lock( _mutex );
+  for ( size_t i = 0; i < _entries.size( ); ++i ) {
+    _entries[i].tag = 0;
+    _entries[i].deps = 0;
+  }
+  _stamp = 0;
+  fill( _changed.begin( ), _changed.end( ), 0 );
+}
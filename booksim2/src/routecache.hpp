@@ -0,0 +1,119 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*routecache.hpp
+ *
+ *Per-router memo of the routes computed by deterministic routing
+ *functions. A routing function opts in by registering a specification in
+ *gRouteCacheMap, which declares the inputs the route depends on besides
+ *the router, the destination and the flit type: whether the input port
+ *matters and a key function for the relevant flit state (e.g. the inputs
+ *of the escape decision).
+ *
+ *The cache is direct-mapped and indexed by the dense key, so it acts as a
+ *lookup table once it is at least as large as the key space. Each entry
+ *records the neighbor ports whose power state or logical neighbor were
+ *read while the route was computed, and when it was filled. A state change
+ *at a port only stamps that port, and a lookup rejects the entries that
+ *depend on a port changed after they were filled, so invalidation takes
+ *constant time however large the cache is.
+ */
+
+#ifndef _ROUTECACHE_HPP_
+#define _ROUTECACHE_HPP_
+
+#include <vector>
+#include <map>
+#include <string>
+#include <mutex>
+
+#include "flit.hpp"
+#include "outputset.hpp"
+#include "routefunc.hpp"
+#include "config_utils.hpp"
+
+class Router;
+
+class RouteCache {
+
+public:
+  typedef int (*tKeyFunction)( const Router *, const Flit *, int in_channel );
+
+  struct sSpec {
+    bool in_channel; // route depends on the input port
+    int keys;        // number of distinct values returned by key
+    tKeyFunction key;
+  };
+
+private:
+  typedef unsigned long long stamp_t;
+
+  struct sEntry {
+    int tag; // key + 1, zero if empty
+    unsigned deps;
+    stamp_t filled;
+    OutputSet::sSetElement route;
+  };
+
+  const Router * _router;
+  tRoutingFunction _rf;
+  sSpec _spec;
+
+  int _inputs;
+  vector<sEntry> _entries;
+  int _mask;
+
+  // number of invalidations so far, and when each port was last invalidated
+  stamp_t _stamp;
+  vector<stamp_t> _changed;
+
+  mutex _mutex;
+
+public:
+  RouteCache( const Router * router, tRoutingFunction rf, sSpec const & spec,
+              int inputs, int size );
+
+  // returns NULL if caching is disabled or the routing function did not opt in
+  static RouteCache * New( const Configuration & config, const Router * router,
+                           tRoutingFunction rf, int inputs );
+
+  // routing function serving the route from the cache of router r
+  static void Route( const Router * r, const Flit * f, int in_channel,
+                     OutputSet * outputs, bool inject );
+
+  // drop the routes that depend on the state of neighbor port
+  void Invalidate( int port );
+  void Clear( );
+
+private:
+  void _Route( const Flit * f, int in_channel, OutputSet * outputs );
+  bool _Valid( sEntry const & e ) const;
+};
+
+extern thread_local map<string, RouteCache::sSpec> gRouteCacheMap;
+
+#endif
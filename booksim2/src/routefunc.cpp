@@ -42,6 +42,7 @@
 
 #include "booksim.hpp"
 #include "routefunc.hpp"
+#include "routecache.hpp"
 #include "kncube.hpp"
 #include "random_utils.hpp"
 #include "misc_utils.hpp"
@@ -52,16 +53,16 @@
 
 
 
-map<string, tRoutingFunction> gRoutingFunctionMap;
+thread_local map<string, tRoutingFunction> gRoutingFunctionMap;
 
 /* Global information used by routing functions */
 
 /* ==== Power Gate - Begin ==== */
-int gRoutingDeadlockTimeoutThreshold;
-int gMissRouteThreshold;
+thread_local int gRoutingDeadlockTimeoutThreshold;
+thread_local int gMissRouteThreshold;
 /* ==== Power Gate - End ==== */
 
-int gNumVCs;
+thread_local int gNumVCs;
 
 /* Add more functions here
  *
@@ -69,10 +70,10 @@ int gNumVCs;
 
 // ============================================================
 //  Balfour-Schultz
-int gReadReqBeginVC, gReadReqEndVC;
-int gWriteReqBeginVC, gWriteReqEndVC;
-int gReadReplyBeginVC, gReadReplyEndVC;
-int gWriteReplyBeginVC, gWriteReplyEndVC;
+thread_local int gReadReqBeginVC, gReadReqEndVC;
+thread_local int gWriteReqBeginVC, gWriteReqEndVC;
+thread_local int gReadReplyBeginVC, gReadReplyEndVC;
+thread_local int gWriteReplyBeginVC, gWriteReplyEndVC;
 
 // ============================================================
 //  QTree: Nearest Common Ancestor
@@ -2016,6 +2017,27 @@ void chaos_mesh( const Router *r, const Flit *f,
 //=============================================================
 
 /* ==== Power Gate - Begin ==== */
+// inputs of the escape decision of the flov routing functions besides the
+// input port: whether the flit uses the escape VC and whether it timed out
+int flov_mesh_escape_key( const Router *r, const Flit *f, int in_channel )
+{
+  int vcBegin = 0;
+  if ( f->type == Flit::READ_REQUEST ) {
+    vcBegin = gReadReqBeginVC;
+  } else if ( f->type == Flit::WRITE_REQUEST ) {
+    vcBegin = gWriteReqBeginVC;
+  } else if ( f->type ==  Flit::READ_REPLY ) {
+    vcBegin = gReadReplyBeginVC;
+  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+    vcBegin = gWriteReplyBeginVC;
+  }
+
+  int key = ( f->vc == vcBegin ) ? 1 : 0;
+  if ( GetSimTime() - f->rtime > 300 )
+    key |= 2;
+  return key;
+}
+
 void flov_mesh( const Router *r, const Flit *f, int in_channel,
     OutputSet *outputs, bool inject )
 {
@@ -2890,4 +2912,41 @@ void InitializeRoutingMap( const Configuration & config )
   gRoutingFunctionMap["nord_mesh"] = &nord_mesh;
   gRoutingFunctionMap["ring_dateline_mesh"] = &ring_dateline_mesh;
   /* ==== Power Gate - End ==== */
+
+  /* Routing functions supporting the route cache */
+
+  RouteCache::sSpec const dor_spec = { false, 1, NULL };
+  gRouteCacheMap["dor_mesh"]            = dor_spec;
+  gRouteCacheMap["dim_order_mesh"]      = dor_spec;
+
+  /* ==== Power Gate - Begin ==== */
+  RouteCache::sSpec const flov_spec = { true, 4, &flov_mesh_escape_key };
+  gRouteCacheMap["flov_mesh"]           = flov_spec;
+  gRouteCacheMap["opt_rflov_mesh"]      = flov_spec;
+  gRouteCacheMap["opt_flov_mesh"]       = flov_spec;
+  /* ==== Power Gate - End ==== */
+}
+
+// Routing functions that may draw random numbers while routing a flit; the
+// draws depend on the order in which the routers are evaluated
+bool RandomizedRoutingFunction( string const & name )
+{
+  static char const * const randomized[] = {
+    "nca_fattree", "anca_fattree", "nca_tree4", "anca_tree4",
+    "xy_yx_mesh", "adaptive_xy_yx_mesh", "romm_mesh", "romm_ni_mesh",
+    "planar_adapt_mesh", "valiant_mesh",
+    // tie-breaking between the two directions of an even-sized ring
+    "dim_order_torus", "dim_order_ni_torus", "dim_order_bal_torus",
+    "min_adapt_torus", "valiant_torus", "valiant_ni_torus",
+    "xy_yx_cmesh", "xy_yx_no_express_cmesh",
+    "min_dragonflynew", "ugal_dragonflynew",
+    "adaptive_xyyx_flatfly", "xyyx_flatfly", "valiant_flatfly",
+    "ugal_flatfly", "ugal_pni_flatfly", "ugal_xyyx_flatfly"
+  };
+  for ( size_t i = 0; i < sizeof(randomized) / sizeof(randomized[0]); ++i ) {
+    if ( name == randomized[i] ) {
+      return true;
+    }
+  }
+  return false;
 }
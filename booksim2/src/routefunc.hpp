@@ -36,6 +36,7 @@
 typedef void (*tRoutingFunction)( const Router *, const Flit *, int in_channel, OutputSet *, bool );
 
 void InitializeRoutingMap( const Configuration & config );
+bool RandomizedRoutingFunction( string const & name );
 
 /* ==== Power Gate - Begin ==== */
 enum Direction {
@@ -47,16 +48,16 @@ enum Direction {
     DIR_INVALID,
 };
 
-extern int gRoutingDeadlockTimeoutThreshold;
-extern int gMissRouteThreshold;
+extern thread_local int gRoutingDeadlockTimeoutThreshold;
+extern thread_local int gMissRouteThreshold;
 /* ==== Power Gate - End ==== */
 
-extern map<string, tRoutingFunction> gRoutingFunctionMap;
+extern thread_local map<string, tRoutingFunction> gRoutingFunctionMap;
 
-extern int gNumVCs;
-extern int gReadReqBeginVC, gReadReqEndVC;
-extern int gWriteReqBeginVC, gWriteReqEndVC;
-extern int gReadReplyBeginVC, gReadReplyEndVC;
-extern int gWriteReplyBeginVC, gWriteReplyEndVC;
+extern thread_local int gNumVCs;
+extern thread_local int gReadReqBeginVC, gReadReqEndVC;
+extern thread_local int gWriteReqBeginVC, gWriteReqEndVC;
+extern thread_local int gReadReplyBeginVC, gReadReplyEndVC;
+extern thread_local int gWriteReplyBeginVC, gWriteReplyEndVC;
 
 #endif
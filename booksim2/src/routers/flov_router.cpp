@@ -26,6 +26,7 @@
 #include "allocator.hpp"
 #include "switch_monitor.hpp"
 #include "buffer_monitor.hpp"
+#include "checkpoint.hpp"
 
 /* ==== Power Gate - Begin ==== */
 const char * const FLOVPolicy[] = {"G-FLOV", "R-FLOV", "No-FLOV", "invalid"};
@@ -48,6 +49,10 @@ FLOVRouter::FLOVRouter( Configuration const & config, Module *parent,
   _handshake_buffer.resize(4);
 
   _flov_policy = gflov;
+
+  _vote_tile_size = config.GetInt("flov_vote_tile_size");
+  _vote_tally = 0;
+  _vote_out.resize(4, 0);
   /* ==== Power Gate - End ==== */
 }
 
@@ -55,6 +60,22 @@ FLOVRouter::~FLOVRouter( )
 {
 }
 
+// handshakes are only received and evaluated within a cycle, the queued
+// ones are saved with the handshake channels' contents
+void FLOVRouter::Serialize( Checkpoint & cp )
+{
+  IQRouter::Serialize( cp );
+  /* ==== Power Gate - Begin ==== */
+  assert(_proc_handshakes.empty() && _out_queue_handshakes.empty());
+  cp.Sync( _credit_counter );
+  cp.Sync( _clear_credits );
+  cp.Sync( _handshake_buffer );
+  cp.Sync( _flov_policy );
+  cp.Sync( _vote_tally );
+  cp.Sync( _vote_out );
+  /* ==== Power Gate - End ==== */
+}
+
 void FLOVRouter::ReadInputs( )
 {
   bool have_flits = _ReceiveFlits( );
@@ -368,21 +389,7 @@ void FLOVRouter::_RFLOVPowerStateEvaluate()
       _idle_timer = 0;
     } else if (_router_state == false) {
       assert(_outstanding_requests == 0);
-      bool neighbor_draining_wakeup_off = false;
-      for (int out = 0; out < 4; ++out) {
-        if ((out == DIR_EAST && _id % gK == gK-1) ||
-            (out == DIR_WEST && _id % gK == 0) ||
-            (out == DIR_SOUTH && _id / gK == gK-1) ||
-            (out == DIR_NORTH && _id / gK == 0))
-          continue;
-        if (_neighbor_states[out] == draining ||
-            _neighbor_states[out] == wakeup ||
-            _neighbor_states[out] == power_off) {
-          neighbor_draining_wakeup_off = true;
-          break;
-        }
-      }
-      if (!neighbor_draining_wakeup_off) {
+      if (!_RFLOVNeighborsBlockDrain()) {
         _power_state = draining;
         _idle_timer = 0;
         _drain_timer = 0;
@@ -705,6 +712,25 @@ void FLOVRouter::_RFLOVPowerStateEvaluate()
   }
 }
 
+// under R-FLOV, a router only starts draining while none of its neighbors
+// is gated, draining or waking up
+bool FLOVRouter::_RFLOVNeighborsBlockDrain() const
+{
+  for (int out = 0; out < 4; ++out) {
+    if ((out == DIR_EAST && _id % gK == gK-1) ||
+        (out == DIR_WEST && _id % gK == 0) ||
+        (out == DIR_SOUTH && _id / gK == gK-1) ||
+        (out == DIR_NORTH && _id / gK == 0))
+      continue;
+    if (_neighbor_states[out] == draining ||
+        _neighbor_states[out] == wakeup ||
+        _neighbor_states[out] == power_off) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void FLOVRouter::_NoFLOVPowerStateEvaluate()
 {
   if (_outstanding_requests) {
@@ -879,6 +905,8 @@ void FLOVRouter::_NoFLOVPowerStateEvaluate()
 
 void FLOVRouter::PowerStateEvaluate()
 {
+  _TrackNodeActivity(1);
+
   switch (_flov_policy) {
     case gflov:
       _GFLOVPowerStateEvaluate();
@@ -899,8 +927,109 @@ void FLOVRouter::PowerStateEvaluate()
   }
 }
 
+// besides empty router and fly-over datapaths, no handshakes may be in
+// flight and no downstream router may be draining or waking up, since the
+// handshake responses are evaluated every cycle
+bool FLOVRouter::Quiescent( ) const
+{
+  if (!IQRouter::Quiescent() || !_proc_handshakes.empty() ||
+      !_out_queue_handshakes.empty()) {
+    return false;
+  }
+  for (int out = 0; out < 4; ++out) {
+    if (!_handshake_buffer[out].empty() || _vote_out[out] != 0 ||
+        _downstream_states[out] == draining ||
+        _downstream_states[out] == wakeup) {
+      return false;
+    }
+    // credits relayed by a gated router
+    for (int vc = 0; (vc < _vcs) && (_power_state == power_off); ++vc) {
+      if (_credit_counter[out][vc] > 0) {
+        return false;
+      }
+    }
+  }
+  return (NextPowerEventCycle() > 0);
+}
+
+// number of cycles, starting with the next evaluation, in which the power
+// state machine only advances its timers
+int FLOVRouter::NextPowerEventCycle( ) const
+{
+  int const never = numeric_limits<int>::max();
+
+  if (_node_activity == node_busy)
+    return 0;
+
+  switch (_power_state) {
+  case power_on:
+    if (_outstanding_requests || _wakeup_signal)
+      return 0;
+    // the neighbor states only change through handshakes, which wake up
+    // the router
+    if (_router_state == false && _flov_policy == rflov)
+      return _RFLOVNeighborsBlockDrain() ? never : 0;
+    if (_router_state == false && _flov_policy != noflov)
+      return 0;
+    return never;
+
+  case power_off:
+    if (_flov_policy == gflov)
+      return never;
+    if (_flov_policy == rflov)
+      return (_router_state || _wakeup_signal) ? 0 : never;
+    // the off timer also advances while the node is idle
+    if (_node_activity == node_idle)
+      return max(0, (_bet_threshold - _off_timer + 1) / 2 - 1);
+    return max(0, _bet_threshold - _off_timer - 1);
+
+  default:
+    return 0;
+  }
+}
+
+void FLOVRouter::SynchronizeCycle( int cycles )
+{
+  _TrackNodeActivity(cycles);
+  // R-FLOV counts down the idle timer while waiting for its neighbors
+  if (_power_state == power_on && _router_state == false &&
+      _flov_policy == rflov)
+    _idle_timer -= cycles;
+  if (_power_state == power_off) {
+    _power_off_cycles += cycles;
+    _total_power_off_cycles += cycles;
+    if (_flov_policy == noflov)
+      _off_timer += cycles;
+  }
+}
+
+// without a tile size, the node at (row, col) votes into its row if
+// row <= col and into its column if col <= row
+void FLOVRouter::CastPowerGatingVote(int vote)
+{
+  _vote_tally += vote;
+  int const row = _id / gK;
+  int const col = _id % gK;
+  for (int out = 0; out < 4; ++out) {
+    bool const horizontal = (out == DIR_EAST || out == DIR_WEST);
+    if (_vote_tile_size == 0 && (horizontal ? (row > col) : (col > row)))
+      continue;
+    if (_InVoteRegion(out))
+      _vote_out[out] += vote;
+  }
+  Activate();
+}
+
+int FLOVRouter::TallyPowerGatingVotes()
+{
+  int const votes = _vote_tally;
+  _vote_tally = 0;
+  return votes;
+}
+
 void FLOVRouter::AggressFLOVPolicy()
 {
+  _PreparePowerStateChange();
   if (_watch_power_gating) {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | ";
   }
@@ -926,6 +1055,7 @@ void FLOVRouter::AggressFLOVPolicy()
 
 void FLOVRouter::RegressFLOVPolicy()
 {
+  _PreparePowerStateChange();
   if (_watch_power_gating) {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | ";
   }
@@ -1070,10 +1200,66 @@ void FLOVRouter::_ReceiveHandshakes()
   for (int input = 0; input < 4; ++input) {
     Handshake * const h = _input_handshakes[input]->Receive();
     if (h) {
+      if (h->vote != 0) {
+        _ReceiveVote(input, h->vote);
+        h->vote = 0;
+      }
+      // handshakes that only carried votes are not seen by the power-state
+      // protocol
+      if (h->new_state == -1 && h->src_state == -1 && !h->drain_done &&
+          h->logical_neighbor == -1) {
+        h->Free();
+        continue;
+      }
       _proc_handshakes.push_back(make_pair(input, h));
     }
   }
 }
+
+// votes are broadcast along the row of the voting node, and along the
+// columns of its region; relaying routers of any power state add them to
+// their tally
+void FLOVRouter::_ReceiveVote(int input, int vote)
+{
+  assert((input >= 0) && (input < 4));
+  _vote_tally += vote;
+  int output = input;
+  if (output % 2)
+    --output;
+  else
+    ++output;
+  if (_InVoteRegion(output))
+    _vote_out[output] += vote;
+  // a tile is covered by the columns of the routers in the row of the voter
+  if (_vote_tile_size > 0 && (input == DIR_EAST || input == DIR_WEST)) {
+    if (_InVoteRegion(DIR_SOUTH))
+      _vote_out[DIR_SOUTH] += vote;
+    if (_InVoteRegion(DIR_NORTH))
+      _vote_out[DIR_NORTH] += vote;
+  }
+}
+
+bool FLOVRouter::_InVoteRegion(int output) const
+{
+  int const row = _id / gK;
+  int const col = _id % gK;
+  int next_row = row;
+  int next_col = col;
+  switch (output) {
+  case DIR_EAST: ++next_col; break;
+  case DIR_WEST: --next_col; break;
+  case DIR_SOUTH: ++next_row; break;
+  case DIR_NORTH: --next_row; break;
+  default: assert(false);
+  }
+  if (next_col < 0 || next_col >= gK || next_row < 0 ||
+      next_row >= gNodes / gK)
+    return false;
+  if (_vote_tile_size == 0)
+    return true;
+  return (next_row / _vote_tile_size == row / _vote_tile_size) &&
+    (next_col / _vote_tile_size == col / _vote_tile_size);
+}
 /* ==== Power Gate - End ==== */
 
 //------------------------------------------------------------------------------
@@ -1082,15 +1268,12 @@ void FLOVRouter::_ReceiveHandshakes()
 
 void FLOVRouter::_InputQueuing( )
 {
-  for(map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-      iter != _in_queue_flits.end();
-      ++iter) {
+  for(int input = 0; input < _inputs; ++input) {
 
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
-
-    Flit * const f = iter->second;
-    assert(f);
+    Flit * const f = _in_queue_flits[input];
+    if(!f) {
+      continue;
+    }
 
     int const vc = f->vc;
     assert((vc >= 0) && (vc < _vcs));
@@ -1131,7 +1314,7 @@ void FLOVRouter::_InputQueuing( )
       assert(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] != vc);
       if(_routing_delay) {
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
       } else {
         if(f->watch) {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1143,12 +1326,10 @@ void FLOVRouter::_InputQueuing( )
         cur_buf->SetRouteSet(vc, &f->la_route_set);
         cur_buf->SetState(vc, VC::vc_alloc);
         if(_speculative) {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                  -1)));
+          _sw_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
         }
         if(_vc_allocator) {
-          _vc_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                  -1)));
+          _vc_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
         }
         if(_noq) {
           _UpdateNOQ(input, vc, f);
@@ -1157,11 +1338,9 @@ void FLOVRouter::_InputQueuing( )
     } else if((cur_buf->GetState(vc) == VC::active) &&
         (cur_buf->FrontFlit(vc) == f)) {
       if(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] == vc) {
-        _sw_hold_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                -1)));
+        _sw_hold_vcs.push_back(sVCRecord(-1, input, vc, -1));
       } else {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                -1)));
+        _sw_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
       }
     }
   }
@@ -1169,23 +1348,23 @@ void FLOVRouter::_InputQueuing( )
 
   while(!_proc_credits.empty()) {
 
-    pair<int, pair<Credit *, int> > const & item = _proc_credits.front();
+    sCreditRecord const item = _proc_credits.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if(GetSimTime() < time) {
       break;
     }
 
-    Credit * const c = item.second.first;
+    Credit * const c = item.c;
     assert(c);
 
-    int const output = item.second.second;
+    int const output = item.output;
     assert((output >= 0) && (output < _outputs));
 
     BufferState * const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+    for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
       int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
@@ -1212,17 +1391,17 @@ void FLOVRouter::_RouteUpdate( )
 
   while(!_route_vcs.empty()) {
 
-    pair<int, pair<int, int> > const & item = _route_vcs.front();
+    sRouteRecord const item = _route_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer * const cur_buf = _buf[input];
@@ -1251,9 +1430,9 @@ void FLOVRouter::_RouteUpdate( )
     if (f->dest != _id) {
       OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
       assert(route_set);
-      set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+      OutputSet::ElementSet const setlist = route_set->GetSet();
       if (setlist.size() == 1) {
-        set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+        OutputSet::ElementSet::const_iterator iset = setlist.begin();
         int const out_port = iset->output_port;
         assert((out_port >= 0) && (out_port < _outputs));
         const FlitChannel * channel = _output_channels[out_port];
@@ -1276,10 +1455,10 @@ void FLOVRouter::_RouteUpdate( )
     }
     /* ==== Power Gate - End ==== */
     if(_speculative) {
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     if(_vc_allocator) {
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     // NOTE: No need to handle NOQ here, as it requires lookahead routing!
     _route_vcs.pop_front();
@@ -1297,20 +1476,20 @@ void FLOVRouter::_VCAllocUpdate( )
 
   while(!_vc_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _vc_alloc_vcs.front();
+    sVCRecord const item = _vc_alloc_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(item.output != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -1329,7 +1508,7 @@ void FLOVRouter::_VCAllocUpdate( )
         << ")." << endl;
     }
 
-    int const output_and_vc = item.second.second;
+    int const output_and_vc = item.output;
 
     if(output_and_vc >= 0) {
 
@@ -1365,18 +1544,17 @@ void FLOVRouter::_VCAllocUpdate( )
         cur_buf->SetOutput(vc, match_output, match_vc);
         cur_buf->SetState(vc, VC::active);
         if(!_speculative) {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+          _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
         }
       } else {
         cur_buf->ClearRouteSet(vc);
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
           // should remove the speculative SA
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
             }
           }
@@ -1391,9 +1569,9 @@ void FLOVRouter::_VCAllocUpdate( )
           cur_buf->Display(*gWatchOut);
 
           *gWatchOut << " route_vcs size: " << _route_vcs.size()
-            << " time: " << _route_vcs.front().first
-            << " input: " << _route_vcs.front().second.first
-            << " vc: " << _route_vcs.front().second.second
+            << " time: " << _route_vcs.front().time
+            << " input: " << _route_vcs.front().input
+            << " vc: " << _route_vcs.front().vc
             << " pid: " << f->pid << endl;
 
           *gWatchOut << " route_vcs empty?"
@@ -1423,10 +1601,10 @@ void FLOVRouter::_VCAllocUpdate( )
       OutputSet const * route_set = cur_buf->GetRouteSet(vc);
       assert(route_set);
 
-      set<OutputSet::sSetElement> setlist = route_set->GetSet();
+      OutputSet::ElementSet setlist = route_set->GetSet();
 
       bool delete_route = false;
-      set<OutputSet::sSetElement>::iterator iset = setlist.begin();
+      OutputSet::ElementSet::iterator iset = setlist.begin();
       while (iset != setlist.end()) {
 
         int const out_port = iset->output_port;
@@ -1443,9 +1621,7 @@ void FLOVRouter::_VCAllocUpdate( )
         }
 
         if (delete_route) {
-          set<OutputSet::sSetElement>::iterator iter = iset;
-          ++iset;
-          setlist.erase(iter);
+          iset = setlist.erase(iset);
         } else {
           ++iset;
         }
@@ -1458,13 +1634,12 @@ void FLOVRouter::_VCAllocUpdate( )
       if (back_to_route) {
         cur_buf->ClearRouteSet(vc);
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
           // should remove the speculative SA
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
             }
           }
@@ -1475,19 +1650,18 @@ void FLOVRouter::_VCAllocUpdate( )
 
       if (GetSimTime() - f->rtime == 300) { // timeout
         _buf[input]->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
               break;
             }
           }
         }
       } else {
-        _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+        _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
       }
       /* ==== Power Gate - End ==== */
     }
@@ -1506,20 +1680,20 @@ void FLOVRouter::_SWHoldUpdate( )
 
   while(!_sw_hold_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_hold_vcs.front();
+    sVCRecord const item = _sw_hold_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if(time < 0) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(item.output != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -1540,7 +1714,7 @@ void FLOVRouter::_SWHoldUpdate( )
     int const expanded_input = input * _input_speedup + vc % _input_speedup;
     assert(_switch_hold_vc[expanded_input] == vc);
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = item.output;
 
     if(expanded_output >= 0 && ( _output_buffer_size==-1 || _output_buffer[expanded_output].size()<size_t(_output_buffer_size))) {
 
@@ -1673,10 +1847,10 @@ void FLOVRouter::_SWHoldUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(sCrossbarRecord(-1, f, expanded_input, expanded_output));
 
-      if(_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
       _out_queue_credits[input]->vc.insert(vc);
 
@@ -1717,7 +1891,7 @@ void FLOVRouter::_SWHoldUpdate( )
             /* ==== Power Gate - Begin ==== */
             nf->rtime = GetSimTime();
             /* ==== Power Gate - End ==== */
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           } else {
             if(nf->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1729,20 +1903,17 @@ void FLOVRouter::_SWHoldUpdate( )
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
             if(_speculative) {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_vc_allocator) {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_noq) {
               _UpdateNOQ(input, vc, nf);
             }
           }
         } else {
-          _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                  -1)));
+          _sw_hold_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
         }
       }
     } else {
@@ -1764,8 +1935,7 @@ void FLOVRouter::_SWHoldUpdate( )
       _switch_hold_vc[expanded_input] = -1;
       _switch_hold_in[expanded_input] = -1;
       _switch_hold_out[held_expanded_output] = -1;
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-              -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     _sw_hold_vcs.pop_front();
   }
@@ -1780,17 +1950,17 @@ void FLOVRouter::_SWAllocUpdate( )
 {
   while(!_sw_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_alloc_vcs.front();
+    sVCRecord const item = _sw_alloc_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer * const cur_buf = _buf[input];
@@ -1810,7 +1980,7 @@ void FLOVRouter::_SWAllocUpdate( )
         << ")." << endl;
     }
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = item.output;
 
     if(expanded_output >= 0) {
 
@@ -1839,11 +2009,11 @@ void FLOVRouter::_SWAllocUpdate( )
         int match_prio = numeric_limits<int>::min();
 
         const OutputSet * route_set = cur_buf->GetRouteSet(vc);
-        set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+        OutputSet::ElementSet const setlist = route_set->GetSet();
 
         assert(!_noq || (setlist.size() == 1));
 
-        for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+        for(OutputSet::ElementSet::const_iterator iset = setlist.begin();
             iset != setlist.end();
             ++iset) {
           if(iset->output_port == output) {
@@ -1932,10 +2102,9 @@ void FLOVRouter::_SWAllocUpdate( )
             }
             if (cur_buf->GetState(vc) == VC::vc_alloc) {
               assert(_speculative);
-              pair<int, int> input_vc = make_pair(input, vc);
               for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-                pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-                if (item.second.first == input_vc) {
+                sVCRecord item = _vc_alloc_vcs[i];
+                if ((item.input == input) && (item.vc == vc)) {
                   _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
                   break;
                 }
@@ -1947,7 +2116,7 @@ void FLOVRouter::_SWAllocUpdate( )
             }
             cur_buf->ClearRouteSet(vc);
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+            _route_vcs.push_back(sRouteRecord(-1, input, vc));
             _sw_alloc_vcs.pop_front();
             continue;
           }
@@ -2069,10 +2238,10 @@ void FLOVRouter::_SWAllocUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(sCrossbarRecord(-1, f, expanded_input, expanded_output));
 
-      if(_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
       _out_queue_credits[input]->vc.insert(vc);
 
@@ -2088,7 +2257,7 @@ void FLOVRouter::_SWAllocUpdate( )
           assert(nf->head);
           if(_routing_delay) {
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           } else {
             if(nf->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -2100,12 +2269,10 @@ void FLOVRouter::_SWAllocUpdate( )
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
             if(_speculative) {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_vc_allocator) {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_noq) {
               _UpdateNOQ(input, vc, nf);
@@ -2125,11 +2292,9 @@ void FLOVRouter::_SWAllocUpdate( )
             _switch_hold_vc[expanded_input] = vc;
             _switch_hold_in[expanded_input] = expanded_output;
             _switch_hold_out[expanded_output] = expanded_input;
-            _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                    -1)));
+            _sw_hold_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
           } else {
-            _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                    -1)));
+            _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
           }
         }
       }
@@ -2153,10 +2318,10 @@ void FLOVRouter::_SWAllocUpdate( )
           OutputSet const * route_set = cur_buf->GetRouteSet(vc);
           assert(route_set);
 
-          set<OutputSet::sSetElement> setlist = route_set->GetSet();
+          OutputSet::ElementSet setlist = route_set->GetSet();
 
           bool delete_route = false;
-          set<OutputSet::sSetElement>::iterator iset = setlist.begin();
+          OutputSet::ElementSet::iterator iset = setlist.begin();
           while (iset != setlist.end()) {
 
             int const out_port = iset->output_port;
@@ -2173,9 +2338,7 @@ void FLOVRouter::_SWAllocUpdate( )
             }
 
             if (delete_route) {
-              set<OutputSet::sSetElement>::iterator iter = iset;
-              ++iset;
-              setlist.erase(iter);
+              iset = setlist.erase(iset);
             } else {
               ++iset;
             }
@@ -2183,10 +2346,9 @@ void FLOVRouter::_SWAllocUpdate( )
 
           if (setlist.empty()) {
             back_to_route = true;
-            pair<int, int> input_vc = make_pair(input, vc);
             for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-              pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-              if (item.second.first == input_vc) {
+              sVCRecord item = _vc_alloc_vcs[i];
+              if ((item.input == input) && (item.vc == vc)) {
                 _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
                 break;
               }
@@ -2215,7 +2377,7 @@ void FLOVRouter::_SWAllocUpdate( )
         if (back_to_route) {
           cur_buf->ClearRouteSet(vc);
           cur_buf->SetState(vc, VC::routing);
-          _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+          _route_vcs.push_back(sRouteRecord(-1, input, vc));
           _sw_alloc_vcs.pop_front();
           continue;
         }
@@ -2248,9 +2410,9 @@ void FLOVRouter::_SWAllocUpdate( )
 #endif
 
       /* ==== Power Gate - Begin ==== */
-      int const input = item.second.first.first;
+      int const input = item.input;
       assert((input >= 0) && (input < _inputs));
-      int const vc = item.second.first.second;
+      int const vc = item.vc;
       assert((vc >= 0) && (vc < _vcs));
       Buffer * const cur_buf = _buf[input];
       int const escape_vc = 0;
@@ -2262,7 +2424,7 @@ void FLOVRouter::_SWAllocUpdate( )
           assert((dest_vc >= 0) && (dest_vc < _vcs));
           BufferState * const dest_buf = _next_buf[dest_output];
           dest_buf->ReturnBuffer(dest_vc);
-          _route_vcs.push_back(make_pair(-1, item.second.first));
+          _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           cur_buf->SetState(vc, VC::routing);
         } else {
           assert(cur_buf->GetState(vc) == VC::vc_alloc);
@@ -2270,19 +2432,18 @@ void FLOVRouter::_SWAllocUpdate( )
           assert(dest_output == -1);
           int const dest_vc = cur_buf->GetOutputVC(vc);
           assert(dest_vc == -1);
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _vc_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
               break;
             }
           }
-          _route_vcs.push_back(make_pair(-1, item.second.first));
+          _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           cur_buf->SetState(vc, VC::routing);
         }
       } else {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+        _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
       }
       /* ==== Power Gate - End ==== */
     }
@@ -2299,15 +2460,12 @@ void FLOVRouter::_SWAllocUpdate( )
 
 void FLOVRouter::_OutputQueuing( )
 {
-  for(map<int, Credit *>::const_iterator iter = _out_queue_credits.begin();
-      iter != _out_queue_credits.end();
-      ++iter) {
-
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
+  for(int input = 0; input < _inputs; ++input) {
 
-    Credit * const c = iter->second;
-    assert(c);
+    Credit * const c = _out_queue_credits[input];
+    if(!c) {
+      continue;
+    }
     assert(!c->vc.empty());
 
     _credit_buffer[input].push(c);
@@ -2340,6 +2498,19 @@ void FLOVRouter::_OutputQueuing( )
     _handshake_buffer[output].push(h);
   }
   _out_queue_handshakes.clear();
+
+  // votes ride on the last queued handshake of their output
+  for (int output = 0; output < 4; ++output) {
+    if (_vote_out[output] == 0)
+      continue;
+    if (_handshake_buffer[output].empty()) {
+      Handshake * const h = Handshake::New();
+      h->id = _id;
+      _handshake_buffer[output].push(h);
+    }
+    _handshake_buffer[output].back()->vote += _vote_out[output];
+    _vote_out[output] = 0;
+  }
   /* ==== Power Gate - End ==== */
 }
 
@@ -2379,14 +2550,13 @@ void FLOVRouter::_FlovStep() {
     assert(_in_queue_flits.empty());
 
   // process flits
-  for (map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-       iter != _in_queue_flits.end(); ++iter) {
+  for(int input = 0; input < _inputs; ++input) {
 
-    int const input = iter->first;
-    assert((input >= 0) && (input < 4));
-
-    Flit * const f = iter->second;
-    assert(f);
+    Flit * const f = _in_queue_flits[input];
+    if(!f) {
+      continue;
+    }
+    assert(input < 4);
 
     int const vc = f->vc;
     assert((vc >= 0) && (vc < _vcs));
@@ -2464,23 +2634,23 @@ void FLOVRouter::_FlovStep() {
   // off routers also process credits to make an image
   while (!_proc_credits.empty()) {
 
-    pair<int, pair<Credit *, int> > const & item = _proc_credits.front();
+    sCreditRecord const item = _proc_credits.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if (GetSimTime() < time) {
       break;
     }
 
-    Credit * const c = item.second.first;
+    Credit * const c = item.c;
     assert(c);
 
-    int const output = item.second.second;
+    int const output = item.output;
     assert((output >= 0) && (output < _outputs));
 
     BufferState * const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+    for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
       int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
@@ -2512,8 +2682,8 @@ void FLOVRouter::_FlovStep() {
         c->Free();
       else if (_power_state == wakeup && _downstream_states[input] == power_off)
         c->Free();
-      else if (_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, c));
+      else if (!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, c);
       }
     }
 
@@ -2530,8 +2700,8 @@ void FLOVRouter::_FlovStep() {
       ++out;
     for (int vc = 0; vc < _vcs; ++vc) {
       if (_credit_counter[out][vc] > 0) {
-        if (_out_queue_credits.count(in) == 0) {
-          _out_queue_credits.insert(make_pair(in, Credit::New()));
+        if (!_out_queue_credits[in]) {
+          _out_queue_credits.insert(in, Credit::New());
         }
         if (_out_queue_credits[in]->vc.count(vc) == 0) {
           --_credit_counter[out][vc];
@@ -2555,7 +2725,7 @@ void FLOVRouter::_HandshakeEvaluate() {
       << "receive handshake(s):" << endl;
   }
 
-  for (deque<pair<int, Handshake *> >::iterator iter = _proc_handshakes.begin();
+  for (RingBuffer<pair<int, Handshake *> >::iterator iter = _proc_handshakes.begin();
       iter != _proc_handshakes.end(); ++iter) {
     pair<int, Handshake *> & item = (*iter);
     int const input = item.first;
@@ -2728,15 +2898,15 @@ void FLOVRouter::_HandshakeEvaluate() {
       if ((_id - h->id == -1) || (_id - h->id == 1) ||
           (_id - h->id == -gK) || (_id - h->id == gK)) {
         assert(h->src_state >= 0);
-        _neighbor_states[input] = (ePowerState) h->src_state;
+        SetNeighborPowerState(input, (ePowerState) h->src_state);
       }
     }
 
     // update logical neighbor
     if (h->logical_neighbor >= 0) {
-      _logical_neighbors[input] = h->logical_neighbor;
+      SetLogicalNeighbor(input, h->logical_neighbor);
     } else if (new_downstream_states[input] == power_off) {
-      _logical_neighbors[input] = -1;
+      SetLogicalNeighbor(input, -1);
     }
   }
 
@@ -2862,11 +3032,11 @@ void FLOVRouter::_HandshakeResponse() {
       }
       // check ST stage, crossbar_flits
       if (drain_done)
-        for (deque<pair<int, pair<Flit *, pair<int, int> > > >::iterator iter =
+        for (RingBuffer<sCrossbarRecord>::iterator iter =
              _crossbar_flits.begin(); iter != _crossbar_flits.end(); ++iter) {
-          int const time = iter->first;
+          int const time = iter->time;
           assert(time <= GetSimTime());
-          int const expanded_output = iter->second.second.second;
+          int const expanded_output = iter->output;
           int const output = expanded_output / _output_speedup;
           assert((output >= 0) && (output < _outputs));
           if (output == out_port) {
@@ -26,7 +26,7 @@ public:
 protected:
 
   /* ==== Power Gate - Begin ==== */
-  deque<pair<int, Handshake *> > _proc_handshakes;
+  RingBuffer<pair<int, Handshake *> > _proc_handshakes;
 
   map<int, Handshake *> _out_queue_handshakes;
 
@@ -37,7 +37,17 @@ protected:
 
   eFLOVPolicy _flov_policy;
 
+  // adaptive power-gating votes propagated over the handshake channels:
+  // the tile size of the vote region (0 for the row and the column of the
+  // voting node), the votes received in the current epoch, and the sum of
+  // the votes to be relayed at each output
+  int _vote_tile_size;
+  int _vote_tally;
+  vector<int> _vote_out;
+
   void _ReceiveHandshakes( );
+  void _ReceiveVote( int input, int vote );
+  bool _InVoteRegion( int output ) const;
   /* ==== Power Gate - End ==== */
 
   virtual void _InternalStep( );
@@ -58,6 +68,7 @@ protected:
   void _HandshakeEvaluate();
   void _HandshakeResponse();
   void _RFLOVPowerStateEvaluate();
+  bool _RFLOVNeighborsBlockDrain() const;
   void _GFLOVPowerStateEvaluate();
   void _NoFLOVPowerStateEvaluate();
   /* ==== Power Gate - End ==== */
@@ -72,15 +83,24 @@ public:
 
   /* ==== Power Gate - Begin ==== */
   virtual void PowerStateEvaluate( );
+  // a retired router is woken up by the traffic manager, by handshakes, or
+  // when its break-even time may have been reached
+  virtual bool Quiescent( ) const;
+  virtual int NextPowerEventCycle( ) const;
+  virtual void SynchronizeCycle( int cycles );
   virtual void AggressFLOVPolicy();
   virtual void RegressFLOVPolicy();
   virtual inline void AggressPowerGatingPolicy() { AggressFLOVPolicy(); }
   virtual inline void RegressPowerGatingPolicy() { RegressFLOVPolicy(); }
+  virtual void CastPowerGatingVote(int vote);
+  virtual int TallyPowerGatingVotes();
   /* ==== Power Gate - End ==== */
 
   virtual void ReadInputs( );
   virtual void WriteOutputs( );
 
+  virtual void Serialize( Checkpoint & cp );
+
 };
 
 #endif
@@ -26,6 +26,7 @@
 #include "allocator.hpp"
 #include "switch_monitor.hpp"
 #include "buffer_monitor.hpp"
+#include "checkpoint.hpp"
 
 GFLOVRouter::GFLOVRouter( Configuration const & config, Module *parent,
     string const & name, int id, int inputs, int outputs )
@@ -51,6 +52,17 @@ GFLOVRouter::~GFLOVRouter( )
 {
 }
 
+void GFLOVRouter::Serialize( Checkpoint & cp )
+{
+  IQRouter::Serialize( cp );
+  /* ==== Power Gate - Begin ==== */
+  assert(_proc_handshakes.empty() && _out_queue_handshakes.empty());
+  cp.Sync( _credit_counter );
+  cp.Sync( _clear_credits );
+  cp.Sync( _handshake_buffer );
+  /* ==== Power Gate - End ==== */
+}
+
 void GFLOVRouter::ReadInputs( )
 {
   bool have_flits = _ReceiveFlits( );
@@ -67,6 +79,8 @@ void GFLOVRouter::ReadInputs( )
 /* ==== Power Gate - Begin ==== */
 void GFLOVRouter::PowerStateEvaluate()
 {
+  _TrackNodeActivity(1);
+
   if (_outstanding_requests) {
     assert(_power_state == power_on);
   }
@@ -476,15 +490,12 @@ void GFLOVRouter::_ReceiveHandshakes()
 
 void GFLOVRouter::_InputQueuing( )
 {
-  for(map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-      iter != _in_queue_flits.end();
-      ++iter) {
-
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
+  for(int input = 0; input < _inputs; ++input) {
 
-    Flit * const f = iter->second;
-    assert(f);
+    Flit * const f = _in_queue_flits[input];
+    if(!f) {
+      continue;
+    }
 
     int const vc = f->vc;
     assert((vc >= 0) && (vc < _vcs));
@@ -525,7 +536,7 @@ void GFLOVRouter::_InputQueuing( )
       assert(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] != vc);
       if(_routing_delay) {
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
       } else {
         if(f->watch) {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -537,12 +548,10 @@ void GFLOVRouter::_InputQueuing( )
         cur_buf->SetRouteSet(vc, &f->la_route_set);
         cur_buf->SetState(vc, VC::vc_alloc);
         if(_speculative) {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                  -1)));
+          _sw_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
         }
         if(_vc_allocator) {
-          _vc_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                  -1)));
+          _vc_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
         }
         if(_noq) {
           _UpdateNOQ(input, vc, f);
@@ -551,11 +560,9 @@ void GFLOVRouter::_InputQueuing( )
     } else if((cur_buf->GetState(vc) == VC::active) &&
         (cur_buf->FrontFlit(vc) == f)) {
       if(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] == vc) {
-        _sw_hold_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                -1)));
+        _sw_hold_vcs.push_back(sVCRecord(-1, input, vc, -1));
       } else {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                -1)));
+        _sw_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
       }
     }
   }
@@ -563,23 +570,23 @@ void GFLOVRouter::_InputQueuing( )
 
   while(!_proc_credits.empty()) {
 
-    pair<int, pair<Credit *, int> > const & item = _proc_credits.front();
+    sCreditRecord const item = _proc_credits.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if(GetSimTime() < time) {
       break;
     }
 
-    Credit * const c = item.second.first;
+    Credit * const c = item.c;
     assert(c);
 
-    int const output = item.second.second;
+    int const output = item.output;
     assert((output >= 0) && (output < _outputs));
 
     BufferState * const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+    for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
       int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
@@ -606,17 +613,17 @@ void GFLOVRouter::_RouteUpdate( )
 
   while(!_route_vcs.empty()) {
 
-    pair<int, pair<int, int> > const & item = _route_vcs.front();
+    sRouteRecord const item = _route_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer * const cur_buf = _buf[input];
@@ -645,9 +652,9 @@ void GFLOVRouter::_RouteUpdate( )
     if (f->dest != _id) {
       OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
       assert(route_set);
-      set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+      OutputSet::ElementSet const setlist = route_set->GetSet();
       if (setlist.size() == 1) {
-        set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+        OutputSet::ElementSet::const_iterator iset = setlist.begin();
         int const out_port = iset->output_port;
         assert((out_port >= 0) && (out_port < _outputs));
         const FlitChannel * channel = _output_channels[out_port];
@@ -670,10 +677,10 @@ void GFLOVRouter::_RouteUpdate( )
     }
     /* ==== Power Gate - End ==== */
     if(_speculative) {
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     if(_vc_allocator) {
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     // NOTE: No need to handle NOQ here, as it requires lookahead routing!
     _route_vcs.pop_front();
@@ -691,20 +698,20 @@ void GFLOVRouter::_VCAllocUpdate( )
 
   while(!_vc_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _vc_alloc_vcs.front();
+    sVCRecord const item = _vc_alloc_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(item.output != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -723,7 +730,7 @@ void GFLOVRouter::_VCAllocUpdate( )
         << ")." << endl;
     }
 
-    int const output_and_vc = item.second.second;
+    int const output_and_vc = item.output;
 
     if(output_and_vc >= 0) {
 
@@ -759,18 +766,17 @@ void GFLOVRouter::_VCAllocUpdate( )
         cur_buf->SetOutput(vc, match_output, match_vc);
         cur_buf->SetState(vc, VC::active);
         if(!_speculative) {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+          _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
         }
       } else {
         cur_buf->ClearRouteSet(vc);
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
           // should remove the speculative SA
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
             }
           }
@@ -785,9 +791,9 @@ void GFLOVRouter::_VCAllocUpdate( )
           cur_buf->Display(*gWatchOut);
 
           *gWatchOut << " route_vcs size: " << _route_vcs.size()
-            << " time: " << _route_vcs.front().first
-            << " input: " << _route_vcs.front().second.first
-            << " vc: " << _route_vcs.front().second.second
+            << " time: " << _route_vcs.front().time
+            << " input: " << _route_vcs.front().input
+            << " vc: " << _route_vcs.front().vc
             << " pid: " << f->pid << endl;
 
           *gWatchOut << " route_vcs empty?"
@@ -817,10 +823,10 @@ void GFLOVRouter::_VCAllocUpdate( )
       OutputSet const * route_set = cur_buf->GetRouteSet(vc);
       assert(route_set);
 
-      set<OutputSet::sSetElement> setlist = route_set->GetSet();
+      OutputSet::ElementSet setlist = route_set->GetSet();
 
       bool delete_route = false;
-      set<OutputSet::sSetElement>::iterator iset = setlist.begin();
+      OutputSet::ElementSet::iterator iset = setlist.begin();
       while (iset != setlist.end()) {
 
         int const out_port = iset->output_port;
@@ -837,9 +843,7 @@ void GFLOVRouter::_VCAllocUpdate( )
         }
 
         if (delete_route) {
-          set<OutputSet::sSetElement>::iterator iter = iset;
-          ++iset;
-          setlist.erase(iter);
+          iset = setlist.erase(iset);
         } else {
           ++iset;
         }
@@ -852,13 +856,12 @@ void GFLOVRouter::_VCAllocUpdate( )
       if (back_to_route) {
         cur_buf->ClearRouteSet(vc);
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
           // should remove the speculative SA
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
             }
           }
@@ -869,19 +872,18 @@ void GFLOVRouter::_VCAllocUpdate( )
 
       if (GetSimTime() - f->rtime == 300) { // timeout
         _buf[input]->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
               break;
             }
           }
         }
       } else {
-        _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+        _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
       }
       /* ==== Power Gate - End ==== */
     }
@@ -900,20 +902,20 @@ void GFLOVRouter::_SWHoldUpdate( )
 
   while(!_sw_hold_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_hold_vcs.front();
+    sVCRecord const item = _sw_hold_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if(time < 0) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(item.output != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -934,7 +936,7 @@ void GFLOVRouter::_SWHoldUpdate( )
     int const expanded_input = input * _input_speedup + vc % _input_speedup;
     assert(_switch_hold_vc[expanded_input] == vc);
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = item.output;
 
     if(expanded_output >= 0 && ( _output_buffer_size==-1 || _output_buffer[expanded_output].size()<size_t(_output_buffer_size))) {
 
@@ -1013,10 +1015,10 @@ void GFLOVRouter::_SWHoldUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(sCrossbarRecord(-1, f, expanded_input, expanded_output));
 
-      if(_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
       _out_queue_credits[input]->vc.insert(vc);
 
@@ -1057,7 +1059,7 @@ void GFLOVRouter::_SWHoldUpdate( )
             /* ==== Power Gate - Begin ==== */
             nf->rtime = GetSimTime();
             /* ==== Power Gate - End ==== */
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           } else {
             if(nf->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1069,20 +1071,17 @@ void GFLOVRouter::_SWHoldUpdate( )
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
             if(_speculative) {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_vc_allocator) {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_noq) {
               _UpdateNOQ(input, vc, nf);
             }
           }
         } else {
-          _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                  -1)));
+          _sw_hold_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
         }
       }
     } else {
@@ -1104,8 +1103,7 @@ void GFLOVRouter::_SWHoldUpdate( )
       _switch_hold_vc[expanded_input] = -1;
       _switch_hold_in[expanded_input] = -1;
       _switch_hold_out[held_expanded_output] = -1;
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-              -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     _sw_hold_vcs.pop_front();
   }
@@ -1120,17 +1118,17 @@ void GFLOVRouter::_SWAllocUpdate( )
 {
   while(!_sw_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_alloc_vcs.front();
+    sVCRecord const item = _sw_alloc_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer * const cur_buf = _buf[input];
@@ -1150,7 +1148,7 @@ void GFLOVRouter::_SWAllocUpdate( )
         << ")." << endl;
     }
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = item.output;
 
     if(expanded_output >= 0) {
 
@@ -1179,11 +1177,11 @@ void GFLOVRouter::_SWAllocUpdate( )
         int match_prio = numeric_limits<int>::min();
 
         const OutputSet * route_set = cur_buf->GetRouteSet(vc);
-        set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+        OutputSet::ElementSet const setlist = route_set->GetSet();
 
         assert(!_noq || (setlist.size() == 1));
 
-        for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+        for(OutputSet::ElementSet::const_iterator iset = setlist.begin();
             iset != setlist.end();
             ++iset) {
           if(iset->output_port == output) {
@@ -1272,10 +1270,9 @@ void GFLOVRouter::_SWAllocUpdate( )
             }
             if (cur_buf->GetState(vc) == VC::vc_alloc) {
               assert(_speculative);
-              pair<int, int> input_vc = make_pair(input, vc);
               for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-                pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-                if (item.second.first == input_vc) {
+                sVCRecord item = _vc_alloc_vcs[i];
+                if ((item.input == input) && (item.vc == vc)) {
                   _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
                   break;
                 }
@@ -1287,7 +1284,7 @@ void GFLOVRouter::_SWAllocUpdate( )
             }
             cur_buf->ClearRouteSet(vc);
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+            _route_vcs.push_back(sRouteRecord(-1, input, vc));
             _sw_alloc_vcs.pop_front();
             continue;
           }
@@ -1359,10 +1356,10 @@ void GFLOVRouter::_SWAllocUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(sCrossbarRecord(-1, f, expanded_input, expanded_output));
 
-      if(_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
       _out_queue_credits[input]->vc.insert(vc);
 
@@ -1378,7 +1375,7 @@ void GFLOVRouter::_SWAllocUpdate( )
           assert(nf->head);
           if(_routing_delay) {
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           } else {
             if(nf->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1390,12 +1387,10 @@ void GFLOVRouter::_SWAllocUpdate( )
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
             if(_speculative) {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_vc_allocator) {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_noq) {
               _UpdateNOQ(input, vc, nf);
@@ -1415,11 +1410,9 @@ void GFLOVRouter::_SWAllocUpdate( )
             _switch_hold_vc[expanded_input] = vc;
             _switch_hold_in[expanded_input] = expanded_output;
             _switch_hold_out[expanded_output] = expanded_input;
-            _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                    -1)));
+            _sw_hold_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
           } else {
-            _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                    -1)));
+            _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
           }
         }
       }
@@ -1443,10 +1436,10 @@ void GFLOVRouter::_SWAllocUpdate( )
           OutputSet const * route_set = cur_buf->GetRouteSet(vc);
           assert(route_set);
 
-          set<OutputSet::sSetElement> setlist = route_set->GetSet();
+          OutputSet::ElementSet setlist = route_set->GetSet();
 
           bool delete_route = false;
-          set<OutputSet::sSetElement>::iterator iset = setlist.begin();
+          OutputSet::ElementSet::iterator iset = setlist.begin();
           while (iset != setlist.end()) {
 
             int const out_port = iset->output_port;
@@ -1463,9 +1456,7 @@ void GFLOVRouter::_SWAllocUpdate( )
             }
 
             if (delete_route) {
-              set<OutputSet::sSetElement>::iterator iter = iset;
-              ++iset;
-              setlist.erase(iter);
+              iset = setlist.erase(iset);
             } else {
               ++iset;
             }
@@ -1473,10 +1464,9 @@ void GFLOVRouter::_SWAllocUpdate( )
 
           if (setlist.empty()) {
             back_to_route = true;
-            pair<int, int> input_vc = make_pair(input, vc);
             for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-              pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-              if (item.second.first == input_vc) {
+              sVCRecord item = _vc_alloc_vcs[i];
+              if ((item.input == input) && (item.vc == vc)) {
                 _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
                 break;
               }
@@ -1505,7 +1495,7 @@ void GFLOVRouter::_SWAllocUpdate( )
         if (back_to_route) {
           cur_buf->ClearRouteSet(vc);
           cur_buf->SetState(vc, VC::routing);
-          _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+          _route_vcs.push_back(sRouteRecord(-1, input, vc));
           _sw_alloc_vcs.pop_front();
           continue;
         }
@@ -1538,9 +1528,9 @@ void GFLOVRouter::_SWAllocUpdate( )
 #endif
 
       /* ==== Power Gate - Begin ==== */
-      int const input = item.second.first.first;
+      int const input = item.input;
       assert((input >= 0) && (input < _inputs));
-      int const vc = item.second.first.second;
+      int const vc = item.vc;
       assert((vc >= 0) && (vc < _vcs));
       Buffer * const cur_buf = _buf[input];
       int const escape_vc = 0;
@@ -1552,7 +1542,7 @@ void GFLOVRouter::_SWAllocUpdate( )
           assert((dest_vc >= 0) && (dest_vc < _vcs));
           BufferState * const dest_buf = _next_buf[dest_output];
           dest_buf->ReturnBuffer(dest_vc);
-          _route_vcs.push_back(make_pair(-1, item.second.first));
+          _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           cur_buf->SetState(vc, VC::routing);
         } else {
           assert(cur_buf->GetState(vc) == VC::vc_alloc);
@@ -1560,19 +1550,18 @@ void GFLOVRouter::_SWAllocUpdate( )
           assert(dest_output == -1);
           int const dest_vc = cur_buf->GetOutputVC(vc);
           assert(dest_vc == -1);
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _vc_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
               break;
             }
           }
-          _route_vcs.push_back(make_pair(-1, item.second.first));
+          _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           cur_buf->SetState(vc, VC::routing);
         }
       } else {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+        _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
       }
       /* ==== Power Gate - End ==== */
     }
@@ -1589,15 +1578,12 @@ void GFLOVRouter::_SWAllocUpdate( )
 
 void GFLOVRouter::_OutputQueuing( )
 {
-  for(map<int, Credit *>::const_iterator iter = _out_queue_credits.begin();
-      iter != _out_queue_credits.end();
-      ++iter) {
+  for(int input = 0; input < _inputs; ++input) {
 
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
-
-    Credit * const c = iter->second;
-    assert(c);
+    Credit * const c = _out_queue_credits[input];
+    if(!c) {
+      continue;
+    }
     assert(!c->vc.empty());
 
     _credit_buffer[input].push(c);
@@ -1659,14 +1645,13 @@ void GFLOVRouter::_FlovStep() {
     assert(_in_queue_flits.empty());
 
   // process flits
-  for (map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-       iter != _in_queue_flits.end(); ++iter) {
-
-    int const input = iter->first;
-    assert((input >= 0) && (input < 4));
+  for(int input = 0; input < _inputs; ++input) {
 
-    Flit * const f = iter->second;
-    assert(f);
+    Flit * const f = _in_queue_flits[input];
+    if(!f) {
+      continue;
+    }
+    assert(input < 4);
 
     int const vc = f->vc;
     assert((vc >= 0) && (vc < _vcs));
@@ -1702,23 +1687,23 @@ void GFLOVRouter::_FlovStep() {
   // off routers also process credits to make an image
   while (!_proc_credits.empty()) {
 
-    pair<int, pair<Credit *, int> > const & item = _proc_credits.front();
+    sCreditRecord const item = _proc_credits.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if (GetSimTime() < time) {
       break;
     }
 
-    Credit * const c = item.second.first;
+    Credit * const c = item.c;
     assert(c);
 
-    int const output = item.second.second;
+    int const output = item.output;
     assert((output >= 0) && (output < _outputs));
 
     BufferState * const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+    for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
       int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
@@ -1748,8 +1733,8 @@ void GFLOVRouter::_FlovStep() {
         c->Free();
       else if (_power_state == wakeup && _downstream_states[input] == power_off)
         c->Free();
-      else if (_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, c));
+      else if (!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, c);
       }
     }
 
@@ -1766,8 +1751,8 @@ void GFLOVRouter::_FlovStep() {
       ++out;
     for (int vc = 0; vc < _vcs; ++vc) {
       if (_credit_counter[out][vc] > 0) {
-        if (_out_queue_credits.count(in) == 0) {
-          _out_queue_credits.insert(make_pair(in, Credit::New()));
+        if (!_out_queue_credits[in]) {
+          _out_queue_credits.insert(in, Credit::New());
         }
         if (_out_queue_credits[in]->vc.count(vc) == 0) {
           --_credit_counter[out][vc];
@@ -1997,15 +1982,15 @@ void GFLOVRouter::_HandshakeEvaluate() {
       if ((_id - h->id == -1) || (_id - h->id == 1) || (_id - h->id == -gK)
           || (_id - h->id == gK)) {
         assert(h->src_state >= 0);
-        _neighbor_states[input] = (ePowerState) h->src_state;
+        SetNeighborPowerState(input, (ePowerState) h->src_state);
       }
     }
 
     // update logical neighbor
     if (h->logical_neighbor >= 0) {
-      _logical_neighbors[input] = h->logical_neighbor;
+      SetLogicalNeighbor(input, h->logical_neighbor);
     } else if (new_downstream_states[input] == power_off) {
-      _logical_neighbors[input] = -1;
+      SetLogicalNeighbor(input, -1);
     }
 
     // free or relaying handshake
@@ -2087,11 +2072,11 @@ void GFLOVRouter::_HandshakeResponse() {
       }
       // check ST stage, crossbar_flits
       if (drain_done)
-        for (deque<pair<int, pair<Flit *, pair<int, int> > > >::iterator iter =
+        for (RingBuffer<sCrossbarRecord>::iterator iter =
              _crossbar_flits.begin(); iter != _crossbar_flits.end(); ++iter) {
-          int const time = iter->first;
+          int const time = iter->time;
           assert(time <= GetSimTime());
-          int const expanded_output = iter->second.second.second;
+          int const expanded_output = iter->output;
           int const output = expanded_output / _output_speedup;
           assert((output >= 0) && (output < _outputs));
           if (output == out_port) {
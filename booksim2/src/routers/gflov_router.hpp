@@ -19,7 +19,7 @@ class GFLOVRouter : public IQRouter {
 protected:
 
   /* ==== Power Gate - Begin ==== */
-  deque<pair<int, Handshake *> > _proc_handshakes;
+  RingBuffer<pair<int, Handshake *> > _proc_handshakes;
 
   map<int, Handshake *> _out_queue_handshakes;
 
@@ -61,11 +61,15 @@ public:
 
   /* ==== Power Gate - Begin ==== */
   virtual void PowerStateEvaluate( );
+  // power-state timers and handshakes are evaluated every cycle
+  virtual bool Quiescent( ) const { return false; }
   /* ==== Power Gate - End ==== */
 
   virtual void ReadInputs( );
   virtual void WriteOutputs( );
 
+  virtual void Serialize( Checkpoint & cp );
+
 };
 
 #endif
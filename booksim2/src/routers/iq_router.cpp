@@ -39,6 +39,7 @@
 #include "random_utils.hpp"
 #include "vc.hpp"
 #include "routefunc.hpp"
+#include "routecache.hpp"
 #include "outputset.hpp"
 #include "buffer.hpp"
 #include "buffer_state.hpp"
@@ -79,6 +80,10 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
     Error("Invalid routing function: " + rf);
   }
   _rf = rf_iter->second;
+  _route_cache = RouteCache::New(config, this, _rf, _inputs);
+  if(_route_cache) {
+    _rf = &RouteCache::Route;
+  }
 
   // Alloc VC's
   _buf.resize(_inputs);
@@ -157,6 +162,16 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
   _noq_next_vc_start.resize(_inputs, vector<int>(_vcs, -1));
   _noq_next_vc_end.resize(_inputs, vector<int>(_vcs, -1));
 
+  // Pipeline queues, sized for one entry per input VC
+  _in_queue_flits.resize(_inputs);
+  _proc_credits = RingBuffer<sCreditRecord>(_outputs);
+  _route_vcs = RingBuffer<sRouteRecord>(_inputs*_vcs);
+  _vc_alloc_vcs = RingBuffer<sVCRecord>(_inputs*_vcs);
+  _sw_hold_vcs = RingBuffer<sVCRecord>(_inputs*_vcs);
+  _sw_alloc_vcs = RingBuffer<sVCRecord>(_inputs*_vcs);
+  _crossbar_flits = RingBuffer<sCrossbarRecord>(_inputs*_input_speedup);
+  _out_queue_credits.resize(_inputs);
+
   // Output queues
   _output_buffer_size = config.GetInt("output_buffer_size");
   _output_buffer.resize(_outputs);
@@ -288,6 +303,27 @@ void IQRouter::WriteOutputs( )
   _SendCredits( );
 }
 
+// an inactive router with drained output queues only needs to be evaluated
+// again once a flit or credit arrives
+bool IQRouter::Quiescent( ) const
+{
+  if(_active || !_in_queue_flits.empty() || !_proc_credits.empty() ||
+     !_FixedInternalSteps()) {
+    return false;
+  }
+  for(int output = 0; output < _outputs; ++output) {
+    if(!_output_buffer[output].empty()) {
+      return false;
+    }
+  }
+  for(int input = 0; input < _inputs; ++input) {
+    if(!_credit_buffer[input].empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 
 //------------------------------------------------------------------------------
 // read inputs
@@ -310,7 +346,7 @@ bool IQRouter::_ReceiveFlits( )
           << " from channel at input " << input
           << "." << endl;
       }
-      _in_queue_flits.insert(make_pair(input, f));
+      _in_queue_flits.insert(input, f);
       activity = true;
     }
   }
@@ -323,8 +359,7 @@ bool IQRouter::_ReceiveCredits( )
   for(int output = 0; output < _outputs; ++output) {
     Credit * const c = _output_credits[output]->Receive();
     if(c) {
-      _proc_credits.push_back(make_pair(GetSimTime() + _credit_delay,
-            make_pair(c, output)));
+      _proc_credits.push_back(sCreditRecord(GetSimTime() + _credit_delay, c, output));
       activity = true;
     }
   }
@@ -338,15 +373,12 @@ bool IQRouter::_ReceiveCredits( )
 
 void IQRouter::_InputQueuing( )
 {
-  for(map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-      iter != _in_queue_flits.end();
-      ++iter) {
-
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
+  for(int input = 0; input < _inputs; ++input) {
 
-    Flit * const f = iter->second;
-    assert(f);
+    Flit * const f = _in_queue_flits[input];
+    if(!f) {
+      continue;
+    }
 
     int const vc = f->vc;
     assert((vc >= 0) && (vc < _vcs));
@@ -383,7 +415,7 @@ void IQRouter::_InputQueuing( )
       assert(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] != vc);
       if(_routing_delay) {
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
       } else {
         if(f->watch) {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -395,12 +427,10 @@ void IQRouter::_InputQueuing( )
         cur_buf->SetRouteSet(vc, &f->la_route_set);
         cur_buf->SetState(vc, VC::vc_alloc);
         if(_speculative) {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                  -1)));
+          _sw_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
         }
         if(_vc_allocator) {
-          _vc_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                  -1)));
+          _vc_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
         }
         if(_noq) {
           _UpdateNOQ(input, vc, f);
@@ -409,11 +439,9 @@ void IQRouter::_InputQueuing( )
     } else if((cur_buf->GetState(vc) == VC::active) &&
         (cur_buf->FrontFlit(vc) == f)) {
       if(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] == vc) {
-        _sw_hold_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                -1)));
+        _sw_hold_vcs.push_back(sVCRecord(-1, input, vc, -1));
       } else {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                -1)));
+        _sw_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
       }
     }
   }
@@ -421,23 +449,23 @@ void IQRouter::_InputQueuing( )
 
   while(!_proc_credits.empty()) {
 
-    pair<int, pair<Credit *, int> > const & item = _proc_credits.front();
+    sCreditRecord const item = _proc_credits.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if(GetSimTime() < time) {
       break;
     }
 
-    Credit * const c = item.second.first;
+    Credit * const c = item.c;
     assert(c);
 
-    int const output = item.second.second;
+    int const output = item.output;
     assert((output >= 0) && (output < _outputs));
 
     BufferState * const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+    for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
       int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
@@ -462,19 +490,19 @@ void IQRouter::_RouteEvaluate( )
 {
   assert(_routing_delay);
 
-  for(deque<pair<int, pair<int, int> > >::iterator iter = _route_vcs.begin();
+  for(RingBuffer<sRouteRecord>::iterator iter = _route_vcs.begin();
       iter != _route_vcs.end();
       ++iter) {
 
-    int const time = iter->first;
+    int const time = iter->time;
     if(time >= 0) {
       break;
     }
-    iter->first = GetSimTime() + _routing_delay - 1;
+    iter->time = GetSimTime() + _routing_delay - 1;
 
-    int const input = iter->second.first;
+    int const input = iter->input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.second;
+    int const vc = iter->vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer const * const cur_buf = _buf[input];
@@ -502,17 +530,17 @@ void IQRouter::_RouteUpdate( )
 
   while(!_route_vcs.empty()) {
 
-    pair<int, pair<int, int> > const & item = _route_vcs.front();
+    sRouteRecord const item = _route_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer * const cur_buf = _buf[input];
@@ -535,10 +563,10 @@ void IQRouter::_RouteUpdate( )
     cur_buf->Route(vc, _rf, this, f, input);
     cur_buf->SetState(vc, VC::vc_alloc);
     if(_speculative) {
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     if(_vc_allocator) {
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     // NOTE: No need to handle NOQ here, as it requires lookahead routing!
     _route_vcs.pop_front();
@@ -556,21 +584,21 @@ void IQRouter::_VCAllocEvaluate( )
 
   bool watched = false;
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
+  for(RingBuffer<sVCRecord>::iterator iter = _vc_alloc_vcs.begin();
       iter != _vc_alloc_vcs.end();
       ++iter) {
 
-    int const time = iter->first;
+    int const time = iter->time;
     if(time >= 0) {
       break;
     }
 
-    int const input = iter->second.first.first;
+    int const input = iter->input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = iter->vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(iter->second.second == -1);
+    assert(iter->output == -1);
 
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -593,7 +621,7 @@ void IQRouter::_VCAllocEvaluate( )
     assert(route_set);
 
     int const out_priority = cur_buf->GetPriority(vc);
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    OutputSet::ElementSet const setlist = route_set->GetSet();
 
     bool elig = false;
     bool cred = false;
@@ -601,7 +629,7 @@ void IQRouter::_VCAllocEvaluate( )
 
     assert(!_noq || (setlist.size() == 1));
 
-    for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+    for(OutputSet::ElementSet::const_iterator iset = setlist.begin();
         iset != setlist.end();
         ++iset) {
 
@@ -687,9 +715,9 @@ void IQRouter::_VCAllocEvaluate( )
       }
     }
     if(!elig) {
-      iter->second.second = STALL_BUFFER_BUSY;
+      iter->output = STALL_BUFFER_BUSY;
     } else if(_vc_busy_when_full && !cred) {
-      iter->second.second = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
+      iter->output = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
     }
   }
 
@@ -705,26 +733,26 @@ void IQRouter::_VCAllocEvaluate( )
     _vc_allocator->PrintGrants( gWatchOut );
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
+  for(RingBuffer<sVCRecord>::iterator iter = _vc_alloc_vcs.begin();
       iter != _vc_alloc_vcs.end();
       ++iter) {
 
-    int const time = iter->first;
+    int const time = iter->time;
     if(time >= 0) {
       break;
     }
-    iter->first = GetSimTime() + _vc_alloc_delay - 1;
+    iter->time = GetSimTime() + _vc_alloc_delay - 1;
 
-    int const input = iter->second.first.first;
+    int const input = iter->input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = iter->vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    if(iter->second.second < -1) {
+    if(iter->output < -1) {
       continue;
     }
 
-    assert(iter->second.second == -1);
+    assert(iter->output == -1);
 
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -755,7 +783,7 @@ void IQRouter::_VCAllocEvaluate( )
           << "." << endl;
       }
 
-      iter->second.second = output_and_vc;
+      iter->output = output_and_vc;
 
     } else {
 
@@ -766,7 +794,7 @@ void IQRouter::_VCAllocEvaluate( )
           << "." << endl;
       }
 
-      iter->second.second = STALL_BUFFER_CONFLICT;
+      iter->output = STALL_BUFFER_CONFLICT;
 
     }
   }
@@ -775,19 +803,19 @@ void IQRouter::_VCAllocEvaluate( )
     return;
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
+  for(RingBuffer<sVCRecord>::iterator iter = _vc_alloc_vcs.begin();
       iter != _vc_alloc_vcs.end();
       ++iter) {
 
-    int const time = iter->first;
+    int const time = iter->time;
     assert(time >= 0);
     if(GetSimTime() < time) {
       break;
     }
 
-    assert(iter->second.second != -1);
+    assert(iter->output != -1);
 
-    int const output_and_vc = iter->second.second;
+    int const output_and_vc = iter->output;
 
     if(output_and_vc >= 0) {
 
@@ -798,9 +826,9 @@ void IQRouter::_VCAllocEvaluate( )
 
       BufferState const * const dest_buf = _next_buf[match_output];
 
-      int const input = iter->second.first.first;
+      int const input = iter->input;
       assert((input >= 0) && (input < _inputs));
-      int const vc = iter->second.first.second;
+      int const vc = iter->vc;
       assert((vc >= 0) && (vc < _vcs));
 
       Buffer const * const cur_buf = _buf[input];
@@ -821,7 +849,7 @@ void IQRouter::_VCAllocEvaluate( )
             << " at output " << match_output
             << " is no longer available." << endl;
         }
-        iter->second.second = STALL_BUFFER_BUSY;
+        iter->output = STALL_BUFFER_BUSY;
       } else if(_vc_busy_when_full && dest_buf->IsFullFor(match_vc)) {
         if(f->watch) {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -831,7 +859,7 @@ void IQRouter::_VCAllocEvaluate( )
             << " at output " << match_output
             << " has become full." << endl;
         }
-        iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+        iter->output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
       }
     }
   }
@@ -843,20 +871,20 @@ void IQRouter::_VCAllocUpdate( )
 
   while(!_vc_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _vc_alloc_vcs.front();
+    sVCRecord const item = _vc_alloc_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(item.output != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -875,7 +903,7 @@ void IQRouter::_VCAllocUpdate( )
         << ")." << endl;
     }
 
-    int const output_and_vc = item.second.second;
+    int const output_and_vc = item.output;
 
     if(output_and_vc >= 0) {
 
@@ -899,7 +927,7 @@ void IQRouter::_VCAllocUpdate( )
       cur_buf->SetOutput(vc, match_output, match_vc);
       cur_buf->SetState(vc, VC::active);
       if(!_speculative) {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+        _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
       }
     } else {
       if(f->watch) {
@@ -917,7 +945,7 @@ void IQRouter::_VCAllocUpdate( )
       }
 #endif
 
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     _vc_alloc_vcs.pop_front();
   }
@@ -932,22 +960,22 @@ void IQRouter::_SWHoldEvaluate( )
 {
   assert(_hold_switch_for_packet);
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_hold_vcs.begin();
+  for(RingBuffer<sVCRecord>::iterator iter = _sw_hold_vcs.begin();
       iter != _sw_hold_vcs.end();
       ++iter) {
 
-    int const time = iter->first;
+    int const time = iter->time;
     if(time >= 0) {
       break;
     }
-    iter->first = GetSimTime();
+    iter->time = GetSimTime();
 
-    int const input = iter->second.first.first;
+    int const input = iter->input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = iter->vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(iter->second.second == -1);
+    assert(iter->output == -1);
 
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -987,7 +1015,7 @@ void IQRouter::_SWHoldEvaluate( )
           << "." << (expanded_output % _output_speedup)
           << ": No credit available." << endl;
       }
-      iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+      iter->output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
     } else {
       if(f->watch) {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -997,7 +1025,7 @@ void IQRouter::_SWHoldEvaluate( )
           << "." << (expanded_output % _output_speedup)
           << "." << endl;
       }
-      iter->second.second = expanded_output;
+      iter->output = expanded_output;
     }
   }
 }
@@ -1008,20 +1036,20 @@ void IQRouter::_SWHoldUpdate( )
 
   while(!_sw_hold_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_hold_vcs.front();
+    sVCRecord const item = _sw_hold_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if(time < 0) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(item.output != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -1042,7 +1070,7 @@ void IQRouter::_SWHoldUpdate( )
     int const expanded_input = input * _input_speedup + vc % _input_speedup;
     assert(_switch_hold_vc[expanded_input] == vc);
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = item.output;
 
     if(expanded_output >= 0 && ( _output_buffer_size==-1 || _output_buffer[expanded_output].size()<size_t(_output_buffer_size))) {
 
@@ -1121,12 +1149,12 @@ void IQRouter::_SWHoldUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(sCrossbarRecord(-1, f, expanded_input, expanded_output));
 
-      if(_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
+      _out_queue_credits[input]->vc.insert(vc);
 
       if(cur_buf->Empty(vc)) {
         if(f->watch) {
@@ -1162,7 +1190,7 @@ void IQRouter::_SWHoldUpdate( )
           _switch_hold_out[expanded_output] = -1;
           if(_routing_delay) {
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           } else {
             if(nf->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1174,20 +1202,17 @@ void IQRouter::_SWHoldUpdate( )
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
             if(_speculative) {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_vc_allocator) {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_noq) {
               _UpdateNOQ(input, vc, nf);
             }
           }
         } else {
-          _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                  -1)));
+          _sw_hold_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
         }
       }
     } else {
@@ -1209,8 +1234,7 @@ void IQRouter::_SWHoldUpdate( )
       _switch_hold_vc[expanded_input] = -1;
       _switch_hold_in[expanded_input] = -1;
       _switch_hold_out[held_expanded_output] = -1;
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-              -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     _sw_hold_vcs.pop_front();
   }
@@ -1328,21 +1352,21 @@ void IQRouter::_SWAllocEvaluate( )
 {
   bool watched = false;
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
+  for(RingBuffer<sVCRecord>::iterator iter = _sw_alloc_vcs.begin();
       iter != _sw_alloc_vcs.end();
       ++iter) {
 
-    int const time = iter->first;
+    int const time = iter->time;
     if(time >= 0) {
       break;
     }
 
-    int const input = iter->second.first.first;
+    int const input = iter->input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = iter->vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(iter->second.second == -1);
+    assert(iter->output == -1);
 
     assert(_switch_hold_vc[input * _input_speedup + vc % _input_speedup] != vc);
 
@@ -1379,7 +1403,7 @@ void IQRouter::_SWAllocEvaluate( )
             << " at output " << dest_output
             << " is full." << endl;
         }
-        iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+        iter->output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
         continue;
       }
       bool const requested = _SWAllocAddReq(input, vc, dest_output);
@@ -1397,11 +1421,11 @@ void IQRouter::_SWAllocEvaluate( )
     OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
     assert(route_set);
 
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    OutputSet::ElementSet const setlist = route_set->GetSet();
 
     assert(!_noq || (setlist.size() == 1));
 
-    for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+    for(OutputSet::ElementSet::const_iterator iset = setlist.begin();
         iset != setlist.end();
         ++iset) {
 
@@ -1455,14 +1479,14 @@ void IQRouter::_SWAllocEvaluate( )
             << "  Output " << dest_output
             << " has no suitable VCs available." << endl;
         }
-        iter->second.second = STALL_BUFFER_BUSY;
+        iter->output = STALL_BUFFER_BUSY;
       } else if(_spec_check_cred && !cred) {
         if(f->watch) {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | "
             << "  All suitable VCs at output " << dest_output
             << " are full." << endl;
         }
-        iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+        iter->output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
       } else {
         bool const requested = _SWAllocAddReq(input, vc, dest_output);
         watched |= requested && f->watch;
@@ -1492,26 +1516,26 @@ void IQRouter::_SWAllocEvaluate( )
     }
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
+  for(RingBuffer<sVCRecord>::iterator iter = _sw_alloc_vcs.begin();
       iter != _sw_alloc_vcs.end();
       ++iter) {
 
-    int const time = iter->first;
+    int const time = iter->time;
     if(time >= 0) {
       break;
     }
-    iter->first = GetSimTime() + _sw_alloc_delay - 1;
+    iter->time = GetSimTime() + _sw_alloc_delay - 1;
 
-    int const input = iter->second.first.first;
+    int const input = iter->input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = iter->vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    if(iter->second.second < -1) {
+    if(iter->output < -1) {
       continue;
     }
 
-    assert(iter->second.second == -1);
+    assert(iter->output == -1);
 
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -1540,7 +1564,7 @@ void IQRouter::_SWAllocEvaluate( )
             << "." << endl;
         }
         _sw_rr_offset[expanded_input] = (vc + _input_speedup) % _vcs;
-        iter->second.second = expanded_output;
+        iter->output = expanded_output;
       } else {
         if(f->watch) {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1548,7 +1572,7 @@ void IQRouter::_SWAllocEvaluate( )
             << " at input " << input
             << ": Granted to VC " << granted_vc << "." << endl;
         }
-        iter->second.second = STALL_CROSSBAR_CONFLICT;
+        iter->output = STALL_CROSSBAR_CONFLICT;
       }
     } else if(_spec_sw_allocator) {
       expanded_output = _spec_sw_allocator->OutputAssigned(expanded_input);
@@ -1565,7 +1589,7 @@ void IQRouter::_SWAllocEvaluate( )
               << "." << (expanded_output % _output_speedup)
               << " has non-speculative requests." << endl;
           }
-          iter->second.second = STALL_CROSSBAR_CONFLICT;
+          iter->output = STALL_CROSSBAR_CONFLICT;
         } else if(!_spec_mask_by_reqs &&
             (_sw_allocator->InputAssigned(expanded_output) >= 0)) {
           if(f->watch) {
@@ -1577,7 +1601,7 @@ void IQRouter::_SWAllocEvaluate( )
               << "." << (expanded_output % _output_speedup)
               << " has a non-speculative grant." << endl;
           }
-          iter->second.second = STALL_CROSSBAR_CONFLICT;
+          iter->output = STALL_CROSSBAR_CONFLICT;
         } else {
           int const granted_vc = _spec_sw_allocator->ReadRequest(expanded_input,
               expanded_output);
@@ -1592,7 +1616,7 @@ void IQRouter::_SWAllocEvaluate( )
                 << "." << endl;
             }
             _sw_rr_offset[expanded_input] = (vc + _input_speedup) % _vcs;
-            iter->second.second = expanded_output;
+            iter->output = expanded_output;
           } else {
             if(f->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1600,7 +1624,7 @@ void IQRouter::_SWAllocEvaluate( )
                 << " at input " << input
                 << ": Granted to VC " << granted_vc << "." << endl;
             }
-            iter->second.second = STALL_CROSSBAR_CONFLICT;
+            iter->output = STALL_CROSSBAR_CONFLICT;
           }
         }
       } else {
@@ -1612,7 +1636,7 @@ void IQRouter::_SWAllocEvaluate( )
             << ": No output granted." << endl;
         }
 
-        iter->second.second = STALL_CROSSBAR_CONFLICT;
+        iter->output = STALL_CROSSBAR_CONFLICT;
 
       }
     } else {
@@ -1624,7 +1648,7 @@ void IQRouter::_SWAllocEvaluate( )
           << ": No output granted." << endl;
       }
 
-      iter->second.second = STALL_CROSSBAR_CONFLICT;
+      iter->output = STALL_CROSSBAR_CONFLICT;
 
     }
   }
@@ -1633,19 +1657,19 @@ void IQRouter::_SWAllocEvaluate( )
     return;
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
+  for(RingBuffer<sVCRecord>::iterator iter = _sw_alloc_vcs.begin();
       iter != _sw_alloc_vcs.end();
       ++iter) {
 
-    int const time = iter->first;
+    int const time = iter->time;
     assert(time >= 0);
     if(GetSimTime() < time) {
       break;
     }
 
-    assert(iter->second.second != -1);
+    assert(iter->output != -1);
 
-    int const expanded_output = iter->second.second;
+    int const expanded_output = iter->output;
 
     if(expanded_output >= 0) {
 
@@ -1654,10 +1678,10 @@ void IQRouter::_SWAllocEvaluate( )
 
       BufferState const * const dest_buf = _next_buf[output];
 
-      int const input = iter->second.first.first;
+      int const input = iter->input;
       assert((input >= 0) && (input < _inputs));
       assert((input % _output_speedup) == (expanded_output % _output_speedup));
-      int const vc = iter->second.first.second;
+      int const vc = iter->vc;
       assert((vc >= 0) && (vc < _vcs));
 
       int const expanded_input = input * _input_speedup + vc % _input_speedup;
@@ -1693,7 +1717,7 @@ void IQRouter::_SWAllocEvaluate( )
           }
           *gWatchOut << "." << endl;
         }
-        iter->second.second = STALL_CROSSBAR_CONFLICT;
+        iter->output = STALL_CROSSBAR_CONFLICT;
       } else if(_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)) {
 
         assert(f->head);
@@ -1713,7 +1737,7 @@ void IQRouter::_SWAllocEvaluate( )
                 << "." << (expanded_output % _output_speedup)
                 << " due to misspeculation." << endl;
             }
-            iter->second.second = -1; // stall is counted in VC allocation path!
+            iter->output = -1; // stall is counted in VC allocation path!
           } else if((output_and_vc / _vcs) != output) {
             if(f->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1723,7 +1747,7 @@ void IQRouter::_SWAllocEvaluate( )
                 << "." << (expanded_output % _output_speedup)
                 << " due to port mismatch between VC and switch allocator." << endl;
             }
-            iter->second.second = STALL_BUFFER_CONFLICT; // count this case as if we had failed allocation
+            iter->output = STALL_BUFFER_CONFLICT; // count this case as if we had failed allocation
           } else if(dest_buf->IsFullFor((output_and_vc % _vcs))) {
             if(f->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1733,7 +1757,7 @@ void IQRouter::_SWAllocEvaluate( )
                 << "." << (expanded_output % _output_speedup)
                 << " due to lack of credit." << endl;
             }
-            iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+            iter->output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
           }
 
         } else { // VC allocation is piggybacked onto switch allocation
@@ -1741,7 +1765,7 @@ void IQRouter::_SWAllocEvaluate( )
           OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
           assert(route_set);
 
-          set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+          OutputSet::ElementSet const setlist = route_set->GetSet();
 
           bool busy = true;
           bool full = true;
@@ -1749,7 +1773,7 @@ void IQRouter::_SWAllocEvaluate( )
 
           assert(!_noq || (setlist.size() == 1));
 
-          for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+          for(OutputSet::ElementSet::const_iterator iset = setlist.begin();
               iset != setlist.end();
               ++iset) {
             if(iset->output_port == output) {
@@ -1796,7 +1820,7 @@ void IQRouter::_SWAllocEvaluate( )
                 << "." << (expanded_output % _output_speedup)
                 << " because no suitable output VC for piggyback allocation is available." << endl;
             }
-            iter->second.second = STALL_BUFFER_BUSY;
+            iter->output = STALL_BUFFER_BUSY;
           } else if(full) {
             if(f->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1806,7 +1830,7 @@ void IQRouter::_SWAllocEvaluate( )
                 << "." << (expanded_output % _output_speedup)
                 << " because all suitable output VCs for piggyback allocation are full." << endl;
             }
-            iter->second.second = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
+            iter->output = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
           }
 
         }
@@ -1826,7 +1850,7 @@ void IQRouter::_SWAllocEvaluate( )
               << "." << (expanded_output % _output_speedup)
               << " due to lack of credit." << endl;
           }
-          iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+          iter->output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
         }
       }
     }
@@ -1837,17 +1861,17 @@ void IQRouter::_SWAllocUpdate( )
 {
   while(!_sw_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_alloc_vcs.front();
+    sVCRecord const item = _sw_alloc_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer * const cur_buf = _buf[input];
@@ -1867,7 +1891,7 @@ void IQRouter::_SWAllocUpdate( )
         << ")." << endl;
     }
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = item.output;
 
     if(expanded_output >= 0) {
 
@@ -1896,11 +1920,11 @@ void IQRouter::_SWAllocUpdate( )
         int match_prio = numeric_limits<int>::min();
 
         const OutputSet * route_set = cur_buf->GetRouteSet(vc);
-        set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+        OutputSet::ElementSet const setlist = route_set->GetSet();
 
         assert(!_noq || (setlist.size() == 1));
 
-        for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+        for(OutputSet::ElementSet::const_iterator iset = setlist.begin();
             iset != setlist.end();
             ++iset) {
           if(iset->output_port == output) {
@@ -2031,12 +2055,12 @@ void IQRouter::_SWAllocUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(sCrossbarRecord(-1, f, expanded_input, expanded_output));
 
-      if(_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
+      _out_queue_credits[input]->vc.insert(vc);
 
       if(cur_buf->Empty(vc)) {
         if(f->tail) {
@@ -2050,7 +2074,7 @@ void IQRouter::_SWAllocUpdate( )
           assert(nf->head);
           if(_routing_delay) {
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           } else {
             if(nf->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -2062,12 +2086,10 @@ void IQRouter::_SWAllocUpdate( )
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
             if(_speculative) {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_vc_allocator) {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_noq) {
               _UpdateNOQ(input, vc, nf);
@@ -2087,11 +2109,9 @@ void IQRouter::_SWAllocUpdate( )
             _switch_hold_vc[expanded_input] = vc;
             _switch_hold_in[expanded_input] = expanded_output;
             _switch_hold_out[expanded_output] = expanded_input;
-            _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                    -1)));
+            _sw_hold_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
           } else {
-            _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                    -1)));
+            _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
           }
         }
       }
@@ -2121,7 +2141,7 @@ void IQRouter::_SWAllocUpdate( )
       }
 #endif
 
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     _sw_alloc_vcs.pop_front();
   }
@@ -2134,21 +2154,21 @@ void IQRouter::_SWAllocUpdate( )
 
 void IQRouter::_SwitchEvaluate( )
 {
-  for(deque<pair<int, pair<Flit *, pair<int, int> > > >::iterator iter = _crossbar_flits.begin();
+  for(RingBuffer<sCrossbarRecord>::iterator iter = _crossbar_flits.begin();
       iter != _crossbar_flits.end();
       ++iter) {
 
-    int const time = iter->first;
+    int const time = iter->time;
     if(time >= 0) {
       break;
     }
-    iter->first = GetSimTime() + _crossbar_delay - 1;
+    iter->time = GetSimTime() + _crossbar_delay - 1;
 
-    Flit const * const f = iter->second.first;
+    Flit const * const f = iter->f;
     assert(f);
 
-    int const expanded_input = iter->second.second.first;
-    int const expanded_output = iter->second.second.second;
+    int const expanded_input = iter->input;
+    int const expanded_output = iter->output;
 
     if(f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -2166,21 +2186,21 @@ void IQRouter::_SwitchUpdate( )
 {
   while(!_crossbar_flits.empty()) {
 
-    pair<int, pair<Flit *, pair<int, int> > > const & item = _crossbar_flits.front();
+    sCrossbarRecord const item = _crossbar_flits.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    Flit * const f = item.second.first;
+    Flit * const f = item.f;
     assert(f);
 
-    int const expanded_input = item.second.second.first;
+    int const expanded_input = item.input;
     int const input = expanded_input / _input_speedup;
     assert((input >= 0) && (input < _inputs));
-    int const expanded_output = item.second.second.second;
+    int const expanded_output = item.output;
     int const output = expanded_output / _output_speedup;
     assert((output >= 0) && (output < _outputs));
 
@@ -2217,15 +2237,12 @@ void IQRouter::_SwitchUpdate( )
 
 void IQRouter::_OutputQueuing( )
 {
-  for(map<int, Credit *>::const_iterator iter = _out_queue_credits.begin();
-      iter != _out_queue_credits.end();
-      ++iter) {
-
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
+  for(int input = 0; input < _inputs; ++input) {
 
-    Credit * const c = iter->second;
-    assert(c);
+    Credit * const c = _out_queue_credits[input];
+    if(!c) {
+      continue;
+    }
     assert(!c->vc.empty());
 
     _credit_buffer[input].push(c);
@@ -2363,7 +2380,7 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
   assert(f);
   assert(f->vc == vc);
   assert(f->head);
-  set<OutputSet::sSetElement> sl = f->la_route_set.GetSet();
+  OutputSet::ElementSet sl = f->la_route_set.GetSet();
   assert(sl.size() == 1);
   int out_port = sl.begin()->output_port;
   const FlitChannel * channel = _output_channels[out_port];
@@ -2396,3 +2413,119 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
     }
   }
 }
+
+void IQRouter::Serialize( Checkpoint & cp )
+{
+  Router::Serialize( cp );
+
+  cp.Check( _vcs, FullName( ) + " VCs" );
+
+  cp.Sync( _active );
+
+  _Sync( cp, _in_queue_flits );
+  _Sync( cp, _proc_credits );
+  _Sync( cp, _route_vcs );
+  _Sync( cp, _vc_alloc_vcs );
+  _Sync( cp, _sw_hold_vcs );
+  _Sync( cp, _sw_alloc_vcs );
+  _Sync( cp, _crossbar_flits );
+  _Sync( cp, _out_queue_credits );
+
+  for ( int i = 0; i < _inputs; ++i ) {
+    _buf[i]->Serialize( cp );
+  }
+  for ( int o = 0; o < _outputs; ++o ) {
+    _next_buf[o]->Serialize( cp );
+  }
+
+  // the requests are cleared in every cycle, only the priority pointers
+  // carry over
+  if ( _vc_allocator ) {
+    _vc_allocator->Serialize( cp );
+  }
+  _sw_allocator->Serialize( cp );
+  if ( _spec_sw_allocator ) {
+    _spec_sw_allocator->Serialize( cp );
+  }
+  cp.Sync( _vc_rr_offset );
+  cp.Sync( _sw_rr_offset );
+
+  cp.Sync( _output_buffer );
+  cp.Sync( _credit_buffer );
+
+  cp.Sync( _switch_hold_in );
+  cp.Sync( _switch_hold_out );
+  cp.Sync( _switch_hold_vc );
+
+  cp.Sync( _noq_next_output_port );
+  cp.Sync( _noq_next_vc_start );
+  cp.Sync( _noq_next_vc_end );
+
+  _switchMonitor->Serialize( cp );
+  _bufferMonitor->Serialize( cp );
+}
+
+void IQRouter::_Sync( Checkpoint & cp, sRouteRecord & r )
+{
+  cp.Sync( r.time );
+  cp.Sync( r.input );
+  cp.Sync( r.vc );
+}
+
+void IQRouter::_Sync( Checkpoint & cp, sVCRecord & r )
+{
+  cp.Sync( r.time );
+  cp.Sync( r.input );
+  cp.Sync( r.vc );
+  cp.Sync( r.output );
+}
+
+void IQRouter::_Sync( Checkpoint & cp, sCreditRecord & r )
+{
+  cp.Sync( r.time );
+  cp.Sync( r.c );
+  cp.Sync( r.output );
+}
+
+void IQRouter::_Sync( Checkpoint & cp, sCrossbarRecord & r )
+{
+  cp.Sync( r.time );
+  cp.Sync( r.f );
+  cp.Sync( r.input );
+  cp.Sync( r.output );
+}
+
+template<class R>
+void IQRouter::_Sync( Checkpoint & cp, RingBuffer<R> & records )
+{
+  int const size = cp.SyncSize( records.size( ) );
+  if ( cp.Loading( ) ) {
+    records.clear( );
+    for ( int i = 0; i < size; ++i ) {
+      records.push_back( R( ) );
+    }
+  }
+  for ( int i = 0; i < size; ++i ) {
+    _Sync( cp, records[i] );
+  }
+}
+
+template<class T>
+void IQRouter::_Sync( Checkpoint & cp, PortArray<T> & items )
+{
+  int const ports = items.size( );
+  cp.Check( ports, "ports" );
+  vector<T *> v( ports );
+  for ( int p = 0; p < ports; ++p ) {
+    v[p] = items[p];
+  }
+  if ( cp.Loading( ) ) {
+    items.clear( );
+  }
+  for ( int p = 0; p < ports; ++p ) {
+    cp.Sync( v[p] );
+    if ( cp.Loading( ) && v[p] ) {
+      items.insert( p, v[p] );
+    }
+  }
+}
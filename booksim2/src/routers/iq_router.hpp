@@ -36,6 +36,7 @@
 
 #include "router.hpp"
 #include "routefunc.hpp"
+#include "ring_buffer.hpp"
 
 using namespace std;
 
@@ -69,18 +70,54 @@ protected:
   int _vc_alloc_delay;
   int _sw_alloc_delay;
 
-  map<int, Flit *> _in_queue_flits;
-
-  deque<pair<int, pair<Credit *, int> > > _proc_credits;
-
-  deque<pair<int, pair<int, int> > > _route_vcs;
-  deque<pair<int, pair<pair<int, int>, int> > > _vc_alloc_vcs;
-  deque<pair<int, pair<pair<int, int>, int> > > _sw_hold_vcs;
-  deque<pair<int, pair<pair<int, int>, int> > > _sw_alloc_vcs;
-
-  deque<pair<int, pair<Flit *, pair<int, int> > > > _crossbar_flits;
-
-  map<int, Credit *> _out_queue_credits;
+  // pipeline stage entries; the time is -1 until the entry has been
+  // evaluated, and then the cycle in which the stage completes
+  struct sRouteRecord {
+    int time;
+    int input;
+    int vc;
+    sRouteRecord( int t = -1, int i = -1, int v = -1 )
+      : time( t ), input( i ), vc( v ) {}
+  };
+  // output is the allocated output and VC (VC allocation) or the expanded
+  // output port (switch allocation), -1 or a stall code until then
+  struct sVCRecord {
+    int time;
+    int input;
+    int vc;
+    int output;
+    sVCRecord( int t = -1, int i = -1, int v = -1, int o = -1 )
+      : time( t ), input( i ), vc( v ), output( o ) {}
+  };
+  struct sCreditRecord {
+    int time;
+    Credit * c;
+    int output;
+    sCreditRecord( int t = -1, Credit * cred = 0, int o = -1 )
+      : time( t ), c( cred ), output( o ) {}
+  };
+  // input and output are expanded crossbar ports
+  struct sCrossbarRecord {
+    int time;
+    Flit * f;
+    int input;
+    int output;
+    sCrossbarRecord( int t = -1, Flit * flit = 0, int i = -1, int o = -1 )
+      : time( t ), f( flit ), input( i ), output( o ) {}
+  };
+
+  PortArray<Flit> _in_queue_flits;
+
+  RingBuffer<sCreditRecord> _proc_credits;
+
+  RingBuffer<sRouteRecord> _route_vcs;
+  RingBuffer<sVCRecord> _vc_alloc_vcs;
+  RingBuffer<sVCRecord> _sw_hold_vcs;
+  RingBuffer<sVCRecord> _sw_alloc_vcs;
+
+  RingBuffer<sCrossbarRecord> _crossbar_flits;
+
+  PortArray<Credit> _out_queue_credits;
 
   vector<Buffer *> _buf;
   vector<BufferState *> _next_buf;
@@ -141,6 +178,15 @@ protected:
 
   void _UpdateNOQ(int input, int vc, Flit const * f);
 
+  static void _Sync( Checkpoint & cp, sRouteRecord & r );
+  static void _Sync( Checkpoint & cp, sVCRecord & r );
+  static void _Sync( Checkpoint & cp, sCreditRecord & r );
+  static void _Sync( Checkpoint & cp, sCrossbarRecord & r );
+  template<class R>
+  static void _Sync( Checkpoint & cp, RingBuffer<R> & records );
+  template<class T>
+  static void _Sync( Checkpoint & cp, PortArray<T> & items );
+
   // ----------------------------------------
   //
   //   Router Power Modellingyes
@@ -163,6 +209,10 @@ public:
   virtual void ReadInputs( );
   virtual void WriteOutputs( );
 
+  virtual bool Quiescent( ) const;
+
+  virtual void Serialize( Checkpoint & cp );
+
   void Display( ostream & os = cout ) const;
 
   /* ==== Power Gate - Begin ==== */
@@ -27,6 +27,7 @@
 #include "allocator.hpp"
 #include "switch_monitor.hpp"
 #include "buffer_monitor.hpp"
+#include "checkpoint.hpp"
 
 NoRDRouter::NoRDRouter( Configuration const & config, Module *parent,
     string const & name, int id, int inputs, int outputs )
@@ -119,6 +120,19 @@ NoRDRouter::~NoRDRouter( )
   }
 }
 
+void NoRDRouter::Serialize( Checkpoint & cp )
+{
+  IQRouter::Serialize( cp );
+  /* ==== Power Gate - Begin ==== */
+  assert(_proc_handshakes.empty() && _out_queue_handshakes.empty());
+  cp.Sync( _handshake_buffer );
+  cp.Sync( _credit_counter );
+  cp.Sync( _pending_credits );
+  cp.Sync( _outstanding_bypass_packets );
+  cp.Sync( _wakeup_monitor_vc_requests );
+  /* ==== Power Gate - End ==== */
+}
+
 void NoRDRouter::ReadInputs( )
 {
   bool have_flits = _ReceiveFlits( );
@@ -389,6 +403,82 @@ void NoRDRouter::PowerStateEvaluate()
       Error(err.str());
   }
 }
+
+// besides an empty datapath, no handshakes may be in flight and no
+// neighbor may be draining or waking up, since the handshake responses are
+// evaluated every cycle
+bool NoRDRouter::Quiescent( ) const
+{
+  if (!IQRouter::Quiescent() || (_pending_credits > 0) ||
+      !_proc_handshakes.empty() || !_out_queue_handshakes.empty()) {
+    return false;
+  }
+  for (int out = 0; out < 4; ++out) {
+    if (!_handshake_buffer[out].empty() ||
+        _neighbor_states[out] == draining ||
+        _neighbor_states[out] == wakeup) {
+      return false;
+    }
+  }
+  return (NextPowerEventCycle() > 0);
+}
+
+// number of cycles, starting with the next evaluation, in which the power
+// state machine only advances its timers
+int NoRDRouter::NextPowerEventCycle( ) const
+{
+  int const never = numeric_limits<int>::max();
+
+  if (_id >= gNodes - gK)
+    return never;
+
+  switch (_power_state) {
+    case power_on:
+      if (_wakeup_signal)
+        return 0;
+      if (_router_state)
+        return never;
+      return max(0, _idle_threshold - _idle_timer);
+
+    case power_off:
+      if (_nord_wakeup_threshold > 0 && _wakeup_monitor_vc_requests > 0)
+        return 0;
+      if (!_wakeup_signal)
+        return never;
+      return max(0, _bet_threshold - _off_timer - 1);
+
+    case wakeup:
+      return max(0, _wakeup_threshold - _wakeup_timer - 1);
+
+    default:
+      return 0;
+  }
+}
+
+void NoRDRouter::SynchronizeCycle( int cycles )
+{
+  if (_id >= gNodes - gK)
+    return;
+
+  switch (_power_state) {
+    case power_on:
+      _idle_timer += cycles;
+      break;
+
+    case power_off:
+      _off_timer += cycles;
+      _power_off_cycles += cycles;
+      _total_power_off_cycles += cycles;
+      break;
+
+    case wakeup:
+      _wakeup_timer += cycles;
+      break;
+
+    default:
+      break;
+  }
+}
 /* ==== Power Gate - End ==== */
 
 
@@ -496,7 +586,7 @@ bool NoRDRouter::_ReceiveFlits( )
           << " from channel at input " << input
           << "." << endl;
       }
-      _in_queue_flits.insert(make_pair(input, f));
+      _in_queue_flits.insert(input, f);
       activity = true;
       _idle_timer = 0;
 
@@ -527,15 +617,12 @@ void NoRDRouter::_ReceiveHandshakes()
 
 void NoRDRouter::_InputQueuing( )
 {
-  for(map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-      iter != _in_queue_flits.end();
-      ++iter) {
-
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
+  for(int input = 0; input < _inputs; ++input) {
 
-    Flit * const f = iter->second;
-    assert(f);
+    Flit * const f = _in_queue_flits[input];
+    if(!f) {
+      continue;
+    }
 
     int const vc = f->vc;
     assert((vc >= 0) && (vc < _vcs));
@@ -581,7 +668,7 @@ void NoRDRouter::_InputQueuing( )
       assert(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] != vc);
       if(_routing_delay) {
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
       } else {
         if(f->watch) {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -593,12 +680,10 @@ void NoRDRouter::_InputQueuing( )
         cur_buf->SetRouteSet(vc, &f->la_route_set);
         cur_buf->SetState(vc, VC::vc_alloc);
         if(_speculative) {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                  -1)));
+          _sw_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
         }
         if(_vc_allocator) {
-          _vc_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                  -1)));
+          _vc_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
         }
         if(_noq) {
           _UpdateNOQ(input, vc, f);
@@ -607,11 +692,9 @@ void NoRDRouter::_InputQueuing( )
     } else if((cur_buf->GetState(vc) == VC::active) &&
         (cur_buf->FrontFlit(vc) == f)) {
       if(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] == vc) {
-        _sw_hold_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                -1)));
+        _sw_hold_vcs.push_back(sVCRecord(-1, input, vc, -1));
       } else {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                -1)));
+        _sw_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
       }
     }
   }
@@ -619,23 +702,23 @@ void NoRDRouter::_InputQueuing( )
 
   while(!_proc_credits.empty()) {
 
-    pair<int, pair<Credit *, int> > const & item = _proc_credits.front();
+    sCreditRecord const item = _proc_credits.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if(GetSimTime() < time) {
       break;
     }
 
-    Credit * const c = item.second.first;
+    Credit * const c = item.c;
     assert(c);
 
-    int const output = item.second.second;
+    int const output = item.output;
     assert((output >= 0) && (output < _outputs));
 
     BufferState * const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+    for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
       int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
@@ -650,7 +733,7 @@ void NoRDRouter::_InputQueuing( )
       *gWatchOut << GetSimTime() << " | " << FullName() << " | ["
         << POWERSTATE[_power_state] << "] receives credit for ring output "
         << _ring_out_port << "'s VCs";
-      for (set<int>::iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+      for (VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
         *gWatchOut << " " << *iter;
       }
       *gWatchOut << endl;
@@ -673,17 +756,17 @@ void NoRDRouter::_RouteUpdate( )
 
   while(!_route_vcs.empty()) {
 
-    pair<int, pair<int, int> > const & item = _route_vcs.front();
+    sRouteRecord const item = _route_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer * const cur_buf = _buf[input];
@@ -712,9 +795,9 @@ void NoRDRouter::_RouteUpdate( )
     if (f->dest != _id) {
       OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
       assert(route_set);
-      set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+      OutputSet::ElementSet const setlist = route_set->GetSet();
       if (setlist.size() == 1) {
-        set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+        OutputSet::ElementSet::const_iterator iset = setlist.begin();
         int const out_port = iset->output_port;
         assert((out_port >= 0) && (out_port < _outputs));
         const FlitChannel * channel = _output_channels[out_port];
@@ -724,10 +807,10 @@ void NoRDRouter::_RouteUpdate( )
     }
     /* ==== Power Gate - End ==== */
     if(_speculative) {
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     if(_vc_allocator) {
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     // NOTE: No need to handle NOQ here, as it requires lookahead routing!
     _route_vcs.pop_front();
@@ -745,9 +828,9 @@ void NoRDRouter::_VCAllocUpdate( )
 
   while(!_vc_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _vc_alloc_vcs.front();
+    sVCRecord const item = _vc_alloc_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
@@ -757,12 +840,12 @@ void NoRDRouter::_VCAllocUpdate( )
       _wakeup_monitor_vc_requests++;
     }
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(item.output != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -781,7 +864,7 @@ void NoRDRouter::_VCAllocUpdate( )
         << ")." << endl;
     }
 
-    int const output_and_vc = item.second.second;
+    int const output_and_vc = item.output;
 
     if(output_and_vc >= 0) {
 
@@ -827,18 +910,17 @@ void NoRDRouter::_VCAllocUpdate( )
         cur_buf->SetOutput(vc, match_output, match_vc);
         cur_buf->SetState(vc, VC::active);
         if(!_speculative) {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+          _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
         }
       } else {
         cur_buf->ClearRouteSet(vc);
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
           // should remove the speculative SA
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
             }
           }
@@ -853,9 +935,9 @@ void NoRDRouter::_VCAllocUpdate( )
           cur_buf->Display(*gWatchOut);
 
           *gWatchOut << " route_vcs size: " << _route_vcs.size()
-            << " time: " << _route_vcs.front().first
-            << " input: " << _route_vcs.front().second.first
-            << " vc: " << _route_vcs.front().second.second
+            << " time: " << _route_vcs.front().time
+            << " input: " << _route_vcs.front().input
+            << " vc: " << _route_vcs.front().vc
             << " pid: " << f->pid << endl;
 
           *gWatchOut << " route_vcs empty?"
@@ -885,10 +967,10 @@ void NoRDRouter::_VCAllocUpdate( )
       OutputSet const * route_set = cur_buf->GetRouteSet(vc);
       assert(route_set);
 
-      set<OutputSet::sSetElement> setlist = route_set->GetSet();
+      OutputSet::ElementSet setlist = route_set->GetSet();
 
       bool delete_route = false;
-      set<OutputSet::sSetElement>::iterator iset = setlist.begin();
+      OutputSet::ElementSet::iterator iset = setlist.begin();
       while (iset != setlist.end()) {
 
         int const out_port = iset->output_port;
@@ -906,9 +988,7 @@ void NoRDRouter::_VCAllocUpdate( )
         }
 
         if (delete_route) {
-          set<OutputSet::sSetElement>::iterator iter = iset;
-          ++iset;
-          setlist.erase(iter);
+          iset = setlist.erase(iset);
         } else {
           ++iset;
         }
@@ -921,13 +1001,12 @@ void NoRDRouter::_VCAllocUpdate( )
       if (back_to_route) {
         cur_buf->ClearRouteSet(vc);
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
           // should remove the speculative SA
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
             }
           }
@@ -936,7 +1015,7 @@ void NoRDRouter::_VCAllocUpdate( )
         continue;
       }
 
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
       /* ==== Power Gate - End ==== */
     }
     _vc_alloc_vcs.pop_front();
@@ -954,20 +1033,20 @@ void NoRDRouter::_SWHoldUpdate( )
 
   while(!_sw_hold_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_hold_vcs.front();
+    sVCRecord const item = _sw_hold_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if(time < 0) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(item.output != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -988,7 +1067,7 @@ void NoRDRouter::_SWHoldUpdate( )
     int const expanded_input = input * _input_speedup + vc % _input_speedup;
     assert(_switch_hold_vc[expanded_input] == vc);
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = item.output;
 
     if(expanded_output >= 0 && ( _output_buffer_size==-1 || _output_buffer[expanded_output].size()<size_t(_output_buffer_size))) {
 
@@ -1126,10 +1205,10 @@ void NoRDRouter::_SWHoldUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(sCrossbarRecord(-1, f, expanded_input, expanded_output));
 
-      if(_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
       _out_queue_credits[input]->vc.insert(vc);
 
@@ -1170,7 +1249,7 @@ void NoRDRouter::_SWHoldUpdate( )
             /* ==== Power Gate - Begin ==== */
             nf->rtime = GetSimTime();
             /* ==== Power Gate - End ==== */
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           } else {
             if(nf->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1182,20 +1261,17 @@ void NoRDRouter::_SWHoldUpdate( )
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
             if(_speculative) {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_vc_allocator) {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_noq) {
               _UpdateNOQ(input, vc, nf);
             }
           }
         } else {
-          _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                  -1)));
+          _sw_hold_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
         }
       }
     } else {
@@ -1217,8 +1293,7 @@ void NoRDRouter::_SWHoldUpdate( )
       _switch_hold_vc[expanded_input] = -1;
       _switch_hold_in[expanded_input] = -1;
       _switch_hold_out[held_expanded_output] = -1;
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-              -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     _sw_hold_vcs.pop_front();
   }
@@ -1233,17 +1308,17 @@ void NoRDRouter::_SWAllocUpdate( )
 {
   while(!_sw_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_alloc_vcs.front();
+    sVCRecord const item = _sw_alloc_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer * const cur_buf = _buf[input];
@@ -1263,7 +1338,7 @@ void NoRDRouter::_SWAllocUpdate( )
         << ")." << endl;
     }
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = item.output;
 
     if(expanded_output >= 0) {
 
@@ -1292,11 +1367,11 @@ void NoRDRouter::_SWAllocUpdate( )
         int match_prio = numeric_limits<int>::min();
 
         const OutputSet * route_set = cur_buf->GetRouteSet(vc);
-        set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+        OutputSet::ElementSet const setlist = route_set->GetSet();
 
         assert(!_noq || (setlist.size() == 1));
 
-        for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+        for(OutputSet::ElementSet::const_iterator iset = setlist.begin();
             iset != setlist.end();
             ++iset) {
           if(iset->output_port == output) {
@@ -1385,10 +1460,9 @@ void NoRDRouter::_SWAllocUpdate( )
             }
             if (cur_buf->GetState(vc) == VC::vc_alloc) {
               assert(_speculative);
-              pair<int, int> input_vc = make_pair(input, vc);
               for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-                pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-                if (item.second.first == input_vc) {
+                sVCRecord item = _vc_alloc_vcs[i];
+                if ((item.input == input) && (item.vc == vc)) {
                   _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
                   break;
                 }
@@ -1400,7 +1474,7 @@ void NoRDRouter::_SWAllocUpdate( )
             }
             cur_buf->ClearRouteSet(vc);
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+            _route_vcs.push_back(sRouteRecord(-1, input, vc));
             _sw_alloc_vcs.pop_front();
             continue;
           }
@@ -1527,10 +1601,10 @@ void NoRDRouter::_SWAllocUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(sCrossbarRecord(-1, f, expanded_input, expanded_output));
 
-      if(_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
       _out_queue_credits[input]->vc.insert(vc);
 
@@ -1546,7 +1620,7 @@ void NoRDRouter::_SWAllocUpdate( )
           assert(nf->head);
           if(_routing_delay) {
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           } else {
             if(nf->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1558,12 +1632,10 @@ void NoRDRouter::_SWAllocUpdate( )
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
             if(_speculative) {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_vc_allocator) {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_noq) {
               _UpdateNOQ(input, vc, nf);
@@ -1583,11 +1655,9 @@ void NoRDRouter::_SWAllocUpdate( )
             _switch_hold_vc[expanded_input] = vc;
             _switch_hold_in[expanded_input] = expanded_output;
             _switch_hold_out[expanded_output] = expanded_input;
-            _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                    -1)));
+            _sw_hold_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
           } else {
-            _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                    -1)));
+            _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
           }
         }
       }
@@ -1611,10 +1681,10 @@ void NoRDRouter::_SWAllocUpdate( )
           OutputSet const * route_set = cur_buf->GetRouteSet(vc);
           assert(route_set);
 
-          set<OutputSet::sSetElement> setlist = route_set->GetSet();
+          OutputSet::ElementSet setlist = route_set->GetSet();
 
           bool delete_route = false;
-          set<OutputSet::sSetElement>::iterator iset = setlist.begin();
+          OutputSet::ElementSet::iterator iset = setlist.begin();
           while (iset != setlist.end()) {
 
             int const out_port = iset->output_port;
@@ -1632,9 +1702,7 @@ void NoRDRouter::_SWAllocUpdate( )
             }
 
             if (delete_route) {
-              set<OutputSet::sSetElement>::iterator iter = iset;
-              ++iset;
-              setlist.erase(iter);
+              iset = setlist.erase(iset);
             } else {
               ++iset;
             }
@@ -1642,10 +1710,9 @@ void NoRDRouter::_SWAllocUpdate( )
 
           if (setlist.empty()) {
             back_to_route = true;
-            pair<int, int> input_vc = make_pair(input, vc);
             for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-              pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-              if (item.second.first == input_vc) {
+              sVCRecord item = _vc_alloc_vcs[i];
+              if ((item.input == input) && (item.vc == vc)) {
                 _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
                 break;
               }
@@ -1675,7 +1742,7 @@ void NoRDRouter::_SWAllocUpdate( )
         if (back_to_route) {
           cur_buf->ClearRouteSet(vc);
           cur_buf->SetState(vc, VC::routing);
-          _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+          _route_vcs.push_back(sRouteRecord(-1, input, vc));
           _sw_alloc_vcs.pop_front();
           continue;
         }
@@ -1707,7 +1774,7 @@ void NoRDRouter::_SWAllocUpdate( )
       }
 #endif
 
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     _sw_alloc_vcs.pop_front();
   }
@@ -1727,8 +1794,8 @@ void NoRDRouter::_OutputQueuing( )
     for (int input = 0; input < _inputs; input++) {
       for (int vc = 0; vc < _vcs; vc++) {
         if (_credit_counter[input][vc] > 0) {
-          if (_out_queue_credits.count(input) == 0) {
-            _out_queue_credits.insert(make_pair(input, Credit::New()));
+          if (!_out_queue_credits[input]) {
+            _out_queue_credits.insert(input, Credit::New());
           }
           if (_out_queue_credits[input]->vc.count(vc) == 0) {
             _out_queue_credits[input]->vc.insert(vc);
@@ -1741,15 +1808,12 @@ void NoRDRouter::_OutputQueuing( )
   }
   /* ==== power gate - end ==== */
 
-  for(map<int, Credit *>::const_iterator iter = _out_queue_credits.begin();
-      iter != _out_queue_credits.end();
-      ++iter) {
-
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
+  for(int input = 0; input < _inputs; ++input) {
 
-    Credit * const c = iter->second;
-    assert(c);
+    Credit * const c = _out_queue_credits[input];
+    if(!c) {
+      continue;
+    }
     assert(!c->vc.empty());
 
     _credit_buffer[input].push(c);
@@ -1858,13 +1922,12 @@ void NoRDRouter::_NoRDStep()
   //  assert(_in_queue_flits.empty());
 
   // process flits
-  for (map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-       iter != _in_queue_flits.end(); ++iter) {
-
-    int const input = iter->first;
+  for(int input = 0; input < _inputs; ++input) {
 
-    Flit * const f = iter->second;
-    assert(f);
+    Flit * const f = _in_queue_flits[input];
+    if(!f) {
+      continue;
+    }
 
     int const vc = f->vc;
     assert((vc >= 0) && (vc < _vcs));
@@ -1959,23 +2022,23 @@ void NoRDRouter::_NoRDStep()
   // off routers also process credits to make an image
   while (!_proc_credits.empty()) {
 
-    pair<int, pair<Credit *, int> > const & item = _proc_credits.front();
+    sCreditRecord const item = _proc_credits.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if (GetSimTime() < time) {
       break;
     }
 
-    Credit * const c = item.second.first;
+    Credit * const c = item.c;
     assert(c);
 
-    int const output = item.second.second;
+    int const output = item.output;
     assert((output >= 0) && (output < _outputs));
 
     BufferState * const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+    for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
       int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
@@ -1989,7 +2052,7 @@ void NoRDRouter::_NoRDStep()
     if (_watch_power_gating && output == _ring_out_port) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | ["
         << POWERSTATE[_power_state] << "] relaying credit to NI for VCs";
-      for (set<int>::iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+      for (VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
         *gWatchOut << " " << *iter;
       }
       *gWatchOut << endl;
@@ -2008,10 +2071,10 @@ void NoRDRouter::_NoRDStep()
     }
 
     if (input != -1) {
-      if (_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if (!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
-      set<int>::iterator iter = c->vc.begin();
+      VCMask::const_iterator iter = c->vc.begin();
       while (iter != c->vc.end()) {
 
         int const vc = *iter;
@@ -2058,13 +2121,13 @@ void NoRDRouter::_HandshakeEvaluate()
               _neighbor_states[output] == draining);
           if (_neighbor_states[output] == power_off && output == _ring_out_port)
             _next_buf[output]->ResetVCBufferSize();
-          _neighbor_states[output] = power_on;
+          SetNeighborPowerState(output, power_on);
           _resp_hids[input] = h->hid;
           break;
 
         case draining:
           assert(_neighbor_states[output] == power_on);
-          _neighbor_states[output] = draining;
+          SetNeighborPowerState(output, draining);
           _resp_hids[input] = h->hid;
           _drain_done_sent[output] = false;
           break;
@@ -2078,13 +2141,13 @@ void NoRDRouter::_HandshakeEvaluate()
               assert(_next_buf[output]->IsAvailableFor(vc));
             }
           }
-          _neighbor_states[output] = power_off;
+          SetNeighborPowerState(output, power_off);
           _resp_hids[input] = h->hid;
           break;
 
         case wakeup:
           assert(_neighbor_states[output] == power_off);
-          _neighbor_states[output] = wakeup;
+          SetNeighborPowerState(output, wakeup);
           _drain_done_sent[output] = false;
           _resp_hids[input] = h->hid;
           break;
@@ -2130,11 +2193,11 @@ void NoRDRouter::_HandshakeResponse()
       }
       // check ST stage, crossbar_flits
       if (drain_done)
-        for (deque<pair<int, pair<Flit *, pair<int, int> > > >::iterator iter =
+        for (RingBuffer<sCrossbarRecord>::iterator iter =
              _crossbar_flits.begin(); iter != _crossbar_flits.end(); ++iter) {
-          int const time = iter->first;
+          int const time = iter->time;
           assert(time <= GetSimTime());
-          int const expanded_output = iter->second.second.second;
+          int const expanded_output = iter->output;
           int const output = expanded_output / _output_speedup;
           assert((output >= 0) && (output < _outputs));
           if (output == out_port) {
@@ -21,7 +21,7 @@ protected:
   /* ==== Power Gate - Begin ==== */
   int _routing_deadlock_timeout_threshold;
 
-  deque<pair<int, Handshake *> > _proc_handshakes;
+  RingBuffer<pair<int, Handshake *> > _proc_handshakes;
 
   map<int, Handshake *> _out_queue_handshakes;
 
@@ -69,12 +69,19 @@ public:
 
   /* ==== Power Gate - Begin ==== */
   virtual void PowerStateEvaluate( );
+  // a retired router is woken up when its idle threshold, break-even time
+  // or wakeup latency is reached
+  virtual bool Quiescent( ) const;
+  virtual int NextPowerEventCycle( ) const;
+  virtual void SynchronizeCycle( int cycles );
   virtual void SetRingOutputVCBufferSize(int vc_buf_size);
   /* ==== Power Gate - End ==== */
 
   virtual void ReadInputs( );
   virtual void WriteOutputs( );
 
+  virtual void Serialize( Checkpoint & cp );
+
 };
 
 #endif
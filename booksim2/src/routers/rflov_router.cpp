@@ -27,6 +27,7 @@
 #include "allocator.hpp"
 #include "switch_monitor.hpp"
 #include "buffer_monitor.hpp"
+#include "checkpoint.hpp"
 
 RFLOVRouter::RFLOVRouter( Configuration const & config, Module *parent,
     string const & name, int id, int inputs, int outputs )
@@ -49,6 +50,16 @@ RFLOVRouter::~RFLOVRouter( )
 {
 }
 
+void RFLOVRouter::Serialize( Checkpoint & cp )
+{
+  IQRouter::Serialize( cp );
+  /* ==== Power Gate - Begin ==== */
+  assert(_proc_handshakes.empty() && _out_queue_handshakes.empty());
+  cp.Sync( _credit_counter );
+  cp.Sync( _handshake_buffer );
+  /* ==== Power Gate - End ==== */
+}
+
 void RFLOVRouter::ReadInputs( )
 {
   bool have_flits = _ReceiveFlits( );
@@ -65,6 +76,8 @@ void RFLOVRouter::ReadInputs( )
 /* ==== Power Gate - Begin ==== */
 void RFLOVRouter::PowerStateEvaluate()
 {
+  _TrackNodeActivity(1);
+
   if (_outstanding_requests) {
     assert(_power_state == power_on);
   }
@@ -436,15 +449,12 @@ void RFLOVRouter::_ReceiveHandshakes()
 
 void RFLOVRouter::_InputQueuing( )
 {
-  for(map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-      iter != _in_queue_flits.end();
-      ++iter) {
-
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
+  for(int input = 0; input < _inputs; ++input) {
 
-    Flit * const f = iter->second;
-    assert(f);
+    Flit * const f = _in_queue_flits[input];
+    if(!f) {
+      continue;
+    }
 
     int const vc = f->vc;
     assert((vc >= 0) && (vc < _vcs));
@@ -485,7 +495,7 @@ void RFLOVRouter::_InputQueuing( )
       assert(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] != vc);
       if(_routing_delay) {
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
       } else {
         if(f->watch) {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -497,12 +507,10 @@ void RFLOVRouter::_InputQueuing( )
         cur_buf->SetRouteSet(vc, &f->la_route_set);
         cur_buf->SetState(vc, VC::vc_alloc);
         if(_speculative) {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                  -1)));
+          _sw_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
         }
         if(_vc_allocator) {
-          _vc_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                  -1)));
+          _vc_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
         }
         if(_noq) {
           _UpdateNOQ(input, vc, f);
@@ -511,11 +519,9 @@ void RFLOVRouter::_InputQueuing( )
     } else if((cur_buf->GetState(vc) == VC::active) &&
         (cur_buf->FrontFlit(vc) == f)) {
       if(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] == vc) {
-        _sw_hold_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                -1)));
+        _sw_hold_vcs.push_back(sVCRecord(-1, input, vc, -1));
       } else {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                -1)));
+        _sw_alloc_vcs.push_back(sVCRecord(-1, input, vc, -1));
       }
     }
   }
@@ -523,23 +529,23 @@ void RFLOVRouter::_InputQueuing( )
 
   while(!_proc_credits.empty()) {
 
-    pair<int, pair<Credit *, int> > const & item = _proc_credits.front();
+    sCreditRecord const item = _proc_credits.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if(GetSimTime() < time) {
       break;
     }
 
-    Credit * const c = item.second.first;
+    Credit * const c = item.c;
     assert(c);
 
-    int const output = item.second.second;
+    int const output = item.output;
     assert((output >= 0) && (output < _outputs));
 
     BufferState * const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+    for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
       int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
@@ -566,17 +572,17 @@ void RFLOVRouter::_RouteUpdate( )
 
   while(!_route_vcs.empty()) {
 
-    pair<int, pair<int, int> > const & item = _route_vcs.front();
+    sRouteRecord const item = _route_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer * const cur_buf = _buf[input];
@@ -605,9 +611,9 @@ void RFLOVRouter::_RouteUpdate( )
     if (f->dest != _id) {
       OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
       assert(route_set);
-      set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+      OutputSet::ElementSet const setlist = route_set->GetSet();
       if (setlist.size() == 1) {
-        set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+        OutputSet::ElementSet::const_iterator iset = setlist.begin();
         int const out_port = iset->output_port;
         assert((out_port >= 0) && (out_port < _outputs));
         const FlitChannel * channel = _output_channels[out_port];
@@ -630,10 +636,10 @@ void RFLOVRouter::_RouteUpdate( )
     }
     /* ==== Power Gate - End ==== */
     if(_speculative) {
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     if(_vc_allocator) {
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     // NOTE: No need to handle NOQ here, as it requires lookahead routing!
     _route_vcs.pop_front();
@@ -651,20 +657,20 @@ void RFLOVRouter::_VCAllocUpdate( )
 
   while(!_vc_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _vc_alloc_vcs.front();
+    sVCRecord const item = _vc_alloc_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(item.output != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -683,7 +689,7 @@ void RFLOVRouter::_VCAllocUpdate( )
         << ")." << endl;
     }
 
-    int const output_and_vc = item.second.second;
+    int const output_and_vc = item.output;
 
     if(output_and_vc >= 0) {
 
@@ -718,18 +724,17 @@ void RFLOVRouter::_VCAllocUpdate( )
         cur_buf->SetOutput(vc, match_output, match_vc);
         cur_buf->SetState(vc, VC::active);
         if(!_speculative) {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+          _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
         }
       } else {
         cur_buf->ClearRouteSet(vc);
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
           // should remove the speculative SA
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
             }
           }
@@ -744,9 +749,9 @@ void RFLOVRouter::_VCAllocUpdate( )
           cur_buf->Display(*gWatchOut);
 
           *gWatchOut << " route_vcs size: " << _route_vcs.size()
-            << " time: " << _route_vcs.front().first
-            << " input: " << _route_vcs.front().second.first
-            << " vc: " << _route_vcs.front().second.second
+            << " time: " << _route_vcs.front().time
+            << " input: " << _route_vcs.front().input
+            << " vc: " << _route_vcs.front().vc
             << " pid: " << f->pid << endl;
 
           *gWatchOut << " route_vcs empty?"
@@ -776,10 +781,10 @@ void RFLOVRouter::_VCAllocUpdate( )
       OutputSet const * route_set = cur_buf->GetRouteSet(vc);
       assert(route_set);
 
-      set<OutputSet::sSetElement> setlist = route_set->GetSet();
+      OutputSet::ElementSet setlist = route_set->GetSet();
 
       bool delete_route = false;
-      set<OutputSet::sSetElement>::iterator iset = setlist.begin();
+      OutputSet::ElementSet::iterator iset = setlist.begin();
       while (iset != setlist.end()) {
 
         int const out_port = iset->output_port;
@@ -795,9 +800,7 @@ void RFLOVRouter::_VCAllocUpdate( )
         }
 
         if (delete_route) {
-          set<OutputSet::sSetElement>::iterator iter = iset;
-          ++iset;
-          setlist.erase(iter);
+          iset = setlist.erase(iset);
         } else {
           ++iset;
         }
@@ -810,13 +813,12 @@ void RFLOVRouter::_VCAllocUpdate( )
       if (back_to_route) {
         cur_buf->ClearRouteSet(vc);
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
           // should remove the speculative SA
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
             }
           }
@@ -827,19 +829,18 @@ void RFLOVRouter::_VCAllocUpdate( )
 
       if (GetSimTime() - f->rtime == 300) { // timeout
         _buf[input]->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back(sRouteRecord(-1, input, vc));
         if (_speculative) {
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _sw_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _sw_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _sw_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _sw_alloc_vcs.erase(_sw_alloc_vcs.begin()+i);
               break;
             }
           }
         }
       } else {
-        _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+        _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
       }
       /* ==== Power Gate - End ==== */
     }
@@ -858,20 +859,20 @@ void RFLOVRouter::_SWHoldUpdate( )
 
   while(!_sw_hold_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_hold_vcs.front();
+    sVCRecord const item = _sw_hold_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if(time < 0) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(item.output != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -892,7 +893,7 @@ void RFLOVRouter::_SWHoldUpdate( )
     int const expanded_input = input * _input_speedup + vc % _input_speedup;
     assert(_switch_hold_vc[expanded_input] == vc);
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = item.output;
 
     if(expanded_output >= 0 && ( _output_buffer_size==-1 || _output_buffer[expanded_output].size()<size_t(_output_buffer_size))) {
 
@@ -971,11 +972,11 @@ void RFLOVRouter::_SWHoldUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(sCrossbarRecord(-1, f, expanded_input, expanded_output));
 
       assert(input >= 0 && input < _inputs);
-      if(_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
       _out_queue_credits[input]->vc.insert(vc);
 
@@ -1016,7 +1017,7 @@ void RFLOVRouter::_SWHoldUpdate( )
             /* ==== Power Gate - Begin ==== */
             nf->rtime = GetSimTime();
             /* ==== Power Gate - End ==== */
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           } else {
             if(nf->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1028,20 +1029,17 @@ void RFLOVRouter::_SWHoldUpdate( )
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
             if(_speculative) {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_vc_allocator) {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_noq) {
               _UpdateNOQ(input, vc, nf);
             }
           }
         } else {
-          _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                  -1)));
+          _sw_hold_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
         }
       }
     } else {
@@ -1063,8 +1061,7 @@ void RFLOVRouter::_SWHoldUpdate( )
       _switch_hold_vc[expanded_input] = -1;
       _switch_hold_in[expanded_input] = -1;
       _switch_hold_out[held_expanded_output] = -1;
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-              -1)));
+      _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
     }
     _sw_hold_vcs.pop_front();
   }
@@ -1079,17 +1076,17 @@ void RFLOVRouter::_SWAllocUpdate( )
 {
   while(!_sw_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_alloc_vcs.front();
+    sVCRecord const item = _sw_alloc_vcs.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = item.input;
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = item.vc;
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer * const cur_buf = _buf[input];
@@ -1109,7 +1106,7 @@ void RFLOVRouter::_SWAllocUpdate( )
         << ")." << endl;
     }
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = item.output;
 
     if(expanded_output >= 0) {
 
@@ -1138,11 +1135,11 @@ void RFLOVRouter::_SWAllocUpdate( )
         int match_prio = numeric_limits<int>::min();
 
         const OutputSet * route_set = cur_buf->GetRouteSet(vc);
-        set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+        OutputSet::ElementSet const setlist = route_set->GetSet();
 
         assert(!_noq || (setlist.size() == 1));
 
-        for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+        for(OutputSet::ElementSet::const_iterator iset = setlist.begin();
             iset != setlist.end();
             ++iset) {
           if(iset->output_port == output) {
@@ -1230,10 +1227,9 @@ void RFLOVRouter::_SWAllocUpdate( )
             }
             if (cur_buf->GetState(vc) == VC::vc_alloc) {
               assert(_speculative);
-              pair<int, int> input_vc = make_pair(input, vc);
               for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-                pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-                if (item.second.first == input_vc) {
+                sVCRecord item = _vc_alloc_vcs[i];
+                if ((item.input == input) && (item.vc == vc)) {
                   _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
                   break;
                 }
@@ -1243,7 +1239,7 @@ void RFLOVRouter::_SWAllocUpdate( )
             }
             cur_buf->ClearRouteSet(vc);
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+            _route_vcs.push_back(sRouteRecord(-1, input, vc));
             _sw_alloc_vcs.pop_front();
             continue;
           }
@@ -1315,11 +1311,11 @@ void RFLOVRouter::_SWAllocUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(sCrossbarRecord(-1, f, expanded_input, expanded_output));
 
       assert(input >= 0 && input < _inputs);
-      if(_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
       _out_queue_credits[input]->vc.insert(vc);
 
@@ -1335,7 +1331,7 @@ void RFLOVRouter::_SWAllocUpdate( )
           assert(nf->head);
           if(_routing_delay) {
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           } else {
             if(nf->watch) {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -1347,12 +1343,10 @@ void RFLOVRouter::_SWAllocUpdate( )
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
             if(_speculative) {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_vc_allocator) {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                      -1)));
+              _vc_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
             }
             if(_noq) {
               _UpdateNOQ(input, vc, nf);
@@ -1372,11 +1366,9 @@ void RFLOVRouter::_SWAllocUpdate( )
             _switch_hold_vc[expanded_input] = vc;
             _switch_hold_in[expanded_input] = expanded_output;
             _switch_hold_out[expanded_output] = expanded_input;
-            _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                    -1)));
+            _sw_hold_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
           } else {
-            _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                    -1)));
+            _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
           }
         }
       }
@@ -1400,10 +1392,10 @@ void RFLOVRouter::_SWAllocUpdate( )
           OutputSet const * route_set = cur_buf->GetRouteSet(vc);
           assert(route_set);
 
-          set<OutputSet::sSetElement> setlist = route_set->GetSet();
+          OutputSet::ElementSet setlist = route_set->GetSet();
 
           bool delete_route = false;
-          set<OutputSet::sSetElement>::iterator iset = setlist.begin();
+          OutputSet::ElementSet::iterator iset = setlist.begin();
           while (iset != setlist.end()) {
 
             int const out_port = iset->output_port;
@@ -1419,9 +1411,7 @@ void RFLOVRouter::_SWAllocUpdate( )
             }
 
             if (delete_route) {
-              set<OutputSet::sSetElement>::iterator iter = iset;
-              ++iset;
-              setlist.erase(iter);
+              iset = setlist.erase(iset);
             } else {
               ++iset;
             }
@@ -1429,10 +1419,9 @@ void RFLOVRouter::_SWAllocUpdate( )
 
           if (setlist.empty()) {
             back_to_route = true;
-            pair<int, int> input_vc = make_pair(input, vc);
             for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-              pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-              if (item.second.first == input_vc) {
+              sVCRecord item = _vc_alloc_vcs[i];
+              if ((item.input == input) && (item.vc == vc)) {
                 _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
                 break;
               }
@@ -1461,7 +1450,7 @@ void RFLOVRouter::_SWAllocUpdate( )
         if (back_to_route) {
           cur_buf->ClearRouteSet(vc);
           cur_buf->SetState(vc, VC::routing);
-          _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+          _route_vcs.push_back(sRouteRecord(-1, input, vc));
           _sw_alloc_vcs.pop_front();
           continue;
         }
@@ -1495,9 +1484,9 @@ void RFLOVRouter::_SWAllocUpdate( )
 
       /* ==== Power Gate - Begin ==== */
       if (GetSimTime() - f->rtime == 300 && f->head) { // timeout
-        int const input = item.second.first.first;
+        int const input = item.input;
         assert((input >= 0) && (input < _inputs));
-        int const vc = item.second.first.second;
+        int const vc = item.vc;
         assert((vc >= 0) && (vc < _vcs));
         Buffer * const cur_buf = _buf[input];
         if (cur_buf->GetState(vc) == VC::active) {
@@ -1507,7 +1496,7 @@ void RFLOVRouter::_SWAllocUpdate( )
           assert((dest_vc >= 0) && (dest_vc < _vcs));
           BufferState * const dest_buf = _next_buf[dest_output];
           dest_buf->ReturnBuffer(dest_vc);
-          _route_vcs.push_back(make_pair(-1, item.second.first));
+          _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           cur_buf->SetState(vc, VC::routing);
         } else {
           assert(cur_buf->GetState(vc) == VC::vc_alloc);
@@ -1515,19 +1504,18 @@ void RFLOVRouter::_SWAllocUpdate( )
           assert(dest_output == -1);
           int const dest_vc = cur_buf->GetOutputVC(vc);
           assert(dest_vc == -1);
-          pair<int, int> input_vc = make_pair(input, vc);
           for (unsigned i = 0; i < _vc_alloc_vcs.size(); ++i) {
-            pair<int, pair<pair<int, int>, int> > item = _vc_alloc_vcs[i];
-            if (item.second.first == input_vc) {
+            sVCRecord item = _vc_alloc_vcs[i];
+            if ((item.input == input) && (item.vc == vc)) {
               _vc_alloc_vcs.erase(_vc_alloc_vcs.begin()+i);
               break;
             }
           }
-          _route_vcs.push_back(make_pair(-1, item.second.first));
+          _route_vcs.push_back(sRouteRecord(-1, item.input, item.vc));
           cur_buf->SetState(vc, VC::routing);
         }
       } else {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+        _sw_alloc_vcs.push_back(sVCRecord(-1, item.input, item.vc, -1));
       }
       /* ==== Power Gate - End ==== */
     }
@@ -1544,15 +1532,12 @@ void RFLOVRouter::_SWAllocUpdate( )
 
 void RFLOVRouter::_OutputQueuing( )
 {
-  for(map<int, Credit *>::const_iterator iter = _out_queue_credits.begin();
-      iter != _out_queue_credits.end();
-      ++iter) {
+  for(int input = 0; input < _inputs; ++input) {
 
-    int const input = iter->first;
-    assert((input >= 0) && (input < _inputs));
-
-    Credit * const c = iter->second;
-    assert(c);
+    Credit * const c = _out_queue_credits[input];
+    if(!c) {
+      continue;
+    }
     assert(!c->vc.empty());
 
     _credit_buffer[input].push(c);
@@ -1612,14 +1597,13 @@ void RFLOVRouter::_RFlovStep() {
     assert(_in_queue_flits.empty());
 
   // process flits
-  for (map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-      iter != _in_queue_flits.end(); ++iter) {
-
-    int const input = iter->first;
-    assert((input >= 0) && (input < 4));
+  for(int input = 0; input < _inputs; ++input) {
 
-    Flit * const f = iter->second;
-    assert(f);
+    Flit * const f = _in_queue_flits[input];
+    if(!f) {
+      continue;
+    }
+    assert(input < 4);
 
     int const vc = f->vc;
     assert((vc >= 0) && (vc < _vcs));
@@ -1655,23 +1639,23 @@ void RFLOVRouter::_RFlovStep() {
   // off routers also process credits to make an image
   while (!_proc_credits.empty()) {
 
-    pair<int, pair<Credit *, int> > const & item = _proc_credits.front();
+    sCreditRecord const item = _proc_credits.front();
 
-    int const time = item.first;
+    int const time = item.time;
     if (GetSimTime() < time) {
       break;
     }
 
-    Credit * const c = item.second.first;
+    Credit * const c = item.c;
     assert(c);
 
-    int const output = item.second.second;
+    int const output = item.output;
     assert((output >= 0) && (output < _outputs));
 
     BufferState * const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+    for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
       int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
@@ -1698,10 +1682,10 @@ void RFLOVRouter::_RFlovStep() {
       else
         ++input;
       assert((input >= 0) && (input < 4));
-      if (_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if (!_out_queue_credits[input]) {
+        _out_queue_credits.insert(input, Credit::New());
       }
-      set<int>::iterator iter = c->vc.begin();
+      VCMask::const_iterator iter = c->vc.begin();
       while (iter != c->vc.end()) {
 
         int const vc = *iter;
@@ -1726,8 +1710,8 @@ void RFLOVRouter::_RFlovStep() {
     for (int vc = 0; vc < _vcs; ++vc) {
       if (_credit_counter[out][vc] > 0) {
         assert(in >= 0 && in < 4);
-        if (_out_queue_credits.count(in) == 0) {
-          _out_queue_credits.insert(make_pair(in, Credit::New()));
+        if (!_out_queue_credits[in]) {
+          _out_queue_credits.insert(in, Credit::New());
         }
         if (_out_queue_credits[in]->vc.count(vc) == 0) {
           --_credit_counter[out][vc];
@@ -1757,18 +1741,18 @@ void RFLOVRouter::_HandshakeEvaluate() {
       _drain_done_sent[output] = false;
       BufferState * dest_buf = _next_buf[output];
       dest_buf->ClearCredits();
-      _neighbor_states[output] = (ePowerState) h->new_state;
+      SetNeighborPowerState(output, (ePowerState) h->new_state);
     } else if (h->new_state == power_on && _neighbor_states[output] == wakeup) {
       _drain_done_sent[output] = false;
       BufferState * dest_buf = _next_buf[output];
       dest_buf->FullCredits();
-      _neighbor_states[output] = (ePowerState) h->new_state;
+      SetNeighborPowerState(output, (ePowerState) h->new_state);
     } else if (h->new_state == power_on && _neighbor_states[output] == draining) {
       _drain_done_sent[output] = false;
-      _neighbor_states[output] = (ePowerState) h->new_state;
+      SetNeighborPowerState(output, (ePowerState) h->new_state);
     } else if (h->new_state == draining || h->new_state == wakeup) {
       _drain_done_sent[output] = false;
-      _neighbor_states[output] = (ePowerState) h->new_state;
+      SetNeighborPowerState(output, (ePowerState) h->new_state);
     }
 
     if (h->drain_done) {
@@ -1809,11 +1793,11 @@ void RFLOVRouter::_HandshakeResponse() {
       }
       // check ST stage, crossbar_flits
       if (drain_done)
-        for (deque<pair<int, pair<Flit *, pair<int, int> > > >::iterator iter =
+        for (RingBuffer<sCrossbarRecord>::iterator iter =
             _crossbar_flits.begin(); iter != _crossbar_flits.end(); ++iter) {
-          int const time = iter->first;
+          int const time = iter->time;
           assert(time <= GetSimTime());
-          int const expanded_output = iter->second.second.second;
+          int const expanded_output = iter->output;
           int const output = expanded_output / _output_speedup;
           assert((output >= 0) && (output < _outputs));
           if (output == out_port) {
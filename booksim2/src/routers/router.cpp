@@ -42,6 +42,7 @@
 #include <iostream>
 #include <cassert>
 #include "router.hpp"
+#include "routecache.hpp"
 
 //////////////////Sub router types//////////////////////
 #include "iq_router.hpp"
@@ -66,11 +67,13 @@ int const Router::STALL_BUFFER_FULL = -4;
 int const Router::STALL_BUFFER_RESERVED = -5;
 int const Router::STALL_CROSSBAR_CONFLICT = -6;
 
+thread_local unsigned * Router::_route_deps = 0;
+
 Router::Router( const Configuration& config,
     Module *parent, const string & name, int id,
     int inputs, int outputs ) :
 TimedModule( parent, name ), _id( id ), _inputs( inputs ), _outputs( outputs ),
-   _partial_internal_cycles(0.0)
+   _partial_internal_cycles(0.0), _route_cache(0)
 {
   _crossbar_delay   = ( config.GetInt( "st_prepare_delay" ) +
       config.GetInt( "st_final_delay" ) );
@@ -110,6 +113,7 @@ TimedModule( parent, name ), _id( id ), _inputs( inputs ), _outputs( outputs ),
   _off_timer = 0;
   _wakeup_timer = 0;
   _wakeup_signal = false;
+  _node_activity = node_untracked;
   _off_counter = 0;
   _drain_counter = 0;
   _drain_timeout_counter = 0;
@@ -152,11 +156,17 @@ TimedModule( parent, name ), _id( id ), _inputs( inputs ), _outputs( outputs ),
   /* ==== Power Gate - End ==== */
 }
 
+Router::~Router( )
+{
+  delete _route_cache;
+}
+
 void Router::AddInputChannel( FlitChannel *channel, CreditChannel *backchannel )
 {
   _input_channels.push_back( channel );
   _input_credits.push_back( backchannel );
   channel->SetSink( this, _input_channels.size() - 1 ) ;
+  channel->SetSinkModule( this );
 }
 
 void Router::AddOutputChannel( FlitChannel *channel, CreditChannel *backchannel )
@@ -165,12 +175,14 @@ void Router::AddOutputChannel( FlitChannel *channel, CreditChannel *backchannel
   _output_credits.push_back( backchannel );
   _channel_faults.push_back( false );
   channel->SetSource( this, _output_channels.size() - 1 ) ;
+  backchannel->SetSinkModule( this );
 }
 
 /* ==== Power Gate - Begin ==== */
 void Router::AddInputHandshake( HandshakeChannel *channel )
 {
   _input_handshakes.push_back(channel);
+  channel->SetSinkModule(this);
 }
 
 void Router::AddOutputHandshake( HandshakeChannel *channel )
@@ -203,6 +215,40 @@ bool Router::IsFaultyOutput( int c ) const
 }
 
 /*Router constructor*/
+void Router::Serialize( Checkpoint & cp )
+{
+  cp.Sync( _partial_internal_cycles );
+  /* ==== Power Gate - Begin ==== */
+  cp.Sync( _power_state );
+  cp.Sync( _power_off_cycles );
+  cp.Sync( _total_power_off_cycles );
+  cp.Sync( _total_run_time );
+  cp.Sync( _idle_timer );
+  cp.Sync( _drain_timer );
+  cp.Sync( _off_timer );
+  cp.Sync( _wakeup_timer );
+  cp.Sync( _wakeup_signal );
+  cp.Sync( _node_activity );
+  cp.Sync( _off_counter );
+  cp.Sync( _drain_counter );
+  cp.Sync( _drain_timeout_counter );
+  cp.Sync( _drain_time_q );
+  cp.Sync( _max_drain_time );
+  cp.Sync( _min_drain_time );
+  cp.Sync( _neighbor_states );
+  cp.Sync( _downstream_states );
+  cp.Sync( _logical_neighbors );
+  cp.Sync( _outstanding_requests );
+  cp.Sync( _drain_done_sent );
+  cp.Sync( _drain_tags );
+  cp.Sync( _router_state );
+  cp.Sync( _rt_tbl );
+  cp.Sync( _esc_rt_tbl );
+  cp.Sync( _req_hids );
+  cp.Sync( _resp_hids );
+  /* ==== Power Gate - End ==== */
+}
+
 Router *Router::NewRouter( const Configuration& config,
     Module *parent, const string & name, int id,
     int inputs, int outputs )
@@ -239,14 +285,18 @@ Router *Router::NewRouter( const Configuration& config,
 }
 
 /* ==== Power Gate - Begin ==== */
-void Router::IdleDetected()
+void Router::_TrackNodeActivity(int cycles)
 {
-  if (_power_state == power_on)
-    ++_idle_timer;
-  else if (_power_state == draining || _power_state == wakeup)
-    ++_drain_timer;
-  else if (_power_state == power_off)
-    ++_off_timer;
+  if (_node_activity == node_busy) {
+    _wakeup_signal = true;
+  } else if (_node_activity == node_idle) {
+    if (_power_state == power_on)
+      _idle_timer += cycles;
+    else if (_power_state == draining || _power_state == wakeup)
+      _drain_timer += cycles;
+    else if (_power_state == power_off)
+      _off_timer += cycles;
+  }
 }
 
 Router * Router::GetNeighborRouter(int out_port)
@@ -257,6 +307,20 @@ Router * Router::GetNeighborRouter(int out_port)
   return router;
 }
 
+void Router::SetNeighborPowerState(int output, ePowerState s)
+{
+  if (_route_cache && (_neighbor_states[output] != s))
+    _route_cache->Invalidate(output);
+  _neighbor_states[output] = s;
+}
+
+void Router::SetLogicalNeighbor(int out_port, int id)
+{
+  if (_route_cache && (_logical_neighbors[out_port] != id))
+    _route_cache->Invalidate(out_port);
+  _logical_neighbors[out_port] = id;
+}
+
 void Router::SetRingOutputVCBufferSize(int vc_buf_size) {};
 /* ==== Power Gate - End ==== */
 
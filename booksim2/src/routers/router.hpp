@@ -44,6 +44,8 @@
 #include "channel.hpp"
 #include "config_utils.hpp"
 
+class RouteCache;
+
 typedef Channel<Credit> CreditChannel;
 /* ==== Power Gate - Begin ==== */
 typedef Channel<Handshake> HandshakeChannel;
@@ -56,6 +58,8 @@ public:
   enum ePowerState { state_min = 0, power_off = state_min,
     power_on, draining, wakeup, state_max = wakeup };
   static const char * const POWERSTATE[];
+  // activity of the attached node, as last reported by the traffic manager
+  enum eNodeActivity { node_untracked, node_idle, node_busy };
 /* ==== Power Gate - End ==== */
 
 protected:
@@ -90,6 +94,8 @@ protected:
   vector<FlitChannel *>   _output_channels;
   vector<CreditChannel *> _output_credits;
   vector<bool>            _channel_faults;
+
+  RouteCache * _route_cache;
   /* ==== Power Gate - Begin ==== */
   vector<HandshakeChannel *> _input_handshakes;
   vector<HandshakeChannel *> _output_handshakes;
@@ -113,6 +119,17 @@ protected:
 
   virtual void _InternalStep() = 0;
 
+  friend class RouteCache;
+  // neighbor ports read by the routing function while the route cache
+  // computes a route
+  static thread_local unsigned * _route_deps;
+
+  // skipping a cycle does not shift the internal steps of later cycles
+  inline bool _FixedInternalSteps() const {
+    return (_partial_internal_cycles == 0.0) &&
+      (_internal_speedup == (double)(int)_internal_speedup);
+  }
+
   /* ==== Power Gate - Begin ==== */
   ePowerState _power_state;
   uint64_t _power_off_cycles; // number of power-off cycles for current kernel? needed?
@@ -127,6 +144,7 @@ protected:
   int _off_timer; // consecutive off cycles
   int _wakeup_timer;
   bool _wakeup_signal;
+  eNodeActivity _node_activity;
   double _off_counter;
   double _drain_counter;
   double _drain_timeout_counter;
@@ -150,12 +168,17 @@ protected:
   vector<int> _req_hids;
   vector<int> _resp_hids;
   bool _watch_power_gating;
+
+  // advances the power-state timers or raises the wakeup signal for the
+  // given number of cycles, depending on the activity of the node
+  void _TrackNodeActivity(int cycles);
   /* ==== Power Gate - End ==== */
 
 public:
   Router( const Configuration& config,
       Module *parent, const string & name, int id,
       int inputs, int outputs );
+  virtual ~Router( );
 
   static Router *NewRouter( const Configuration& config,
       Module *parent, const string & name, int id,
@@ -190,7 +213,11 @@ public:
   void OutChannelFault( int c, bool fault = true );
   bool IsFaultyOutput( int c ) const;
 
+  // save or restore the state of the router
+  virtual void Serialize( Checkpoint & cp );
+
   inline int GetID( ) const {return _id;}
+  inline RouteCache * GetRouteCache( ) const {return _route_cache;}
 
 
   /* ==== Power Gate - Begin ==== */
@@ -276,12 +303,12 @@ public:
   inline int NumOutputs() const {return _outputs;}
 
   /* ==== Power Gate - Begin ==== */
-  inline void PowerOn() {_power_state = power_on;}
-  inline void PowerOff() {_power_state = power_off;}
-  inline void WakeUp() {_wakeup_signal = true;}
-  inline void SetPowerState( ePowerState s ) {_power_state = s;}
+  inline void PowerOn() {_PreparePowerStateChange(); _power_state = power_on;}
+  inline void PowerOff() {_PreparePowerStateChange(); _power_state = power_off;}
+  inline void WakeUp() {_PreparePowerStateChange(); _wakeup_signal = true;}
+  inline void SetPowerState( ePowerState s ) {_PreparePowerStateChange(); _power_state = s;}
   inline Router::ePowerState GetPowerState() const {return _power_state;}
-  inline void SetRouterState(bool state) {_router_state = state;}
+  inline void SetRouterState(bool state) {_PreparePowerStateChange(); _router_state = state;}
   inline string GetRouterState() const {return _router_state ? "On" : "Off";}
 
   inline uint64_t GetPowerOffCycles() const {return _power_off_cycles;}
@@ -304,18 +331,33 @@ public:
 
   inline int GetRingOutput() const {return _ring_out_port;}
   virtual void SetRingOutputVCBufferSize(int vc_buf_size);
-  inline void SetNeighborPowerState(int output, ePowerState s) {_neighbor_states[output] = s;}
+  void SetNeighborPowerState(int output, ePowerState s);
 
-  inline Router::ePowerState GetNeighborPowerState(int out_port) const {return _neighbor_states[out_port];}
-  inline void SetLogicalNeighbor(int out_port, int id) {_logical_neighbors[out_port] = id;}
-  inline int GetLogicalNeighbor(int out_port) const {return _logical_neighbors[out_port];}
+  inline Router::ePowerState GetNeighborPowerState(int out_port) const {
+    if (_route_deps) *_route_deps |= 1u << out_port;
+    return _neighbor_states[out_port];
+  }
+  void SetLogicalNeighbor(int out_port, int id);
+  inline int GetLogicalNeighbor(int out_port) const {
+    if (_route_deps) *_route_deps |= 1u << out_port;
+    return _logical_neighbors[out_port];
+  }
   inline void WatchPowerGating() {_watch_power_gating = true;}
 
-  void IdleDetected();
+  // called by the traffic manager at the start and the end of each idle
+  // period of the attached node; the power-state timers advance in the
+  // idle cycles and the router is woken up in the busy cycles
+  inline void IdleDetected() {_PreparePowerStateChange(); _node_activity = node_idle;}
+  inline void BusyDetected() {_PreparePowerStateChange(); _node_activity = node_busy;}
+  inline Router::eNodeActivity GetNodeActivity() const {return _node_activity;}
   Router * GetNeighborRouter(int out_port);
 
   virtual void AggressPowerGatingPolicy() {};
   virtual void RegressPowerGatingPolicy() {};
+  // latency votes of the attached node, propagated over the handshake
+  // channels to the routers of its region; the tally is cleared when read
+  virtual void CastPowerGatingVote(int vote) {};
+  virtual int TallyPowerGatingVotes() {return 0;};
   /* ==== Power Gate - End ==== */
 
 };
@@ -31,7 +31,11 @@ public:
 
   virtual ~RPRouter( );
 
+  // parked routers count their power-off cycles, which is caught up with
+  // while they are retired; the power state only changes through the
+  // fabric manager, so there are no power-state events
   virtual void PowerStateEvaluate( );
+  virtual void SynchronizeCycle( int cycles );
 
 };
 
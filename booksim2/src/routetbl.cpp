@@ -5,28 +5,34 @@
  * Author: Jiayi Huang
  */
 
-#include <deque>
+#include <algorithm>
 #include <limits>
+#include <thread>
 
 #include "globals.hpp"
 #include "misc_utils.hpp"
 #include "routetbl.hpp"
 
+const int RouteTbl::UNREACHABLE = numeric_limits<int>::max();
 
-RouteTbl::RouteTbl()
+RouteTbl::RouteTbl(int num_nodes, const vector<bool> & router_states,
+    int root, int threads)
+  : _num_nodes(num_nodes), _root(root), _threads(threads),
+  _router_states(router_states), _pool(NULL), _changed(-1)
 {
-}
-
-RouteTbl::~RouteTbl()
-{
-}
+  assert(_num_nodes == powi(gK, gN));
+  assert(gN == 2);
+  assert((int)_router_states.size() == _num_nodes);
+  assert(_root >= 0 && _root < _num_nodes);
 
-RouteTbl::RouteTbl(int src, int num_nodes, vector<bool> router_states)
-  : _src(src), _num_nodes(num_nodes), _router_states(router_states)
-{
-  _Init();
-  _rt_tbl.resize(_num_nodes, INVALID);
-  _esc_rt_tbl.resize(_num_nodes, INVALID);
+  if (_threads <= 0) {
+    _threads = max((int)thread::hardware_concurrency(), 1);
+  }
+  _threads = min(_threads, _num_nodes);
+  if (_threads > 1) {
+    _pool = new WorkerPool(_threads);
+  }
+  _queues.resize(_threads);
 
 #ifdef DEBUG_ROUTE
   cout << "Power-on routers: ";
@@ -36,261 +42,353 @@ RouteTbl::RouteTbl(int src, int num_nodes, vector<bool> router_states)
   }
   cout << endl;
 #endif
-  assert(_num_nodes == powi(gK, gN));
-  assert(gN == 2);
 
-  _adj_mtx.resize(_num_nodes);
+  // mesh links, in ascending order of the neighbor id
+  _adj_offsets.resize(_num_nodes + 1, 0);
+  _adj.reserve(4 * _num_nodes);
   for (int i = 0; i < _num_nodes; i++) {
-    _adj_mtx[i].resize(_num_nodes, -1);
-
     int ix = i % gK;
     int iy = i / gK;
-    for (int j = 0; j < _num_nodes; j++) {
-      if (_router_states[i] == false)
-        continue;
-      if (_router_states[j] == false)
-        continue;
-
-      int jx = j % gK;
-      int jy = j / gK;
-
-      if (i == j) {
-        _adj_mtx[i][j] = 0;
-      } else if ( (abs(ix - jx) == 1 && iy == jy) ||
-          (abs(iy - jy) == 1 && ix == jx) ) {
-        _adj_mtx[i][j] = 1;
-      }
-    }
+    _adj_offsets[i] = _adj.size();
+    if (iy > 0)
+      _adj.push_back(i - gK);
+    if (ix > 0)
+      _adj.push_back(i - 1);
+    if (ix < gK - 1)
+      _adj.push_back(i + 1);
+    if (iy < gK - 1)
+      _adj.push_back(i + gK);
   }
-#ifdef DEBUG_ROUTE
-  cout << "Adjacent List: " << endl;
-  for (int i = 0; i < _num_nodes; i++) {
-    cout << i << ": ";
-    for (int j = 0; j < _num_nodes; j++) {
-      if (_adj_mtx[i][j] > 0)
-        cout << j << " ";
-    }
-    cout << endl;
-  }
-#endif
+  _adj_offsets[_num_nodes] = _adj.size();
+
+  _dist.resize(_num_nodes * _num_nodes, UNREACHABLE);
+  _pred.resize(_num_nodes * _num_nodes, -1);
+  _rt_tbl.resize(_num_nodes * _num_nodes, INVALID);
+  _esc_rt_tbl.resize(_num_nodes * _num_nodes, INVALID);
+
+  BuildRoute();
+  BuildEscRoute();
 }
 
-void RouteTbl::_Init()
+RouteTbl::~RouteTbl()
 {
-  _visited.clear();
-  _pred.clear();
-  _dist.clear();
-  _visited.resize(_num_nodes, false);
-  _pred.resize(_num_nodes, -1);
-  _dist.resize(_num_nodes, numeric_limits<int>::max());
-  _dist[_src] = 0;
+  delete _pool;
 }
 
-int RouteTbl::_ClosestUnvisited()
+void RouteTbl::BuildRoute()
 {
-  int min_dist = numeric_limits<int>::max();
-  int closest = -1;
-  for (int i = 0; i < _num_nodes; i++) {
-    if (!_visited[i] && (min_dist >= _dist[i])) {
-      min_dist = _dist[i];
-      closest = i;
-    }
+  _ForEachSource(&RouteTbl::_BuildRoute);
+
+#ifdef DEBUG_ROUTE
+  cout << endl;
+  cout << "Regular routes:" << endl;
+  for (int src = 0; src < _num_nodes; src++) {
+    _PrintAllPath(src);
   }
+#endif
+}
 
-  return closest;
+void RouteTbl::BuildEscRoute()
+{
+  _BuildTree();
+  _ForEachSource(&RouteTbl::_BuildEscRoute);
 }
 
-void RouteTbl::_CalDist()
+void RouteTbl::SetRouterState(int node, bool state)
 {
-  _Init();
+  assert(node >= 0 && node < _num_nodes);
+  if (_router_states[node] == state)
+    return;
 
-  int closest;
-  int count = 0;
+  _router_states[node] = state;
+  _changed = node;
 
-  while (count < _num_nodes) {
+  _ForEachSource(&RouteTbl::_UpdateRouteTask);
 
-    closest = _ClosestUnvisited();
-    //cout << "closest: " << closest << endl;
-    if (closest < 0) {
-      //cout << "count: " << count << endl;
-      //assert(0);
+  // the escape routes of the other routers only change if the router
+  // joins or leaves the up*/down* tree as a leaf
+  vector<int> parent = _parent;
+  _BuildTree();
+  bool leaf = true;
+  for (int i = 0; i < _num_nodes; i++) {
+    if (i != node && parent[i] != _parent[i]) {
+      leaf = false;
       break;
     }
-
-    _visited[closest] = true;
-
-    for (int i = 0; i < _num_nodes; i++) {
-      if (!_visited[i] && (_adj_mtx[closest][i] > 0)) {
-        if (_dist[i] > _dist[closest] + _adj_mtx[closest][i]) {
-          _dist[i] = _dist[closest] + _adj_mtx[closest][i];
-          _pred[i] = closest;
-        }
-      }
-    }
-
-    count++;
   }
+  _ForEachSource(leaf ? &RouteTbl::_UpdateEscRouteTask : &RouteTbl::_BuildEscRoute);
 }
 
-void RouteTbl::_CalUpDownDist()
+vector<int> RouteTbl::GetRouteTbl(int src) const
 {
-  _Init();
+  assert(src >= 0 && src < _num_nodes);
+  vector<int>::const_iterator row = _rt_tbl.begin() + src * _num_nodes;
+  return vector<int>(row, row + _num_nodes);
+}
 
-  int closest;
-  int count = 0;
+vector<int> RouteTbl::GetEscRouteTbl(int src) const
+{
+  assert(src >= 0 && src < _num_nodes);
+  vector<int>::const_iterator row = _esc_rt_tbl.begin() + src * _num_nodes;
+  return vector<int>(row, row + _num_nodes);
+}
 
-  while (count < _num_nodes) {
+/* Helper functions */
 
-    closest = _ClosestUnvisited();
-    _visited[closest] = true;
+int RouteTbl::_Direction(int src, int next) const
+{
+  int coord = next - src;
+  if (coord == 1) {
+    return EAST;
+  } else if (coord == -1) {
+    return WEST;
+  } else if (coord == gK) {
+    return SOUTH;
+  } else {
+    return NORTH;
+  }
+}
 
-    for (int i = 0; i < _num_nodes; i++) {
-      if (!_visited[i] && (_updown_adj_mtx[closest][i] > 0)) {
-        if (_dist[i] > _dist[closest] + _updown_adj_mtx[closest][i]) {
-          _dist[i] = _dist[closest] + _updown_adj_mtx[closest][i];
-          _pred[i] = closest;
-        }
+// The predecessor of each router is its neighbor with the highest id one
+// hop closer to the source, which is the first one the Dijkstra of the
+// original implementation visited (it picked the highest id among the
+// closest unvisited routers). Routers take the first hop of their
+// predecessor, so the table is filled in BFS order.
+void RouteTbl::_BuildRoute(int src, vector<int> & queue)
+{
+  int * dist = &_dist[src * _num_nodes];
+  int * pred = &_pred[src * _num_nodes];
+  int * rt = &_rt_tbl[src * _num_nodes];
+
+  fill(dist, dist + _num_nodes, UNREACHABLE);
+  fill(pred, pred + _num_nodes, -1);
+  fill(rt, rt + _num_nodes, (int)INVALID);
+
+  if (_router_states[src] == false)
+    return;
+
+  queue.clear();
+  queue.push_back(src);
+  dist[src] = 0;
+  rt[src] = ARRIVED;
+
+  for (size_t q = 0; q < queue.size(); q++) {
+    int cur = queue[q];
+    for (int a = _adj_offsets[cur]; a < _adj_offsets[cur + 1]; a++) {
+      int i = _adj[a];
+      if (_router_states[i] && dist[i] == UNREACHABLE) {
+        dist[i] = dist[cur] + 1;
+        queue.push_back(i);
       }
     }
-    count++;
+  }
+
+  for (size_t q = 1; q < queue.size(); q++) {
+    int cur = queue[q];
+    for (int a = _adj_offsets[cur]; a < _adj_offsets[cur + 1]; a++) {
+      int i = _adj[a];
+      if (_router_states[i] && dist[i] == dist[cur] - 1)
+        pred[cur] = i;
+    }
+    rt[cur] = (pred[cur] == src) ? _Direction(src, cur) : rt[pred[cur]];
   }
 }
 
-void RouteTbl::BuildRoute()
+// Parking a router only affects the routes through it, i.e., the routers
+// it is the predecessor of. Unparking one only affects other routes if
+// it shortens them or becomes a predecessor with a higher id. Otherwise,
+// only the route to the router itself is updated.
+void RouteTbl::_UpdateRouteTask(int src, vector<int> & queue)
 {
-  _CalDist();
+  int const node = _changed;
 
-  for (int i = 0; i < _num_nodes; i++) {
-    if (_router_states[i] == false) {
-      continue;
-    }
-    if (i == _src) {
-      _rt_tbl[i] = ARRIVED;
-    } else {
-
-      int j = i;
-      while (_pred[j] != _src) {
-        j = _pred[j];
+  if (src == node) {
+    _BuildRoute(src, queue);
+    return;
+  }
+  if (_router_states[src] == false)
+    return;
+
+  int * dist = &_dist[src * _num_nodes];
+  int * pred = &_pred[src * _num_nodes];
+  int * rt = &_rt_tbl[src * _num_nodes];
+
+  if (_router_states[node] == false) {
+    if (dist[node] == UNREACHABLE)
+      return;
+    for (int a = _adj_offsets[node]; a < _adj_offsets[node + 1]; a++) {
+      if (pred[_adj[a]] == node) {
+        _BuildRoute(src, queue);
+        return;
       }
+    }
+    dist[node] = UNREACHABLE;
+    pred[node] = -1;
+    rt[node] = INVALID;
+    return;
+  }
 
-      int dir = INVALID;
-      int coord = j - _src;
-      if (coord == 1) {
-        dir = EAST;
-      } else if (coord == -1) {
-        dir = WEST;
-      } else if (coord == gK) {
-        dir = SOUTH;
-      } else {
-        dir = NORTH;
-      }
+  int closest = UNREACHABLE;
+  for (int a = _adj_offsets[node]; a < _adj_offsets[node + 1]; a++) {
+    int i = _adj[a];
+    if (_router_states[i])
+      closest = min(closest, dist[i]);
+  }
+  if (closest == UNREACHABLE)
+    return;
 
-      _rt_tbl[i] = dir;
+  int node_dist = closest + 1;
+  for (int a = _adj_offsets[node]; a < _adj_offsets[node + 1]; a++) {
+    int i = _adj[a];
+    if (_router_states[i] == false)
+      continue;
+    if ((dist[i] > node_dist + 1) ||
+        (dist[i] == node_dist + 1 && pred[i] < node)) {
+      _BuildRoute(src, queue);
+      return;
     }
   }
 
-#ifdef DEBUG_ROUTE
-  cout << endl;
-  cout << "Regular routes:" << endl;
-  _PrintAllPath();
-#endif
+  dist[node] = node_dist;
+  for (int a = _adj_offsets[node]; a < _adj_offsets[node + 1]; a++) {
+    int i = _adj[a];
+    if (_router_states[i] && dist[i] == closest)
+      pred[node] = i;
+  }
+  rt[node] = (pred[node] == src) ? _Direction(src, node) : rt[pred[node]];
 }
 
-void RouteTbl::BuildEscRoute(int root)
+// up*/down* tree spanned by a BFS from the fabric manager
+void RouteTbl::_BuildTree()
 {
-  // construct up*/down* tree
-  _updown_adj_mtx.resize(_num_nodes);
-  for (int i = 0; i < _num_nodes; i++) {
-    _updown_adj_mtx[i].resize(_num_nodes, -1);
-    _updown_adj_mtx[i][i] = 0;
+  _parent.assign(_num_nodes, -1);
+
+  vector<int> & queue = _queues[0];
+  vector<bool> visited(_num_nodes, false);
+  queue.clear();
+  if (_router_states[_root]) {
+    queue.push_back(_root);
+    visited[_root] = true;
   }
-
-  _visited.clear();
-  _visited.resize(_num_nodes, false);
-  _BFS(root);
-  _CalUpDownDist();
-
-  _esc_rt_tbl.resize(_num_nodes, INVALID);
-  for (int i = 0; i < _num_nodes; i++) {
-    if (_router_states[i] == false)
-      continue;
-
-    if (i == _src) {
-      _esc_rt_tbl[i] = ARRIVED;
-    } else {
-      int j = i;
-      while (_pred[j] != _src) {
-        j = _pred[j];
+  for (size_t q = 0; q < queue.size(); q++) {
+    int cur = queue[q];
+    for (int a = _adj_offsets[cur]; a < _adj_offsets[cur + 1]; a++) {
+      int i = _adj[a];
+      if (_router_states[i] && !visited[i]) {
+        _parent[i] = cur;
+        visited[i] = true;
+        queue.push_back(i);
       }
+    }
+  }
 
-      int dir = INVALID;
-      int coord = j - _src;
-      if (coord == 1) {
-        dir = EAST;
-      } else if (coord == -1) {
-        dir = WEST;
-      } else if (coord == gK) {
-        dir = SOUTH;
-      } else {
-        dir = NORTH;
-      }
-      _esc_rt_tbl[i] = dir;
+  // tree links of each router: its parent and its children
+  _tree_offsets.assign(_num_nodes + 1, 0);
+  for (int i = 0; i < _num_nodes; i++) {
+    if (_parent[i] >= 0) {
+      _tree_offsets[i + 1]++;
+      _tree_offsets[_parent[i] + 1]++;
+    }
+  }
+  for (int i = 0; i < _num_nodes; i++) {
+    _tree_offsets[i + 1] += _tree_offsets[i];
+  }
+  _tree_adj.resize(_tree_offsets[_num_nodes]);
+  vector<int> fill_pos(_tree_offsets.begin(), _tree_offsets.end() - 1);
+  for (int i = 0; i < _num_nodes; i++) {
+    if (_parent[i] >= 0) {
+      _tree_adj[fill_pos[i]++] = _parent[i];
+      _tree_adj[fill_pos[_parent[i]]++] = i;
     }
   }
 
 #ifdef DEBUG_ROUTE
-  cout << "Escape Up*/Down* tree routes:" << endl;
-  _PrintAllPath();
+  cout << "Up*/Down* tree parents:" << endl;
+  for (int i = 0; i < _num_nodes; i++) {
+    cout << i << ": " << _parent[i] << endl;
+  }
 #endif
 }
 
-/* Helper functions */
-
-void RouteTbl::_BFS(int current)
+void RouteTbl::_BuildEscRoute(int src, vector<int> & queue)
 {
-  deque<int> bfs_q;
-
-  bfs_q.push_back(current);
-  _visited[current] = true;
-
-  while (!bfs_q.empty()) {
-    current = bfs_q.front();
-    bfs_q.pop_front();
-    for (int i = 0; i < _num_nodes; i++) {
-      if (_adj_mtx[current][i] == 1 && _visited[i] == false) {
-        _updown_adj_mtx[current][i] = 1;
-        _updown_adj_mtx[i][current] = 1;
-        _visited[i] = true;
-        bfs_q.push_back(i);
+  int * esc = &_esc_rt_tbl[src * _num_nodes];
+  fill(esc, esc + _num_nodes, (int)INVALID);
+
+  if (_router_states[src] == false)
+    return;
+
+  queue.clear();
+  queue.push_back(src);
+  esc[src] = ARRIVED;
+
+  for (size_t q = 0; q < queue.size(); q++) {
+    int cur = queue[q];
+    for (int a = _tree_offsets[cur]; a < _tree_offsets[cur + 1]; a++) {
+      int i = _tree_adj[a];
+      if (esc[i] == INVALID) {
+        esc[i] = (cur == src) ? _Direction(src, i) : esc[cur];
+        queue.push_back(i);
       }
     }
   }
 }
 
-void RouteTbl::_PrintPath(int node) {
+// the router joined or left the tree as a leaf, so only the routes to
+// the router itself change
+void RouteTbl::_UpdateEscRouteTask(int src, vector<int> & queue)
+{
+  int const node = _changed;
 
-  if (node == _src) {
-    cout << node << "->";
-  } else if (_pred[node] == -1) {
-    //cout << "No path from " << _src
-    //  << " to " << node
-    //  << " (dist: " << _dist[node]
-    //  << ")" << endl;
+  if (src == node) {
+    _BuildEscRoute(src, queue);
+    return;
+  }
+  if (_router_states[src] == false)
+    return;
+
+  int * esc = &_esc_rt_tbl[src * _num_nodes];
+  int parent = _parent[node];
+  if (_router_states[node] == false || parent < 0) {
+    esc[node] = INVALID;
+  } else {
+    esc[node] = (parent == src) ? _Direction(src, node) : esc[parent];
+  }
+}
+
+void RouteTbl::_ForEachSource(tSourceTask task)
+{
+  _task = task;
+  if (_pool) {
+    _pool->Run(&RouteTbl::_SourceWorker, this);
   } else {
-    _PrintPath(_pred[node]);
-    cout << node << "->";
+    _SourceWorker(this, 0);
   }
 }
 
-void RouteTbl::_PrintAllPath()
+void RouteTbl::_SourceWorker(void * arg, int thread)
 {
+  RouteTbl * rt = static_cast<RouteTbl *>(arg);
+  for (int src = thread; src < rt->_num_nodes; src += rt->_threads) {
+    (rt->*(rt->_task))(src, rt->_queues[thread]);
+  }
+}
+
+void RouteTbl::_PrintAllPath(int src)
+{
+  int const * dist = &_dist[src * _num_nodes];
+  int const * pred = &_pred[src * _num_nodes];
   for (int i = 0; i < _num_nodes; i++) {
-    if (i == _src) {
-      cout << _src << "->" << _src;
-    } else {
-      _PrintPath(i);
+    if (dist[i] == UNREACHABLE)
+      continue;
+    vector<int> path;
+    for (int j = i; j != src; j = pred[j]) {
+      path.push_back(j);
+    }
+    cout << src;
+    for (int j = (int)path.size() - 1; j >= 0; j--) {
+      cout << "->" << path[j];
     }
-    if (_dist[i] < _num_nodes)
-      cout << " (" << _dist[i] << ")." << endl;
+    cout << " (" << dist[i] << ")." << endl;
   }
 }
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "booksim.hpp"
+#include "parallel_utils.hpp"
 
 //#define INFINITY (__builtin_inff())
 
@@ -19,53 +20,82 @@ enum { INVALID = -1, EAST, WEST,
   SOUTH, NORTH, ARRIVED
 };
 
+// Routing tables of all routers of a 2D mesh. The regular routes follow
+// the shortest paths among the power-on routers (BFS, ties broken towards
+// the highest router id as the original Dijkstra did), the escape routes
+// follow the up*/down* tree spanned by a BFS from the fabric manager.
+// The tables of all sources are built in parallel and kept up to date
+// incrementally when a single router is parked or unparked.
 class RouteTbl {
 
 private:
 
-  vector<int> _pred;
-  vector<int> _dist;
-  vector<bool> _visited;
-
-  int _src;
   int _num_nodes;
+  int _root;
+  int _threads;
   vector<bool> _router_states;
 
-  // routing table: BFS shortest path
+  // mesh adjacency in CSR format, neighbors in ascending order; links to
+  // power-off routers are skipped during the traversals
+  vector<int> _adj_offsets;
+  vector<int> _adj;
+
+  // per source (row-major): BFS distance, predecessor and routing table
+  vector<int> _dist;
+  vector<int> _pred;
   vector<int> _rt_tbl;
-  // adjacent matrix for shortest-path
-  vector<vector<int> > _adj_mtx;
 
-  // escape routing table: up*/down* tree
+  // up*/down* tree: parent of each router, tree adjacency in CSR format
+  // and the escape routing tables of all sources
+  vector<int> _parent;
+  vector<int> _tree_offsets;
+  vector<int> _tree_adj;
   vector<int> _esc_rt_tbl;
-  // adjacent matrix after minimum spanning tree
-  vector<vector<int> > _updown_adj_mtx;
+
+  // workers building the tables of different sources, and their BFS queues
+  WorkerPool * _pool;
+  vector<vector<int> > _queues;
+
+  // router that changed its state
+  int _changed;
 
 public:
 
-  RouteTbl();
-  RouteTbl(int src, int num_nodes, vector<bool> router_states);
+  RouteTbl(int num_nodes, const vector<bool> & router_states, int root,
+      int threads = 1);
 
   ~RouteTbl();
 
+  void BuildRoute();
+  void BuildEscRoute();
+
+  // park (false) or unpark (true) a router, recomputing only the routes
+  // affected by the change
+  void SetRouterState(int node, bool state);
+  inline bool GetRouterState(int node) const {return _router_states[node];}
+
+  vector<int> GetRouteTbl(int src) const;
+  vector<int> GetEscRouteTbl(int src) const;
+
 private:
 
-  void _Init();
-  int _ClosestUnvisited();
-  void _CalDist();
-  void _CalUpDownDist();
-  void _BFS(int current);
+  static const int UNREACHABLE;
 
-  void _PrintPath(int dest);
-  void _PrintAllPath();
+  int _Direction(int src, int next) const;
 
-public:
+  void _BuildRoute(int src, vector<int> & queue);
+  void _BuildTree();
+  void _BuildEscRoute(int src, vector<int> & queue);
 
-  void BuildRoute();
-  void BuildEscRoute(int root);
+  typedef void (RouteTbl::*tSourceTask)(int src, vector<int> & queue);
+  void _ForEachSource(tSourceTask task);
+  static void _SourceWorker(void * arg, int thread);
+  tSourceTask _task;
+
+  void _UpdateRouteTask(int src, vector<int> & queue);
+  void _UpdateEscRouteTask(int src, vector<int> & queue);
 
-  inline vector<int> & GetRouteTbl() {return _rt_tbl;}
-  inline vector<int> & GetEscRouteTbl() {return _esc_rt_tbl;}
+  void _PrintAllPath(int src);
 
 };
 
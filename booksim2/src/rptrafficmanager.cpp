@@ -18,6 +18,8 @@
 #include "random_utils.hpp"
 #include "vc.hpp"
 #include "packet_reply_info.hpp"
+#include "routetbl.hpp"
+#include "checkpoint.hpp"
 
 
 RPTrafficManager::RPTrafficManager( const Configuration &config,
@@ -75,6 +77,47 @@ RPTrafficManager::RPTrafficManager( const Configuration &config,
         }
     }
 
+    // ============ Reconfiguration ============
+
+    vector<int> reconfig_times = config.GetIntArray("reconfig_times");
+    vector<int> reconfig_cores = config.GetIntArray("reconfig_cores");
+    if(reconfig_times.size() != reconfig_cores.size()) {
+        Error("reconfig_times and reconfig_cores must have the same number of entries");
+    }
+    for(size_t i = 0; i < reconfig_times.size(); ++i) {
+        int const core = reconfig_cores[i];
+        if((core < 0) || (core >= _nodes) ||
+           ((i > 0) && (reconfig_times[i] < reconfig_times[i-1]))) {
+            ostringstream err;
+            err << "Invalid reconfiguration of core " << core
+                << " at cycle " << reconfig_times[i];
+            Error( err.str( ) );
+        }
+        // cores toggled at the same cycle share one epoch
+        if(_reconfig_times.empty() || (reconfig_times[i] != _reconfig_times.back())) {
+            _reconfig_times.push_back(reconfig_times[i]);
+            _reconfig_cores.push_back(vector<int>());
+        }
+        _reconfig_cores.back().push_back(core);
+    }
+    if(!_reconfig_times.empty()) {
+        for(int subnet = 0; subnet < _subnets; ++subnet) {
+            if(!_net[subnet]->GetRouteTbl()) {
+                Error("Runtime reconfiguration requires Router Parking routers");
+            }
+        }
+    }
+    _reconfig_latency = config.GetInt("reconfig_latency");
+    assert(_reconfig_latency >= 0);
+    _reconfig_epoch = 0;
+    _reconfig_state = reconfig_idle;
+    _reconfig_start = -1;
+    _reconfig_drained = -1;
+    _reconfig_resume = -1;
+    _reconfig_flit = -1;
+    _reconfig_parked = 0;
+    _reconfig_unparked = 0;
+
     // ============ Statistics ============
 
 }
@@ -84,6 +127,23 @@ RPTrafficManager::~RPTrafficManager( )
 
 }
 
+void RPTrafficManager::_Serialize( Checkpoint & cp )
+{
+    cp.Check( (int)_reconfig_times.size( ), "number of reconfigurations" );
+    int epoch = _reconfig_epoch;
+    cp.Sync( epoch );
+    _reconfig_epoch = epoch;
+    cp.Sync( _reconfig_state );
+    cp.Sync( _reconfig_on_cores );
+    cp.Sync( _reconfig_start );
+    cp.Sync( _reconfig_drained );
+    cp.Sync( _reconfig_resume );
+    cp.Sync( _reconfig_flit );
+    cp.Sync( _reconfig_parked );
+    cp.Sync( _reconfig_unparked );
+    cp.Sync( _reconfig_stall );
+}
+
 
 
 void RPTrafficManager::_GeneratePacket( int source, int stype,
@@ -237,41 +297,113 @@ void RPTrafficManager::_GeneratePacket( int source, int stype,
     }
 }
 
-void RPTrafficManager::_Inject()
+// the cycle of the next reconfiguration event, which must not be skipped
+int RPTrafficManager::_NextReconfigCycle( ) const
 {
-    /* ==== Power Gate - Begin ==== */
-    vector<bool> & core_states = _net[0]->GetCoreStates();
-    /* ==== Power Gate - End ==== */
+    switch(_reconfig_state) {
+    case reconfig_draining:
+        return _time;
+    case reconfig_updating:
+        return _reconfig_resume;
+    default:
+        return (_reconfig_epoch < _reconfig_times.size()) ?
+            _reconfig_times[_reconfig_epoch] : numeric_limits<int>::max();
+    }
+}
 
-    for ( int input = 0; input < _nodes; ++input ) {
-        /* ==== Power Gate - Begin ==== */
-        if (core_states[input] == false)
-            continue;
-        /* ==== Power Gate - End ==== */
-        for ( int c = 0; c < _classes; ++c ) {
-            // Potentially generate packets for any (input,class)
-            // that is currently empty
-            if ( _partial_packets[input][c].empty() ) {
-                bool generated = false;
-                while( !generated && ( _qtime[input][c] <= _time ) ) {
-                    int stype = _IssuePacket( input, c );
-
-                    if ( stype != 0 ) { //generate a packet
-                        _GeneratePacket( input, stype, c,
-                                         _include_queuing==1 ?
-                                         _qtime[input][c] : _time );
-                        generated = true;
-                    }
-                    // only advance time if this is not a reply packet
-                    if(!_use_read_write[c] || (stype >= 0)){
-                        ++_qtime[input][c];
-                    }
-                }
+void RPTrafficManager::_Reconfigure( )
+{
+    if(_reconfig_state == reconfig_idle) {
+        if((_reconfig_epoch >= _reconfig_times.size()) ||
+           (_time < _reconfig_times[_reconfig_epoch])) {
+            return;
+        }
+        // cores turned off stop generating packets right away, the ones
+        // turned on wait for their routers to be unparked
+        vector<int> const & cores = _reconfig_cores[_reconfig_epoch];
+        vector<bool> const & core_states = _net[0]->GetCoreStates();
+        _reconfig_on_cores.clear();
+        for(size_t i = 0; i < cores.size(); ++i) {
+            if(core_states[cores[i]]) {
+                _SetCoreState(cores[i], false);
+            } else {
+                _reconfig_on_cores.push_back(cores[i]);
+            }
+        }
+        _reconfig_start = _time;
+        _reconfig_flit = _cur_id;
+        _reconfig_state = reconfig_draining;
+    }
 
-                if ( ( _sim_state == draining ) &&
-                     ( _qtime[input][c] > _drain_time ) ) {
-                    _qdrained[input][c] = true;
-                }
+    if(_reconfig_state == reconfig_draining) {
+        // the packets generated before the epoch still use the old tables;
+        // in-flight flits are ordered by id
+        for(int c = 0; c < _classes; ++c) {
+            if(!_total_in_flight_flits[c].empty() &&
+               (_total_in_flight_flits[c].begin()->first < _reconfig_flit)) {
+                return;
+            }
+        }
+        for(int subnet = 0; subnet < _subnets; ++subnet) {
+            if(_net[subnet]->IdleCycles(1) <= 0) {
+                return;
+            }
+        }
+        _reconfig_drained = _time;
+        for(size_t i = 0; i < _reconfig_on_cores.size(); ++i) {
+            _SetCoreState(_reconfig_on_cores[i], true);
+        }
+        _InstallRouteTables();
+        _reconfig_resume = _time + _reconfig_latency;
+        _reconfig_state = reconfig_updating;
+    }
+
+    if(_reconfig_state == reconfig_updating) {
+        if(_time < _reconfig_resume) {
+            return;
+        }
+        int const stall = _time - _reconfig_start;
+        _reconfig_stall.push_back(stall);
+        cout << "Reconfiguration " << _reconfig_epoch
+             << " at cycle " << _reconfig_start
+             << ": drained in " << _reconfig_drained - _reconfig_start
+             << " cycles, " << _reconfig_parked << " routers parked, "
+             << _reconfig_unparked << " unparked, stall = " << stall
+             << " cycles" << endl;
+        ++_reconfig_epoch;
+        _reconfig_state = reconfig_idle;
+    }
+}
+
+// the fabric manager parks and unparks the routers and swaps the routing
+// tables of all routers at once, while the network is empty
+void RPTrafficManager::_InstallRouteTables( )
+{
+    _reconfig_parked = 0;
+    _reconfig_unparked = 0;
+    for(int subnet = 0; subnet < _subnets; ++subnet) {
+        vector<int> const changed = _net[subnet]->ReconfigureRouters();
+        if(changed.empty()) {
+            continue;
+        }
+        RouteTbl * const rt_tbl = _net[subnet]->GetRouteTbl();
+        vector<bool> const & router_states = _net[subnet]->GetRouterStates();
+        for(size_t i = 0; i < changed.size(); ++i) {
+            rt_tbl->SetRouterState(changed[i], router_states[changed[i]]);
+            if(subnet == 0) {
+                ++(router_states[changed[i]] ? _reconfig_unparked : _reconfig_parked);
+            }
+        }
+        const vector<Router *> & routers = _net[subnet]->GetRouters();
+        for(int n = 0; n < _nodes; ++n) {
+            Router * const r = routers[n];
+            r->SetRouterState(router_states[n]);
+            if(router_states[n]) {
+                r->SetPowerState(Router::power_on);
+                r->SetRouteTable(rt_tbl->GetRouteTbl(n));
+                r->SetEscRouteTable(rt_tbl->GetEscRouteTbl(n));
+            } else {
+                r->SetPowerState(Router::power_off);
             }
         }
     }
@@ -279,6 +411,21 @@ void RPTrafficManager::_Inject()
 
 void RPTrafficManager::_Step( )
 {
+    if ( _fast_forward ) {
+        int const step_limit = _step_limit;
+        int const next = _NextReconfigCycle();
+        if ( next < _step_limit ) {
+            _step_limit = next;
+        }
+        bool const idle = !_SkipIdleCycles( true );
+        _step_limit = step_limit;
+        if ( idle && ( _time >= _step_limit ) ) {
+            return;
+        }
+    }
+
+    _Reconfigure();
+
     bool flits_in_flight = false;
     for(int c = 0; c < _classes; ++c) {
         flits_in_flight |= !_total_in_flight_flits[c].empty();
@@ -327,7 +474,7 @@ void RPTrafficManager::_Step( )
             Credit * const c = _net[subnet]->ReadCredit( n );
             if ( c ) {
 #ifdef TRACK_FLOWS
-                for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+                for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
                     int const vc = *iter;
                     assert(!_outstanding_classes[n][subnet][vc].empty());
                     int cl = _outstanding_classes[n][subnet][vc].front();
@@ -394,11 +541,17 @@ void RPTrafficManager::_Step( )
                     continue;
                 }
 
+                // new packets wait for the reconfiguration to finish
+                if((_reconfig_state != reconfig_idle) && cf->head &&
+                   (cf->id >= _reconfig_flit)) {
+                    continue;
+                }
+
                 if(cf->head && cf->vc == -1) { // Find first available VC
 
                     OutputSet route_set;
                     _rf(NULL, cf, -1, &route_set, true);
-                    set<OutputSet::sSetElement> const & os = route_set.GetSet();
+                    OutputSet::ElementSet const & os = route_set.GetSet();
                     assert(os.size() == 1);
                     OutputSet::sSetElement const & se = *os.begin();
                     assert(se.output_port == -1);
@@ -425,7 +578,7 @@ void RPTrafficManager::_Step( )
                                        << "Generating lookahead routing info for flit " << cf->id
                                        << " (NOQ)." << endl;
                         }
-                        set<OutputSet::sSetElement> const sl = cf->la_route_set.GetSet();
+                        OutputSet::ElementSet const sl = cf->la_route_set.GetSet();
                         assert(sl.size() == 1);
                         int next_output = sl.begin()->output_port;
                         vc_count /= router->NumOutputs();
@@ -616,3 +769,36 @@ void RPTrafficManager::_Step( )
 
 }
 
+
+void RPTrafficManager::WriteStats(ostream & os) const {
+
+    TrafficManager::WriteStats(os);
+
+    if(!_reconfig_stall.empty()) {
+        os << "reconfig_stall = [ ";
+        for(size_t i = 0; i < _reconfig_stall.size(); ++i) {
+            os << _reconfig_stall[i] << " ";
+        }
+        os << "];" << endl;
+    }
+}
+
+void RPTrafficManager::DisplayOverallStats( ostream & os ) const {
+
+    TrafficManager::DisplayOverallStats(os);
+
+    if(!_reconfig_stall.empty()) {
+        int total_stall = 0;
+        int max_stall = 0;
+        for(size_t i = 0; i < _reconfig_stall.size(); ++i) {
+            total_stall += _reconfig_stall[i];
+            max_stall = max(max_stall, _reconfig_stall[i]);
+        }
+        int const epochs = _reconfig_stall.size();
+        os << "====== Reconfiguration ======" << endl;
+        os << "Reconfiguration stall average = " << total_stall / (double)epochs
+           << " (" << epochs << " samples)" << endl;
+        os << "\tmaximum = " << max_stall << endl;
+        os << "\ttotal = " << total_stall << endl;
+    }
+}
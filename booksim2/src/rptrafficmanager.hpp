@@ -20,19 +20,45 @@ private:
   vector<vector<int> > _packet_size_rate;
   vector<int> _packet_size_max_val;
 
+  // runtime reconfiguration: at each epoch the given cores are turned off or
+  // on, the packets generated before the epoch are drained, the new routing
+  // tables are installed by the fabric manager and injection resumes
+  enum eReconfigState { reconfig_idle, reconfig_draining, reconfig_updating };
+  vector<int> _reconfig_times;
+  vector<vector<int> > _reconfig_cores;
+  vector<int> _reconfig_on_cores;
+  int _reconfig_latency;
+  size_t _reconfig_epoch;
+  eReconfigState _reconfig_state;
+  int _reconfig_start;
+  int _reconfig_drained;
+  int _reconfig_resume;
+  int _reconfig_flit;  // flits from this id on are held back at the sources
+  int _reconfig_parked;
+  int _reconfig_unparked;
+  vector<int> _reconfig_stall;
+
   // ============ Internal methods ============
 protected:
 
-  virtual void _Inject();
+  int _NextReconfigCycle( ) const;
+  void _Reconfigure( );
+  void _InstallRouteTables( );
+
   virtual void _Step( );
 
   virtual void _GeneratePacket( int source, int size, int cl, int time );
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
 
   RPTrafficManager( const Configuration &config, const vector<Network *> & net );
   virtual ~RPTrafficManager( );
 
+  virtual void WriteStats( ostream & os = cout ) const ;
+  virtual void DisplayOverallStats( ostream & os = cout ) const ;
+
 };
 
 #endif
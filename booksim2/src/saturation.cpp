@@ -0,0 +1,248 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*saturation.cpp
+ *
+ *saturation throughput search over latency simulations
+ */
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "saturation.hpp"
+#include "trafficmanager.hpp"
+#include "globals.hpp"
+
+struct SaturationProbe {
+  double rate;
+  bool stable;
+  SimSummary summary;
+};
+
+static bool _RateLess( SaturationProbe const & a, SaturationProbe const & b )
+{
+  return a.rate < b.rate;
+}
+
+// an empty file for the checkpoint of a probe
+static string _TempCheckpoint( )
+{
+  char const * const dir = getenv( "TMPDIR" );
+  string const name = string( ( dir && *dir ) ? dir : "/tmp" ) + "/booksim_saturation_XXXXXX";
+  vector<char> buffer( name.begin( ), name.end( ) );
+  buffer.push_back( '\0' );
+  int const fd = mkstemp( &buffer[0] );
+  if ( fd < 0 ) {
+    cerr << "Unable to create a checkpoint file " << name << ": " << strerror( errno ) << endl;
+    exit( -1 );
+  }
+  close( fd );
+  return string( &buffer[0] );
+}
+
+// a latency simulation at the given rate; it resumes from the state in
+// checkpoint_in and saves its own once warmed up to checkpoint_out, unless
+// they are empty
+static void _Probe( BookSimConfig const & config, SaturationProbe * probe,
+                    string const & checkpoint_in, string const & checkpoint_out )
+{
+  BookSimConfig probe_config( config );
+  if ( config.GetStr( "sim_type" ) == "saturation" ) {
+    probe_config.Assign( "sim_type", string( "latency" ) );
+  }
+  probe_config.Assign( "measure_latency", 1 );
+  probe_config.Assign( "injection_rate", probe->rate );
+  probe_config.Assign( "injection_rate", string( "" ) );
+  probe_config.Assign( "checkpoint_in", checkpoint_in );
+  probe_config.Assign( "checkpoint_out", checkpoint_out );
+  probe_config.Assign( "checkpoint_warmup", 1 );
+  probe_config.Assign( "latency_trend_periods", config.GetInt( "saturation_trend_periods" ) );
+
+  cout << "SATURATION: Simulating for injection rate " << probe->rate;
+  if ( !checkpoint_in.empty( ) ) {
+    cout << ", resuming from the last stable probe";
+  }
+  cout << " ..." << endl;
+  probe->stable = Simulate( probe_config, 0, &probe->summary );
+  if ( !probe->stable ) {
+    cout << "SATURATION: Injection rate " << probe->rate << " is unstable." << endl;
+  }
+}
+
+// the largest latency of a measured class relative to its zero-load latency
+static double _LatencyRatio( SimSummary const & summary, SimSummary const & zero_load )
+{
+  double ratio = 1.0;
+  for ( size_t c = 0; c < summary.latency.size( ); ++c ) {
+    if ( summary.measured[c] && ( zero_load.latency[c] > 0.0 ) ) {
+      ratio = max( ratio, summary.latency[c] / zero_load.latency[c] );
+    }
+  }
+  return ratio;
+}
+
+bool RunSaturation( BookSimConfig const & config )
+{
+  vector<string> patterns = config.GetStrArray( "saturation_traffic" );
+  if ( patterns.empty( ) ) {
+    patterns.push_back( config.GetStr( "traffic" ) );
+  }
+  double const zero_load_rate = config.GetFloat( "saturation_zero_load_rate" );
+  double const initial_step = config.GetFloat( "saturation_step" );
+  double const min_step = config.GetFloat( "saturation_min_step" );
+  if ( ( zero_load_rate <= 0.0 ) || ( zero_load_rate >= 1.0 ) ) {
+    config.ParseError( "saturation_zero_load_rate must be in (0, 1)" );
+  }
+  if ( ( min_step <= 0.0 ) || ( initial_step < min_step ) ) {
+    config.ParseError( "saturation_step must be at least saturation_min_step, which must be positive" );
+  }
+
+  // the probes keep the traffic manager of the configured sim_type
+  string const sim_type = config.GetStr( "sim_type" );
+  if ( ( sim_type != "saturation" ) && ( sim_type != "latency" ) &&
+       ( sim_type != "flov" ) && ( sim_type != "nord" ) && ( sim_type != "rp" ) ) {
+    config.ParseError( "Saturation search is not supported for sim_type = " + sim_type );
+  }
+
+  // checkpoints are not supported by the event and chaos routers
+  bool const warm = ( config.GetStr( "router" ) != "event" ) &&
+                    ( config.GetStr( "router" ) != "chaos" );
+  if ( !warm ) {
+    cout << "WARNING: Probes of " << config.GetStr( "router" )
+         << " routers cannot resume from checkpoints and start cold." << endl;
+  }
+
+  bool success = true;
+  vector<vector<SaturationProbe> > curves( patterns.size( ) );
+  // the last stable probe of each pattern
+  vector<SaturationProbe> saturation( patterns.size( ) );
+
+  for ( size_t p = 0; p < patterns.size( ); ++p ) {
+
+    BookSimConfig pattern_config( config );
+    pattern_config.Assign( "traffic", patterns[p] );
+    vector<SaturationProbe> & curve = curves[p];
+
+    cout << "SATURATION: Determining zero-load latency of " << patterns[p] << " ..." << endl;
+    string last_checkpoint = warm ? _TempCheckpoint( ) : "";
+    SaturationProbe zero_load;
+    zero_load.rate = zero_load_rate;
+    _Probe( pattern_config, &zero_load, "", last_checkpoint );
+    curve.push_back( zero_load );
+    if ( !zero_load.stable ) {
+      cout << "WARNING: " << patterns[p] << " is unstable at zero load." << endl;
+      if ( warm ) {
+        unlink( last_checkpoint.c_str( ) );
+      }
+      success = false;
+      continue;
+    }
+
+    SaturationProbe & last = saturation[p];
+    last = zero_load;
+    double step = initial_step;
+    // the lowest rate found to be unstable, higher rates (up to rounding)
+    // are not probed
+    double unstable_rate = 1.0 + min_step;
+    while ( ( step >= min_step ) && ( last.rate < 1.0 ) ) {
+      SaturationProbe probe;
+      probe.rate = min( last.rate + step, 1.0 );
+      if ( probe.rate > unstable_rate - 0.5 * min_step ) {
+        step /= 2.0;
+        continue;
+      }
+      string const checkpoint = warm ? _TempCheckpoint( ) : "";
+      _Probe( pattern_config, &probe, last_checkpoint, checkpoint );
+      curve.push_back( probe );
+
+      if ( probe.stable ) {
+        if ( warm ) {
+          unlink( last_checkpoint.c_str( ) );
+        }
+        last_checkpoint = checkpoint;
+        last = probe;
+        // take smaller steps as the latency rises, so the knee of the curve
+        // gets more points
+        double const ratio = _LatencyRatio( probe.summary, zero_load.summary );
+        step = min( step, max( min_step, initial_step / ratio ) );
+      } else {
+        if ( warm ) {
+          unlink( checkpoint.c_str( ) );
+        }
+        unstable_rate = probe.rate;
+        step /= 2.0;
+      }
+    }
+    if ( warm ) {
+      unlink( last_checkpoint.c_str( ) );
+    }
+
+    cout << "SATURATION: Saturation throughput of " << patterns[p] << " is " << last.rate << "." << endl;
+    stable_sort( curve.begin( ), curve.end( ), _RateLess );
+  }
+
+  cout << "SATURATION: rows are curve:traffic,injection_rate,class,latency,accepted_flit_rate"
+       << " (or unstable), and saturation:traffic,class,zero_load_latency,saturation_rate,accepted_flit_rate"
+       << endl;
+  for ( size_t p = 0; p < patterns.size( ); ++p ) {
+    for ( size_t i = 0; i < curves[p].size( ); ++i ) {
+      SaturationProbe const & probe = curves[p][i];
+      if ( !probe.stable ) {
+        cout << "curve:" << patterns[p] << ',' << probe.rate << ",unstable" << endl;
+        continue;
+      }
+      for ( size_t c = 0; c < probe.summary.latency.size( ); ++c ) {
+        if ( probe.summary.measured[c] ) {
+          cout << "curve:" << patterns[p] << ',' << probe.rate << ',' << c
+               << ',' << probe.summary.latency[c] << ',' << probe.summary.accepted[c] << endl;
+        }
+      }
+    }
+  }
+  for ( size_t p = 0; p < patterns.size( ); ++p ) {
+    SaturationProbe const & zero_load = curves[p].front( );
+    if ( !zero_load.stable ) {
+      cout << "saturation:" << patterns[p] << ",unstable" << endl;
+      continue;
+    }
+    for ( size_t c = 0; c < zero_load.summary.latency.size( ); ++c ) {
+      if ( zero_load.summary.measured[c] ) {
+        cout << "saturation:" << patterns[p] << ',' << c
+             << ',' << zero_load.summary.latency[c] << ',' << saturation[p].rate
+             << ',' << saturation[p].summary.accepted[c] << endl;
+      }
+    }
+  }
+
+  return success;
+}
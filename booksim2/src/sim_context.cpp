@@ -0,0 +1,206 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*sim_context.cpp
+ *
+ *per-simulation state of a thread
+ */
+
+#include <fstream>
+#include <streambuf>
+#include <cassert>
+
+#include "sim_context.hpp"
+#include "globals.hpp"
+#include "routefunc.hpp"
+#include "anynet.hpp"
+#include "cmesh.hpp"
+#include "dragonfly.hpp"
+#include "flatfly_onchip.hpp"
+#include "parallel_utils.hpp"
+
+// defined in main.cpp
+extern thread_local TrafficManager * trafficManager;
+
+thread_local SimContext * SimContext::_current = 0;
+
+// the buffer of the stream a simulation of this thread prints to, if not cout
+static thread_local streambuf * _thread_output = 0;
+
+// installed in cout by SeparateOutput(): it keeps no characters itself, so
+// the threads only share the buffer they print to if they print to cout
+class ThreadOutputBuffer : public streambuf {
+  streambuf * const _cout;
+
+  inline streambuf * _Target( ) const {
+    return _thread_output ? _thread_output : _cout;
+  }
+
+public:
+  ThreadOutputBuffer( streambuf * cout_buffer ) : _cout( cout_buffer ) { }
+
+protected:
+  virtual int overflow( int c ) {
+    if ( c == traits_type::eof( ) ) {
+      return traits_type::not_eof( c );
+    }
+    return _Target( )->sputc( traits_type::to_char_type( c ) );
+  }
+  virtual streamsize xsputn( char const * s, streamsize n ) {
+    return _Target( )->sputn( s, n );
+  }
+  virtual int sync( ) {
+    return _Target( )->pubsync( );
+  }
+};
+
+static ThreadOutputBuffer * _output_buffer = 0;
+
+void SimContext::SeparateOutput( )
+{
+  if ( !_output_buffer ) {
+    cout.flush( );
+    _output_buffer = new ThreadOutputBuffer( cout.rdbuf( ) );
+    cout.rdbuf( _output_buffer );
+  }
+}
+
+template<class T>
+static inline void _Copy( bool capture, T & global, T & value )
+{
+  if ( capture ) {
+    value = global;
+  } else {
+    global = value;
+  }
+}
+
+SimContext::SimContext( Configuration const & config, ostream * out ) :
+  _watch_out( 0 ), _out( out ), _parallel_random_draws( 0 )
+{
+  // simulations of one thread run one after the other
+  assert( !_current );
+  _current = this;
+
+  if ( _out ) {
+    assert( _output_buffer );
+    _thread_output = _out->rdbuf( );
+  }
+
+  Flit::_pool = &_flits;
+  Credit::_pool = &_credits;
+  Handshake::_pool = &_handshakes;
+
+  /*initialize routing, traffic, injection functions
+   */
+  InitializeRoutingMap( config );
+
+  gPrintActivity = (config.GetInt("print_activity") > 0);
+  gTrace = (config.GetInt("viewer_trace") > 0);
+
+  string watch_out_file = config.GetStr( "watch_out" );
+  if(watch_out_file == "") {
+    gWatchOut = NULL;
+  } else if(watch_out_file == "-") {
+    gWatchOut = &cout;
+  } else {
+    _watch_out = new ofstream(watch_out_file.c_str());
+    gWatchOut = _watch_out;
+  }
+
+  Capture( );
+}
+
+SimContext::~SimContext( )
+{
+  assert( _current == this );
+  gWatchOut = NULL;
+  delete _watch_out;
+  if ( _out ) {
+    _out->flush( );
+    _thread_output = 0;
+  }
+  // a simulation ended by an error may have left a parallel phase
+  gParallelPhase = false;
+  Flit::_pool = 0;
+  Credit::_pool = 0;
+  Handshake::_pool = 0;
+  trafficManager = NULL;
+  _current = 0;
+}
+
+void SimContext::Capture( )
+{
+  assert( _current == this );
+  _Transfer( true );
+}
+
+void SimContext::Install( )
+{
+  _current = this;
+  Flit::_pool = &_flits;
+  Credit::_pool = &_credits;
+  Handshake::_pool = &_handshakes;
+  _Transfer( false );
+}
+
+void SimContext::_Transfer( bool capture )
+{
+  _Copy( capture, trafficManager, _traffic_manager );
+  _Copy( capture, gPrintActivity, _print_activity );
+  _Copy( capture, gTrace, _trace );
+  _Copy( capture, gK, _k );
+  _Copy( capture, gN, _n );
+  _Copy( capture, gC, _c );
+  _Copy( capture, gNodes, _nodes );
+  _Copy( capture, gNumVCs, _num_vcs );
+  _Copy( capture, gReadReqBeginVC, _read_req_begin_vc );
+  _Copy( capture, gReadReqEndVC, _read_req_end_vc );
+  _Copy( capture, gWriteReqBeginVC, _write_req_begin_vc );
+  _Copy( capture, gWriteReqEndVC, _write_req_end_vc );
+  _Copy( capture, gReadReplyBeginVC, _read_reply_begin_vc );
+  _Copy( capture, gReadReplyEndVC, _read_reply_end_vc );
+  _Copy( capture, gWriteReplyBeginVC, _write_reply_begin_vc );
+  _Copy( capture, gWriteReplyEndVC, _write_reply_end_vc );
+  /* ==== Power Gate - Begin ==== */
+  _Copy( capture, gRoutingDeadlockTimeoutThreshold, _routing_deadlock_timeout_threshold );
+  _Copy( capture, gMissRouteThreshold, _misroute_threshold );
+  /* ==== Power Gate - End ==== */
+  _Copy( capture, gP, _dragonfly_p );
+  _Copy( capture, gA, _dragonfly_a );
+  _Copy( capture, gG, _dragonfly_g );
+  _Copy( capture, global_routing_table, _anynet_routing_table );
+  _Copy( capture, CMesh::_cX, _cmesh_x );
+  _Copy( capture, CMesh::_cY, _cmesh_y );
+  _Copy( capture, CMesh::_memo_NodeShiftX, _cmesh_node_shift_x );
+  _Copy( capture, CMesh::_memo_NodeShiftY, _cmesh_node_shift_y );
+  _Copy( capture, CMesh::_memo_PortShiftY, _cmesh_port_shift_y );
+  _Copy( capture, _xcount, _flatfly_x_count );
+  _Copy( capture, _ycount, _flatfly_y_count );
+  _Copy( capture, _xrouter, _flatfly_x_router );
+  _Copy( capture, _yrouter, _flatfly_y_router );
+}
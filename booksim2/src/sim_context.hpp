@@ -0,0 +1,125 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*sim_context.hpp
+ *
+ *The state of one simulation. The globals that describe the simulated
+ *network (gK, gNumVCs, the VC ranges, the routing tables, the traffic
+ *manager, ...) and the random number generators are thread local, so that
+ *simulations run by different threads are independent, while a single
+ *simulation accesses them as cheaply as before. A SimContext sets up the
+ *calling thread for a simulation, owns the state that is not a plain value,
+ *i.e., the flit, credit and handshake pools and the watch output, and
+ *copies the globals to the worker threads of the parallel engine.
+ *
+ *Simulations that run at the same time can print to their own streams:
+ *once SeparateOutput() was called, cout writes to the stream given to the
+ *SimContext of the calling thread. The format state of cout is shared by
+ *all threads, the simulator does not change it.
+ */
+
+#ifndef _SIM_CONTEXT_HPP_
+#define _SIM_CONTEXT_HPP_
+
+#include <iostream>
+#include <map>
+#include <atomic>
+
+#include "config_utils.hpp"
+#include "object_pool.hpp"
+#include "flit.hpp"
+#include "credit.hpp"
+#include "handshake.hpp"
+
+class TrafficManager;
+
+class SimContext {
+
+  ObjectPool<Flit> _flits;
+  ObjectPool<Credit> _credits;
+  ObjectPool<Handshake> _handshakes;
+  ostream * _watch_out;
+  ostream * _out;
+
+  // random draws made from within a parallel phase
+  std::atomic<long> _parallel_random_draws;
+
+  // the globals of the thread running the simulation
+  TrafficManager * _traffic_manager;
+  bool _print_activity;
+  bool _trace;
+  int _k;
+  int _n;
+  int _c;
+  int _nodes;
+  int _num_vcs;
+  int _read_req_begin_vc, _read_req_end_vc;
+  int _write_req_begin_vc, _write_req_end_vc;
+  int _read_reply_begin_vc, _read_reply_end_vc;
+  int _write_reply_begin_vc, _write_reply_end_vc;
+  /* ==== Power Gate - Begin ==== */
+  int _routing_deadlock_timeout_threshold;
+  int _misroute_threshold;
+  /* ==== Power Gate - End ==== */
+  int _dragonfly_p, _dragonfly_a, _dragonfly_g;
+  map<int, int> * _anynet_routing_table;
+  int _cmesh_x, _cmesh_y;
+  int _cmesh_node_shift_x, _cmesh_node_shift_y, _cmesh_port_shift_y;
+  int _flatfly_x_count, _flatfly_y_count;
+  int _flatfly_x_router, _flatfly_y_router;
+
+  static thread_local SimContext * _current;
+
+  // copy between the globals of the calling thread and the saved values
+  void _Transfer( bool capture );
+
+  SimContext( SimContext const & );
+  SimContext & operator=( SimContext const & );
+
+public:
+  // sets up the calling thread for a simulation of config, printing to out
+  // instead of cout if given
+  SimContext( Configuration const & config, ostream * out = 0 );
+  ~SimContext( );
+
+  // the simulation run by the calling thread
+  static inline SimContext * Current( ) { return _current; }
+
+  // lets each thread running a simulation print to its own stream; called
+  // before the threads are started
+  static void SeparateOutput( );
+
+  inline void CountParallelRandomDraw( ) { ++_parallel_random_draws; }
+  inline long ParallelRandomDraws( ) const { return _parallel_random_draws; }
+
+  // save the globals of the thread running the simulation ...
+  void Capture( );
+  // ... and set them in a worker thread of the parallel engine
+  void Install( );
+};
+
+#endif
@@ -39,16 +39,29 @@
 #include <limits>
 #include <cmath>
 #include <cstdio>
+#include <cassert>
+#include <algorithm>
 
 #include "stats.hpp"
+#include "checkpoint.hpp"
 
 Stats::Stats( Module *parent, const string &name,
 	      double bin_size, int num_bins ) :
-  Module( parent, name ), _num_bins( num_bins ), _bin_size( bin_size )
+  Module( parent, name ), _num_bins( num_bins ), _bin_size( bin_size ),
+  _quantile_bits( 0 )
 {
   Clear();
 }
 
+void Stats::EnableQuantiles( int bits )
+{
+  assert( ( bits > 0 ) && ( bits < 31 ) );
+  _quantile_bits = bits;
+  // buckets for all values below 2^31, larger ones go into the last bucket
+  int const sub_buckets = 1 << bits;
+  _quantile_hist.assign( sub_buckets + ( 31 - bits ) * ( sub_buckets / 2 ), 0 );
+}
+
 void Stats::Clear( )
 {
   _num_samples = 0;
@@ -56,6 +69,7 @@ void Stats::Clear( )
   _sample_squared_sum = 0.0;
 
   _hist.assign(_num_bins, 0);
+  _quantile_hist.assign(_quantile_hist.size(), 0);
 
   _min = numeric_limits<double>::quiet_NaN();
   _max = -numeric_limits<double>::quiet_NaN();
@@ -112,6 +126,92 @@ void Stats::AddSample( double val )
   b = (b >= _num_bins) ? (_num_bins - 1) : b;
 
   _hist[b]++;
+
+  if ( !_quantile_hist.empty() ) {
+    _quantile_hist[_QuantileBucket( val )]++;
+  }
+}
+
+int Stats::_QuantileBucket( double val ) const
+{
+  int const sub_buckets = 1 << _quantile_bits;
+  if ( !( val >= 1.0 ) ) {
+    return 0;
+  } else if ( val < (double)sub_buckets ) {
+    return (int)val;
+  }
+  // val = m * 2^e with 2^(e-1) <= val < 2^e, e > _quantile_bits
+  int e;
+  frexp( val, &e );
+  int const shift = e - _quantile_bits;
+  int const b = sub_buckets + ( shift - 1 ) * ( sub_buckets / 2 ) +
+    (int)ldexp( val, -shift ) - sub_buckets / 2;
+  return min( b, (int)_quantile_hist.size() - 1 );
+}
+
+double Stats::_QuantileValue( int b ) const
+{
+  int const sub_buckets = 1 << _quantile_bits;
+  if ( b < sub_buckets ) {
+    return (double)b;
+  }
+  int const shift = ( b - sub_buckets ) / ( sub_buckets / 2 ) + 1;
+  int const m = ( b - sub_buckets ) % ( sub_buckets / 2 ) + sub_buckets / 2;
+  // middle of the bucket
+  return ldexp( (double)m + 0.5, shift );
+}
+
+// smallest bucket value such that at least a fraction q of the samples are
+// not larger, clamped to the observed range
+double Stats::Quantile( double q ) const
+{
+  assert( HasQuantiles() );
+  if ( _num_samples == 0 ) {
+    return numeric_limits<double>::quiet_NaN();
+  }
+  // tolerance for q * n landing just above an integer due to rounding
+  double const rank = max( ceil( q * (double)_num_samples - 1e-9 ), 1.0 );
+  double count = 0.0;
+  for ( size_t b = 0; b < _quantile_hist.size(); ++b ) {
+    count += (double)_quantile_hist[b];
+    if ( count >= rank ) {
+      return min( max( _QuantileValue( b ), _min ), _max );
+    }
+  }
+  return _max;
+}
+
+void Stats::Merge( Stats const & s )
+{
+  assert( ( _num_bins == s._num_bins ) && ( _bin_size == s._bin_size ) );
+  assert( _quantile_hist.size() == s._quantile_hist.size() );
+  if ( s._num_samples == 0 ) {
+    return;
+  }
+  _num_samples += s._num_samples;
+  _sample_sum += s._sample_sum;
+  _sample_squared_sum += s._sample_squared_sum;
+  _max = !(s._max <= _max) ? s._max : _max;
+  _min = !(s._min >= _min) ? s._min : _min;
+  for ( int b = 0; b < _num_bins; ++b ) {
+    _hist[b] += s._hist[b];
+  }
+  for ( size_t b = 0; b < _quantile_hist.size(); ++b ) {
+    _quantile_hist[b] += s._quantile_hist[b];
+  }
+}
+
+void Stats::Serialize( Checkpoint & cp )
+{
+  cp.Check( _num_bins, FullName( ) + " bins" );
+  cp.Check( _quantile_hist.size( ), FullName( ) + " quantile buckets" );
+  cp.Sync( _num_samples );
+  cp.Sync( _sample_sum );
+  cp.Sync( _sample_squared_sum );
+  cp.Sync( _min );
+  cp.Sync( _max );
+  cp.Sync( _hist );
+  cp.Sync( _quantile_hist );
 }
 
 void Stats::Display( ostream & os ) const
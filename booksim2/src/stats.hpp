@@ -30,6 +30,8 @@
 
 #include "module.hpp"
 
+class Checkpoint;
+
 class Stats : public Module {
   int    _num_samples;
   double _sample_sum;
@@ -44,12 +46,31 @@ class Stats : public Module {
 
   vector<int> _hist;
 
+  // log-linear histogram for quantile estimates, empty unless enabled:
+  // values below 2^_quantile_bits are counted exactly, larger values in
+  // 2^(_quantile_bits-1) buckets per power of two (relative error below
+  // 2^-(_quantile_bits-1))
+  int _quantile_bits;
+  vector<int> _quantile_hist;
+
+  int _QuantileBucket( double val ) const;
+  double _QuantileValue( int b ) const;
+
 public:
   Stats( Module *parent, const string &name,
 	 double bin_size = 1.0, int num_bins = 10 );
 
   void Clear( );
 
+  void EnableQuantiles( int bits = 7 );
+  inline bool HasQuantiles( ) const { return !_quantile_hist.empty(); }
+  double Quantile( double q ) const;
+
+  // adds the samples of another Stats object with the same configuration
+  void Merge( Stats const & s );
+
+  void Serialize( Checkpoint & cp );
+
   double Average( ) const;
   double Variance( ) const;
   double Max( ) const;
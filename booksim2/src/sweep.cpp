@@ -0,0 +1,313 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*sweep.cpp
+ *
+ *parameter sweeps with a pool of worker processes
+ */
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <cassert>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "sweep.hpp"
+#include "globals.hpp"
+
+vector<string> SweepValues( BookSimConfig const & config, string const & param,
+                            string const & list )
+{
+  vector<string> const tokens = tokenize_str( list );
+  vector<string> values;
+
+  for ( size_t i = 0; i < tokens.size( ); ++i ) {
+    if ( tokens[i] != "..." ) {
+      values.push_back( tokens[i] );
+      continue;
+    }
+
+    size_t const n = values.size( );
+    if ( ( n < 2 ) || ( i + 1 >= tokens.size( ) ) ) {
+      config.ParseError( "\"...\" in the values of " + param +
+                         " needs two values before and one after it" );
+    }
+    char * end0;
+    char * end1;
+    char * end2;
+    double const prev = strtod( values[n - 2].c_str( ), &end0 );
+    double const start = strtod( values[n - 1].c_str( ), &end1 );
+    double const last = strtod( tokens[i + 1].c_str( ), &end2 );
+    if ( *end0 || *end1 || *end2 ) {
+      config.ParseError( "\"...\" in the values of " + param + " needs numbers around it" );
+    }
+    double const step = start - prev;
+    double const steps = ( last - start ) / step;
+    if ( ( step == 0.0 ) || ( steps < 0.0 ) ) {
+      config.ParseError( "The values of " + param + " do not approach " + tokens[i + 1] );
+    }
+
+    // compute each value from the start, so rounding errors do not add up;
+    // the value after "..." is added by the next iteration
+    int const count = (int)ceil( steps - 1e-6 ) - 1;
+    for ( int s = 1; s <= count; ++s ) {
+      ostringstream value;
+      value << start + s * step;
+      values.push_back( value.str( ) );
+    }
+  }
+
+  return values;
+}
+
+// numbers are assigned to the numeric field of a parameter, anything else
+// to its string field
+static void _AssignValue( BookSimConfig & config, string const & param,
+                          string const & value )
+{
+  char * end;
+  double const number = strtod( value.c_str( ), &end );
+  bool const numeric = !value.empty( ) && ( *end == '\0' );
+  if ( numeric && config.GetIntMap( ).count( param ) && ( number == floor( number ) ) ) {
+    config.Assign( param, (int)number );
+  } else if ( numeric && config.GetFloatMap( ).count( param ) ) {
+    config.Assign( param, number );
+  } else if ( !config.GetStrMap( ).count( param ) &&
+              ( config.GetIntMap( ).count( param ) || config.GetFloatMap( ).count( param ) ) ) {
+    config.ParseError( "Invalid value " + value + " for " + param );
+  } else {
+    config.Assign( param, value );
+  }
+}
+
+struct SweepWorker {
+  pid_t pid;
+  int fd;
+  int point;
+  string rows;
+};
+
+// runs in the forked worker: simulates one point with its output going to
+// its own log and writes the result rows to fd
+static void _RunPoint( BookSimConfig const & config, int point,
+                       string const & values, string const & log, int fd )
+{
+  ostringstream log_name;
+  if ( log.empty( ) ) {
+    log_name << "/dev/null";
+  } else {
+    log_name << log << '.' << point;
+  }
+  int const out = open( log_name.str( ).c_str( ), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+  if ( out < 0 ) {
+    cerr << "Unable to open sweep log " << log_name.str( ) << ": " << strerror( errno ) << endl;
+    _exit( -1 );
+  }
+  dup2( out, STDOUT_FILENO );
+  close( out );
+
+  ostringstream results;
+  bool const stable = Simulate( config, &results );
+  cout.flush( );
+
+  // "results:<class>,..." becomes "sweep:<point>,<values>,<class>,..."
+  ostringstream rows;
+  if ( stable ) {
+    istringstream in( results.str( ) );
+    string line;
+    while ( getline( in, line ) ) {
+      rows << "sweep:" << point << values << ','
+           << line.substr( line.find( ':' ) + 1 ) << endl;
+    }
+  } else {
+    rows << "sweep:" << point << values << ",unstable" << endl;
+  }
+
+  string const data = rows.str( );
+  size_t written = 0;
+  while ( written < data.size( ) ) {
+    ssize_t const n = write( fd, data.c_str( ) + written, data.size( ) - written );
+    if ( n < 0 ) {
+      if ( errno == EINTR ) {
+        continue;
+      }
+      _exit( -1 );
+    }
+    written += n;
+  }
+  close( fd );
+  _exit( 0 );
+}
+
+bool RunSweep( BookSimConfig const & config )
+{
+  // the points enumerate all combinations of the swept values, with the
+  // last parameter changing fastest
+  vector<string> const params = config.GetStrArray( "sweep_params" );
+  vector<string> const lists = config.GetStrArray( "sweep_values" );
+  if ( params.size( ) != lists.size( ) ) {
+    config.ParseError( "sweep_values needs one list of values per parameter in sweep_params" );
+  }
+  vector<vector<string> > param_values;
+  size_t num_points = 1;
+  for ( size_t p = 0; p < params.size( ); ++p ) {
+    param_values.push_back( SweepValues( config, params[p], lists[p] ) );
+    if ( param_values.back( ).empty( ) ) {
+      config.ParseError( "No values given for " + params[p] );
+    }
+    // report invalid values before any point is simulated
+    BookSimConfig check_config( config );
+    for ( size_t v = 0; v < param_values[p].size( ); ++v ) {
+      _AssignValue( check_config, params[p], param_values[p][v] );
+    }
+    num_points *= param_values.back( ).size( );
+  }
+
+  int jobs = config.GetInt( "sweep_jobs" );
+  if ( jobs <= 0 ) {
+    jobs = max( (int)thread::hardware_concurrency( ), 1 );
+  }
+  jobs = min( jobs, (int)num_points );
+  string const log = config.GetStr( "sweep_log" );
+
+  cout << "SWEEP: " << num_points << " points";
+  for ( size_t p = 0; p < params.size( ); ++p ) {
+    cout << ( p ? ", " : " of " ) << params[p] << " (" << param_values[p].size( ) << " values)";
+  }
+  cout << ", " << jobs << " at a time" << endl;
+  cout << "SWEEP: rows are sweep:point";
+  for ( size_t p = 0; p < params.size( ); ++p ) {
+    cout << ',' << params[p];
+  }
+  cout << ",class,... as in the results: rows" << endl;
+
+  bool success = true;
+  size_t next_point = 0;
+  vector<SweepWorker> workers;
+
+  while ( ( next_point < num_points ) || !workers.empty( ) ) {
+
+    while ( ( (int)workers.size( ) < jobs ) && ( next_point < num_points ) ) {
+      int const point = next_point++;
+
+      BookSimConfig point_config( config );
+      vector<string> values( params.size( ) );
+      int index = point;
+      for ( int p = params.size( ) - 1; p >= 0; --p ) {
+        values[p] = param_values[p][index % param_values[p].size( )];
+        index /= param_values[p].size( );
+        _AssignValue( point_config, params[p], values[p] );
+      }
+      ostringstream row_values;
+      for ( size_t p = 0; p < params.size( ); ++p ) {
+        row_values << ',' << values[p];
+      }
+
+      int pipe_fds[2];
+      if ( pipe( pipe_fds ) < 0 ) {
+        cerr << "Unable to create a pipe: " << strerror( errno ) << endl;
+        exit( -1 );
+      }
+      // the worker would print anything still buffered again
+      cout.flush( );
+      pid_t const pid = fork( );
+      if ( pid < 0 ) {
+        cerr << "Unable to start a sweep worker: " << strerror( errno ) << endl;
+        exit( -1 );
+      }
+      if ( pid == 0 ) {
+        close( pipe_fds[0] );
+        for ( size_t w = 0; w < workers.size( ); ++w ) {
+          close( workers[w].fd );
+        }
+        _RunPoint( point_config, point, row_values.str( ), log, pipe_fds[1] );
+      }
+      close( pipe_fds[1] );
+
+      SweepWorker worker;
+      worker.pid = pid;
+      worker.fd = pipe_fds[0];
+      worker.point = point;
+      workers.push_back( worker );
+    }
+
+    vector<struct pollfd> fds( workers.size( ) );
+    for ( size_t w = 0; w < workers.size( ); ++w ) {
+      fds[w].fd = workers[w].fd;
+      fds[w].events = POLLIN;
+      fds[w].revents = 0;
+    }
+    if ( poll( &fds[0], fds.size( ), -1 ) < 0 ) {
+      if ( errno == EINTR ) {
+        continue;
+      }
+      cerr << "Unable to wait for the sweep workers: " << strerror( errno ) << endl;
+      exit( -1 );
+    }
+
+    for ( int w = workers.size( ) - 1; w >= 0; --w ) {
+      if ( !fds[w].revents ) {
+        continue;
+      }
+      char buffer[4096];
+      ssize_t const n = read( workers[w].fd, buffer, sizeof( buffer ) );
+      if ( n > 0 ) {
+        workers[w].rows.append( buffer, n );
+        continue;
+      }
+      if ( ( n < 0 ) && ( errno == EINTR ) ) {
+        continue;
+      }
+
+      // the worker is done once it closed its end of the pipe
+      close( workers[w].fd );
+      int status;
+      while ( ( waitpid( workers[w].pid, &status, 0 ) < 0 ) && ( errno == EINTR ) );
+      if ( WIFEXITED( status ) && ( WEXITSTATUS( status ) == 0 ) ) {
+        cout << workers[w].rows << flush;
+      } else {
+        cout << "WARNING: Sweep point " << workers[w].point << " failed";
+        if ( !log.empty( ) ) {
+          cout << ", see " << log << '.' << workers[w].point;
+        }
+        cout << endl;
+        success = false;
+      }
+      workers.erase( workers.begin( ) + w );
+    }
+  }
+
+  return success;
+}
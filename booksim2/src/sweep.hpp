@@ -0,0 +1,54 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*sweep.hpp
+ *
+ *Runs a simulation for every combination of the values of the swept
+ *parameters, e.g., sweep_params = {injection_rate,powergate_percentile};
+ *sweep_values = {{0.01,0.02,...,0.3},{10,20,...,80}}; and streams one
+ *result row per point and class as the points finish. The points are
+ *simulated by a bounded pool of worker processes, which inherit the parsed
+ *configuration of the simulator.
+ */
+
+#ifndef _SWEEP_HPP_
+#define _SWEEP_HPP_
+
+#include <string>
+#include <vector>
+
+#include "booksim_config.hpp"
+
+// the values of a list such as {10,20,...,80}; "..." continues the step of
+// the two preceding values up to the value following it
+vector<string> SweepValues( BookSimConfig const & config, string const & param,
+                            string const & list );
+
+// returns false if a point could not be simulated
+bool RunSweep( BookSimConfig const & config );
+
+#endif
@@ -28,13 +28,79 @@
 #ifndef _TIMED_MODULE_HPP_
 #define _TIMED_MODULE_HPP_
 
+#include <limits>
+
 #include "module.hpp"
+#include "active_set.hpp"
+#include "globals.hpp"
 
 class TimedModule : public Module {
 
+protected:
+  ActiveSet * _active_set;
+  int _active_id;
+  /* ==== Power Gate - Begin ==== */
+  // last cycle whose PowerStateEvaluate has been accounted for
+  int _power_time;
+
+  // bring the power state up to date before it is changed from outside of
+  // PowerStateEvaluate, and evaluate the module again
+  inline void _PreparePowerStateChange() {
+    if(_active_set) {
+      SynchronizePowerState(GetSimTime() - 1);
+      Activate();
+    }
+  }
+  /* ==== Power Gate - End ==== */
+
 public:
-  TimedModule(Module * parent, string const & name) : Module(parent, name) {}
+  TimedModule(Module * parent, string const & name) : Module(parent, name),
+    _active_set(0), _active_id(-1), _power_time(-1) {}
   virtual ~TimedModule() {}
+
+  void SetActiveSet(ActiveSet * active_set, int id) {
+    _active_set = active_set;
+    _active_id = id;
+  }
+  // schedule the module for evaluation, e.g., when it receives data
+  inline void Activate() {
+    if(_active_set) _active_set->Insert(_active_id);
+  }
+  // true if the module has nothing to do in the following cycles until it
+  // is activated again
+  virtual bool Quiescent() const { return false; }
+  // number of cycles, starting with the current one, in which ReadInputs,
+  // Evaluate and WriteOutputs are no-ops unless the module is woken up
+  virtual int IdleCycles() const {
+    return Quiescent() ? numeric_limits<int>::max() : 0;
+  }
+  /* ==== Power Gate - Begin ==== */
+  // number of cycles, starting with the current one, until PowerStateEvaluate
+  // changes the power state on its own
+  virtual int NextPowerEventCycle() const {
+    return Quiescent() ? numeric_limits<int>::max() : 0;
+  }
+  // account for skipped idle cycles as PowerStateEvaluate would have
+  virtual void SynchronizeCycle(int cycles) {}
+  // account for the cycles up to and including time in which the module
+  // was not evaluated
+  inline void SynchronizePowerState(int time) {
+    if(time > _power_time) {
+      SynchronizeCycle(time - _power_time);
+      _power_time = time;
+    }
+  }
+  // the clock restarted at time
+  inline void RestartPowerState(int time) { _power_time = time; }
+  // PowerStateEvaluate of the current cycle, after catching up with the
+  // cycles in which the module was skipped
+  void EvaluatePowerState() {
+    int const time = GetSimTime();
+    SynchronizePowerState(time - 1);
+    _power_time = time;
+    PowerStateEvaluate();
+  }
+  /* ==== Power Gate - End ==== */
   
   virtual void ReadInputs() = 0;
   /* ==== Power Gate - Begin ==== */
@@ -0,0 +1,208 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+*/
+
+#include <cassert>
+#include <limits>
+
+#include "timer_wheel.hpp"
+#include "parallel_utils.hpp"
+
+using namespace std;
+
+TimerWheel::TimerWheel( )
+  : _slots( LEVELS * SLOTS ), _time( -1 ), _pending( 0 ), _entries( 0 ),
+    _next( numeric_limits<int>::max( ) ), _next_valid( true )
+{
+}
+
+void TimerWheel::Resize( int size )
+{
+  _due.assign( size, -1 );
+  _Clear( );
+}
+
+void TimerWheel::_Clear( )
+{
+  for ( size_t s = 0; s < _slots.size( ); ++s ) {
+    _slots[s].clear( );
+  }
+  _overflow.clear( );
+  _pending = 0;
+  _entries = 0;
+  _next = numeric_limits<int>::max( );
+  _next_valid = true;
+}
+
+// the level of an event is the first one whose current block contains it
+void TimerWheel::_Insert( sEvent const & e )
+{
+  for ( int level = 0; level < LEVELS; ++level ) {
+    int const shift = SLOT_BITS * ( level + 1 );
+    if ( ( e.time >> shift ) == ( _time >> shift ) ) {
+      int const slot = ( e.time >> ( shift - SLOT_BITS ) ) & ( SLOTS - 1 );
+      _slots[level * SLOTS + slot].push_back( e );
+      return;
+    }
+  }
+  _overflow.push_back( e );
+}
+
+void TimerWheel::Schedule( int id, int time )
+{
+  ParallelLock lock( _lock );
+  assert( ( id >= 0 ) && ( id < (int)_due.size( ) ) );
+  assert( time > _time );
+  if ( _due[id] >= 0 ) {
+    if ( _due[id] == _next ) {
+      _next_valid = false;
+    }
+  } else {
+    ++_pending;
+  }
+  _due[id] = time;
+  if ( _next_valid && ( time < _next ) ) {
+    _next = time;
+  }
+  sEvent const e = { id, time };
+  _Insert( e );
+  ++_entries;
+}
+
+// superseded events are dropped, the others move down to a lower level
+void TimerWheel::_Cascade( vector<sEvent> & slot )
+{
+  if ( slot.empty( ) ) {
+    return;
+  }
+  vector<sEvent> events;
+  events.swap( slot );
+  for ( size_t i = 0; i < events.size( ); ++i ) {
+    if ( _due[events[i].id] == events[i].time ) {
+      _Insert( events[i] );
+    } else {
+      --_entries;
+    }
+  }
+}
+
+void TimerWheel::_Fire( vector<sEvent> & slot, ActiveSet & active )
+{
+  for ( size_t i = 0; i < slot.size( ); ++i ) {
+    sEvent const & e = slot[i];
+    if ( _due[e.id] == e.time ) {
+      assert( e.time == _time );
+      _due[e.id] = -1;
+      --_pending;
+      active.Insert( e.id );
+    }
+  }
+  _entries -= slot.size( );
+  slot.clear( );
+}
+
+void TimerWheel::Advance( int time, ActiveSet & active )
+{
+  if ( time < _time ) {
+    for ( size_t id = 0; id < _due.size( ); ++id ) {
+      if ( _due[id] >= 0 ) {
+        _due[id] = -1;
+        active.Insert( id );
+      }
+    }
+    _Clear( );
+    _time = time;
+    return;
+  }
+
+  // nothing to deliver in between, the wheel can jump ahead
+  if ( !_pending ) {
+    if ( _entries ) {
+      _Clear( );
+    }
+    _time = time;
+    return;
+  }
+
+  while ( _time < time ) {
+    int const now = ++_time;
+    int const mask = SLOTS - 1;
+    if ( !( now & mask ) ) {
+      if ( !( ( now >> SLOT_BITS ) & mask ) ) {
+        if ( !( ( now >> ( 2 * SLOT_BITS ) ) & mask ) ) {
+          _Cascade( _overflow );
+        }
+        _Cascade( _slots[2 * SLOTS + ( ( now >> ( 2 * SLOT_BITS ) ) & mask )] );
+      }
+      _Cascade( _slots[SLOTS + ( ( now >> SLOT_BITS ) & mask )] );
+    }
+    _Fire( _slots[now & mask], active );
+  }
+  if ( _next <= _time ) {
+    _next_valid = false;
+  }
+}
+
+int TimerWheel::NextEvent( ) const
+{
+  if ( !_pending ) {
+    return numeric_limits<int>::max( );
+  }
+  if ( _next_valid ) {
+    return _next;
+  }
+
+  // the slots of each level are in time order, and all events of a level
+  // precede those of the levels above
+  int next = numeric_limits<int>::max( );
+  for ( int level = 0; level < LEVELS; ++level ) {
+    int const shift = SLOT_BITS * level;
+    for ( int slot = ( ( _time >> shift ) & ( SLOTS - 1 ) ) + ( level ? 1 : 0 );
+          slot < SLOTS; ++slot ) {
+      vector<sEvent> const & events = _slots[level * SLOTS + slot];
+      for ( size_t i = 0; i < events.size( ); ++i ) {
+        if ( _due[events[i].id] == events[i].time ) {
+          next = min( next, events[i].time );
+        }
+      }
+      if ( next < numeric_limits<int>::max( ) ) {
+        break;
+      }
+    }
+    if ( next < numeric_limits<int>::max( ) ) {
+      break;
+    }
+  }
+  if ( next == numeric_limits<int>::max( ) ) {
+    for ( size_t i = 0; i < _overflow.size( ); ++i ) {
+      if ( _due[_overflow[i].id] == _overflow[i].time ) {
+        next = min( next, _overflow[i].time );
+      }
+    }
+  }
+  _next = next;
+  _next_valid = true;
+  return next;
+}
@@ -0,0 +1,105 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+*/
+
+/*timer_wheel.hpp
+ *
+ *Hierarchical timing wheel of the power-state events of the timed modules
+ *of a network, e.g., a router reaching its idle threshold, its break-even
+ *time or the end of its wakeup. A module that is retired while one of its
+ *power-state timers is running schedules the cycle of its next event, and
+ *the wheel puts it back into the active set in that cycle, so the
+ *power-state machine is only evaluated when an event fires or when the
+ *module is woken up by a channel or the traffic manager.
+ *
+ *Each module has at most one pending event, scheduling it again supersedes
+ *the previous one, which is dropped when its slot comes up. The first level
+ *has one slot per cycle of the current 256-cycle block, each further level
+ *has one slot per block of the level below, and events beyond the last
+ *level wait in an overflow list. The events of a slot are moved down when
+ *the current cycle enters the block the slot stands for.
+ *
+ *Modules are retired by the worker threads of the parallel engine, so
+ *scheduling is serialized with a lock during parallel phases.
+ */
+
+#ifndef _TIMER_WHEEL_HPP_
+#define _TIMER_WHEEL_HPP_
+
+#include <vector>
+#include <mutex>
+
+#include "active_set.hpp"
+
+class TimerWheel {
+
+  static const int LEVELS = 3;
+  static const int SLOT_BITS = 8;
+  static const int SLOTS = 1 << SLOT_BITS;
+
+  struct sEvent {
+    int id;
+    int time;
+  };
+
+  // pending event of each module, or -1 if there is none
+  std::vector<int> _due;
+  std::vector<std::vector<sEvent> > _slots;
+  std::vector<sEvent> _overflow;
+  // last cycle the wheel was advanced to
+  int _time;
+  // number of pending events, and number of entries including superseded ones
+  int _pending;
+  int _entries;
+  // cached earliest pending event
+  mutable int _next;
+  mutable bool _next_valid;
+  std::mutex _lock;
+
+  void _Insert( sEvent const & e );
+  void _Cascade( std::vector<sEvent> & slot );
+  void _Fire( std::vector<sEvent> & slot, ActiveSet & active );
+  void _Clear( );
+
+public:
+  TimerWheel( );
+
+  void Resize( int size );
+
+  // cycle of the last call to Advance
+  inline int Time( ) const { return _time; }
+
+  // the module is woken up in the given cycle, which lies in the future
+  void Schedule( int id, int time );
+
+  // wake up the modules of all events up to and including the given cycle;
+  // if the clock was restarted, all pending events fire right away
+  void Advance( int time, ActiveSet & active );
+
+  // cycle of the earliest pending event, or the largest int if there is none
+  int NextEvent( ) const;
+};
+
+#endif
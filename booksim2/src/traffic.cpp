@@ -31,13 +31,14 @@
 #include <cmath>
 #include "random_utils.hpp"
 #include "traffic.hpp"
+#include "module.hpp"
 
 TrafficPattern::TrafficPattern(int nodes)
 : _nodes(nodes)
 {
   if(nodes <= 0) {
     cout << "Error: Traffic patterns require at least one node." << endl;
-    exit(-1);
+    throw SimError("Invalid traffic pattern");
   }
 }
 
@@ -86,7 +87,7 @@ TrafficPattern * TrafficPattern::New(string const & pattern, int nodes,
 	}
       } else {
 	cout << "Error: Missing parameter for random permutation traffic pattern: " << pattern << endl;
-	exit(-1);
+	throw SimError("Invalid traffic pattern");
       }
     } else {
       perm_seed = atoi(params[0].c_str());
@@ -127,7 +128,7 @@ TrafficPattern * TrafficPattern::New(string const & pattern, int nodes,
     }
     if(missing_params) {
       cout << "Error: Missing parameters for dragonfly bad permutation traffic pattern: " << pattern << endl;
-      exit(-1);
+      throw SimError("Invalid traffic pattern");
     }
     result = new BadPermDFlyTrafficPattern(nodes, k, n);
   } else if((pattern_name == "tornado") || (pattern_name == "neighbor") ||
@@ -165,7 +166,7 @@ TrafficPattern * TrafficPattern::New(string const & pattern, int nodes,
     }
     if(missing_params) {
       cout << "Error: Missing parameters for digit permutation traffic pattern: " << pattern << endl;
-      exit(-1);
+      throw SimError("Invalid traffic pattern");
     }
     if(pattern_name == "tornado") {
       result = new TornadoTrafficPattern(nodes, k, n, xr);
@@ -194,7 +195,7 @@ TrafficPattern * TrafficPattern::New(string const & pattern, int nodes,
     result = new HotSpotTrafficPattern(nodes, hotspots, rates);
   } else {
     cout << "Error: Unknown traffic pattern: " << pattern << endl;
-    exit(-1);
+    throw SimError("Invalid traffic pattern");
   }
   return result;
 }
@@ -211,7 +212,7 @@ BitPermutationTrafficPattern::BitPermutationTrafficPattern(int nodes)
   if((nodes & -nodes) != nodes) {
     cout << "Error: Bit permutation traffic patterns require the number of "
 	 << "nodes to be a power of two." << endl;
-    exit(-1);
+    throw SimError("Invalid traffic pattern");
   }
 }
 
@@ -237,7 +238,7 @@ TransposeTrafficPattern::TransposeTrafficPattern(int nodes)
   if(_shift % 2) {
     cout << "Error: Transpose traffic pattern requires the number of nodes to "
 	 << "be an even power of two." << endl;
-    exit(-1);
+    throw SimError("Invalid traffic pattern");
   }
   _shift >>= 1;
 }
@@ -456,7 +457,7 @@ Taper64TrafficPattern::Taper64TrafficPattern(int nodes)
   if(nodes != 64) {
     cout << "Error: Tthe Taper64 traffic pattern requires the number of nodes "
 	 << "to be exactly 64." << endl;
-    exit(-1);
+    throw SimError("Invalid traffic pattern");
   }
 }
 
@@ -31,6 +31,7 @@
 #include <limits>
 #include <cstdlib>
 #include <ctime>
+#include <stdint.h>
 
 #include "booksim.hpp"
 #include "booksim_config.hpp"
@@ -69,7 +70,7 @@ TrafficManager * TrafficManager::New(Configuration const & config,
 }
 
 TrafficManager::TrafficManager( const Configuration &config, const vector<Network *> & net )
-    : Module( 0, "traffic_manager" ), _net(net), _empty_network(false), _deadlock_timer(0), _reset_time(0), _drain_time(-1), _cur_id(0), _cur_pid(0), _time(0)
+    : Module( 0, "traffic_manager" ), _net(net), _empty_network(false), _deadlock_timer(0), _step_limit(0), _reset_time(0), _drain_time(-1), _cur_id(0), _cur_pid(0), _time(0)
 {
 
     _nodes = _net[0]->NumNodes( );
@@ -245,6 +246,19 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _injection_process[c] = InjectionProcess::New(injection_process[c], _nodes, _load[c], &config);
     }
 
+    string const injection_sampling = config.GetStr("injection_sampling");
+    if((injection_sampling != "event") && (injection_sampling != "legacy")) {
+        Error("Unknown injection sampling: " + injection_sampling);
+    }
+    // replies are issued by _IssuePacket, so read/write classes are sampled
+    // every cycle
+    _event_injection.resize(_classes);
+    _legacy_injection = false;
+    for(int c = 0; c < _classes; ++c) {
+        _event_injection[c] = (injection_sampling == "event") && !_use_read_write[c];
+        _legacy_injection |= !_event_injection[c];
+    }
+
     // ============ Injection VC states  ============
 
     _buf_states.resize(_nodes);
@@ -291,6 +305,7 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _qdrained[s].resize(_classes);
         _partial_packets[s].resize(_classes);
     }
+    _next_inject.resize(_nodes, vector<int>(_classes));
 
     _total_in_flight_flits.resize(_classes);
     _measured_in_flight_flits.resize(_classes);
@@ -321,7 +336,8 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     }
     RandomSeed(seed);
 
-    _measure_latency = (config.GetStr("sim_type") == "latency");
+    _measure_latency = (config.GetStr("sim_type") == "latency") ||
+                       (config.GetInt("measure_latency") > 0);
 
     _sample_period = config.GetInt( "sample_period" );
     _max_samples    = config.GetInt( "max_samples" );
@@ -329,6 +345,42 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
 
     _converged_threshold = config.GetInt("converged_threshold");
 
+    string const stopping_mode = config.GetStr("stopping_mode");
+    if(stopping_mode == "confidence") {
+        _confidence_stopping = true;
+    } else if(stopping_mode == "convergence") {
+        _confidence_stopping = false;
+    } else {
+        ostringstream err;
+        err << "Unknown stopping mode: " << stopping_mode;
+        Error( err.str( ) );
+    }
+    _ci_half_width = config.GetFloat("ci_half_width");
+    _ci_confidence = config.GetFloat("ci_confidence");
+    if((_ci_confidence <= 0.0) || (_ci_confidence >= 1.0)) {
+        ostringstream err;
+        err << "Confidence level " << _ci_confidence << " not in (0, 1)";
+        Error( err.str( ) );
+    }
+    int const ci_min_batches = config.GetInt("ci_min_batches");
+    if(ci_min_batches < 2) {
+        Error("ci_min_batches must be at least 2");
+    }
+
+    _checkpoint_out = config.GetStr("checkpoint_out");
+    _checkpoint_in = config.GetStr("checkpoint_in");
+    _checkpoint_warmup = (config.GetInt("checkpoint_warmup") > 0);
+    if(!_checkpoint_out.empty() || !_checkpoint_in.empty()) {
+        string const sim_type = config.GetStr("sim_type");
+        string const router = config.GetStr("router");
+        if(((sim_type != "latency") && (sim_type != "throughput") &&
+            (sim_type != "flov") && (sim_type != "nord") && (sim_type != "rp")) ||
+           (router == "event") || (router == "chaos")) {
+            Error("Checkpoints are not supported for " + sim_type +
+                  " simulations with " + router + " routers");
+        }
+    }
+
     _measure_stats = config.GetIntArray( "measure_stats" );
     if(_measure_stats.empty()) {
         _measure_stats.push_back(config.GetInt("measure_stats"));
@@ -336,12 +388,26 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _measure_stats.resize(_classes, _measure_stats.back());
     _pair_stats = (config.GetInt("pair_stats")==1);
 
+    _latency_quantiles = config.GetFloatArray( "latency_quantiles" );
+    for(size_t i = 0; i < _latency_quantiles.size(); ++i) {
+        if((_latency_quantiles[i] <= 0.0) || (_latency_quantiles[i] > 1.0)) {
+            ostringstream err;
+            err << "Latency quantile " << _latency_quantiles[i]
+                << " not in (0, 1]";
+            Error( err.str( ) );
+        }
+    }
+
     _latency_thres = config.GetFloatArray( "latency_thres" );
     if(_latency_thres.empty()) {
         _latency_thres.push_back(config.GetFloat("latency_thres"));
     }
     _latency_thres.resize(_classes, _latency_thres.back());
 
+    _latency_trend_periods = config.GetInt("latency_trend_periods");
+    _latency_trend_growth = config.GetFloat("latency_trend_growth");
+    _latency_trend_min_samples = config.GetInt("latency_trend_min_samples");
+
     _warmup_threshold = config.GetFloatArray( "warmup_thres" );
     if(_warmup_threshold.empty()) {
         _warmup_threshold.push_back(config.GetFloat("warmup_thres"));
@@ -371,6 +437,8 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _print_csv_results = config.GetInt( "print_csv_results" );
     _deadlock_warn_timeout = config.GetInt( "deadlock_warn_timeout" );
 
+    _fast_forward = (config.GetInt( "fast_forward" ) > 0) && !gTrace;
+
     string watch_file = config.GetStr( "watch_file" );
     if((watch_file != "") && (watch_file != "-")) {
         _LoadWatchList(watch_file);
@@ -398,6 +466,13 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         config.WriteMatlabFile(_stats_out);
     }
 
+    string pair_stats_out_file = config.GetStr( "pair_stats_out" );
+    if((pair_stats_out_file == "") || !_pair_stats) {
+        _pair_stats_out = NULL;
+    } else {
+        _pair_stats_out = new ofstream(pair_stats_out_file.c_str(), ios::binary);
+    }
+
 #ifdef TRACK_FLOWS
     _injected_flits.resize(_classes, vector<int>(_nodes, 0));
     _ejected_flits.resize(_classes, vector<int>(_nodes, 0));
@@ -478,6 +553,14 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _overall_avg_nlat.resize(_classes, 0.0);
     _overall_max_nlat.resize(_classes, 0.0);
 
+    _overall_plat_quantiles.resize(_classes, vector<double>(_latency_quantiles.size(), 0.0));
+    _overall_nlat_quantiles.resize(_classes, vector<double>(_latency_quantiles.size(), 0.0));
+
+    _plat_batches.resize(_classes, BatchMeans(ci_min_batches));
+    _accepted_batches.resize(_classes, BatchMeans(ci_min_batches));
+    _overall_plat_ci.resize(_classes, 0.0);
+    _overall_accepted_ci.resize(_classes, 0.0);
+
     _flat_stats.resize(_classes);
     _overall_min_flat.resize(_classes, 0.0);
     _overall_avg_flat.resize(_classes, 0.0);
@@ -488,6 +571,7 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _overall_avg_frag.resize(_classes, 0.0);
     _overall_max_frag.resize(_classes, 0.0);
 
+    int const pair_quantile_bits = config.GetInt("pair_quantile_bits");
     if(_pair_stats){
         _pair_plat.resize(_classes);
         _pair_nlat.resize(_classes);
@@ -541,6 +625,11 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _stats[tmp_name.str()] = _nlat_stats[c];
         tmp_name.str("");
 
+        if(!_latency_quantiles.empty()) {
+            _plat_stats[c]->EnableQuantiles();
+            _nlat_stats[c]->EnableQuantiles();
+        }
+
         tmp_name << "flat_stat_" << c;
         _flat_stats[c] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
         _stats[tmp_name.str()] = _flat_stats[c];
@@ -556,12 +645,6 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _stats[tmp_name.str()] = _hop_stats[c];
         tmp_name.str("");
 
-        if(_pair_stats){
-            _pair_plat[c].resize(_nodes*_nodes);
-            _pair_nlat[c].resize(_nodes*_nodes);
-            _pair_flat[c].resize(_nodes*_nodes);
-        }
-
         _sent_packets[c].resize(_nodes, 0);
         _accepted_packets[c].resize(_nodes, 0);
         _sent_flits[c].resize(_nodes, 0);
@@ -575,24 +658,17 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _crossbar_conflict_stalls[c].resize(_subnets*_routers, 0);
 #endif
         if(_pair_stats){
-            for ( int i = 0; i < _nodes; ++i ) {
-                for ( int j = 0; j < _nodes; ++j ) {
-                    tmp_name << "pair_plat_stat_" << c << "_" << i << "_" << j;
-                    _pair_plat[c][i*_nodes+j] = new Stats( this, tmp_name.str( ), 1.0, 250 );
-                    _stats[tmp_name.str()] = _pair_plat[c][i*_nodes+j];
-                    tmp_name.str("");
-
-                    tmp_name << "pair_nlat_stat_" << c << "_" << i << "_" << j;
-                    _pair_nlat[c][i*_nodes+j] = new Stats( this, tmp_name.str( ), 1.0, 250 );
-                    _stats[tmp_name.str()] = _pair_nlat[c][i*_nodes+j];
-                    tmp_name.str("");
-
-                    tmp_name << "pair_flat_stat_" << c << "_" << i << "_" << j;
-                    _pair_flat[c][i*_nodes+j] = new Stats( this, tmp_name.str( ), 1.0, 250 );
-                    _stats[tmp_name.str()] = _pair_flat[c][i*_nodes+j];
-                    tmp_name.str("");
-                }
-            }
+            tmp_name << "pair_plat_stat_" << c;
+            _pair_plat[c] = new PairStats( this, tmp_name.str( ), _nodes, pair_quantile_bits );
+            tmp_name.str("");
+
+            tmp_name << "pair_nlat_stat_" << c;
+            _pair_nlat[c] = new PairStats( this, tmp_name.str( ), _nodes, pair_quantile_bits );
+            tmp_name.str("");
+
+            tmp_name << "pair_flat_stat_" << c;
+            _pair_flat[c] = new PairStats( this, tmp_name.str( ), _nodes, pair_quantile_bits );
+            tmp_name.str("");
         }
     }
 
@@ -622,18 +698,15 @@ TrafficManager::~TrafficManager( )
         delete _traffic_pattern[c];
         delete _injection_process[c];
         if(_pair_stats){
-            for ( int i = 0; i < _nodes; ++i ) {
-                for ( int j = 0; j < _nodes; ++j ) {
-                    delete _pair_plat[c][i*_nodes+j];
-                    delete _pair_nlat[c][i*_nodes+j];
-                    delete _pair_flat[c][i*_nodes+j];
-                }
-            }
+            delete _pair_plat[c];
+            delete _pair_nlat[c];
+            delete _pair_flat[c];
         }
     }
 
     if(gWatchOut && (gWatchOut != &cout)) delete gWatchOut;
     if(_stats_out && (_stats_out != &cout)) delete _stats_out;
+    if(_pair_stats_out) delete _pair_stats_out;
 
 #ifdef TRACK_FLOWS
     if(_injected_flits_out) delete _injected_flits_out;
@@ -651,6 +724,15 @@ TrafficManager::~TrafficManager( )
     if(_max_credits_out) delete _max_credits_out;
 #endif
 
+    int const leaked_flits = Flit::OutStanding();
+    int const leaked_credits = Credit::OutStanding();
+    int const leaked_handshakes = Handshake::OutStanding();
+    if(leaked_flits || leaked_credits || leaked_handshakes) {
+        cout << "WARNING: " << leaked_flits << " flits, "
+             << leaked_credits << " credits and "
+             << leaked_handshakes << " handshakes were not freed." << endl;
+    }
+
     PacketReplyInfo::FreeAll();
     Flit::FreeAll();
     Credit::FreeAll();
@@ -693,7 +775,7 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
         _slowest_flit[f->cl] = f->id;
     _flat_stats[f->cl]->AddSample( f->atime - f->itime);
     if(_pair_stats){
-        _pair_flat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - f->itime );
+        _pair_flat[f->cl]->AddSample( f->src, dest, f->atime - f->itime );
     }
 
     if ( f->tail ) {
@@ -751,8 +833,8 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
             _frag_stats[f->cl]->AddSample( (f->atime - head->atime) - (f->id - head->id) );
 
             if(_pair_stats){
-                _pair_plat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - head->ctime );
-                _pair_nlat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - head->itime );
+                _pair_plat[f->cl]->AddSample( f->src, dest, f->atime - head->ctime );
+                _pair_nlat[f->cl]->AddSample( f->src, dest, f->atime - head->itime );
             }
         }
 
@@ -959,10 +1041,20 @@ void TrafficManager::_Inject(){
 
     for ( int input = 0; input < _nodes; ++input ) {
         /* ==== Power Gate - Begin ==== */
-        if (core_states[input] == false)
+        if (core_states[input] == false) {
+            // a power-off core generates no more packets
+            for ( int c = 0; ( _sim_state == draining ) && ( c < _classes ); ++c ) {
+                if ( !_event_injection[c] && _partial_packets[input][c].empty() ) {
+                    _qdrained[input][c] = true;
+                }
+            }
             continue;
+        }
         /* ==== Power Gate - End ==== */
         for ( int c = 0; c < _classes; ++c ) {
+            if ( _event_injection[c] ) {
+                continue;
+            }
             // Potentially generate packets for any (input,class)
             // that is currently empty
             if ( _partial_packets[input][c].empty() ) {
@@ -989,10 +1081,190 @@ void TrafficManager::_Inject(){
             }
         }
     }
+
+    _InjectEvents();
+}
+
+void TrafficManager::_InitInjectionEvents( )
+{
+    while ( !_inject_events.empty() ) {
+        _inject_events.pop();
+    }
+    _inject_blocked.clear();
+
+    vector<bool> & core_states = _net[0]->GetCoreStates();
+    for ( int input = 0; input < _nodes; ++input ) {
+        for ( int c = 0; c < _classes; ++c ) {
+            _next_inject[input][c] = numeric_limits<int>::max();
+            if ( _event_injection[c] && core_states[input] ) {
+                _ScheduleInjection( input, c );
+            }
+        }
+    }
+}
+
+// draws the next injection of a source, sampling from _qtime on
+void TrafficManager::_ScheduleInjection( int source, int cl )
+{
+    int const time = _injection_process[cl]->next( source, _qtime[source][cl] );
+    _next_inject[source][cl] = time;
+    if ( time < numeric_limits<int>::max() ) {
+        _inject_events.push( make_pair( time, source * _classes + cl ) );
+    }
+}
+
+/* Event-based counterpart of the per-cycle sampling in _Inject(): only the
+ * sources whose next injection time has come up are visited. As before, a
+ * source with a non-empty queue holds back its packet until the queue has
+ * drained, and the packet keeps its original creation time.
+ */
+void TrafficManager::_InjectEvents( )
+{
+    size_t kept = 0;
+    for ( size_t i = 0; i < _inject_blocked.size(); ++i ) {
+        int const input = _inject_blocked[i] / _classes;
+        int const c = _inject_blocked[i] % _classes;
+        if ( !_partial_packets[input][c].empty() ) {
+            _inject_blocked[kept++] = _inject_blocked[i];
+        } else {
+            _inject_events.push( make_pair( _next_inject[input][c],
+                                            _inject_blocked[i] ) );
+        }
+    }
+    _inject_blocked.resize(kept);
+
+    while ( !_inject_events.empty() &&
+            ( _inject_events.top().first <= _time ) ) {
+        int const input = _inject_events.top().second / _classes;
+        int const c = _inject_events.top().second % _classes;
+        int const time = _inject_events.top().first;
+        _inject_events.pop();
+        /* ==== Power Gate - Begin ==== */
+        if ( time != _next_inject[input][c] ) {
+            // rescheduled when the core was turned off or on
+            continue;
+        }
+        /* ==== Power Gate - End ==== */
+        if ( !_partial_packets[input][c].empty() ) {
+            _inject_blocked.push_back( input * _classes + c );
+            continue;
+        }
+        _packet_seq_no[input]++;
+        _requestsOutstanding[input]++;
+        _GeneratePacket( input, 1, c, _include_queuing==1 ? time : _time );
+        _qtime[input][c] = time + 1;
+        _ScheduleInjection( input, c );
+    }
+
+    if ( _sim_state == draining ) {
+        for ( int input = 0; input < _nodes; ++input ) {
+            for ( int c = 0; c < _classes; ++c ) {
+                if ( _event_injection[c] && _partial_packets[input][c].empty() &&
+                     ( _next_inject[input][c] > _drain_time ) ) {
+                    _qdrained[input][c] = true;
+                }
+            }
+        }
+    }
+}
+
+/* ==== Power Gate - Begin ==== */
+// Turns a core off or on at runtime. A power-off core neither generates
+// packets nor is chosen as a destination; a core turned on samples its
+// injection processes from the current cycle on.
+void TrafficManager::_SetCoreState( int node, bool state )
+{
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+        _net[subnet]->GetCoreStates()[node] = state;
+    }
+    for ( int c = 0; c < _classes; ++c ) {
+        if ( state ) {
+            _qtime[node][c] = _time;
+            if ( _event_injection[c] ) {
+                _ScheduleInjection( node, c );
+            }
+        } else {
+            _next_inject[node][c] = numeric_limits<int>::max();
+        }
+    }
+}
+/* ==== Power Gate - End ==== */
+
+/* Skips over cycles in which neither the routers nor the channels have any
+ * work and no flits are waiting at the sources. With event-based injection
+ * or once the network is drained, the cycles are skipped entirely; with
+ * legacy sampling, the injection processes are still sampled in each of
+ * those cycles, in the same order as in _Step(), so the results are identical
+ * to simulating every cycle. Skipping stops at the first cycle in which a
+ * packet is generated or the network has work, which the caller then
+ * simulates, or at _step_limit. Returns false if the step limit was reached.
+ */
+bool TrafficManager::_SkipIdleCycles( bool power_evaluate )
+{
+    if ( _step_limit <= _time + 1 ) {
+        return true;
+    }
+
+    int idle = _step_limit - _time;
+    for ( int subnet = 0; ( subnet < _subnets ) && ( idle > 0 ); ++subnet ) {
+        idle = _net[subnet]->IdleCycles( idle, power_evaluate );
+    }
+    if ( idle <= 0 ) {
+        return true;
+    }
+
+    bool flits_in_flight = false;
+    for(int c = 0; c < _classes; ++c) {
+        flits_in_flight |= !_total_in_flight_flits[c].empty();
+    }
+    if ( flits_in_flight ) {
+        // flits may only be in flight on the channels, and the deadlock
+        // warning must not be skipped
+        for ( int n = 0; n < _nodes; ++n ) {
+            for ( int c = 0; c < _classes; ++c ) {
+                if ( !_partial_packets[n][c].empty() ) {
+                    return true;
+                }
+            }
+        }
+        idle = min( idle, _deadlock_warn_timeout - _deadlock_timer );
+        if ( idle <= 0 ) {
+            return true;
+        }
+    }
+
+    int const start = _time;
+    int const end = _time + idle;
+    if ( _empty_network ) {
+        _time = end;
+    } else if ( !_legacy_injection ) {
+        _time = _inject_events.empty() ? end :
+            min( end, _inject_events.top().first );
+    } else {
+        while ( _time < end ) {
+            int const pid = _cur_pid;
+            _Inject();
+            if ( _cur_pid != pid ) {
+                // calling _Inject() again in this cycle has no effect
+                break;
+            }
+            ++_time;
+        }
+    }
+
+    if ( flits_in_flight ) {
+        _deadlock_timer += _time - start;
+    }
+
+    return ( _time < _step_limit );
 }
 
 void TrafficManager::_Step( )
 {
+    if ( _fast_forward && !_SkipIdleCycles( false ) ) {
+        return;
+    }
+
     bool flits_in_flight = false;
     for(int c = 0; c < _classes; ++c) {
         flits_in_flight |= !_total_in_flight_flits[c].empty();
@@ -1028,7 +1300,7 @@ void TrafficManager::_Step( )
             Credit * const c = _net[subnet]->ReadCredit( n );
             if ( c ) {
 #ifdef TRACK_FLOWS
-                for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+                for(VCMask::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
                     int const vc = *iter;
                     assert(!_outstanding_classes[n][subnet][vc].empty());
                     int cl = _outstanding_classes[n][subnet][vc].front();
@@ -1099,7 +1371,7 @@ void TrafficManager::_Step( )
 
                     OutputSet route_set;
                     _rf(NULL, cf, -1, &route_set, true);
-                    set<OutputSet::sSetElement> const & os = route_set.GetSet();
+                    OutputSet::ElementSet const & os = route_set.GetSet();
                     assert(os.size() == 1);
                     OutputSet::sSetElement const & se = *os.begin();
                     assert(se.output_port == -1);
@@ -1126,7 +1398,7 @@ void TrafficManager::_Step( )
                                        << "Generating lookahead routing info for flit " << cf->id
                                        << " (NOQ)." << endl;
                         }
-                        set<OutputSet::sSetElement> const sl = cf->la_route_set.GetSet();
+                        OutputSet::ElementSet const sl = cf->la_route_set.GetSet();
                         assert(sl.size() == 1);
                         int next_output = sl.begin()->output_port;
                         vc_count /= router->NumOutputs();
@@ -1366,13 +1638,9 @@ void TrafficManager::_ClearStats( )
         _crossbar_conflict_stalls[c].assign(_subnets*_routers, 0);
 #endif
         if(_pair_stats){
-            for ( int i = 0; i < _nodes; ++i ) {
-                for ( int j = 0; j < _nodes; ++j ) {
-                    _pair_plat[c][i*_nodes+j]->Clear( );
-                    _pair_nlat[c][i*_nodes+j]->Clear( );
-                    _pair_flat[c][i*_nodes+j]->Clear( );
-                }
-            }
+            _pair_plat[c]->Clear( );
+            _pair_nlat[c]->Clear( );
+            _pair_flat[c]->Clear( );
         }
         _hop_stats[c]->Clear();
 
@@ -1463,8 +1731,43 @@ bool TrafficManager::_SingleSim( )
     vector<double> prev_accepted(_classes, 0.0);
     bool clear_last = false;
     int total_phases = 0;
-    while( ( total_phases < _max_samples ) &&
-           ( ( _sim_state != running ) ||
+
+    // in confidence mode every sample period yields one observation of the
+    // latency and accepted rate of each class, taken as the difference of
+    // the accumulated statistics over the period; the latency trend is
+    // taken from the same differences
+    vector<vector<double> > warmup_latency(_classes);
+    vector<vector<double> > warmup_accepted(_classes);
+    vector<double> period_latency(_classes, 0.0);
+    vector<double> period_count(_classes, 0.0);
+    vector<int> period_accepted(_classes, 0);
+    bool ci_reached = false;
+
+    // latency of the packets that arrived in the last sample period, and the
+    // number of successive periods in which it grew
+    vector<double> trend_latency(_classes, 0.0);
+    vector<int> trend_periods(_classes, 0);
+    for(int c = 0; c < _classes; ++c) {
+        _plat_batches[c].Clear();
+        _accepted_batches[c].Clear();
+    }
+
+    if ( !_checkpoint_in.empty( ) ) {
+        // resume from a warmed-up state
+        Checkpoint cp( _checkpoint_in, true );
+        _SerializeState( cp, total_phases, prev_latency, prev_accepted );
+        cout << "Restored checkpoint " << _checkpoint_in << " at time " << _time << " cycles" << endl;
+        _checkpoint_in.clear( );
+        clear_last = true;
+        if ( _checkpoint_warmup ) {
+            // the state was warmed up at another load
+            _sim_state = warming_up;
+            total_phases = 0;
+        }
+    }
+
+    while( ( total_phases < _max_samples ) && !ci_reached &&
+           ( ( _sim_state != running ) || _confidence_stopping ||
              ( _converged_threshold == -1 || converged < _converged_threshold ) ) ) {
 
         if ( clear_last || (( ( _sim_state == warming_up ) && ( ( total_phases % 2 ) == 0 ) )) ) {
@@ -1472,9 +1775,22 @@ bool TrafficManager::_SingleSim( )
             _ClearStats( );
         }
 
+        int const period_start = _time;
+        if ( _confidence_stopping || ( _latency_trend_periods > 0 ) ) {
+            for(int c = 0; c < _classes; ++c) {
+                period_latency[c] = _plat_stats[c]->Sum();
+                period_count[c] = (double)_plat_stats[c]->NumSamples();
+                _ComputeStats( _accepted_flits[c], &period_accepted[c] );
+            }
+        }
+
 
-        for ( int iter = 0; iter < _sample_period; ++iter )
+        int const sample_end = _time + _sample_period;
+        while ( _time < sample_end ) {
+            _step_limit = sample_end;
             _Step( );
+        }
+        _step_limit = 0;
 
         //cout << _sim_state << endl;
 
@@ -1482,6 +1798,7 @@ bool TrafficManager::_SingleSim( )
         DisplayStats();
 
         int lat_exc_class = -1;
+        int lat_trend_class = -1;
         int lat_chg_exc_class = -1;
         int acc_chg_exc_class = -1;
 
@@ -1521,6 +1838,17 @@ bool TrafficManager::_SingleSim( )
                 lat_exc_class = c;
             }
 
+            if(_latency_trend_periods > 0) {
+                double const period_samples =
+                    (double)_plat_stats[c]->NumSamples() - period_count[c];
+                if((period_samples > 0.0) &&
+                   _LatencyGrowing((_plat_stats[c]->Sum() - period_latency[c]) / period_samples,
+                                   (int)period_samples, trend_latency[c], trend_periods[c]) &&
+                   (lat_trend_class < 0)) {
+                    lat_trend_class = c;
+                }
+            }
+
             cout << "latency change    = " << latency_change << endl;
             if(lat_chg_exc_class < 0) {
                 if((_sim_state == warming_up) &&
@@ -1550,9 +1878,13 @@ bool TrafficManager::_SingleSim( )
         }
 
         // Fail safe for latency mode, throughput will ust continue
-        if ( _measure_latency && ( lat_exc_class >= 0 ) ) {
+        if ( _measure_latency && ( ( lat_exc_class >= 0 ) || ( lat_trend_class >= 0 ) ) ) {
 
-            cout << "Average latency for class " << lat_exc_class << " exceeded " << _latency_thres[lat_exc_class] << " cycles. Aborting simulation." << endl;
+            if ( lat_exc_class >= 0 ) {
+                cout << "Average latency for class " << lat_exc_class << " exceeded " << _latency_thres[lat_exc_class] << " cycles. Aborting simulation." << endl;
+            } else {
+                cout << "Average latency for class " << lat_trend_class << " grew in " << _latency_trend_periods << " successive sample periods. Aborting simulation." << endl;
+            }
             converged = 0;
             _sim_state = draining;
             _drain_time = _time;
@@ -1563,7 +1895,51 @@ bool TrafficManager::_SingleSim( )
 
         }
 
-        if ( _sim_state == warming_up ) {
+        if ( _confidence_stopping ) {
+
+            bool warmed_up = true;
+            for(int c = 0; c < _classes; ++c) {
+
+                if(_measure_stats[c] == 0) {
+                    continue;
+                }
+
+                int accepted_count;
+                _ComputeStats( _accepted_flits[c], &accepted_count );
+                double const accepted =
+                    (double)( accepted_count - period_accepted[c] ) /
+                    (double)( _time - period_start ) / (double)_nodes;
+                double const count =
+                    (double)_plat_stats[c]->NumSamples() - period_count[c];
+
+                if ( _sim_state == warming_up ) {
+                    if ( count > 0.0 ) {
+                        warmup_latency[c].push_back( ( _plat_stats[c]->Sum() - period_latency[c] ) / count );
+                    }
+                    warmup_accepted[c].push_back( accepted );
+                    if ( ( _measure_latency && ( BatchMeans::MSER5( warmup_latency[c] ) < 0 ) ) ||
+                         ( BatchMeans::MSER5( warmup_accepted[c] ) < 0 ) ) {
+                        warmed_up = false;
+                    }
+                } else if ( _sim_state == running ) {
+                    if ( count > 0.0 ) {
+                        _plat_batches[c].AddObservation( ( _plat_stats[c]->Sum() - period_latency[c] ) / count );
+                    }
+                    _accepted_batches[c].AddObservation( accepted );
+                }
+            }
+
+            if ( _sim_state == warming_up ) {
+                if ( warmed_up ) {
+                    cout << "Warmed up ..." <<  "Time used is " << _time << " cycles" <<endl;
+                    clear_last = true;
+                    _sim_state = running;
+                }
+            } else if ( _sim_state == running ) {
+                ci_reached = _ConfidenceReached( );
+            }
+
+        } else if ( _sim_state == warming_up ) {
             if ( ( _warmup_periods > 0 ) ?
                  ( total_phases + 1 >= _warmup_periods ) :
                  ( ( !_measure_latency || ( lat_chg_exc_class < 0 ) ) &&
@@ -1580,9 +1956,25 @@ bool TrafficManager::_SingleSim( )
                 converged = 0;
             }
         }
+
+        if ( clear_last && !_checkpoint_out.empty( ) ) {
+            // just warmed up, the statistics are cleared before the next
+            // sample period
+            Checkpoint cp( _checkpoint_out, false );
+            int next_phase = total_phases + 1;
+            _SerializeState( cp, next_phase, prev_latency, prev_accepted );
+            cp.Save( );
+            cout << "Saved checkpoint " << _checkpoint_out << " at time " << _time << " cycles" << endl;
+            _checkpoint_out.clear( );
+        }
         ++total_phases;
     }
 
+    if ( _confidence_stopping && ( _sim_state == running ) && !ci_reached ) {
+        cout << "WARNING: Confidence intervals not reached within " << _max_samples
+             << " sample periods" << endl;
+    }
+
     if ( _sim_state == running ) {
         ++converged;
 
@@ -1592,6 +1984,12 @@ bool TrafficManager::_SingleSim( )
         if ( _measure_latency ) {
             cout << "Draining all recorded packets ..." << endl;
             int empty_steps = 0;
+            trend_latency.assign(_classes, 0.0);
+            trend_periods.assign(_classes, 0);
+            for(int c = 0; c < _classes; ++c) {
+                period_latency[c] = _plat_stats[c]->Sum();
+                period_count[c] = (double)_plat_stats[c]->NumSamples();
+            }
             while( _PacketsOutstanding( ) ) {
                 _Step( );
 
@@ -1600,6 +1998,26 @@ bool TrafficManager::_SingleSim( )
                 if ( empty_steps % 1000 == 0 ) {
 
                     int lat_exc_class = -1;
+                    int lat_trend_class = -1;
+
+                    for(int c = 0; (c < _classes) && (_latency_trend_periods > 0); c++) {
+                        double const samples =
+                            (double)_plat_stats[c]->NumSamples() - period_count[c];
+                        if(samples > 0.0) {
+                            _LatencyGrowing((_plat_stats[c]->Sum() - period_latency[c]) / samples,
+                                            (int)samples, trend_latency[c], trend_periods[c]);
+                        } else if(_measured_in_flight_flits[c].empty()) {
+                            // only waiting for source queues that do not run
+                            // empty any more
+                            ++trend_periods[c];
+                        }
+                        if((lat_trend_class < 0) &&
+                           (trend_periods[c] >= _latency_trend_periods)) {
+                            lat_trend_class = c;
+                        }
+                        period_latency[c] = _plat_stats[c]->Sum();
+                        period_count[c] = (double)_plat_stats[c]->NumSamples();
+                    }
 
                     for(int c = 0; c < _classes; c++) {
 
@@ -1626,8 +2044,12 @@ bool TrafficManager::_SingleSim( )
                         }
                     }
 
-                    if(lat_exc_class >= 0) {
-                        cout << "Average latency for class " << lat_exc_class << " exceeded " << _latency_thres[lat_exc_class] << " cycles. Aborting simulation." << endl;
+                    if((lat_exc_class >= 0) || (lat_trend_class >= 0)) {
+                        if(lat_exc_class >= 0) {
+                            cout << "Average latency for class " << lat_exc_class << " exceeded " << _latency_thres[lat_exc_class] << " cycles. Aborting simulation." << endl;
+                        } else {
+                            cout << "Average latency for class " << lat_trend_class << " grew in " << _latency_trend_periods << " successive drain intervals. Aborting simulation." << endl;
+                        }
                         converged = 0;
                         _sim_state = warming_up;
                         if(_stats_out) {
@@ -1648,10 +2070,155 @@ bool TrafficManager::_SingleSim( )
     return ( converged > 0 );
 }
 
+bool TrafficManager::_ConfidenceReached( ) const
+{
+    bool reached = true;
+    for(int c = 0; c < _classes; ++c) {
+
+        if(_measure_stats[c] == 0) {
+            continue;
+        }
+
+        double mean, half_width;
+        int batches;
+        if ( _measure_latency ) {
+            if ( _plat_batches[c].Interval( _ci_confidence, &mean, &half_width, &batches ) ) {
+                cout << "latency interval  = " << mean << " +/- " << half_width
+                     << " (" << batches << " batches)" << endl;
+                reached = reached && ( half_width <= _ci_half_width * fabs( mean ) );
+            } else {
+                reached = false;
+            }
+        }
+        if ( _accepted_batches[c].Interval( _ci_confidence, &mean, &half_width, &batches ) ) {
+            cout << "accepted interval = " << mean << " +/- " << half_width
+                 << " (" << batches << " batches)" << endl;
+            reached = reached && ( half_width <= _ci_half_width * fabs( mean ) );
+        } else {
+            reached = false;
+        }
+    }
+    return reached;
+}
+
+// the latency grew by more than the trend growth in the given number of
+// successive measurements; the average of a period with few packets is too
+// noisy to tell, e.g., near zero load, so such a period does not count
+bool TrafficManager::_LatencyGrowing( double latency, int samples, double & last, int & periods ) const
+{
+    if ( samples < _latency_trend_min_samples ) {
+        return false;
+    }
+    if ( ( last > 0.0 ) && ( latency > last * ( 1.0 + _latency_trend_growth ) ) ) {
+        ++periods;
+    } else {
+        periods = 0;
+    }
+    last = latency;
+    return ( periods >= _latency_trend_periods );
+}
+
+/* The state at the end of a cycle. Only the state that carries over into the
+ * measurement is saved: the statistics are cleared once the simulation is
+ * warmed up, and the traffic patterns and injection rates are given by the
+ * configuration.
+ */
+void TrafficManager::_SerializeState( Checkpoint & cp, int & total_phases,
+                                      vector<double> & prev_latency,
+                                      vector<double> & prev_accepted )
+{
+    cp.Check( _nodes, "number of nodes" );
+    cp.Check( _classes, "number of classes" );
+    cp.Check( _subnets, "number of subnets" );
+    cp.Check( _vcs, "number of VCs" );
+
+    if ( cp.Loading( ) && ( ( Flit::OutStanding( ) != 0 ) ||
+                            ( Credit::OutStanding( ) != 0 ) ) ) {
+        Error( "Checkpoints can only be restored into an empty network" );
+    }
+
+    cp.Sync( _time );
+    cp.Sync( _cur_id );
+    cp.Sync( _cur_pid );
+    cp.Sync( _sim_state );
+    cp.Sync( _deadlock_timer );
+    cp.Sync( total_phases );
+    cp.Sync( prev_latency );
+    cp.Sync( prev_accepted );
+
+    cp.Sync( _qtime );
+    cp.Sync( _qdrained );
+    cp.Sync( _partial_packets );
+    cp.Sync( _last_class );
+    cp.Sync( _last_vc );
+    cp.Sync( _packet_seq_no );
+    cp.Sync( _requestsOutstanding );
+    cp.Sync( _repliesPending );
+
+    cp.Sync( _next_inject );
+    vector<int> event_times;
+    vector<int> event_sources;
+    if ( !cp.Loading( ) ) {
+        priority_queue<pair<int, int>, vector<pair<int, int> >,
+                       greater<pair<int, int> > > events = _inject_events;
+        while ( !events.empty( ) ) {
+            event_times.push_back( events.top( ).first );
+            event_sources.push_back( events.top( ).second );
+            events.pop( );
+        }
+    }
+    cp.Sync( event_times );
+    cp.Sync( event_sources );
+    if ( cp.Loading( ) ) {
+        while ( !_inject_events.empty( ) ) {
+            _inject_events.pop( );
+        }
+        for ( size_t i = 0; i < event_times.size( ); ++i ) {
+            _inject_events.push( make_pair( event_times[i], event_sources[i] ) );
+        }
+    }
+    cp.Sync( _inject_blocked );
+
+    cp.Sync( _total_in_flight_flits );
+    cp.Sync( _measured_in_flight_flits );
+    cp.Sync( _retired_packets );
+
+    for ( int n = 0; n < _nodes; ++n ) {
+        for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+            _buf_states[n][subnet]->Serialize( cp );
+        }
+    }
+    for ( int c = 0; c < _classes; ++c ) {
+        _injection_process[c]->Serialize( cp );
+    }
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+        _net[subnet]->Serialize( cp );
+    }
+    _Serialize( cp );
+
+    vector<long> random_x;
+    vector<double> random_u;
+    if ( !cp.Loading( ) ) {
+        SaveRandomGenerator( random_x, random_u );
+    }
+    cp.Sync( random_x );
+    cp.Sync( random_u );
+    if ( cp.Loading( ) ) {
+        RestoreRandomGenerator( random_x, random_u );
+    }
+}
+
 bool TrafficManager::Run( )
 {
     for ( int sim = 0; sim < _total_sims; ++sim ) {
 
+        /* ==== Power Gate - Begin ==== */
+        // account for the power states of the retired routers before the
+        // clock restarts
+        for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+            _net[subnet]->SynchronizePowerStates( );
+        }
+        /* ==== Power Gate - End ==== */
         _time = 0;
 
         //remove any pending request from the previous simulations
@@ -1681,6 +2248,7 @@ bool TrafficManager::Run( )
             _traffic_pattern[c]->reset();
             _injection_process[c]->reset();
         }
+        _InitInjectionEvents( );
 
         if ( !_SingleSim( ) ) {
             cout << "Simulation unstable, ending ..." << endl;
@@ -1698,9 +2266,13 @@ bool TrafficManager::Run( )
         }
 
         while( packets_left ) {
+            int const step_time = _time;
+            // do not skip past the next progress report
+            _step_limit = _time + 1000 - ( empty_steps % 1000 );
             _Step( );
+            _step_limit = 0;
 
-            ++empty_steps;
+            empty_steps += _time - step_time;
 
             if ( empty_steps % 1000 == 0 ) {
                 _DisplayRemaining( );
@@ -1712,6 +2284,7 @@ bool TrafficManager::Run( )
             }
         }
         //wait until all the credits are drained as well
+        _step_limit = numeric_limits<int>::max();
         while(Credit::OutStanding()!=0){
             _Step();
         }
@@ -1719,6 +2292,7 @@ bool TrafficManager::Run( )
         while (Handshake::OutStanding() != 0) {
           _Step();
         }
+        _step_limit = 0;
         _empty_network = false;
 
         //for the love of god don't ever say "Time taken" anywhere else
@@ -1728,6 +2302,9 @@ bool TrafficManager::Run( )
         if(_stats_out) {
             WriteStats(*_stats_out);
         }
+        if(_pair_stats_out) {
+            _WritePairStatsBinary(*_pair_stats_out);
+        }
         _UpdateOverallStats();
     }
 
@@ -1752,6 +2329,21 @@ void TrafficManager::_UpdateOverallStats() {
         _overall_min_nlat[c] += _nlat_stats[c]->Min();
         _overall_avg_nlat[c] += _nlat_stats[c]->Average();
         _overall_max_nlat[c] += _nlat_stats[c]->Max();
+        for(size_t i = 0; i < _latency_quantiles.size(); ++i) {
+            _overall_plat_quantiles[c][i] += _plat_stats[c]->Quantile(_latency_quantiles[i]);
+            _overall_nlat_quantiles[c][i] += _nlat_stats[c]->Quantile(_latency_quantiles[i]);
+        }
+        if(_confidence_stopping) {
+            // an interval that could not be established is unbounded
+            double mean, half_width;
+            int batches;
+            _overall_plat_ci[c] +=
+                _plat_batches[c].Interval(_ci_confidence, &mean, &half_width, &batches) ?
+                half_width : numeric_limits<double>::infinity();
+            _overall_accepted_ci[c] +=
+                _accepted_batches[c].Interval(_ci_confidence, &mean, &half_width, &batches) ?
+                half_width : numeric_limits<double>::infinity();
+        }
         _overall_min_flat[c] += _flat_stats[c]->Min();
         _overall_avg_flat[c] += _flat_stats[c]->Average();
         _overall_max_flat[c] += _flat_stats[c]->Max();
@@ -1844,34 +2436,9 @@ void TrafficManager::WriteStats(ostream & os) const {
            << "flat_hist(" << c+1 << ",:) = " << *_flat_stats[c] << ";" << endl
            << "frag_hist(" << c+1 << ",:) = " << *_frag_stats[c] << ";" << endl
            << "hops(" << c+1 << ",:) = " << *_hop_stats[c] << ";" << endl;
+        _WriteLatencyQuantiles(os, c);
         if(_pair_stats){
-            os<< "pair_sent(" << c+1 << ",:) = [ ";
-            for(int i = 0; i < _nodes; ++i) {
-                for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_plat[c][i*_nodes+j]->NumSamples() << " ";
-                }
-            }
-            os << "];" << endl
-               << "pair_plat(" << c+1 << ",:) = [ ";
-            for(int i = 0; i < _nodes; ++i) {
-                for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_plat[c][i*_nodes+j]->Average( ) << " ";
-                }
-            }
-            os << "];" << endl
-               << "pair_nlat(" << c+1 << ",:) = [ ";
-            for(int i = 0; i < _nodes; ++i) {
-                for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_nlat[c][i*_nodes+j]->Average( ) << " ";
-                }
-            }
-            os << "];" << endl
-               << "pair_flat(" << c+1 << ",:) = [ ";
-            for(int i = 0; i < _nodes; ++i) {
-                for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_flat[c][i*_nodes+j]->Average( ) << " ";
-                }
-            }
+            _WritePairStats(os, c);
         }
 
         double time_delta = (double)(_drain_time - _reset_time);
@@ -2027,10 +2594,14 @@ void TrafficManager::DisplayStats(ostream & os) const {
         cout
             << "Packet latency average = " << _plat_stats[c]->Average() << endl
             << "\tminimum = " << _plat_stats[c]->Min() << endl
-            << "\tmaximum = " << _plat_stats[c]->Max() << endl
+            << "\tmaximum = " << _plat_stats[c]->Max() << endl;
+        _DisplayLatencyQuantiles(cout, _plat_stats[c]);
+        cout
             << "Network latency average = " << _nlat_stats[c]->Average() << endl
             << "\tminimum = " << _nlat_stats[c]->Min() << endl
-            << "\tmaximum = " << _nlat_stats[c]->Max() << endl
+            << "\tmaximum = " << _nlat_stats[c]->Max() << endl;
+        _DisplayLatencyQuantiles(cout, _nlat_stats[c]);
+        cout
             << "Slowest packet = " << _slowest_packet[c] << endl
             << "Flit latency average = " << _flat_stats[c]->Average() << endl
             << "\tminimum = " << _flat_stats[c]->Min() << endl
@@ -2141,6 +2712,7 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_plat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        _DisplayOverallLatencyQuantiles(os, _overall_plat_quantiles[c]);
 
         os << "Network latency average = " << _overall_avg_nlat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
@@ -2148,6 +2720,7 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_nlat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        _DisplayOverallLatencyQuantiles(os, _overall_nlat_quantiles[c]);
 
         os << "Flit latency average = " << _overall_avg_flat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
@@ -2200,6 +2773,8 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
         os << "Hops average = " << _overall_hop_stats[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
 
+        _DisplayOverallConfidence(os, c);
+
 #ifdef TRACK_STALLS
         os << "Buffer busy stall rate = " << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl
@@ -2251,6 +2826,18 @@ string TrafficManager::_OverallStatsCSV(int c) const
        << ',' << _overall_avg_accepted[c] / _overall_avg_accepted_packets[c]
        << ',' << _overall_hop_stats[c] / (double)_total_sims;
 
+    for(size_t i = 0; i < _latency_quantiles.size(); ++i) {
+        os << ',' << _overall_plat_quantiles[c][i] / (double)_total_sims;
+    }
+    for(size_t i = 0; i < _latency_quantiles.size(); ++i) {
+        os << ',' << _overall_nlat_quantiles[c][i] / (double)_total_sims;
+    }
+
+    if(_confidence_stopping) {
+        os << ',' << _overall_plat_ci[c] / (double)_total_sims
+           << ',' << _overall_accepted_ci[c] / (double)_total_sims;
+    }
+
 #ifdef TRACK_STALLS
     os << ',' << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
        << ',' << (double)_overall_buffer_conflict_stalls[c] / (double)_total_sims
@@ -2262,9 +2849,131 @@ string TrafficManager::_OverallStatsCSV(int c) const
     return os.str();
 }
 
+void TrafficManager::_WriteLatencyQuantiles(ostream & os, int c) const
+{
+    if(_latency_quantiles.empty()) {
+        return;
+    }
+    os << "quantiles(" << c+1 << ",:) = [ ";
+    for(size_t i = 0; i < _latency_quantiles.size(); ++i) {
+        os << _latency_quantiles[i] << " ";
+    }
+    os << "];" << endl
+       << "plat_quantiles(" << c+1 << ",:) = [ ";
+    for(size_t i = 0; i < _latency_quantiles.size(); ++i) {
+        os << _plat_stats[c]->Quantile(_latency_quantiles[i]) << " ";
+    }
+    os << "];" << endl
+       << "nlat_quantiles(" << c+1 << ",:) = [ ";
+    for(size_t i = 0; i < _latency_quantiles.size(); ++i) {
+        os << _nlat_stats[c]->Quantile(_latency_quantiles[i]) << " ";
+    }
+    os << "];" << endl;
+}
+
+// the pair_flat array is closed by the caller
+void TrafficManager::_WritePairStats(ostream & os, int c) const
+{
+    for(size_t q = 0; q < _latency_quantiles.size() && _pair_plat[c]->HasQuantiles(); ++q) {
+        os << "pair_plat_quantiles(" << c+1 << "," << q+1 << ",:) = [ ";
+        for(int i = 0; i < _nodes; ++i) {
+            for(int j = 0; j < _nodes; ++j) {
+                os << _pair_plat[c]->Quantile(i, j, _latency_quantiles[q]) << " ";
+            }
+        }
+        os << "];" << endl;
+    }
+    os<< "pair_sent(" << c+1 << ",:) = [ ";
+    for(int i = 0; i < _nodes; ++i) {
+        for(int j = 0; j < _nodes; ++j) {
+            os << _pair_plat[c]->NumSamples(i, j) << " ";
+        }
+    }
+    os << "];" << endl
+       << "pair_plat(" << c+1 << ",:) = [ ";
+    for(int i = 0; i < _nodes; ++i) {
+        for(int j = 0; j < _nodes; ++j) {
+            os << _pair_plat[c]->Average(i, j) << " ";
+        }
+    }
+    os << "];" << endl
+       << "pair_nlat(" << c+1 << ",:) = [ ";
+    for(int i = 0; i < _nodes; ++i) {
+        for(int j = 0; j < _nodes; ++j) {
+            os << _pair_nlat[c]->Average(i, j) << " ";
+        }
+    }
+    os << "];" << endl
+       << "pair_flat(" << c+1 << ",:) = [ ";
+    for(int i = 0; i < _nodes; ++i) {
+        for(int j = 0; j < _nodes; ++j) {
+            os << _pair_flat[c]->Average(i, j) << " ";
+        }
+    }
+}
+
+// one record per measured class: the class (int32) followed by the packet,
+// network and flit latency pair statistics (see PairStats::WriteBinary)
+void TrafficManager::_WritePairStatsBinary(ostream & os) const
+{
+    for(int c = 0; c < _classes; ++c) {
+        if(_measure_stats[c] == 0) {
+            continue;
+        }
+        int32_t const cl = c;
+        os.write((char const *)&cl, sizeof(cl));
+        _pair_plat[c]->WriteBinary(os);
+        _pair_nlat[c]->WriteBinary(os);
+        _pair_flat[c]->WriteBinary(os);
+    }
+    os.flush();
+}
+
+void TrafficManager::_DisplayLatencyQuantiles(ostream & os, Stats const * stats) const
+{
+    for(size_t i = 0; i < _latency_quantiles.size(); ++i) {
+        os << "\tp" << 100.0 * _latency_quantiles[i] << " = "
+           << stats->Quantile(_latency_quantiles[i]) << endl;
+    }
+}
+
+void TrafficManager::_DisplayOverallLatencyQuantiles(ostream & os,
+                                                     vector<double> const & quantiles) const
+{
+    for(size_t i = 0; i < _latency_quantiles.size(); ++i) {
+        os << "\tp" << 100.0 * _latency_quantiles[i] << " = "
+           << quantiles[i] / (double)_total_sims
+           << " (" << _total_sims << " samples)" << endl;
+    }
+}
+
+void TrafficManager::_DisplayOverallConfidence(ostream & os, int c) const
+{
+    if(!_confidence_stopping) {
+        return;
+    }
+    os << "Packet latency " << 100.0 * _ci_confidence << "% CI half-width = "
+       << _overall_plat_ci[c] / (double)_total_sims
+       << " (" << _total_sims << " samples)" << endl;
+    os << "Accepted flit rate " << 100.0 * _ci_confidence << "% CI half-width = "
+       << _overall_accepted_ci[c] / (double)_total_sims
+       << " (" << _total_sims << " samples)" << endl;
+}
+
 void TrafficManager::DisplayOverallStatsCSV(ostream & os) const {
     for(int c = 0; c < _classes; ++c) {
-        os << "results:" << c << ',' << _OverallStatsCSV() << endl;
+        os << "results:" << c << ',' << _OverallStatsCSV(c) << endl;
+    }
+}
+
+void TrafficManager::Summarize(SimSummary * summary) const {
+    summary->measured.resize(_classes);
+    summary->latency.resize(_classes);
+    summary->accepted.resize(_classes);
+    for(int c = 0; c < _classes; ++c) {
+        summary->measured[c] = (_measure_stats[c] != 0);
+        summary->latency[c] = _overall_avg_plat[c] / (double)_total_sims;
+        summary->accepted[c] = _overall_avg_accepted[c] / (double)_total_sims;
     }
 }
 
@@ -31,6 +31,8 @@
 #include <list>
 #include <map>
 #include <set>
+#include <queue>
+#include <functional>
 #include <cassert>
 
 #include "module.hpp"
@@ -39,14 +41,25 @@
 #include "flit.hpp"
 #include "buffer_state.hpp"
 #include "stats.hpp"
+#include "pair_stats.hpp"
+#include "batch_means.hpp"
 #include "traffic.hpp"
 #include "routefunc.hpp"
 #include "outputset.hpp"
 #include "injection.hpp"
+#include "checkpoint.hpp"
 
 //register the requests to a node
 class PacketReplyInfo;
 
+// overall averages of the simulations, per class, for searches that run
+// several simulations
+struct SimSummary {
+  vector<bool> measured;
+  vector<double> latency;
+  vector<double> accepted;
+};
+
 class TrafficManager : public Module {
 
 private:
@@ -113,6 +126,15 @@ protected:
   vector<vector<bool> > _qdrained;
   vector<vector<list<Flit *> > > _partial_packets;
 
+  // event-based injection: the next injection time of each source is drawn
+  // in advance, and sources are kept in a heap ordered by that time
+  vector<bool> _event_injection;
+  bool _legacy_injection;
+  vector<vector<int> > _next_inject;
+  priority_queue<pair<int, int>, vector<pair<int, int> >,
+                 greater<pair<int, int> > > _inject_events;
+  vector<int> _inject_blocked;
+
   vector<map<int, Flit *> > _total_in_flight_flits;
   vector<map<int, Flit *> > _measured_in_flight_flits;
   vector<map<int, Flit *> > _retired_packets;
@@ -131,6 +153,11 @@ protected:
   int _deadlock_timer;
   int _deadlock_warn_timeout;
 
+  // ============ idle-cycle fast-forward ==========
+
+  bool _fast_forward;
+  int _step_limit;
+
   // ============ request & replies ==========================
 
   vector<int> _packet_seq_no;
@@ -159,13 +186,20 @@ protected:
   vector<double> _overall_avg_frag;
   vector<double> _overall_max_frag;
 
-  vector<vector<Stats *> > _pair_plat;
-  vector<vector<Stats *> > _pair_nlat;
-  vector<vector<Stats *> > _pair_flat;
+  vector<PairStats *> _pair_plat;
+  vector<PairStats *> _pair_nlat;
+  vector<PairStats *> _pair_flat;
 
   vector<Stats *> _hop_stats;
   vector<double> _overall_hop_stats;
 
+  vector<double> _latency_quantiles;
+  vector<vector<double> > _overall_plat_quantiles;
+  vector<vector<double> > _overall_nlat_quantiles;
+
+  vector<double> _overall_plat_ci;
+  vector<double> _overall_accepted_ci;
+
   vector<vector<int> > _sent_packets;
   vector<double> _overall_min_sent_packets;
   vector<double> _overall_avg_sent_packets;
@@ -218,12 +252,25 @@ protected:
 
   int _converged_threshold;
 
+  bool _confidence_stopping;
+  double _ci_half_width;
+  double _ci_confidence;
+  vector<BatchMeans> _plat_batches;
+  vector<BatchMeans> _accepted_batches;
+
+  string _checkpoint_out;
+  string _checkpoint_in;
+  bool _checkpoint_warmup;
+
   int   _include_queuing;
 
   vector<int> _measure_stats;
   bool _pair_stats;
 
   vector<double> _latency_thres;
+  int _latency_trend_periods;
+  double _latency_trend_growth;
+  int _latency_trend_min_samples;
 
   vector<double> _stopping_threshold;
   vector<double> _acc_stopping_threshold;
@@ -243,6 +290,7 @@ protected:
 
   //flits to watch
   ostream * _stats_out;
+  ostream * _pair_stats_out;
 
 #ifdef TRACK_FLOWS
   vector<vector<int> > _injected_flits;
@@ -268,7 +316,14 @@ protected:
   virtual void _RetireFlit( Flit *f, int dest );
 
   virtual void _Inject();
+  void _InitInjectionEvents( );
+  void _ScheduleInjection( int source, int cl );
+  void _InjectEvents( );
+  /* ==== Power Gate - Begin ==== */
+  void _SetCoreState( int node, bool state );
+  /* ==== Power Gate - End ==== */
   virtual void _Step( );
+  bool _SkipIdleCycles( bool power_evaluate );
 
   bool _PacketsOutstanding( ) const;
 
@@ -289,6 +344,22 @@ protected:
 
   virtual string _OverallStatsCSV(int c = 0) const;
 
+  void _WriteLatencyQuantiles(ostream & os, int c) const;
+  void _WritePairStats(ostream & os, int c) const;
+  void _WritePairStatsBinary(ostream & os) const;
+  void _DisplayLatencyQuantiles(ostream & os, Stats const * stats) const;
+  void _DisplayOverallLatencyQuantiles(ostream & os,
+                                       vector<double> const & quantiles) const;
+  void _DisplayOverallConfidence(ostream & os, int c) const;
+  bool _ConfidenceReached() const;
+  bool _LatencyGrowing(double latency, int samples, double & last, int & periods) const;
+
+  void _SerializeState(Checkpoint & cp, int & total_phases,
+                       vector<double> & prev_latency,
+                       vector<double> & prev_accepted);
+  // state of the derived traffic managers
+  virtual void _Serialize(Checkpoint & cp) {}
+
   int _GetNextPacketSize(int cl) const;
   double _GetAveragePacketSize(int cl) const;
 
@@ -307,6 +378,7 @@ public:
   virtual void DisplayStats( ostream & os = cout ) const ;
   virtual void DisplayOverallStats( ostream & os = cout ) const ;
   virtual void DisplayOverallStatsCSV( ostream & os = cout ) const ;
+  void Summarize( SimSummary * summary ) const;
 
   inline int getTime() { return _time;}
   Stats * getStats(const string & name) { return _stats[name]; }
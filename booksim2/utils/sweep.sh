@@ -38,6 +38,9 @@
 # result data can be gathered from standard output by grepping for lines that 
 # start with "results:"; miscellaneous status information for the script 
 # itself is printed out in lines that begin with "SWEEP: ".
+#
+# BookSim's 'sim_type = saturation' performs a similar search within a single
+# run, starting each injection rate from the warmed-up state of the last one.
 
 if [ "${1}" = "" ]
 then
@@ -786,7 +786,8 @@ int Gem5NoRDTrafficManager::NextPowerEventCycle()
     const vector<BSRouter *> routers = _net[0]->GetRouters();
     for (int r = 0; r < routers.size(); r++) {
         int next_event_cycle = routers[r]->NextPowerEventCycle();
-        if (cycle > 0 && next_event_cycle > 0 && next_event_cycle < cycle)
+        // 0 means no event, the earliest event of any router wins
+        if (next_event_cycle > 0 && (cycle == 0 || next_event_cycle < cycle))
             cycle = next_event_cycle;
     }
     if (_time % _wakeup_monitor_epoch != 0 &&
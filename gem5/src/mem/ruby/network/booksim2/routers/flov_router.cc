@@ -14,6 +14,7 @@
 #include <cstdlib>
 #include <cassert>
 #include <limits>
+#include <algorithm>
 
 #include "mem/ruby/network/booksim2/globals.hh"
 #include "mem/ruby/network/booksim2/random_utils.hh"
@@ -1003,6 +1004,18 @@ int FLOVRouter::NextPowerEventCycle()
             Error(err.str());
     }
 
+    // break-even time of a gated router that is going to wake up, and the
+    // end of a wakeup
+    int timer = 0;
+    if (_power_state == power_off &&
+            (_flov_policy == noflov ||
+             (_flov_policy == rflov && (_router_state || _wakeup_signal))))
+        timer = max(1, _bet_threshold - _off_timer);
+    else if (_power_state == wakeup)
+        timer = max(1, _wakeup_threshold - _wakeup_timer);
+    if (timer > 0 && (cycle == 0 || timer < cycle))
+        cycle = timer;
+
     return cycle;
 }
 /* ==== Power Gate - End ==== */
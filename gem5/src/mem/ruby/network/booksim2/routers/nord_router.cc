@@ -401,6 +401,11 @@ int NoRDRouter::NextPowerEventCycle()
         else
             cycle = _idle_threshold - _idle_timer + 1;
     }
+    // break-even time once a wakeup is requested, and the end of a wakeup
+    if (_power_state == power_off && _wakeup_signal)
+        cycle = max(1, _bet_threshold - _off_timer);
+    else if (_power_state == wakeup)
+        cycle = max(1, _wakeup_threshold - _wakeup_timer);
 
     return cycle;
 }
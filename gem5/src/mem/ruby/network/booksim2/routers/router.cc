@@ -268,6 +268,8 @@ void BSRouter::SynchronizeCycle(uint64_t cycles)
         _off_timer += cycles;
         _power_off_cycles += cycles;
         _total_power_off_cycles += cycles;
+    } else if (_power_state == wakeup) {
+        _wakeup_timer += cycles;
     }
 }
 